@@ -0,0 +1,81 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   ArgumentTemplates.cpp
+//! \brief  The ArgumentTemplates class definition.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include "ArgumentTemplates.hpp"
+
+namespace WMI
+{
+
+////////////////////////////////////////////////////////////////////////////////
+//! Default constructor.
+
+ArgumentTemplates::ArgumentTemplates()
+	: m_lock()
+	, m_definitions()
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Destructor.
+
+ArgumentTemplates::~ArgumentTemplates()
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the number of cached definitions.
+
+size_t ArgumentTemplates::size() const
+{
+	CriticalSection::Lock lock(m_lock);
+
+	return m_definitions.size();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Find the definition of a method's input parameters. The definition is null
+//! for a method that takes no arguments.
+
+bool ArgumentTemplates::find(const tstring& className, const tstring& methodName, IWbemClassObjectPtr& definition) const
+{
+	const tstring key = formatKey(className, methodName);
+
+	CriticalSection::Lock lock(m_lock);
+
+	Definitions::const_iterator it = m_definitions.find(key);
+
+	if (it == m_definitions.end())
+		return false;
+
+	definition = it->second;
+
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Add the definition of a method's input parameters. The definition must not
+//! be modified afterwards as it is shared, instead an instance should be
+//! spawned from it for each call.
+
+void ArgumentTemplates::add(const tstring& className, const tstring& methodName, IWbemClassObjectPtr definition)
+{
+	const tstring key = formatKey(className, methodName);
+
+	CriticalSection::Lock lock(m_lock);
+
+	m_definitions[key] = definition;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Format the key for a method.
+
+tstring ArgumentTemplates::formatKey(const tstring& className, const tstring& methodName)
+{
+	return className + TXT(".") + methodName;
+}
+
+//namespace WMI
+}
@@ -0,0 +1,79 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   ArgumentTemplates.hpp
+//! \brief  The ArgumentTemplates class declaration.
+//! \author Chris Oldwood
+
+// Check for previous inclusion
+#ifndef WMI_ARGUMENTTEMPLATES_HPP
+#define WMI_ARGUMENTTEMPLATES_HPP
+
+#if _MSC_VER > 1000
+#pragma once
+#endif
+
+#include "Types.hpp"
+#include "CriticalSection.hpp"
+#include <Core/NotCopyable.hpp>
+#include <Core/SharedPtr.hpp>
+#include <map>
+
+namespace WMI
+{
+
+////////////////////////////////////////////////////////////////////////////////
+//! A cache of the definitions of the input parameters for methods, keyed by
+//! class and method name. Fetching a definition requires a round-trip for the
+//! class and so each is only fetched once per connection. The cache is shared
+//! by the objects created from a connection and is thread-safe.
+
+class ArgumentTemplates : private Core::NotCopyable
+{
+public:
+	//! Default constructor.
+	ArgumentTemplates();
+
+	//! Destructor.
+	~ArgumentTemplates();
+
+	//
+	// Properties.
+	//
+
+	//! Get the number of cached definitions.
+	size_t size() const;
+
+	//
+	// Methods.
+	//
+
+	//! Find the definition of a method's input parameters.
+	bool find(const tstring& className, const tstring& methodName, IWbemClassObjectPtr& definition) const;
+
+	//! Add the definition of a method's input parameters.
+	void add(const tstring& className, const tstring& methodName, IWbemClassObjectPtr definition);
+
+private:
+	//! The definitions, keyed by class and method name.
+	typedef std::map<tstring, IWbemClassObjectPtr> Definitions;
+
+	//
+	// Members.
+	//
+	mutable CriticalSection	m_lock;			//!< The lock guarding the definitions.
+	Definitions				m_definitions;	//!< The cached definitions.
+
+	//
+	// Internal methods.
+	//
+
+	//! Format the key for a method.
+	static tstring formatKey(const tstring& className, const tstring& methodName);
+};
+
+//! The default ArgumentTemplates smart-pointer type.
+typedef Core::SharedPtr<ArgumentTemplates> ArgumentTemplatesPtr;
+
+//namespace WMI
+}
+
+#endif // WMI_ARGUMENTTEMPLATES_HPP
@@ -0,0 +1,327 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   AssociationWalker.cpp
+//! \brief  The AssociationWalker class definition.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include "AssociationWalker.hpp"
+#include "MarshalledConnection.hpp"
+#include "Object.hpp"
+#include "ObjectIterator.hpp"
+#include "MemoryObject.hpp"
+#include "Exception.hpp"
+#include <algorithm>
+
+namespace WMI
+{
+
+//! The number of sources a worker queries at a time. A chunk cannot be stolen
+//! once taken, so it is kept small as one slow host would otherwise hold up
+//! the rest of the chunk, but large enough to take the lock on the worker's
+//! share once per few round-trips instead of once per query.
+static const size_t QUERY_CHUNK_SIZE = 4;
+
+////////////////////////////////////////////////////////////////////////////////
+//! The pool task that runs the query for each source and copies the targets.
+
+class AssociationWalker::QueryTask : public WorkStealingPool::Task
+{
+public:
+	//! A target found by a worker.
+	struct Target
+	{
+		size_t				m_source;	//!< The position of the source it was found from.
+		tstring				m_path;		//!< The relative path of the target.
+		IWbemClassObjectPtr	m_object;	//!< The in-memory copy of the target.
+	};
+
+	//! The targets found by a worker.
+	typedef std::vector<Target> Targets;
+
+	//! The queries, by source.
+	typedef std::vector<tstring> Queries;
+
+public:
+	//! Constructor.
+	QueryTask(const Connection& connection, const Queries& queries, const Paths& found, size_t workers); // throw(WMI::Exception)
+
+	//! Destructor.
+	virtual ~QueryTask();
+
+	//! Unmarshal the connection for the worker.
+	virtual void startWorker(size_t worker); // throw(WMI::Exception)
+
+	//! Run the queries for a range of sources.
+	virtual void process(size_t worker, size_t begin, size_t end);
+
+	//! Release the worker's connection.
+	virtual void stopWorker(size_t worker);
+
+	//! Get the targets found by a worker.
+	const Targets& targets(size_t worker) const;
+
+	//! Get the number of targets discarded by a worker.
+	size_t duplicates(size_t worker) const;
+
+	//! Get the result of the query for a source.
+	HRESULT result(size_t source) const;
+
+	//! Order the targets by the position of their source.
+	static bool lessBySource(const Target& lhs, const Target& rhs);
+
+private:
+	//
+	// Members.
+	//
+	MarshalledConnection	m_connection;	//!< The connection to hand to the workers.
+	const Queries&			m_queries;		//!< The queries to run.
+	const Paths&			m_found;		//!< The paths found before this level.
+	std::vector<Connection>	m_connections;	//!< The unmarshalled connections, by worker.
+	std::vector<Targets>	m_targets;		//!< The targets found, by worker.
+	std::vector<Paths>		m_paths;		//!< The paths of the targets found, by worker.
+	std::vector<size_t>		m_duplicates;	//!< The targets discarded, by worker.
+	std::vector<HRESULT>	m_results;		//!< The result of each query, by source.
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//! Constructor.
+
+AssociationWalker::QueryTask::QueryTask(const Connection& connection, const Queries& queries, const Paths& found, size_t workers)
+	: m_connection(connection)
+	, m_queries(queries)
+	, m_found(found)
+	, m_connections(workers)
+	, m_targets(workers)
+	, m_paths(workers)
+	, m_duplicates(workers, 0)
+	, m_results(queries.size(), S_OK)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Destructor.
+
+AssociationWalker::QueryTask::~QueryTask()
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Unmarshal the connection for the worker.
+
+void AssociationWalker::QueryTask::startWorker(size_t worker)
+{
+	m_connections[worker] = m_connection.unmarshal();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Run the queries for a range of sources. A target that was found before this
+//! level, or already by this worker, is discarded before it is copied. The set
+//! of paths found before this level is only read whilst the workers run. A
+//! query that fails has its error recorded, keeping any targets it had already
+//! returned, and the worker moves on to the next source.
+
+void AssociationWalker::QueryTask::process(size_t worker, size_t begin, size_t end)
+{
+	const Connection&    connection = m_connections[worker];
+	const ObjectIterator last;
+
+	for (size_t source = begin; source != end; ++source)
+	{
+		try
+		{
+			for (ObjectIterator it = connection.execQuery(m_queries[source].c_str()); it != last; ++it)
+			{
+				const tstring path = it->relativePath();
+
+				if ( (m_found.find(path) != m_found.end()) || !m_paths[worker].insert(path).second )
+				{
+					++m_duplicates[worker];
+					continue;
+				}
+
+				const Target target = { source, path, MemoryObject::copy(it->get()) };
+
+				m_targets[worker].push_back(target);
+			}
+		}
+		catch (const Exception& e)
+		{
+			m_results[source] = e.m_result;
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Release the worker's connection, which must be done in its apartment.
+
+void AssociationWalker::QueryTask::stopWorker(size_t worker)
+{
+	m_connections[worker].close();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the targets found by a worker.
+
+const AssociationWalker::QueryTask::Targets& AssociationWalker::QueryTask::targets(size_t worker) const
+{
+	return m_targets[worker];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the number of targets discarded by a worker.
+
+size_t AssociationWalker::QueryTask::duplicates(size_t worker) const
+{
+	return m_duplicates[worker];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the result of the query for a source.
+
+HRESULT AssociationWalker::QueryTask::result(size_t source) const
+{
+	return m_results[source];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Order the targets by the position of their source.
+
+bool AssociationWalker::QueryTask::lessBySource(const Target& lhs, const Target& rhs)
+{
+	return (lhs.m_source < rhs.m_source);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Construction with the association to follow, e.g. Win32_DependentService,
+//! the class of the targets and the role of the sources, any of which can be
+//! empty, and the limit on the queries outstanding, or one per processor if 0.
+
+AssociationWalker::AssociationWalker(const tstring& assocClass, const tstring& resultClass, const tstring& role, size_t maxQueries)
+	: m_assocClass(assocClass)
+	, m_resultClass(resultClass)
+	, m_role(role)
+	, m_pool(maxQueries)
+	, m_queries(0)
+	, m_duplicates(0)
+	, m_failures()
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Destructor.
+
+AssociationWalker::~AssociationWalker()
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Find the distinct objects associated with any of the sources. The targets
+//! replace the contents of the collection and are ordered by the first source
+//! they were found from. The connection must be usable on the calling thread.
+
+size_t AssociationWalker::associators(const Connection& connection, const Objects& sources, Objects& targets)
+{
+	Paths found;
+
+	targets.clear();
+	m_queries = 0;
+	m_duplicates = 0;
+	m_failures.clear();
+
+	expand(connection, sources, found, targets);
+
+	return targets.size();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Find the distinct objects reachable from the sources by following the
+//! association repeatedly, a level at a time, up to a depth. The sources are
+//! not included, and each object is only queried once so that cycles end. The
+//! objects replace the contents of the collection and are ordered by level. An
+//! object whose query fails is not followed any further.
+
+size_t AssociationWalker::walk(const Connection& connection, const Objects& sources, Objects& reached, size_t maxDepth)
+{
+	Paths   found;
+	Objects level(sources);
+	Objects next;
+
+	reached.clear();
+	m_queries = 0;
+	m_duplicates = 0;
+	m_failures.clear();
+
+	for (Objects::const_iterator it = sources.begin(); it != sources.end(); ++it)
+		found.insert(Object(*it, connection).relativePath());
+
+	for (size_t depth = 0; (depth != maxDepth) && !level.empty(); ++depth)
+	{
+		next.clear();
+
+		expand(connection, level, found, next);
+
+		reached.insert(reached.end(), next.begin(), next.end());
+		level.swap(next);
+	}
+
+	return reached.size();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Query the targets of a set of sources, appending those not already found
+//! and adding their paths to those found. The sources whose query failed are
+//! appended to the failures.
+
+void AssociationWalker::expand(const Connection& connection, const Objects& sources, Paths& found, Objects& targets)
+{
+	if (sources.empty())
+		return;
+
+	std::vector<tstring> paths;
+	QueryTask::Queries   queries;
+
+	paths.reserve(sources.size());
+	queries.reserve(sources.size());
+
+	for (Objects::const_iterator it = sources.begin(); it != sources.end(); ++it)
+	{
+		paths.push_back(Object(*it, connection).relativePath());
+		queries.push_back(Object::formatAssociatorsQuery(paths.back(), m_assocClass, m_resultClass, m_role));
+	}
+
+	QueryTask task(connection, queries, found, m_pool.workers());
+
+	m_pool.run(task, queries.size(), QUERY_CHUNK_SIZE);
+	m_queries += queries.size();
+
+	for (size_t source = 0; source != paths.size(); ++source)
+	{
+		if (FAILED(task.result(source)))
+		{
+			const Failure failure = { paths[source], task.result(source) };
+
+			m_failures.push_back(failure);
+		}
+	}
+
+	QueryTask::Targets all;
+
+	for (size_t worker = 0; worker != m_pool.workers(); ++worker)
+	{
+		all.insert(all.end(), task.targets(worker).begin(), task.targets(worker).end());
+		m_duplicates += task.duplicates(worker);
+	}
+
+	std::stable_sort(all.begin(), all.end(), QueryTask::lessBySource);
+
+	for (QueryTask::Targets::const_iterator it = all.begin(); it != all.end(); ++it)
+	{
+		if (found.insert(it->m_path).second)
+			targets.push_back(it->m_object);
+		else
+			++m_duplicates;
+	}
+}
+
+//namespace WMI
+}
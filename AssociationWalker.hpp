@@ -0,0 +1,163 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   AssociationWalker.hpp
+//! \brief  The AssociationWalker class declaration.
+//! \author Chris Oldwood
+
+// Check for previous inclusion
+#ifndef WMI_ASSOCIATIONWALKER_HPP
+#define WMI_ASSOCIATIONWALKER_HPP
+
+#if _MSC_VER > 1000
+#pragma once
+#endif
+
+#include "WorkStealingPool.hpp"
+#include "Types.hpp"
+#include <set>
+#include <vector>
+
+namespace WMI
+{
+
+// Forward declarations.
+class Connection;
+
+////////////////////////////////////////////////////////////////////////////////
+//! Follows an association from a whole set of source objects at once, such as
+//! from every service to the services that depend on it, instead of a query per
+//! object issued one after another.
+//!
+//! The ASSOCIATORS OF query for each source is run on a WorkStealingPool, so
+//! at most maxQueries are outstanding at a time, and each worker gets its own
+//! connection via a MarshalledConnection. The objects found are returned as
+//! in-memory copies, as with ParallelForEach::materialise(), and a target
+//! shared by several sources, or already found, is only returned once. A walk
+//! follows the association repeatedly, a level at a time, so that the number
+//! of round-trips in sequence is set by the depth rather than the object count.
+//! A source whose query fails is recorded and the traversal carries on without
+//! it, so that one unreachable object does not lose the rest of the results.
+
+class AssociationWalker : private Core::NotCopyable
+{
+public:
+	//! The materialised objects.
+	typedef std::vector<IWbemClassObjectPtr> Objects;
+
+	//! A source whose query failed.
+	struct Failure
+	{
+		tstring	m_path;		//!< The relative path of the source.
+		HRESULT	m_result;	//!< The error the query failed with.
+	};
+
+	//! The sources whose query failed.
+	typedef std::vector<Failure> Failures;
+
+public:
+	//! Construction with the association to follow and the query limit.
+	AssociationWalker(const tstring& assocClass, const tstring& resultClass = TXT(""),
+						const tstring& role = TXT(""), size_t maxQueries = DEFAULT_MAX_QUERIES);
+
+	//! Destructor.
+	~AssociationWalker();
+
+	//
+	// Properties.
+	//
+
+	//! Get the maximum number of queries outstanding at a time.
+	size_t maxQueries() const;
+
+	//! Get the number of queries issued by the last traversal.
+	size_t queries() const;
+
+	//! Get the number of targets discarded by the last traversal as already found.
+	size_t duplicates() const;
+
+	//! Get the sources whose query failed during the last traversal.
+	const Failures& failures() const;
+
+	//
+	// Methods.
+	//
+
+	//! Find the distinct objects associated with any of the sources.
+	size_t associators(const Connection& connection, const Objects& sources, Objects& targets); // throw(WMI::Exception)
+
+	//! Find the distinct objects reachable from the sources, up to a depth.
+	size_t walk(const Connection& connection, const Objects& sources, Objects& reached,
+				size_t maxDepth = UNLIMITED_DEPTH); // throw(WMI::Exception)
+
+	//
+	// Constants.
+	//
+
+	//! The default maximum number of queries outstanding at a time.
+	static const size_t DEFAULT_MAX_QUERIES = 4;
+	//! The depth that walks until no new objects are found.
+	static const size_t UNLIMITED_DEPTH = static_cast<size_t>(-1);
+
+private:
+	//! The paths of the objects found so far.
+	typedef std::set<tstring> Paths;
+
+	// Forward declarations.
+	class QueryTask;
+
+	//
+	// Members.
+	//
+	tstring				m_assocClass;	//!< The association class, or empty for any.
+	tstring				m_resultClass;	//!< The class of the targets, or empty for any.
+	tstring				m_role;			//!< The role of the sources, or empty for any.
+	WorkStealingPool	m_pool;			//!< The workers that issue the queries.
+	size_t				m_queries;		//!< The number of queries issued by the last traversal.
+	size_t				m_duplicates;	//!< The number of targets discarded by the last traversal.
+	Failures			m_failures;		//!< The sources whose query failed in the last traversal.
+
+	//
+	// Internal methods.
+	//
+
+	//! Query the targets of a set of sources, appending those not already found.
+	void expand(const Connection& connection, const Objects& sources, Paths& found, Objects& targets); // throw(WMI::Exception)
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the maximum number of queries outstanding at a time.
+
+inline size_t AssociationWalker::maxQueries() const
+{
+	return m_pool.workers();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the number of queries issued by the last traversal.
+
+inline size_t AssociationWalker::queries() const
+{
+	return m_queries;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the number of targets discarded by the last traversal as they had
+//! already been found.
+
+inline size_t AssociationWalker::duplicates() const
+{
+	return m_duplicates;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the sources whose query failed during the last traversal, in the order
+//! they were queried.
+
+inline const AssociationWalker::Failures& AssociationWalker::failures() const
+{
+	return m_failures;
+}
+
+//namespace WMI
+}
+
+#endif // WMI_ASSOCIATIONWALKER_HPP
@@ -0,0 +1,122 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   BatchSizer.cpp
+//! \brief  The BatchSizer class definition.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include "BatchSizer.hpp"
+#include <algorithm>
+#include <math.h>
+
+namespace WMI
+{
+
+//! The weight of a call relative to the one after it.
+static const double DECAY = 0.8;
+//! The fraction of the time per call that the round trip should take.
+static const double TARGET_OVERHEAD = 0.1;
+//! The smallest spread in the batch sizes, relative to the mean, that the cost
+//! can be fitted from.
+static const double MIN_SPREAD = 0.1;
+
+////////////////////////////////////////////////////////////////////////////////
+//! Construction with the maximum batch size.
+
+BatchSizer::BatchSizer(size_t maximum)
+	: m_size(INITIAL_SIZE)
+	, m_maximum(maximum)
+	, m_weight(0.0)
+	, m_sumN(0.0)
+	, m_sumT(0.0)
+	, m_sumNN(0.0)
+	, m_sumNT(0.0)
+	, m_estimated(false)
+	, m_callLatency(0.0)
+	, m_objectCost(0.0)
+{
+	ASSERT(maximum != 0);
+
+	if (m_size > m_maximum)
+		m_size = m_maximum;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Record the duration of a call and choose the next size. Calls that returned
+//! no objects, such as at the end of the sequence, are ignored.
+
+void BatchSizer::record(size_t objects, uint64 microseconds)
+{
+	if (objects == 0)
+		return;
+
+	const double n = static_cast<double>(objects);
+	const double t = static_cast<double>(microseconds);
+
+	m_weight = (m_weight * DECAY) + 1.0;
+	m_sumN   = (m_sumN   * DECAY) + n;
+	m_sumT   = (m_sumT   * DECAY) + t;
+	m_sumNN  = (m_sumNN  * DECAY) + (n * n);
+	m_sumNT  = (m_sumNT  * DECAY) + (n * t);
+
+	estimate();
+
+	m_size = chooseSize();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Update the estimates from the decayed sums. When the recent calls have all
+//! been much the same size the cost cannot be fitted reliably, and so only the
+//! latency is updated, using the last estimate of the cost.
+
+void BatchSizer::estimate()
+{
+	const double meanN = m_sumN / m_weight;
+	const double meanT = m_sumT / m_weight;
+	const double variance = (m_sumNN / m_weight) - (meanN * meanN);
+
+	if (variance >= (MIN_SPREAD * MIN_SPREAD * meanN * meanN))
+	{
+		const double covariance = (m_sumNT / m_weight) - (meanN * meanT);
+
+		m_objectCost = std::max(covariance / variance, 0.0);
+		m_estimated  = true;
+	}
+	else if (!m_estimated)
+	{
+		return;
+	}
+
+	m_callLatency = std::max(meanT - (m_objectCost * meanN), 0.0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Choose the next size from the estimates, such that the latency is the target
+//! fraction of the call. The size changes by at most a factor of two per call,
+//! so that a poor estimate, e.g. while the host is changing, cannot cause a
+//! large overshoot.
+
+size_t BatchSizer::chooseSize() const
+{
+	size_t target = m_maximum;
+
+	if (!m_estimated)
+	{
+		target = m_size * 2;
+	}
+	else if (m_objectCost > 0.0)
+	{
+		const double optimum = (m_callLatency * (1.0 - TARGET_OVERHEAD)) / (m_objectCost * TARGET_OVERHEAD);
+
+		if (optimum < static_cast<double>(m_maximum))
+			target = static_cast<size_t>(floor(optimum + 0.5));
+	}
+
+	target = std::min(target, m_size * 2);
+	target = std::max(target, m_size / 2);
+	target = std::min(target, m_maximum);
+
+	return std::max<size_t>(target, 1);
+}
+
+//namespace WMI
+}
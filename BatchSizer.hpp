@@ -0,0 +1,130 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   BatchSizer.hpp
+//! \brief  The BatchSizer class declaration.
+//! \author Chris Oldwood
+
+// Check for previous inclusion
+#ifndef WMI_BATCHSIZER_HPP
+#define WMI_BATCHSIZER_HPP
+
+#if _MSC_VER > 1000
+#pragma once
+#endif
+
+namespace WMI
+{
+
+////////////////////////////////////////////////////////////////////////////////
+//! Chooses the number of objects to request per call when enumerating, from
+//! the duration of the previous calls. Each call is modelled as a fixed latency,
+//! the round trip, plus a cost per object, which are estimated with a least
+//! squares fit that decays the older calls. The size is then chosen so that
+//! the round trip is only a small fraction of the time spent per call, which
+//! means large batches for a remote host and small ones for a local host.
+//!
+//! The size starts small and doubles until the calls vary enough in size for
+//! the fit. It never changes by more than a factor of two per call nor grows
+//! beyond the maximum, which bounds the objects held in memory.
+
+class BatchSizer
+{
+public:
+	//! Construction with the maximum batch size.
+	explicit BatchSizer(size_t maximum = DEFAULT_MAXIMUM);
+
+	//
+	// Properties.
+	//
+
+	//! Get the number of objects to request on the next call.
+	size_t size() const;
+
+	//! Get the maximum batch size.
+	size_t maximum() const;
+
+	//! Get the estimated latency, in microseconds, of a call.
+	double callLatency() const;
+
+	//! Get the estimated cost, in microseconds, of each object.
+	double objectCost() const;
+
+	//
+	// Methods.
+	//
+
+	//! Record the duration of a call and choose the next size.
+	void record(size_t objects, uint64 microseconds);
+
+	//
+	// Constants.
+	//
+
+	//! The size of the first batch.
+	static const size_t INITIAL_SIZE = 8;
+	//! The default maximum batch size.
+	static const size_t DEFAULT_MAXIMUM = 1000;
+
+private:
+	//
+	// Members.
+	//
+	size_t	m_size;			//!< The size of the next batch.
+	size_t	m_maximum;		//!< The maximum batch size.
+	double	m_weight;		//!< The decayed number of calls.
+	double	m_sumN;			//!< The decayed sum of the batch sizes.
+	double	m_sumT;			//!< The decayed sum of the durations.
+	double	m_sumNN;		//!< The decayed sum of the squared batch sizes.
+	double	m_sumNT;		//!< The decayed sum of the sizes times the durations.
+	bool	m_estimated;	//!< Has the latency and cost been estimated?
+	double	m_callLatency;	//!< The estimated latency of a call.
+	double	m_objectCost;	//!< The estimated cost per object.
+
+	//
+	// Internal methods.
+	//
+
+	//! Update the estimates from the decayed sums, if the sizes vary enough.
+	void estimate();
+
+	//! Choose the next size from the estimates.
+	size_t chooseSize() const;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the number of objects to request on the next call.
+
+inline size_t BatchSizer::size() const
+{
+	return m_size;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the maximum batch size.
+
+inline size_t BatchSizer::maximum() const
+{
+	return m_maximum;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the estimated latency, in microseconds, of a call. This is zero until
+//! enough calls have been recorded.
+
+inline double BatchSizer::callLatency() const
+{
+	return m_callLatency;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the estimated cost, in microseconds, of each object. This is zero until
+//! enough calls have been recorded.
+
+inline double BatchSizer::objectCost() const
+{
+	return m_objectCost;
+}
+
+//namespace WMI
+}
+
+#endif // WMI_BATCHSIZER_HPP
@@ -0,0 +1,97 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   Bench.cpp
+//! \brief  The benchmark harness entry point.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include "Benchmarks.hpp"
+#include <tchar.h>
+#include <Core/Exception.hpp>
+#include <Core/StringUtils.hpp>
+#include <WCL/AutoCom.hpp>
+
+////////////////////////////////////////////////////////////////////////////////
+//! Display the command line usage.
+
+static void showUsage()
+{
+	_tprintf(TXT("USAGE: Bench [--rows <count>] [--latency <microseconds>] [--iterations <count>]\n"));
+	_tprintf(TXT("             [--filter <text>] [--json <file>] [--host <name>]\n"));
+	_tprintf(TXT("\n"));
+	_tprintf(TXT("--rows        The number of rows to enumerate or export (default: 1000000)\n"));
+	_tprintf(TXT("--latency     The simulated provider latency per call and row (default: 0)\n"));
+	_tprintf(TXT("--iterations  The number of iterations of each per-call benchmark (default: 100000)\n"));
+	_tprintf(TXT("--filter      Only run the benchmarks whose name contains the text\n"));
+	_tprintf(TXT("--json        Write the results as JSON to the file\n"));
+	_tprintf(TXT("--host        Also run the remote benchmarks against the host\n"));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Parse the command line into the settings. Returns false if invalid.
+
+static bool parseCmdLine(int argc, _TCHAR* argv[], Settings& settings)
+{
+	for (int i = 1; i < argc; i += 2)
+	{
+		const tstring option = argv[i];
+
+		if (i+1 == argc)
+			return false;
+
+		const tstring value = argv[i+1];
+
+		if (option == TXT("--rows"))
+			settings.m_rows = Core::parse<uint>(value);
+		else if (option == TXT("--latency"))
+			settings.m_latency = Core::parse<uint>(value);
+		else if (option == TXT("--iterations"))
+			settings.m_iterations = Core::parse<uint>(value);
+		else if (option == TXT("--filter"))
+			settings.m_filter = value;
+		else if (option == TXT("--json"))
+			settings.m_output = value;
+		else if (option == TXT("--host"))
+			settings.m_host = value;
+		else
+			return false;
+	}
+
+	return true;
+}
+
+int _tmain(int argc, _TCHAR* argv[])
+{
+	try
+	{
+		Settings settings;
+
+		if (!parseCmdLine(argc, argv, settings))
+		{
+			showUsage();
+			return EXIT_FAILURE;
+		}
+
+		WCL::AutoCom com(COINIT_APARTMENTTHREADED);
+		Results      results(settings);
+
+		runConnectionBenchmarks(settings, results);
+		runObjectBenchmarks(settings, results);
+		runUtilityBenchmarks(settings, results);
+		runExportBenchmarks(settings, results);
+		runParallelBenchmarks(settings, results);
+		runSchedulerBenchmarks(settings, results);
+		runTimeSeriesBenchmarks(settings, results);
+		runProcessBenchmarks(settings, results);
+		runJoinBenchmarks(settings, results);
+
+		if (!settings.m_output.empty())
+			results.writeJson(settings.m_output);
+	}
+	catch (const Core::Exception& e)
+	{
+		_tprintf(TXT("ERROR: %s\n"), e.twhat());
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
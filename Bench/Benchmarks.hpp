@@ -0,0 +1,62 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   Benchmarks.hpp
+//! \brief  The benchmark entry points.
+//! \author Chris Oldwood
+
+// Check for previous inclusion
+#ifndef APP_BENCHMARKS_HPP
+#define APP_BENCHMARKS_HPP
+
+#if _MSC_VER > 1000
+#pragma once
+#endif
+
+#include "Settings.hpp"
+#include "Results.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+//! Measure opening a connection, query enumeration and method execution.
+
+void runConnectionBenchmarks(const Settings& settings, Results& results);
+
+////////////////////////////////////////////////////////////////////////////////
+//! Measure reading properties of each type and creating typed objects.
+
+void runObjectBenchmarks(const Settings& settings, Results& results);
+
+////////////////////////////////////////////////////////////////////////////////
+//! Measure parsing of date/time values and formatting of exceptions.
+
+void runUtilityBenchmarks(const Settings& settings, Results& results);
+
+////////////////////////////////////////////////////////////////////////////////
+//! Measure the throughput of the ResultExporter for each format.
+
+void runExportBenchmarks(const Settings& settings, Results& results);
+
+////////////////////////////////////////////////////////////////////////////////
+//! Measure the scaling of parallel row processing with the number of workers.
+
+void runParallelBenchmarks(const Settings& settings, Results& results);
+
+////////////////////////////////////////////////////////////////////////////////
+//! Measure the overhead of scheduling a large number of periodic polls.
+
+void runSchedulerBenchmarks(const Settings& settings, Results& results);
+
+////////////////////////////////////////////////////////////////////////////////
+//! Measure the ingest rate and compression of the time-series store.
+
+void runTimeSeriesBenchmarks(const Settings& settings, Results& results);
+
+////////////////////////////////////////////////////////////////////////////////
+//! Measure the process monitoring helpers at 10,000 processes per snapshot.
+
+void runProcessBenchmarks(const Settings& settings, Results& results);
+
+////////////////////////////////////////////////////////////////////////////////
+//! Measure joining two materialised query results of 10,000 and 1,000 rows.
+
+void runJoinBenchmarks(const Settings& settings, Results& results);
+
+#endif // APP_BENCHMARKS_HPP
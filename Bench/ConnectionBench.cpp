@@ -0,0 +1,307 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   ConnectionBench.cpp
+//! \brief  The benchmarks for the Connection class.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include "Benchmarks.hpp"
+#include "FakeProvider.hpp"
+#include <WMI/Connection.hpp>
+#include <WMI/Object.hpp>
+#include <WMI/ObjectIterator.hpp>
+#include <WMI/Win32_Process.hpp>
+#include <WMI/Exception.hpp>
+#include <WMI/Stopwatch.hpp>
+#include <WMI/MemoryLocator.hpp>
+#include <algorithm>
+
+//! The maximum number of rows returned by a single query.
+static const size_t QUERY_PAGE_SIZE = 1000;
+
+//! The maximum number of racing connections, as each leaves a thread waiting
+//! on the dead host.
+static const size_t MAX_RACES = 10;
+
+//! The time, in microseconds, the dead host takes to fail.
+static const uint64 DEAD_HOST_LATENCY = 60 * 1000 * 1000;
+
+//! The time, in microseconds, the live host takes to connect.
+static const uint64 LIVE_HOST_LATENCY = 1000;
+
+//! The deadline, in milliseconds, for the racing connections.
+static const uint CONNECT_DEADLINE = 5000;
+
+//! The maximum number of calls made to a real host.
+static const size_t MAX_REMOTE_CALLS = 100;
+
+//! The query enumerated on a real host.
+static const tchar* REMOTE_QUERY = TXT("SELECT Handle FROM Win32_Process");
+
+//! Used to stop the optimiser discarding the results.
+static volatile size_t s_checksum = 0;
+
+////////////////////////////////////////////////////////////////////////////////
+//! Measure attaching a connection to a provider. The fake provider does not go
+//! through the WMI locator and so this is the fixed cost of the wrapper.
+
+static void runOpenBenchmark(const Settings& settings, Results& results)
+{
+	const tstring name = TXT("Connection::open");
+
+	if (!results.isSelected(name))
+		return;
+
+	WMI::IWbemServicesPtr provider = createProvider(settings, 1);
+	WMI::Stopwatch        stopwatch;
+
+	for (size_t i = 0; i != settings.m_iterations; ++i)
+	{
+		WMI::Connection connection;
+
+		connection.open(provider);
+		s_checksum += connection.isOpen();
+		connection.close();
+	}
+
+	results.add(name, settings.m_iterations, stopwatch.elapsed());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Measure racing connections to a dead and a live host through a fake locator.
+//! The time taken should be bounded by the live host rather than the dead one.
+
+static void runOpenFirstBenchmark(const Settings& settings, Results& results)
+{
+	const tstring name = TXT("Connection::openFirst (dead host)");
+
+	if (!results.isSelected(name))
+		return;
+
+	WMI::MemoryLocator*  fake = new WMI::MemoryLocator;
+	WMI::IWbemLocatorPtr locator = fake->getInterface();
+
+	fake->addNamespace(TXT("\\\\LIVE\\root\\cimv2"), createProvider(settings, 1), LIVE_HOST_LATENCY);
+	fake->addFailure(TXT("\\\\DEAD\\root\\cimv2"), WBEM_E_TRANSPORT_FAILURE, DEAD_HOST_LATENCY);
+
+	WMI::Connection::Targets targets;
+
+	targets.push_back(WMI::Connection::Target(TXT("DEAD")));
+	targets.push_back(WMI::Connection::Target(TXT("LIVE")));
+
+	const size_t   races = std::min(settings.m_iterations, MAX_RACES);
+	WMI::Stopwatch stopwatch;
+
+	for (size_t i = 0; i != races; ++i)
+	{
+		WMI::Connection connection;
+
+		connection.setLocator(locator);
+		s_checksum += connection.openFirst(targets, WMI::Deadline::after(CONNECT_DEADLINE));
+		connection.close();
+	}
+
+	results.add(name, races, stopwatch.elapsed());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Measure the throughput of executing a query and enumerating the results.
+//! The query is repeated, a page at a time, until the row count is reached.
+
+static void runQueryBenchmark(const Settings& settings, Results& results)
+{
+	const tstring name = TXT("Connection::execQuery");
+
+	if (!results.isSelected(name))
+		return;
+
+	const size_t    pageSize = std::min(settings.m_rows, QUERY_PAGE_SIZE);
+	WMI::Connection connection;
+
+	connection.open(createProvider(settings, pageSize));
+
+	size_t         rows = 0;
+	WMI::Stopwatch stopwatch;
+
+	while (rows < settings.m_rows)
+	{
+		WMI::ObjectIterator it = connection.execQuery(PROCESS_QUERY);
+		WMI::ObjectIterator end;
+
+		for (; (it != end) && (rows < settings.m_rows); ++it, ++rows)
+			s_checksum += it->get().get() != nullptr;
+	}
+
+	results.add(name, rows, stopwatch.elapsed());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Measure the cost of a raw method call and of a typed method call, which
+//! also fetches the class definition to create the arguments.
+
+static void runMethodBenchmarks(const Settings& settings, Results& results)
+{
+	WMI::Connection connection;
+
+	connection.open(createProvider(settings, 1));
+
+	const tstring rawName = TXT("Connection::execMethod");
+
+	if (results.isSelected(rawName))
+	{
+		const tstring  path = TXT("Win32_Process.Handle=\"1000\"");
+		WMI::Stopwatch stopwatch;
+
+		for (size_t i = 0; i != settings.m_iterations; ++i)
+		{
+			WCL::Variant returnValue;
+
+			WMI::Connection::execMethod(connection.get(), WMI::IWbemClassObjectPtr(), path.c_str(), PROCESS_METHOD, returnValue);
+			s_checksum += V_I4(&returnValue);
+		}
+
+		results.add(rawName, settings.m_iterations, stopwatch.elapsed());
+	}
+
+	const tstring typedName = TXT("Win32_Process::Terminate");
+
+	if (results.isSelected(typedName))
+	{
+		WMI::ObjectIterator it = connection.execQuery(PROCESS_QUERY);
+		WMI::Win32_Process  process(it->get(), connection);
+		WMI::Stopwatch      stopwatch;
+
+		for (size_t i = 0; i != settings.m_iterations; ++i)
+			s_checksum += process.Terminate();
+
+		results.add(typedName, settings.m_iterations, stopwatch.elapsed());
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Measure the cost of a failed lookup of an object that does not exist, both
+//! when the failure is thrown and caught and when it is returned.
+
+static void runFailedProbeBenchmarks(const Settings& settings, Results& results)
+{
+	const tstring missing = TXT("Win32_Process.Handle=\"0\"");
+	WMI::Connection connection;
+
+	connection.open(createProvider(settings, 1));
+
+	const tstring throwingName = TXT("Connection::getObject (missing)");
+
+	if (results.isSelected(throwingName))
+	{
+		WMI::Stopwatch stopwatch;
+
+		for (size_t i = 0; i != settings.m_iterations; ++i)
+		{
+			try
+			{
+				s_checksum += connection.getObject(missing).get().get() != nullptr;
+			}
+			catch (const WMI::Exception& e)
+			{
+				s_checksum += static_cast<size_t>(e.m_result);
+			}
+		}
+
+		results.add(throwingName, settings.m_iterations, stopwatch.elapsed());
+	}
+
+	const tstring tryName = TXT("Connection::tryGetObject (missing)");
+
+	if (results.isSelected(tryName))
+	{
+		WMI::Stopwatch stopwatch;
+
+		for (size_t i = 0; i != settings.m_iterations; ++i)
+			s_checksum += static_cast<size_t>(connection.tryGetObject(missing).result());
+
+		results.add(tryName, settings.m_iterations, stopwatch.elapsed());
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Measure enumerating a query on a real host with a security blanket and batch
+//! size. The blanket is applied to each enumerator as well as the connection,
+//! and so each row fetched is authenticated at the same level.
+
+static void runRemoteQueryBenchmark(const Settings& settings, Results& results,
+									const tstring& name, const WMI::SecurityBlanket& blanket, size_t batchSize = 1)
+{
+	if (!results.isSelected(name))
+		return;
+
+	const size_t    queries = std::min(settings.m_iterations, MAX_REMOTE_CALLS);
+	WMI::Connection connection;
+
+	connection.setSecurityBlanket(blanket);
+	connection.setBatchSize(batchSize);
+	connection.open(settings.m_host);
+
+	size_t         rows = 0;
+	WMI::Stopwatch stopwatch;
+
+	for (size_t i = 0; i != queries; ++i)
+	{
+		WMI::ObjectIterator it = connection.execQuery(REMOTE_QUERY);
+		WMI::ObjectIterator end;
+
+		for (; it != end; ++it, ++rows)
+			s_checksum += it->get().get() != nullptr;
+	}
+
+	results.add(name, rows, stopwatch.elapsed());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Measure opening connections to, and enumerating queries on, a real host.
+//! These are only run when a host is given as they depend on the network. The
+//! connections share the process's locator.
+
+static void runRemoteBenchmarks(const Settings& settings, Results& results)
+{
+	if (settings.m_host.empty())
+		return;
+
+	const tstring openName = TXT("Connection::open (remote)");
+
+	if (results.isSelected(openName))
+	{
+		const size_t   opens = std::min(settings.m_iterations, MAX_REMOTE_CALLS);
+		WMI::Stopwatch stopwatch;
+
+		for (size_t i = 0; i != opens; ++i)
+		{
+			WMI::Connection connection;
+
+			connection.open(settings.m_host);
+			s_checksum += connection.isOpen();
+			connection.close();
+		}
+
+		results.add(openName, opens, stopwatch.elapsed());
+	}
+
+	runRemoteQueryBenchmark(settings, results, TXT("Connection::execQuery (remote)"),
+							WMI::SecurityBlanket());
+	runRemoteQueryBenchmark(settings, results, TXT("Connection::execQuery (remote, privacy)"),
+							WMI::SecurityBlanket(RPC_C_AUTHN_LEVEL_PKT_PRIVACY, RPC_C_IMP_LEVEL_IMPERSONATE));
+	runRemoteQueryBenchmark(settings, results, TXT("Connection::execQuery (remote, adaptive batch)"),
+							WMI::SecurityBlanket(), WMI::Connection::ADAPTIVE_BATCH_SIZE);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Measure opening a connection, query enumeration, method execution and failed
+//! object lookups.
+
+void runConnectionBenchmarks(const Settings& settings, Results& results)
+{
+	runOpenBenchmark(settings, results);
+	runOpenFirstBenchmark(settings, results);
+	runQueryBenchmark(settings, results);
+	runMethodBenchmarks(settings, results);
+	runFailedProbeBenchmarks(settings, results);
+	runRemoteBenchmarks(settings, results);
+}
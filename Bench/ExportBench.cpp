@@ -0,0 +1,43 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   ExportBench.cpp
+//! \brief  The benchmarks for the ResultExporter class.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include "Benchmarks.hpp"
+#include "FakeProvider.hpp"
+#include "NullWriter.hpp"
+#include <WMI/ResultExporter.hpp>
+#include <WMI/Connection.hpp>
+#include <WMI/ObjectIterator.hpp>
+#include <WMI/Stopwatch.hpp>
+
+////////////////////////////////////////////////////////////////////////////////
+//! Measure the throughput of the ResultExporter for a single format.
+
+static void runExportBenchmark(const tchar* name, WMI::ResultExporter::Format format, size_t rows, Results& results)
+{
+	if (!results.isSelected(name))
+		return;
+
+	const WMI::MemoryEnumerator::Objects objects = createProcesses(16);
+	WMI::MemoryEnumerator* enumerator = new WMI::MemoryEnumerator(objects, rows);
+	WMI::Connection connection;
+
+	NullWriter          writer;
+	WMI::ResultExporter exporter(writer, format);
+	WMI::Stopwatch      stopwatch;
+
+	exporter.writeAll(WMI::ObjectIterator(enumerator->getInterface(), connection));
+
+	results.add(name, rows, stopwatch.elapsed(), writer.bytesWritten());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Measure the throughput of the ResultExporter for each format.
+
+void runExportBenchmarks(const Settings& settings, Results& results)
+{
+	runExportBenchmark(TXT("ResultExporter CSV"), WMI::ResultExporter::CSV, settings.m_rows, results);
+	runExportBenchmark(TXT("ResultExporter NDJSON"), WMI::ResultExporter::NDJSON, settings.m_rows, results);
+}
@@ -0,0 +1,101 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   FakeProvider.cpp
+//! \brief  The in-process provider used by the benchmarks.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include "FakeProvider.hpp"
+#include <WMI/MemoryObject.hpp>
+#include <WMI/ReplayServices.hpp>
+#include <Core/StringUtils.hpp>
+
+//! The query for all processes served by the fake provider.
+const tchar* PROCESS_QUERY = TXT("SELECT * FROM Win32_Process");
+
+//! The method served by the fake provider.
+const tchar* PROCESS_METHOD = TXT("Terminate");
+
+////////////////////////////////////////////////////////////////////////////////
+//! Create a set of process objects with a representative mix of property types.
+
+WMI::MemoryEnumerator::Objects createProcesses(size_t count)
+{
+	WMI::MemoryEnumerator::Objects objects;
+
+	for (size_t i = 0; i != count; ++i)
+	{
+		const int32        id = 1000 + static_cast<int32>(i);
+		WMI::MemoryObject* object = new WMI::MemoryObject(TXT("Win32_Process"));
+
+		objects.push_back(object->getInterface());
+
+		object->setProperty(TXT("Handle"), Core::fmt(TXT("%d"), id), CIM_STRING, true);
+		object->setProperty(TXT("ProcessId"), id, CIM_UINT32);
+		object->setProperty(TXT("Name"), Core::fmt(TXT("process%d.exe"), id));
+		object->setProperty(TXT("CommandLine"), Core::fmt(TXT("\"C:\\Program Files\\App\\process%d.exe\" -x, -y"), id));
+		object->setProperty(TXT("CreationDate"), TXT("20010203040506.123456+060"), CIM_DATETIME);
+		object->setProperty(TXT("WorkingSetSize"), Core::fmt(TXT("%d"), static_cast<int32>(i % 64 + 1) * 4096 * 1024), CIM_UINT64);
+		object->setProperty(TXT("HandleCount"), static_cast<int32>(i % 500), CIM_UINT32);
+		object->setProperty(TXT("ThreadCount"), static_cast<int32>(i % 32 + 1), CIM_UINT32);
+
+		WCL::Variant critical;
+
+		V_VT(&critical)   = VT_BOOL;
+		V_BOOL(&critical) = (i % 2) ? VARIANT_TRUE : VARIANT_FALSE;
+
+		object->setProperty(TXT("IsCritical"), critical, CIM_BOOLEAN);
+	}
+
+	return objects;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Create the Win32_Process class definition with the Terminate method.
+
+static WMI::IWbemClassObjectPtr createProcessClass()
+{
+	WMI::MemoryObject*       arguments = new WMI::MemoryObject(TXT("__PARAMETERS"));
+	WMI::IWbemClassObjectPtr inParams = arguments->getInterface();
+
+	arguments->setProperty(TXT("Reason"), 0, CIM_UINT32);
+
+	WMI::MemoryObject*       definition = new WMI::MemoryObject(TXT("Win32_Process"));
+	WMI::IWbemClassObjectPtr result = definition->getInterface();
+
+	definition->setMethod(PROCESS_METHOD, inParams);
+
+	return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Create a provider that serves a query for the processes, the Win32_Process
+//! class definition and the Terminate method, with the configured latency. The
+//! method is served for the first process only.
+
+WMI::IWbemServicesPtr createProvider(const Settings& settings, size_t rows)
+{
+	const WMI::MemoryEnumerator::Objects processes = createProcesses(rows);
+	WMI::RecordingPtr                    recording(new WMI::Recording);
+	const uint32                         latency = settings.m_latency;
+
+	const size_t query = recording->addCall(WMI::Recording::EXEC_QUERY, PROCESS_QUERY, TXT(""), WBEM_S_NO_ERROR, latency);
+
+	for (size_t i = 0; i != processes.size(); ++i)
+		recording->addObject(query, processes[i], latency);
+
+	const size_t get = recording->addCall(WMI::Recording::GET_OBJECT, TXT("Win32_Process"), TXT(""), WBEM_S_NO_ERROR, latency);
+
+	recording->addObject(get, createProcessClass(), 0);
+
+	WMI::MemoryObject*       output = new WMI::MemoryObject(TXT("__PARAMETERS"));
+	WMI::IWbemClassObjectPtr outParams = output->getInterface();
+
+	output->setProperty(TXT("ReturnValue"), 0, CIM_UINT32);
+
+	const size_t method = recording->addCall(WMI::Recording::EXEC_METHOD, TXT("Win32_Process.Handle=\"1000\""), PROCESS_METHOD,
+												WBEM_S_NO_ERROR, latency);
+
+	recording->addObject(method, outParams, 0);
+
+	return (new WMI::ReplayServices(recording, (latency != 0)))->getInterface();
+}
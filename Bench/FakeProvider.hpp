@@ -0,0 +1,35 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   FakeProvider.hpp
+//! \brief  The in-process provider used by the benchmarks.
+//! \author Chris Oldwood
+
+// Check for previous inclusion
+#ifndef APP_FAKEPROVIDER_HPP
+#define APP_FAKEPROVIDER_HPP
+
+#if _MSC_VER > 1000
+#pragma once
+#endif
+
+#include "Settings.hpp"
+#include <WMI/MemoryEnumerator.hpp>
+#include <WMI/Recording.hpp>
+
+//! The query for all processes served by the fake provider.
+extern const tchar* PROCESS_QUERY;
+
+//! The method served by the fake provider.
+extern const tchar* PROCESS_METHOD;
+
+////////////////////////////////////////////////////////////////////////////////
+//! Create a set of process objects with a representative mix of property types.
+
+WMI::MemoryEnumerator::Objects createProcesses(size_t count);
+
+////////////////////////////////////////////////////////////////////////////////
+//! Create a provider that serves a query for the processes, the Win32_Process
+//! class definition and the Terminate method, with the configured latency.
+
+WMI::IWbemServicesPtr createProvider(const Settings& settings, size_t rows);
+
+#endif // APP_FAKEPROVIDER_HPP
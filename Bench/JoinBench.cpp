@@ -0,0 +1,113 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   JoinBench.cpp
+//! \brief  The benchmarks for the HashJoin class.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include "Benchmarks.hpp"
+#include <WMI/HashJoin.hpp>
+#include <WMI/Stopwatch.hpp>
+#include <algorithm>
+
+//! The number of rows on the larger side, e.g. the services.
+static const size_t LARGER_COUNT = 10000;
+
+//! The number of rows on the smaller side, e.g. the processes.
+static const size_t SMALLER_COUNT = 1000;
+
+//! Used to stop the optimiser discarding the results.
+static volatile size_t s_checksum = 0;
+
+namespace
+{
+
+////////////////////////////////////////////////////////////////////////////////
+//! A materialised row keyed by a process ID.
+
+class Row
+{
+public:
+	//! Construction with the process ID.
+	explicit Row(uint32 processId)
+		: m_processId(processId)
+	{
+	}
+
+	//! Get the process ID.
+	uint32 processId() const
+	{
+		return m_processId;
+	}
+
+private:
+	uint32	m_processId;	//!< The process ID.
+};
+
+}
+
+//! The join of the rows on the process ID.
+typedef WMI::HashJoin<Row, Row, uint32> RowJoin;
+
+////////////////////////////////////////////////////////////////////////////////
+//! Measure joining 10,000 rows to 1,000 rows on the process ID, where every
+//! one of the larger side has a match, with the hash join and a nested loop.
+
+void runJoinBenchmarks(const Settings& settings, Results& results)
+{
+	const tstring hashName = TXT("HashJoin::join (10k x 1k)");
+	const tstring loopName = TXT("Nested loop join (10k x 1k)");
+
+	if (!results.isSelected(hashName) && !results.isSelected(loopName))
+		return;
+
+	RowJoin::LeftRows  larger;
+	RowJoin::RightRows smaller;
+
+	for (size_t i = 0; i != SMALLER_COUNT; ++i)
+		smaller.push_back(Row(static_cast<uint32>((i + 1) * 4)));
+
+	for (size_t i = 0; i != LARGER_COUNT; ++i)
+		larger.push_back(Row(static_cast<uint32>((((i * 7919) % SMALLER_COUNT) + 1) * 4)));
+
+	const size_t joins = std::max<size_t>(settings.m_iterations / 1000, 10);
+
+	if (results.isSelected(hashName))
+	{
+		RowJoin          join(&Row::processId, &Row::processId);
+		RowJoin::Matches matches;
+		WMI::Stopwatch   stopwatch;
+
+		for (size_t i = 0; i != joins; ++i)
+			s_checksum += join.join(larger, smaller, matches);
+
+		results.add(hashName, joins * LARGER_COUNT, stopwatch.elapsed());
+	}
+
+	if (results.isSelected(loopName))
+	{
+		RowJoin::Matches matches;
+		WMI::Stopwatch   stopwatch;
+
+		for (size_t i = 0; i != joins; ++i)
+		{
+			matches.clear();
+
+			for (size_t l = 0; l != larger.size(); ++l)
+			{
+				for (size_t r = 0; r != smaller.size(); ++r)
+				{
+					if (larger[l].processId() == smaller[r].processId())
+					{
+						RowJoin::Match match = { l, r };
+
+						matches.push_back(match);
+					}
+				}
+			}
+
+			s_checksum += matches.size();
+		}
+
+		results.add(loopName, joins * LARGER_COUNT, stopwatch.elapsed());
+	}
+}
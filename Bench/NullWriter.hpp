@@ -0,0 +1,36 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   NullWriter.hpp
+//! \brief  The NullWriter class declaration.
+//! \author Chris Oldwood
+
+// Check for previous inclusion
+#ifndef APP_NULLWRITER_HPP
+#define APP_NULLWRITER_HPP
+
+#if _MSC_VER > 1000
+#pragma once
+#endif
+
+#include <WMI/BufferedWriter.hpp>
+
+////////////////////////////////////////////////////////////////////////////////
+//! A BufferedWriter that discards its output so that only the cost of
+//! formatting is measured.
+
+class NullWriter : public WMI::BufferedWriter
+{
+public:
+	//! Constructor.
+	explicit NullWriter(size_t bufferSize = DEFAULT_BUFFER_SIZE)
+		: WMI::BufferedWriter(bufferSize)
+	{
+	}
+
+private:
+	//! Write a block of output to the underlying destination.
+	virtual void writeBlock(const char* /*data*/, size_t /*length*/)
+	{
+	}
+};
+
+#endif // APP_NULLWRITER_HPP
@@ -0,0 +1,205 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   ObjectBench.cpp
+//! \brief  The benchmarks for the Object and TypedObject classes.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include "Benchmarks.hpp"
+#include "FakeProvider.hpp"
+#include <WMI/Connection.hpp>
+#include <WMI/Object.hpp>
+#include <WMI/Win32_Process.hpp>
+#include <WMI/DateTime.hpp>
+#include <WMI/Exception.hpp>
+#include <WMI/Stopwatch.hpp>
+#include <WMI/ObjectPath.hpp>
+#include <WMI/ObjectIterator.hpp>
+#include <Core/StringUtils.hpp>
+#include <vector>
+#include <algorithm>
+#include <psapi.h>
+
+#ifdef _MSC_VER
+#pragma comment(lib, "psapi.lib")
+#endif
+
+//! The maximum number of rows held in memory at once.
+static const size_t MAX_HELD_ROWS = 100000;
+
+//! Used to stop the optimiser discarding the results.
+static volatile size_t s_checksum = 0;
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the private memory committed by the process, in bytes.
+
+static size_t privateBytes()
+{
+	PROCESS_MEMORY_COUNTERS counters;
+
+	memset(&counters, 0, sizeof(counters));
+	counters.cb = sizeof(counters);
+
+	if (!::GetProcessMemoryInfo(::GetCurrentProcess(), &counters, sizeof(counters)))
+		throw WMI::Exception(HRESULT_FROM_WIN32(::GetLastError()), TXT("Failed to query the process memory counters"));
+
+	return counters.PagefileUsage;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Measure enumerating a query and holding on to every row. The bytes are the
+//! growth in the private memory committed by the process while the rows were
+//! fetched and held, which includes the COM objects and their values as well
+//! as the Object handles. Memory freed back to the heap but not decommitted is
+//! not seen, so the figure is only a guide.
+
+static void runHeldRowsBenchmark(const Settings& settings, Results& results)
+{
+	const tstring name = TXT("Object rows held (memory)");
+
+	if (!results.isSelected(name))
+		return;
+
+	const size_t    count = std::min(settings.m_rows, MAX_HELD_ROWS);
+	WMI::Connection connection;
+
+	connection.open(createProvider(settings, count));
+
+	const size_t             before = privateBytes();
+	std::vector<WMI::Object> rows;
+	WMI::Stopwatch           stopwatch;
+
+	rows.reserve(count);
+
+	for (WMI::ObjectIterator it = connection.execQuery(PROCESS_QUERY), end; it != end; ++it)
+		rows.push_back(*it);
+
+	const double elapsed = stopwatch.elapsed();
+	const size_t after = privateBytes();
+
+	results.add(name, rows.size(), elapsed, (after > before) ? (after - before) : 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Measure reading properties of each type, probing for a missing property and
+//! creating typed objects.
+
+void runObjectBenchmarks(const Settings& settings, Results& results)
+{
+	const WMI::MemoryEnumerator::Objects processes = createProcesses(1);
+	const WMI::Connection                connection;
+	const WMI::Object                    object(processes.front(), connection);
+	const size_t                         iterations = settings.m_iterations;
+
+	if (results.isSelected(TXT("Object::getProperty<tstring>")))
+	{
+		WMI::Stopwatch stopwatch;
+
+		for (size_t i = 0; i != iterations; ++i)
+			s_checksum += object.getProperty<tstring>(TXT("Name")).length();
+
+		results.add(TXT("Object::getProperty<tstring>"), iterations, stopwatch.elapsed());
+	}
+
+	if (results.isSelected(TXT("Object::getProperty<int32>")))
+	{
+		WMI::Stopwatch stopwatch;
+
+		for (size_t i = 0; i != iterations; ++i)
+			s_checksum += object.getProperty<int32>(TXT("ProcessId"));
+
+		results.add(TXT("Object::getProperty<int32>"), iterations, stopwatch.elapsed());
+	}
+
+	if (results.isSelected(TXT("Object::getProperty<bool>")))
+	{
+		WMI::Stopwatch stopwatch;
+
+		for (size_t i = 0; i != iterations; ++i)
+			s_checksum += object.getProperty<bool>(TXT("IsCritical"));
+
+		results.add(TXT("Object::getProperty<bool>"), iterations, stopwatch.elapsed());
+	}
+
+	if (results.isSelected(TXT("Object::getProperty<uint64>")))
+	{
+		WMI::Stopwatch stopwatch;
+
+		// 64-bit values are passed as BSTR values.
+		for (size_t i = 0; i != iterations; ++i)
+			s_checksum += static_cast<size_t>(Core::parse<uint64>(object.getProperty<tstring>(TXT("WorkingSetSize"))));
+
+		results.add(TXT("Object::getProperty<uint64>"), iterations, stopwatch.elapsed());
+	}
+
+	if (results.isSelected(TXT("Object::getProperty<CDateTime>")))
+	{
+		WMI::Stopwatch stopwatch;
+
+		for (size_t i = 0; i != iterations; ++i)
+			s_checksum += static_cast<size_t>(WMI::parseDateTime(object.getProperty<tstring>(TXT("CreationDate"))).GetTimeT());
+
+		results.add(TXT("Object::getProperty<CDateTime>"), iterations, stopwatch.elapsed());
+	}
+
+	if (results.isSelected(TXT("Object::getProperty (missing)")))
+	{
+		WMI::Stopwatch stopwatch;
+
+		for (size_t i = 0; i != iterations; ++i)
+		{
+			try
+			{
+				s_checksum += object.getProperty<int32>(TXT("Priority"));
+			}
+			catch (const WMI::Exception& e)
+			{
+				s_checksum += static_cast<size_t>(e.m_result);
+			}
+		}
+
+		results.add(TXT("Object::getProperty (missing)"), iterations, stopwatch.elapsed());
+	}
+
+	if (results.isSelected(TXT("Object::tryGetProperty (missing)")))
+	{
+		WMI::Stopwatch stopwatch;
+
+		for (size_t i = 0; i != iterations; ++i)
+			s_checksum += object.tryGetProperty<int32>(TXT("Priority")).valueOr(0);
+
+		results.add(TXT("Object::tryGetProperty (missing)"), iterations, stopwatch.elapsed());
+	}
+
+	if (results.isSelected(TXT("ObjectPath parsing")))
+	{
+		const tstring  path = TXT("\\\\HOST\\root\\cimv2:Win32_Service.Name=\"Alerter\"");
+		WMI::Stopwatch stopwatch;
+
+		for (size_t i = 0; i != iterations; ++i)
+			s_checksum += WMI::ObjectPath(path).keyCount();
+
+		results.add(TXT("ObjectPath parsing"), iterations, stopwatch.elapsed());
+	}
+
+	if (results.isSelected(TXT("Object::relativePath (cached)")))
+	{
+		WMI::Stopwatch stopwatch;
+
+		for (size_t i = 0; i != iterations; ++i)
+			s_checksum += object.relativePath().length();
+
+		results.add(TXT("Object::relativePath (cached)"), iterations, stopwatch.elapsed());
+	}
+
+	if (results.isSelected(TXT("Win32_Process construction")))
+	{
+		WMI::Stopwatch stopwatch;
+
+		for (size_t i = 0; i != iterations; ++i)
+			const WMI::Win32_Process process(processes.front(), connection);
+
+		results.add(TXT("Win32_Process construction"), iterations, stopwatch.elapsed());
+	}
+
+	runHeldRowsBenchmark(settings, results);
+}
@@ -0,0 +1,110 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   ParallelBench.cpp
+//! \brief  The benchmarks for the ParallelForEach class.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include "Benchmarks.hpp"
+#include "FakeProvider.hpp"
+#include <WMI/ParallelForEach.hpp>
+#include <WMI/Stopwatch.hpp>
+#include <Core/StringUtils.hpp>
+#include <algorithm>
+
+//! The maximum number of rows processed in parallel.
+static const size_t MAX_PARALLEL_ROWS = 100000;
+
+//! The number of times each row is hashed to simulate CPU-heavy processing.
+static const size_t HASH_ROUNDS = 100;
+
+//! Used to stop the optimiser discarding the results.
+static volatile size_t s_checksum = 0;
+
+namespace
+{
+
+////////////////////////////////////////////////////////////////////////////////
+//! A reducer that does a fixed amount of CPU-bound work per row by repeatedly
+//! hashing the row's command line.
+
+class HashReducer
+{
+public:
+	//! Default constructor.
+	HashReducer()
+		: m_rows(0)
+		, m_hash(0)
+	{
+	}
+
+	//! Process a row.
+	void operator()(const WMI::Object& row)
+	{
+		const tstring commandLine = row.getProperty<tstring>(TXT("CommandLine"));
+		uint32        hash = 2166136261u;
+
+		for (size_t round = 0; round != HASH_ROUNDS; ++round)
+		{
+			for (size_t i = 0; i != commandLine.length(); ++i)
+			{
+				hash ^= static_cast<uint32>(commandLine[i]);
+				hash *= 16777619u;
+			}
+		}
+
+		m_hash += hash;
+		++m_rows;
+	}
+
+	//
+	// Members.
+	//
+	size_t	m_rows;		//!< The number of rows processed.
+	uint64	m_hash;		//!< The sum of the row hashes.
+};
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Measure the scaling of CPU-heavy per-row processing as the number of
+//! workers doubles, up to one per processor.
+
+void runParallelBenchmarks(const Settings& settings, Results& results)
+{
+	const size_t                     rowCount = std::min(settings.m_rows, MAX_PARALLEL_ROWS);
+	const WMI::ParallelForEach::Rows rows = createProcesses(rowCount);
+	const size_t                     processors = WMI::ParallelForEach().workers();
+
+	WMI::Connection connection;
+
+	connection.open(createProvider(settings, 1));
+
+	std::vector<size_t> workerCounts;
+
+	for (size_t workers = 1; workers < processors; workers *= 2)
+		workerCounts.push_back(workers);
+
+	workerCounts.push_back(processors);
+
+	for (size_t run = 0; run != workerCounts.size(); ++run)
+	{
+		const size_t  workers = workerCounts[run];
+		const tstring name = Core::fmt(TXT("ParallelForEach (%u workers)"), static_cast<uint>(workers));
+
+		if (!results.isSelected(name))
+			continue;
+
+		WMI::ParallelForEach     forEach(workers);
+		std::vector<HashReducer> reducers;
+		WMI::Stopwatch           stopwatch;
+
+		forEach.run(connection, rows, HashReducer(), reducers);
+
+		const double elapsed = stopwatch.elapsed();
+
+		for (size_t i = 0; i != reducers.size(); ++i)
+			s_checksum += static_cast<size_t>(reducers[i].m_hash) + reducers[i].m_rows;
+
+		results.add(name, rows.size(), elapsed);
+	}
+}
@@ -0,0 +1,127 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   ProcessBench.cpp
+//! \brief  The benchmarks for the process monitoring classes.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include "Benchmarks.hpp"
+#include <WMI/ProcessRateTracker.hpp>
+#include <WMI/ProcessTree.hpp>
+#include <WMI/Stopwatch.hpp>
+#include <algorithm>
+
+//! The number of processes per snapshot.
+static const size_t PROCESS_COUNT = 10000;
+
+//! The number of processes that exit and are replaced per tick.
+static const size_t CHURN = 50;
+
+//! The interval between snapshots, in 100ns units, i.e. 1 second.
+static const uint64 TICK = 10000000;
+
+//! Used to stop the optimiser discarding the results.
+static volatile double s_checksum = 0.0;
+
+////////////////////////////////////////////////////////////////////////////////
+//! Measure computing the rates for 10,000 processes per tick, with some of the
+//! processes exiting and their IDs being reused on each tick.
+
+static void runRateTrackerBenchmark(const Settings& settings, Results& results)
+{
+	const tstring name = TXT("ProcessRateTracker::update (10k)");
+
+	if (!results.isSelected(name))
+		return;
+
+	const size_t ticks = std::max<size_t>(settings.m_iterations / 1000, 10);
+
+	WMI::ProcessRateTracker                  tracker;
+	WMI::ProcessRateTracker::Snapshot        snapshot(PROCESS_COUNT);
+	WMI::ProcessRateTracker::RatesCollection rates;
+
+	for (size_t i = 0; i != PROCESS_COUNT; ++i)
+	{
+		WMI::ProcessRateTracker::Counters& process = snapshot[i];
+
+		process.m_processId    = static_cast<uint32>((i + 1) * 4);
+		process.m_created      = i;
+		process.m_cpuTime      = 0;
+		process.m_ioBytes      = 0;
+		process.m_ioOperations = 0;
+		process.m_pageFaults   = 0;
+		process.m_timestamp    = 0;
+		process.m_frequency    = 0;
+	}
+
+	WMI::Stopwatch stopwatch;
+
+	for (size_t tick = 1; tick <= ticks; ++tick)
+	{
+		for (size_t i = 0; i != PROCESS_COUNT; ++i)
+		{
+			WMI::ProcessRateTracker::Counters& process = snapshot[i];
+
+			process.m_cpuTime      += (i % 7) * 10000;
+			process.m_ioBytes      += (i % 13) * 4096;
+			process.m_ioOperations += (i % 13);
+			process.m_pageFaults   += (i % 5);
+		}
+
+		for (size_t i = 0; i != CHURN; ++i)
+			snapshot[(tick * CHURN + i) % PROCESS_COUNT].m_created += PROCESS_COUNT;
+
+		tracker.update(tick * TICK, snapshot, rates);
+
+		s_checksum += rates[tick % PROCESS_COUNT].m_cpuPercent;
+	}
+
+	results.add(name, ticks * PROCESS_COUNT, stopwatch.elapsed());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Measure building the tree of 10,000 processes, where each process is the
+//! child of one created before it, and then listing the whole tree.
+
+static void runProcessTreeBenchmark(const Settings& settings, Results& results)
+{
+	const tstring name = TXT("ProcessTree::build (10k)");
+
+	if (!results.isSelected(name))
+		return;
+
+	const size_t builds = std::max<size_t>(settings.m_iterations / 1000, 10);
+
+	WMI::ProcessTree             tree;
+	WMI::ProcessTree::Processes  processes(PROCESS_COUNT);
+	WMI::ProcessTree::ProcessIds ids;
+
+	for (size_t i = 0; i != PROCESS_COUNT; ++i)
+	{
+		WMI::ProcessTree::Process& process = processes[i];
+
+		process.m_processId = static_cast<uint32>((i + 1) * 4);
+		process.m_parentId  = static_cast<uint32>(((i * 7) / 8 + 1) * 4);
+		process.m_created   = i;
+	}
+
+	WMI::Stopwatch stopwatch;
+
+	for (size_t build = 0; build != builds; ++build)
+	{
+		tree.build(processes);
+		tree.subtree(4, ids);
+
+		s_checksum += static_cast<double>(ids.size());
+	}
+
+	results.add(name, builds * PROCESS_COUNT, stopwatch.elapsed());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Measure the process monitoring helpers at 10,000 processes per snapshot.
+
+void runProcessBenchmarks(const Settings& settings, Results& results)
+{
+	runRateTrackerBenchmark(settings, results);
+	runProcessTreeBenchmark(settings, results);
+}
@@ -0,0 +1,129 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   Results.cpp
+//! \brief  The Results class definition.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include "Results.hpp"
+#include <WMI/FileWriter.hpp>
+#include <Core/StringUtils.hpp>
+#include <tchar.h>
+
+////////////////////////////////////////////////////////////////////////////////
+//! Calculate the rate of operations per second.
+
+static double rate(uint64 count, double elapsed)
+{
+	return (elapsed > 0.0) ? (static_cast<double>(count) / elapsed) : 0.0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Write a JSON string value. The names are plain text and so only the
+//! mandatory characters are escaped.
+
+static void writeString(WMI::BufferedWriter& writer, const tstring& value)
+{
+	writer.write('"');
+
+	for (tstring::const_iterator it = value.begin(); it != value.end(); ++it)
+	{
+		if ( (*it == TXT('"')) || (*it == TXT('\\')) )
+			writer.write('\\');
+
+		writer.write(&*it, 1);
+	}
+
+	writer.write('"');
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Write a formatted JSON value.
+
+static void writeValue(WMI::BufferedWriter& writer, const tstring& value)
+{
+	writer.write(value.c_str(), value.length());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Construction from the settings used for the run.
+
+Results::Results(const Settings& settings)
+	: m_settings(settings)
+	, m_results()
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Query if a benchmark should be run, based on the name filter.
+
+bool Results::isSelected(const tstring& name) const
+{
+	return m_settings.m_filter.empty() || (name.find(m_settings.m_filter) != tstring::npos);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Add a result and report it to the console.
+
+void Results::add(const tstring& name, uint64 operations, double elapsed, uint64 bytes)
+{
+	Result result;
+
+	result.m_name       = name;
+	result.m_operations = operations;
+	result.m_elapsed    = elapsed;
+	result.m_bytes      = bytes;
+
+	m_results.push_back(result);
+
+	const double opsPerSec = rate(operations, elapsed);
+	const double nsPerOp = (operations != 0) ? (elapsed * 1.0e9 / static_cast<double>(operations)) : 0.0;
+
+	_tprintf(TXT("%-40s %10.0f ops %10.3f s %14.0f ops/s %12.1f ns/op"), name.c_str(),
+				static_cast<double>(operations), elapsed, opsPerSec, nsPerOp);
+
+	if (bytes != 0)
+		_tprintf(TXT(" %8.1f MB/s"), rate(bytes, elapsed) / (1024.0 * 1024.0));
+
+	_tprintf(TXT("\n"));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Write the settings and results as a JSON document.
+
+void Results::writeJson(const tstring& path) const
+{
+	WMI::FileWriter file(path);
+
+	file.write("{\"settings\":{\"rows\":");
+	writeValue(file, Core::fmt(TXT("%u"), static_cast<uint>(m_settings.m_rows)));
+	file.write(",\"latencyMicroseconds\":");
+	writeValue(file, Core::fmt(TXT("%u"), static_cast<uint>(m_settings.m_latency)));
+	file.write(",\"iterations\":");
+	writeValue(file, Core::fmt(TXT("%u"), static_cast<uint>(m_settings.m_iterations)));
+	file.write("},\"results\":[");
+
+	for (Collection::const_iterator it = m_results.begin(); it != m_results.end(); ++it)
+	{
+		const double nsPerOp = (it->m_operations != 0) ? (it->m_elapsed * 1.0e9 / static_cast<double>(it->m_operations)) : 0.0;
+
+		if (it != m_results.begin())
+			file.write(',');
+
+		file.write("\n{\"name\":");
+		writeString(file, it->m_name);
+		file.write(",\"operations\":");
+		writeValue(file, Core::fmt(TXT("%.0f"), static_cast<double>(it->m_operations)));
+		file.write(",\"seconds\":");
+		writeValue(file, Core::fmt(TXT("%.6f"), it->m_elapsed));
+		file.write(",\"opsPerSecond\":");
+		writeValue(file, Core::fmt(TXT("%.1f"), rate(it->m_operations, it->m_elapsed)));
+		file.write(",\"nsPerOp\":");
+		writeValue(file, Core::fmt(TXT("%.1f"), nsPerOp));
+		file.write(",\"bytes\":");
+		writeValue(file, Core::fmt(TXT("%.0f"), static_cast<double>(it->m_bytes)));
+		file.write('}');
+	}
+
+	file.write("\n]}\n");
+	file.close();
+}
@@ -0,0 +1,77 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   Results.hpp
+//! \brief  The Results class declaration.
+//! \author Chris Oldwood
+
+// Check for previous inclusion
+#ifndef APP_RESULTS_HPP
+#define APP_RESULTS_HPP
+
+#if _MSC_VER > 1000
+#pragma once
+#endif
+
+#include "Settings.hpp"
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+//! The collection of benchmark timings. Each result is reported to the console
+//! as it is added and the whole set can be written as a JSON document so that
+//! the results can be compared across builds.
+
+class Results
+{
+public:
+	//! A single benchmark timing.
+	struct Result
+	{
+		tstring	m_name;			//!< The benchmark name.
+		uint64	m_operations;	//!< The number of operations performed.
+		double	m_elapsed;		//!< The time taken in seconds.
+		uint64	m_bytes;		//!< The number of bytes of output, if any.
+	};
+
+	//! The collection of results.
+	typedef std::vector<Result> Collection;
+
+public:
+	//! Construction from the settings used for the run.
+	explicit Results(const Settings& settings);
+
+	//
+	// Properties.
+	//
+
+	//! Get the results in the order they were added.
+	const Collection& results() const;
+
+	//
+	// Methods.
+	//
+
+	//! Query if a benchmark should be run.
+	bool isSelected(const tstring& name) const;
+
+	//! Add a result and report it to the console.
+	void add(const tstring& name, uint64 operations, double elapsed, uint64 bytes = 0);
+
+	//! Write the results as a JSON document.
+	void writeJson(const tstring& path) const; // throw(WMI::Exception)
+
+private:
+	//
+	// Members.
+	//
+	Settings	m_settings;		//!< The settings used for the run.
+	Collection	m_results;		//!< The results.
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the results in the order they were added.
+
+inline const Results::Collection& Results::results() const
+{
+	return m_results;
+}
+
+#endif // APP_RESULTS_HPP
@@ -0,0 +1,100 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   SchedulerBench.cpp
+//! \brief  The benchmarks for the PollScheduler class.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include "Benchmarks.hpp"
+#include "FakeProvider.hpp"
+#include <WMI/PollScheduler.hpp>
+#include <WMI/Stopwatch.hpp>
+
+//! The number of polls scheduled.
+static const size_t POLL_COUNT = 10000;
+
+//! The number of hosts the polls are spread over.
+static const size_t HOST_COUNT = 100;
+
+//! The poll intervals, in milliseconds.
+static const uint INTERVALS[] = { 5000, 30000, 60000 };
+
+//! The number of ticks simulated, i.e. 10 minutes of the default tick length.
+static const uint64 SIMULATED_TICKS = 6000;
+
+//! Used to stop the optimiser discarding the results.
+static volatile size_t s_checksum = 0;
+
+namespace
+{
+
+////////////////////////////////////////////////////////////////////////////////
+//! A sink that only counts the objects.
+
+class NullSink : public WMI::PollScheduler::Sink
+{
+public:
+	//! Count the objects.
+	virtual void onResults(size_t /*poll*/, const tstring& /*host*/, const WMI::PollScheduler::Objects& objects)
+	{
+		s_checksum += objects.size();
+	}
+
+	//! Count the failure.
+	virtual void onFailure(size_t /*poll*/, const tstring& /*host*/, const WMI::Exception& /*error*/)
+	{
+		++s_checksum;
+	}
+};
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Measure the overhead of the PollScheduler with 10,000 polls at the typical
+//! intervals spread over 100 hosts. Only the time spent advancing the timer
+//! wheel and coalescing the due polls into cycles is counted, the cycles are
+//! then executed against the fake provider to release the hosts.
+
+void runSchedulerBenchmarks(const Settings& settings, Results& results)
+{
+	const tstring name = TXT("PollScheduler::collect (10k polls)");
+
+	if (!results.isSelected(name))
+		return;
+
+	NullSink              sink;
+	WMI::PollScheduler    scheduler;
+	WMI::IWbemServicesPtr provider = createProvider(settings, 1);
+	std::vector<tstring>  hosts;
+
+	for (size_t i = 0; i != HOST_COUNT; ++i)
+	{
+		hosts.push_back(Core::fmt(TXT("HOST%u"), static_cast<uint>(i)));
+		scheduler.addHost(hosts.back(), provider);
+	}
+
+	for (size_t i = 0; i != POLL_COUNT; ++i)
+	{
+		scheduler.addPoll(hosts[i % HOST_COUNT], TXT("Win32_Process"), WMI::PollScheduler::Properties(),
+							INTERVALS[i % ARRAY_SIZE(INTERVALS)], sink);
+	}
+
+	WMI::PollScheduler::Cycles cycles;
+	int64                      collecting = 0;
+
+	for (uint64 tick = 1; tick <= SIMULATED_TICKS; ++tick)
+	{
+		const int64 start = WMI::Stopwatch::ticks();
+
+		cycles.clear();
+		scheduler.collect(tick, cycles);
+
+		collecting += WMI::Stopwatch::ticks() - start;
+
+		for (WMI::PollScheduler::Cycles::const_iterator it = cycles.begin(); it != cycles.end(); ++it)
+			scheduler.execute(*it);
+	}
+
+	const double elapsed = static_cast<double>(WMI::Stopwatch::ticksToMicroseconds(collecting)) / 1000000.0;
+
+	results.add(name, SIMULATED_TICKS, elapsed);
+}
@@ -0,0 +1,41 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   Settings.hpp
+//! \brief  The Settings class declaration.
+//! \author Chris Oldwood
+
+// Check for previous inclusion
+#ifndef APP_SETTINGS_HPP
+#define APP_SETTINGS_HPP
+
+#if _MSC_VER > 1000
+#pragma once
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+//! The benchmark settings, as set on the command line.
+
+struct Settings
+{
+	//! Default constructor.
+	Settings()
+		: m_rows(1000000)
+		, m_latency(0)
+		, m_iterations(100000)
+		, m_filter()
+		, m_output()
+		, m_host()
+	{
+	}
+
+	//
+	// Members.
+	//
+	size_t	m_rows;			//!< The number of rows to enumerate or export.
+	uint32	m_latency;		//!< The simulated provider latency per call and row, in microseconds.
+	size_t	m_iterations;	//!< The number of iterations of each per-call benchmark.
+	tstring	m_filter;		//!< Only run the benchmarks whose name contains this.
+	tstring	m_output;		//!< The path of the JSON results file, if required.
+	tstring	m_host;			//!< The real host for the remote benchmarks, if required.
+};
+
+#endif // APP_SETTINGS_HPP
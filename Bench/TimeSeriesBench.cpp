@@ -0,0 +1,123 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   TimeSeriesBench.cpp
+//! \brief  The benchmarks for the TimeSeriesStore class.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include "Benchmarks.hpp"
+#include <WMI/TimeSeriesStore.hpp>
+#include <WMI/Stopwatch.hpp>
+#include <algorithm>
+#include <tchar.h>
+
+//! The number of series, e.g. one per process.
+static const size_t SERIES_COUNT = 1000;
+
+//! The number of samples held per series.
+static const size_t CAPACITY = 1024;
+
+//! The interval between samples, in milliseconds.
+static const int64 CADENCE = 5000;
+
+//! Used to stop the optimiser discarding the results.
+static volatile size_t s_checksum = 0;
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the next value of a gauge that drifts by a few pages per sample, like
+//! the working set of a process.
+
+static uint64 nextValue(uint64 value)
+{
+	const int64 pages = (::rand() % 9) - 4;
+
+	return value + static_cast<uint64>(pages * 4096);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Measure appending samples to a set of series at a fixed cadence, and then
+//! querying and downsampling each full series. The bytes reported for the
+//! ingest are those used to hold the samples once every series is full, as in
+//! the object benchmarks, and the bytes per sample are shown too.
+
+void runTimeSeriesBenchmarks(const Settings& settings, Results& results)
+{
+	const tstring ingestName = TXT("TimeSeriesStore::append");
+	const tstring rangeName = TXT("TimeSeriesStore::range");
+	const tstring downsampleName = TXT("TimeSeriesStore::downsample");
+
+	if (!results.isSelected(ingestName) && !results.isSelected(rangeName) && !results.isSelected(downsampleName))
+		return;
+
+	WMI::TimeSeriesStore store;
+	std::vector<uint64>  values(SERIES_COUNT, static_cast<uint64>(256) * 1024 * 1024);
+
+	for (size_t i = 0; i != SERIES_COUNT; ++i)
+		store.addSeries(Core::fmt(TXT("Process%u"), static_cast<uint>(i)), CAPACITY);
+
+	const size_t   ticks = std::max<size_t>(settings.m_iterations / SERIES_COUNT, 2 * CAPACITY);
+	const int64    end = static_cast<int64>(ticks) * CADENCE;
+	WMI::Stopwatch stopwatch;
+
+	for (size_t tick = 0; tick != ticks; ++tick)
+	{
+		const int64 time = static_cast<int64>(tick) * CADENCE;
+
+		for (size_t series = 0; series != SERIES_COUNT; ++series)
+		{
+			values[series] = nextValue(values[series]);
+			store.append(series, time, values[series]);
+		}
+	}
+
+	const double elapsed = stopwatch.elapsed();
+
+	if (results.isSelected(ingestName))
+	{
+		size_t held = 0;
+
+		for (size_t series = 0; series != SERIES_COUNT; ++series)
+			held += store.size(series);
+
+		results.add(ingestName, ticks * SERIES_COUNT, elapsed, store.bytesUsed());
+
+		_tprintf(TXT("%-40s %10.2f bytes/sample\n"), TXT("TimeSeriesStore (compressed)"),
+					static_cast<double>(store.bytesUsed()) / static_cast<double>(held));
+	}
+
+	if (results.isSelected(rangeName))
+	{
+		WMI::TimeSeriesStore::Samples samples;
+
+		stopwatch.restart();
+
+		for (size_t series = 0; series != SERIES_COUNT; ++series)
+		{
+			samples.m_times.clear();
+			samples.m_values.clear();
+
+			store.range(series, 0, end, samples);
+
+			s_checksum += samples.m_times.size();
+		}
+
+		results.add(rangeName, SERIES_COUNT, stopwatch.elapsed());
+	}
+
+	if (results.isSelected(downsampleName))
+	{
+		WMI::TimeSeriesStore::Aggregates aggregates;
+
+		stopwatch.restart();
+
+		for (size_t series = 0; series != SERIES_COUNT; ++series)
+		{
+			aggregates.clear();
+
+			store.downsample(series, 0, end, 60 * CADENCE, aggregates);
+
+			s_checksum += aggregates.size();
+		}
+
+		results.add(downsampleName, SERIES_COUNT, stopwatch.elapsed());
+	}
+}
@@ -0,0 +1,82 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   UtilityBench.cpp
+//! \brief  The benchmarks for the date/time parsing and exception formatting.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include "Benchmarks.hpp"
+#include "FakeProvider.hpp"
+#include <WMI/DateTime.hpp>
+#include <WMI/Exception.hpp>
+#include <WMI/Stopwatch.hpp>
+
+//! Used to stop the optimiser discarding the results.
+static volatile size_t s_checksum = 0;
+
+////////////////////////////////////////////////////////////////////////////////
+//! Measure parsing of date/time values and formatting of exceptions.
+
+void runUtilityBenchmarks(const Settings& settings, Results& results)
+{
+	const size_t iterations = settings.m_iterations;
+
+	if (results.isSelected(TXT("parseDateTime")))
+	{
+		const tstring  value = TXT("20010203040506.123456+060");
+		WMI::Stopwatch stopwatch;
+
+		for (size_t i = 0; i != iterations; ++i)
+			s_checksum += static_cast<size_t>(WMI::parseDateTime(value).GetTimeT());
+
+		results.add(TXT("parseDateTime"), iterations, stopwatch.elapsed());
+	}
+
+	if (results.isSelected(TXT("Exception formatting")))
+	{
+		WMI::Stopwatch stopwatch;
+
+		for (size_t i = 0; i != iterations; ++i)
+		{
+			const WMI::Exception e(WBEM_E_NOT_FOUND, TXT("Failed to execute a WMI query"));
+
+			s_checksum += tstring(e.twhat()).length();
+		}
+
+		results.add(TXT("Exception formatting"), iterations, stopwatch.elapsed());
+	}
+
+	if (results.isSelected(TXT("Exception formatting (WMI error text)")))
+	{
+		WMI::IWbemServicesPtr provider = createProvider(settings, 1);
+		WMI::Stopwatch        stopwatch;
+
+		for (size_t i = 0; i != iterations; ++i)
+		{
+			const WMI::Exception e(WBEM_E_NOT_FOUND, provider, TXT("Failed to execute a WMI query"));
+
+			s_checksum += tstring(e.twhat()).length();
+		}
+
+		results.add(TXT("Exception formatting (WMI error text)"), iterations, stopwatch.elapsed());
+	}
+
+	if (results.isSelected(TXT("Exception throw and catch")))
+	{
+		WMI::IWbemServicesPtr provider = createProvider(settings, 1);
+		WMI::Stopwatch        stopwatch;
+
+		for (size_t i = 0; i != iterations; ++i)
+		{
+			try
+			{
+				throw WMI::Exception(WBEM_E_NOT_FOUND, provider, TXT("Failed to execute a WMI query"));
+			}
+			catch (const WMI::Exception& e)
+			{
+				s_checksum += static_cast<size_t>(e.m_result);
+			}
+		}
+
+		results.add(TXT("Exception throw and catch"), iterations, stopwatch.elapsed());
+	}
+}
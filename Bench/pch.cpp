@@ -0,0 +1,6 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   pch.cpp
+//! \brief  The file used when creating the pre-compiled header.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
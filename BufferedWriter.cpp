@@ -0,0 +1,127 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   BufferedWriter.cpp
+//! \brief  The BufferedWriter class definition.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include "BufferedWriter.hpp"
+#include <string.h>
+
+namespace WMI
+{
+
+//! The maximum number of bytes required to encode a code point as UTF-8.
+static const size_t MAX_UTF8_SEQUENCE = 4;
+
+////////////////////////////////////////////////////////////////////////////////
+//! Constructor.
+
+BufferedWriter::BufferedWriter(size_t bufferSize)
+	: m_buffer((bufferSize > MIN_BUFFER_SIZE) ? bufferSize : MIN_BUFFER_SIZE)
+	, m_used(0)
+	, m_written(0)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Destructor. The derived class is responsible for flushing any outstanding
+//! output as it owns the destination.
+
+BufferedWriter::~BufferedWriter()
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Write a nul terminated string.
+
+void BufferedWriter::write(const char* text)
+{
+	write(text, strlen(text));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Write a sequence of characters. Blocks larger than the buffer bypass it.
+
+void BufferedWriter::write(const char* text, size_t length)
+{
+	if (length > (m_buffer.size() - m_used))
+		flush();
+
+	if (length >= m_buffer.size())
+	{
+		writeBlock(text, length);
+		m_written += length;
+		return;
+	}
+
+	memcpy(&m_buffer[m_used], text, length);
+	m_used += length;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Write a sequence of wide characters, encoded as UTF-8. Unpaired surrogates
+//! are replaced with U+FFFD.
+
+void BufferedWriter::write(const wchar_t* text, size_t length)
+{
+	const wchar_t* it = text;
+	const wchar_t* end = text + length;
+
+	while (it != end)
+	{
+		if ((m_buffer.size() - m_used) < MAX_UTF8_SEQUENCE)
+			flush();
+
+		char*        output = &m_buffer[m_used];
+		const uint32 unit = static_cast<uint16>(*it++);
+
+		if (unit < 0x80)
+		{
+			*output++ = static_cast<char>(unit);
+		}
+		else if (unit < 0x800)
+		{
+			*output++ = static_cast<char>(0xC0 | (unit >> 6));
+			*output++ = static_cast<char>(0x80 | (unit & 0x3F));
+		}
+		else if ( (unit >= 0xD800) && (unit <= 0xDBFF) && (it != end)
+			   && (static_cast<uint16>(*it) >= 0xDC00) && (static_cast<uint16>(*it) <= 0xDFFF) )
+		{
+			const uint32 codePoint = 0x10000 + ((unit - 0xD800) << 10) + (static_cast<uint16>(*it++) - 0xDC00);
+
+			*output++ = static_cast<char>(0xF0 | (codePoint >> 18));
+			*output++ = static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+			*output++ = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+			*output++ = static_cast<char>(0x80 | (codePoint & 0x3F));
+		}
+		else
+		{
+			const uint32 codePoint = ((unit >= 0xD800) && (unit <= 0xDFFF)) ? 0xFFFD : unit;
+
+			*output++ = static_cast<char>(0xE0 | (codePoint >> 12));
+			*output++ = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+			*output++ = static_cast<char>(0x80 | (codePoint & 0x3F));
+		}
+
+		m_used = output - &m_buffer[0];
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Hand any buffered output on.
+
+void BufferedWriter::flush()
+{
+	if (m_used == 0)
+		return;
+
+	const size_t length = m_used;
+
+	m_used = 0;
+
+	writeBlock(&m_buffer[0], length);
+	m_written += length;
+}
+
+//namespace WMI
+}
@@ -0,0 +1,121 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   BufferedWriter.hpp
+//! \brief  The BufferedWriter class declaration.
+//! \author Chris Oldwood
+
+// Check for previous inclusion
+#ifndef WMI_BUFFEREDWRITER_HPP
+#define WMI_BUFFEREDWRITER_HPP
+
+#if _MSC_VER > 1000
+#pragma once
+#endif
+
+#include <Core/NotCopyable.hpp>
+#include <vector>
+
+namespace WMI
+{
+
+////////////////////////////////////////////////////////////////////////////////
+//! The base class for a text writer that accumulates its output in a fixed-size
+//! buffer and only hands it on to the derived class in whole blocks. Wide
+//! character text is encoded as UTF-8 directly into the buffer so that the
+//! memory footprint does not depend on the amount of data written.
+
+class BufferedWriter : private Core::NotCopyable
+{
+public:
+	//! The default size of the output buffer.
+	static const size_t DEFAULT_BUFFER_SIZE = 64 * 1024;
+
+	//! The smallest output buffer supported.
+	static const size_t MIN_BUFFER_SIZE = 16;
+
+public:
+	//! Constructor.
+	explicit BufferedWriter(size_t bufferSize = DEFAULT_BUFFER_SIZE);
+
+	//! Destructor.
+	virtual ~BufferedWriter();
+
+	//
+	// Properties.
+	//
+
+	//! Get the size of the output buffer.
+	size_t bufferSize() const;
+
+	//! Get the number of bytes handed on so far.
+	uint64 bytesWritten() const;
+
+	//
+	// Methods.
+	//
+
+	//! Write a single character.
+	void write(char value);
+
+	//! Write a nul terminated string.
+	void write(const char* text);
+
+	//! Write a sequence of characters.
+	void write(const char* text, size_t length);
+
+	//! Write a sequence of wide characters, encoded as UTF-8.
+	void write(const wchar_t* text, size_t length);
+
+	//! Hand any buffered output on.
+	void flush();
+
+protected:
+	//
+	// Internal methods.
+	//
+
+	//! Write a block of output to the underlying destination.
+	virtual void writeBlock(const char* data, size_t length) = 0;
+
+private:
+	//! The output buffer type.
+	typedef std::vector<char> Buffer;
+
+	//
+	// Members.
+	//
+	Buffer	m_buffer;	//!< The output buffer.
+	size_t	m_used;		//!< The number of bytes used in the buffer.
+	uint64	m_written;	//!< The number of bytes handed on so far.
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the size of the output buffer.
+
+inline size_t BufferedWriter::bufferSize() const
+{
+	return m_buffer.size();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the number of bytes handed on so far.
+
+inline uint64 BufferedWriter::bytesWritten() const
+{
+	return m_written;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Write a single character.
+
+inline void BufferedWriter::write(char value)
+{
+	if (m_used == m_buffer.size())
+		flush();
+
+	m_buffer[m_used++] = value;
+}
+
+//namespace WMI
+}
+
+#endif // WMI_BUFFEREDWRITER_HPP
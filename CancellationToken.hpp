@@ -0,0 +1,82 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   CancellationToken.hpp
+//! \brief  The CancellationToken class declaration.
+//! \author Chris Oldwood
+
+// Check for previous inclusion
+#ifndef WMI_CANCELLATIONTOKEN_HPP
+#define WMI_CANCELLATIONTOKEN_HPP
+
+#if _MSC_VER > 1000
+#pragma once
+#endif
+
+#include <Core/NotCopyable.hpp>
+#include <Core/SharedPtr.hpp>
+
+namespace WMI
+{
+
+////////////////////////////////////////////////////////////////////////////////
+//! A flag used to ask a long running operation, such as the enumeration of a
+//! query, to stop. The token is shared between the thread doing the work, which
+//! polls it, and any thread that wants to cancel it.
+
+class CancellationToken : private Core::NotCopyable
+{
+public:
+	//! Default constructor.
+	CancellationToken();
+
+	//
+	// Properties.
+	//
+
+	//! Query if cancellation has been requested.
+	bool isCancelled() const;
+
+	//
+	// Methods.
+	//
+
+	//! Request cancellation.
+	void cancel();
+
+private:
+	//
+	// Members.
+	//
+	volatile LONG	m_cancelled;	//!< Non-zero once cancelled.
+};
+
+//! The default CancellationToken smart-pointer type.
+typedef Core::SharedPtr<CancellationToken> CancellationTokenPtr;
+
+////////////////////////////////////////////////////////////////////////////////
+//! Default constructor.
+
+inline CancellationToken::CancellationToken()
+	: m_cancelled(0)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Query if cancellation has been requested.
+
+inline bool CancellationToken::isCancelled() const
+{
+	return (m_cancelled != 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Request cancellation. This can be called from any thread.
+
+inline void CancellationToken::cancel()
+{
+	::InterlockedExchange(&m_cancelled, 1);
+}
+
+//namespace WMI
+}
+
+#endif // WMI_CANCELLATIONTOKEN_HPP
@@ -0,0 +1,324 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   ConnectAttempt.cpp
+//! \brief  The ConnectAttempt class definition.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include "ConnectAttempt.hpp"
+#include "Exception.hpp"
+#include <WCL/ComStr.hpp>
+#include <WCL/AutoCom.hpp>
+#include <process.h>
+
+#ifndef _MSC_VER
+WCL_DECLARE_IFACETRAITS(IWbemServices, IID_IWbemServices);
+WCL_DECLARE_IFACETRAITS(IWbemLocator, IID_IWbemLocator);
+#endif
+
+namespace WMI
+{
+
+////////////////////////////////////////////////////////////////////////////////
+//! Construction from the namespace to connect to. The caller holds the only
+//! reference until the attempt is started.
+
+ConnectAttempt::ConnectAttempt(IWbemLocatorPtr locator, const Connection::Target& target)
+	: m_refCount(1)
+	, m_locator(locator)
+	, m_target(target)
+	, m_completed(::CreateEvent(nullptr, TRUE, FALSE, nullptr))
+	, m_released(::CreateEvent(nullptr, TRUE, FALSE, nullptr))
+	, m_result(E_PENDING)
+	, m_services()
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Destructor.
+
+ConnectAttempt::~ConnectAttempt()
+{
+	if (m_released != nullptr)
+		::CloseHandle(m_released);
+
+	if (m_completed != nullptr)
+		::CloseHandle(m_completed);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Connect to a namespace on the calling thread.
+
+HRESULT ConnectAttempt::connect(IWbemLocatorPtr locator, const Connection::Target& target,
+								long flags, IWbemServicesPtr& services)
+{
+	ASSERT(locator.get() != nullptr);
+
+	const WCL::ComStr path(formatPath(target.m_host, target.m_namespace));
+	const WCL::ComStr authority(TXT(""));
+
+	if (target.m_login.empty())
+	{
+		return locator->ConnectServer(path.Get(), nullptr, nullptr, nullptr, flags,
+										authority.Get(), nullptr, AttachTo(services));
+	}
+
+	const WCL::ComStr login(target.m_login);
+	const WCL::ComStr password(target.m_password);
+
+	return locator->ConnectServer(path.Get(), login.Get(), password.Get(), nullptr, flags,
+									authority.Get(), nullptr, AttachTo(services));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Connect to the first of a set of namespaces to respond before a deadline.
+//! Each namespace is tried in parallel on its own thread with the maximum wait
+//! flag set and the first to succeed wins. The result is that of the winner,
+//! WBEM_E_TIMED_OUT if the deadline passes first, or else the last failure.
+//! The connection is returned for use in the calling apartment.
+
+HRESULT ConnectAttempt::race(IWbemLocatorPtr locator, const Connection::Targets& targets,
+							const Deadline& deadline, IWbemServicesPtr& services, size_t& winner)
+{
+	ASSERT(!targets.empty());
+	ASSERT(targets.size() <= MAXIMUM_WAIT_OBJECTS);
+
+	if (deadline.hasExpired())
+		return WBEM_E_TIMED_OUT;
+
+	typedef std::vector<ConnectAttempt*> Attempts;
+
+	Attempts            attempts;
+	std::vector<size_t> indices;
+	HRESULT             result = WBEM_E_FAILED;
+
+	// Start the attempts.
+	for (size_t i = 0; i != targets.size(); ++i)
+	{
+		ConnectAttempt* attempt = new ConnectAttempt(locator, targets[i]);
+
+		const HRESULT started = attempt->start();
+
+		if (FAILED(started))
+		{
+			attempt->release();
+			result = started;
+			continue;
+		}
+
+		attempts.push_back(attempt);
+		indices.push_back(i);
+	}
+
+	// Wait for the first to succeed.
+	std::vector<size_t> pending;
+
+	for (size_t i = 0; i != attempts.size(); ++i)
+		pending.push_back(i);
+
+	while (!pending.empty())
+	{
+		std::vector<HANDLE> handles;
+
+		for (size_t i = 0; i != pending.size(); ++i)
+			handles.push_back(attempts[pending[i]]->m_completed);
+
+		const DWORD timeout = static_cast<DWORD>(deadline.remaining());
+		const ULONG count = static_cast<ULONG>(handles.size());
+		DWORD       index = 0;
+
+		HRESULT waited = ::CoWaitForMultipleHandles(0, timeout, count, &handles.front(), &index);
+
+		if (waited == RPC_S_CALLPENDING)
+		{
+			result = WBEM_E_TIMED_OUT;
+			break;
+		}
+
+		if (FAILED(waited))
+		{
+			const DWORD signalled = ::WaitForMultipleObjects(count, &handles.front(), FALSE, timeout);
+
+			if (signalled == WAIT_TIMEOUT)
+			{
+				result = WBEM_E_TIMED_OUT;
+				break;
+			}
+
+			if (signalled >= (WAIT_OBJECT_0 + count))
+			{
+				result = HRESULT_FROM_WIN32(::GetLastError());
+				break;
+			}
+
+			index = signalled - WAIT_OBJECT_0;
+		}
+
+		ConnectAttempt* attempt = attempts[pending[index]];
+
+		result = attempt->m_result;
+
+		if (SUCCEEDED(result))
+			result = attempt->collect(services);
+
+		if (SUCCEEDED(result))
+		{
+			winner = indices[pending[index]];
+			break;
+		}
+
+		pending.erase(pending.begin() + index);
+	}
+
+	// Abandon the rest.
+	for (Attempts::iterator it = attempts.begin(); it != attempts.end(); ++it)
+		(*it)->release();
+
+	return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Format the full path for a namespace on a host.
+
+tstring ConnectAttempt::formatPath(const tstring& host, const tstring& nmspace)
+{
+	tstring path = host + nmspace;
+
+	if (path.compare(0, 2, TXT("\\\\")) != 0)
+		path = TXT("\\\\") + path;
+
+	return path;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Start the attempt on a worker thread, which holds its own reference.
+
+HRESULT ConnectAttempt::start()
+{
+	if ( (m_completed == nullptr) || (m_released == nullptr) )
+		return HRESULT_FROM_WIN32(::GetLastError());
+
+	::InterlockedIncrement(&m_refCount);
+
+	const uintptr_t thread = _beginthreadex(nullptr, 0, attemptThread, this, 0, nullptr);
+
+	if (thread == 0)
+	{
+		::InterlockedDecrement(&m_refCount);
+		return E_OUTOFMEMORY;
+	}
+
+	::CloseHandle(reinterpret_cast<HANDLE>(thread));
+
+	return S_OK;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Retrieve the connection for use in the calling apartment. The attempt must
+//! have succeeded.
+
+HRESULT ConnectAttempt::collect(IWbemServicesPtr& services)
+{
+	ASSERT(SUCCEEDED(m_result));
+	ASSERT(m_services.get() != nullptr);
+
+	try
+	{
+		services = m_services->get();
+	}
+	catch (const WCL::ComException& e)
+	{
+		return e.m_result;
+	}
+	catch (const Core::Exception& /*e*/)
+	{
+		return E_FAIL;
+	}
+	catch (const std::exception& /*e*/)
+	{
+		return E_FAIL;
+	}
+
+	return S_OK;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Give up the caller's interest in the attempt. The caller must not use the
+//! attempt afterwards.
+
+void ConnectAttempt::release()
+{
+	::SetEvent(m_released);
+
+	dropReference();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Drop a reference, deleting the attempt when there are no more.
+
+void ConnectAttempt::dropReference()
+{
+	if (::InterlockedDecrement(&m_refCount) == 0)
+		delete this;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Make the attempt on the worker thread. The connection is released in the
+//! worker's apartment once the caller no longer needs it.
+
+void ConnectAttempt::run()
+{
+	try
+	{
+		WCL::AutoCom com(COINIT_MULTITHREADED);
+
+		{
+			IWbemLocatorPtr  locator = m_locator;
+			IWbemServicesPtr services;
+
+			if (locator.get() == nullptr)
+				locator = IWbemLocatorPtr(CLSID_WbemLocator);
+
+			m_result = connect(locator, m_target, WBEM_FLAG_CONNECT_USE_MAX_WAIT, services);
+
+			// Only hand over the connection if the caller is still waiting.
+			if (SUCCEEDED(m_result) && (::WaitForSingleObject(m_released, 0) == WAIT_TIMEOUT))
+				m_services = GlobalServicesPtr(new GlobalInterface<IWbemServices>(services));
+		}
+
+		::SetEvent(m_completed);
+		::WaitForSingleObject(m_released, INFINITE);
+
+		m_services.reset();
+	}
+	catch (const WCL::ComException& e)
+	{
+		m_result = e.m_result;
+		::SetEvent(m_completed);
+	}
+	catch (const Core::Exception& /*e*/)
+	{
+		m_result = E_FAIL;
+		::SetEvent(m_completed);
+	}
+	catch (const std::exception& /*e*/)
+	{
+		m_result = E_FAIL;
+		::SetEvent(m_completed);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! The worker thread function.
+
+unsigned __stdcall ConnectAttempt::attemptThread(void* parameter)
+{
+	ConnectAttempt* attempt = static_cast<ConnectAttempt*>(parameter);
+
+	attempt->run();
+	attempt->dropReference();
+
+	return 0;
+}
+
+//namespace WMI
+}
@@ -0,0 +1,92 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   ConnectAttempt.hpp
+//! \brief  The ConnectAttempt class declaration.
+//! \author Chris Oldwood
+
+// Check for previous inclusion
+#ifndef WMI_CONNECTATTEMPT_HPP
+#define WMI_CONNECTATTEMPT_HPP
+
+#if _MSC_VER > 1000
+#pragma once
+#endif
+
+#include "Connection.hpp"
+#include "GlobalInterface.hpp"
+#include <Core/SharedPtr.hpp>
+
+namespace WMI
+{
+
+////////////////////////////////////////////////////////////////////////////////
+//! An attempt to connect to a namespace that runs on its own thread, so that
+//! the caller can stop waiting for it at a deadline. The call to ConnectServer
+//! cannot be interrupted and so an attempt that is abandoned is left to finish
+//! in the background, after which it cleans itself up.
+//!
+//! The worker joins the multi-threaded apartment and registers the connection
+//! in the Global Interface Table so that it can be collected by the caller. It
+//! stays in the apartment until the caller has collected or abandoned it.
+
+class ConnectAttempt : private Core::NotCopyable
+{
+public:
+	//! Connect to a namespace on the calling thread.
+	static HRESULT connect(IWbemLocatorPtr locator, const Connection::Target& target,
+							long flags, IWbemServicesPtr& services);
+
+	//! Connect to the first of a set of namespaces to respond before a deadline.
+	static HRESULT race(IWbemLocatorPtr locator, const Connection::Targets& targets,
+						const Deadline& deadline, IWbemServicesPtr& services, size_t& winner);
+
+	//! Format the full path for a namespace on a host.
+	static tstring formatPath(const tstring& host, const tstring& nmspace);
+
+private:
+	//! The Global Interface Table entry smart-pointer type.
+	typedef Core::SharedPtr< GlobalInterface<IWbemServices> > GlobalServicesPtr;
+
+	//
+	// Members.
+	//
+	volatile LONG		m_refCount;		//!< The owners, i.e. the caller and the worker.
+	IWbemLocatorPtr		m_locator;		//!< The free-threaded locator, or null for WMI's.
+	Connection::Target	m_target;		//!< The namespace to connect to.
+	HANDLE				m_completed;	//!< Signalled when the attempt has finished.
+	HANDLE				m_released;		//!< Signalled when the caller has finished with it.
+	HRESULT				m_result;		//!< The result of the attempt.
+	GlobalServicesPtr	m_services;		//!< The connection, if the attempt succeeded.
+
+	//! Construction from the namespace to connect to.
+	ConnectAttempt(IWbemLocatorPtr locator, const Connection::Target& target);
+
+	//! Destructor.
+	~ConnectAttempt();
+
+	//
+	// Internal methods.
+	//
+
+	//! Start the attempt on a worker thread.
+	HRESULT start();
+
+	//! Retrieve the connection for use in the calling apartment.
+	HRESULT collect(IWbemServicesPtr& services);
+
+	//! Give up the caller's interest in the attempt.
+	void release();
+
+	//! Drop a reference, deleting the attempt when there are no more.
+	void dropReference();
+
+	//! Make the attempt on the worker thread.
+	void run();
+
+	//! The worker thread function.
+	static unsigned __stdcall attemptThread(void* parameter);
+};
+
+//namespace WMI
+}
+
+#endif // WMI_CONNECTATTEMPT_HPP
@@ -9,6 +9,8 @@
 #include "Exception.hpp"
 #include <Core/StringUtils.hpp>
 #include "ObjectIterator.hpp"
+#include "ConnectAttempt.hpp"
+#include "SharedLocator.hpp"
 
 #ifdef _MSC_VER
 // Add .lib to linker.
@@ -34,7 +36,54 @@ const tstring Connection::DEFAULT_NAMESPACE = TXT("\\root\\cimv2");
 ////////////////////////////////////////////////////////////////////////////////
 //! Default constructor.
 
+Connection::State::State()
+	: m_customLocator()
+	, m_services()
+	, m_stats()
+	, m_affinity()
+	, m_retryPolicy()
+	, m_target(TXT(""))
+	, m_reconnectable(false)
+	, m_templates()
+	, m_blanket()
+	, m_proxy(false)
+	, m_batchSize(1)
+	, m_batchBudget(BatchSizer::DEFAULT_MAXIMUM)
+	, m_limiter()
+	, m_lock()
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Copy constructor, which gives the copy its own lock. The WMI connection is
+//! read under the original's lock as a reconnect may be replacing it.
+
+Connection::State::State(const State& rhs)
+	: m_customLocator(rhs.m_customLocator)
+	, m_services()
+	, m_stats(rhs.m_stats)
+	, m_affinity(rhs.m_affinity)
+	, m_retryPolicy(rhs.m_retryPolicy)
+	, m_target(rhs.m_target)
+	, m_reconnectable(rhs.m_reconnectable)
+	, m_templates(rhs.m_templates)
+	, m_blanket(rhs.m_blanket)
+	, m_proxy(rhs.m_proxy)
+	, m_batchSize(rhs.m_batchSize)
+	, m_batchBudget(rhs.m_batchBudget)
+	, m_limiter(rhs.m_limiter)
+	, m_lock()
+{
+	CriticalSection::Lock lock(rhs.m_lock);
+
+	m_services = rhs.m_services;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Default constructor.
+
 Connection::Connection()
+	: m_state(new State)
 {
 }
 
@@ -42,6 +91,7 @@ Connection::Connection()
 //! Open a connection to a specific host using the current credentials.
 
 Connection::Connection(const tstring& host)
+	: m_state(new State)
 {
 	open(host);
 }
@@ -51,7 +101,6 @@ Connection::Connection(const tstring& host)
 
 Connection::~Connection()
 {
-	close();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -59,7 +108,19 @@ Connection::~Connection()
 
 bool Connection::isOpen() const
 {
-	return ((m_locator.get() != nullptr) && (m_services.get() != nullptr));
+	return (get().get() != nullptr);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the underlying COM connection. The connection is shared by the copies
+//! and can be replaced by a reconnect on another thread, so a reference is
+//! taken under the lock and the caller uses that.
+
+IWbemServicesPtr Connection::get() const
+{
+	CriticalSection::Lock lock(m_state->m_lock);
+
+	return m_state->m_services;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -93,56 +154,232 @@ void Connection::open(const tstring& host, const tstring& login, const tstring&
 {
 	ASSERT(!isOpen());
 
-	// Format the full connection path.
-	tstring path = host + nmspace;
-
-	if (path.compare(0, 2, TXT("\\\\")) != 0)
-		path = TXT("\\\\") + path;
+	detach();
 
 	// Create the connection.
+	IWbemLocatorPtr		locator = m_state->m_customLocator;
 	IWbemServicesPtr	services;
-	IWbemLocatorPtr		locator(CLSID_WbemLocator);
-	WCL::ComStr			bstrPath(path);
-	WCL::ComStr			bstrAuth(TXT(""));
 	HRESULT				result;
 
-	if (login.empty())
-	{
-		result = locator->ConnectServer(bstrPath.Get(), nullptr, nullptr, nullptr, 0,
-										bstrAuth.Get(), nullptr, AttachTo(services));
-	}
-	else
+	if (locator.get() == nullptr)
+		locator = SharedLocator::get();
+
 	{
-		WCL::ComStr	bstrLogin(login);
-		WCL::ComStr	bstrPassword(password);
+		ConnectionStats::Timer timer(m_state->m_stats.get(), ConnectionStats::CONNECT_SERVER);
 
-		result = locator->ConnectServer(bstrPath.Get(), bstrLogin.Get(), bstrPassword.Get(), nullptr, 0,
-										bstrAuth.Get(), nullptr, AttachTo(services));
+		result = ConnectAttempt::connect(locator, Target(host, nmspace, login, password), 0, services);
 	}
 
 	if (FAILED(result))
 		throw Exception(result, locator, Core::fmt(TXT("Failed to connect to the WMI provider on '%s'"), host.c_str()).c_str());
 
-	// Enable impersonation on the connection.
-    result = ::CoSetProxyBlanket(services.get(), RPC_C_AUTHN_DEFAULT, RPC_C_AUTHZ_DEFAULT, nullptr,
-									RPC_C_AUTHN_LEVEL_CALL, RPC_C_IMP_LEVEL_IMPERSONATE,
-									nullptr, EOAC_NONE);
+	attach(services);
+
+	m_state->m_target = Target(host, nmspace, login, password);
+	m_state->m_reconnectable = true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Open a connection to a specific host and namespace, giving up at a deadline.
+//! The attempt is made on a worker thread with the maximum wait flag set and
+//! is abandoned if the deadline passes first, in which case WBEM_E_TIMED_OUT
+//! is thrown.
+
+void Connection::open(const tstring& host, const tstring& login, const tstring& password, const tstring& nmspace,
+						const Deadline& deadline)
+{
+	openFirst(Targets(1, Target(host, nmspace, login, password)), deadline);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Open a connection to the first of a set of namespaces to respond before a
+//! deadline, returning the index of the target connected to. The attempts are
+//! made in parallel, each on its own worker thread, and those that are still
+//! outstanding when one succeeds or the deadline passes are abandoned. If they
+//! all fail the last failure is thrown.
+
+size_t Connection::openFirst(const Targets& targets, const Deadline& deadline)
+{
+	ASSERT(!isOpen());
+	ASSERT(!targets.empty());
+
+	detach();
+
+	IWbemServicesPtr	services;
+	size_t				winner = 0;
+	HRESULT				result;
+
+	{
+		ConnectionStats::Timer timer(m_state->m_stats.get(), ConnectionStats::CONNECT_SERVER);
+
+		result = ConnectAttempt::race(m_state->m_customLocator, targets, deadline, services, winner);
+	}
 
 	if (FAILED(result))
-		throw Exception(result, locator, TXT("Failed to enable impersonation on the WMI connection"));
+	{
+		tstring hosts;
+
+		for (Targets::const_iterator it = targets.begin(); it != targets.end(); ++it)
+		{
+			if (!hosts.empty())
+				hosts += TXT(", ");
+
+			hosts += it->m_host;
+		}
+
+		throw Exception(result, Core::fmt(TXT("Failed to connect to the WMI provider on '%s'"), hosts.c_str()).c_str());
+	}
+
+	attach(services);
+
+	m_state->m_target = targets[winner];
+	m_state->m_reconnectable = true;
+
+	return winner;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Attach the connection to an existing COM connection, such as one that is
+//! being recorded or replayed, or has been marshalled from another apartment.
+
+void Connection::open(IWbemServicesPtr services)
+{
+	ASSERT(!isOpen());
+	ASSERT(services.get() != nullptr);
+
+	detach();
+	attach(services);
+
+	m_state->m_reconnectable = false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Attach the connection to an existing COM connection to a namespace, such as
+//! one marshalled from another apartment, which is re-opened if it is lost.
+
+void Connection::open(IWbemServicesPtr services, const Target& target)
+{
+	ASSERT(!isOpen());
+	ASSERT(services.get() != nullptr);
+
+	detach();
+	attach(services);
+
+	m_state->m_target = target;
+	m_state->m_reconnectable = true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Set the call statistics to update. The statistics are shared with any
+//! objects and iterators subsequently created from the connection and so
+//! should be set before the connection is used.
+
+void Connection::setStats(ConnectionStatsPtr stats)
+{
+	detach();
 
-	// Update state.
-	m_locator  = locator;
-	m_services = services;
+	m_state->m_stats = stats;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-//! Close the connection.
+//! Set the locator used to open connections instead of WMI's, such as a
+//! MemoryLocator. The locator is called on worker threads when opening with a
+//! deadline and so must be free-threaded. Passing null restores WMI's.
+
+void Connection::setLocator(IWbemLocatorPtr locator)
+{
+	detach();
+
+	m_state->m_customLocator = locator;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Set the security blanket to apply to the proxies. The blanket is applied to
+//! the connection when it is opened and then to each query's enumerator, and
+//! so should be set before the connection is opened.
+
+void Connection::setSecurityBlanket(const SecurityBlanket& blanket)
+{
+	detach();
+
+	m_state->m_blanket = blanket;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Set the policy for retrying calls that fail with a transient error. Only
+//! idempotent calls are retried, i.e. getObject() and execQuery(), up to the
+//! point where the first object is returned. A connection opened by host is
+//! also re-opened when it is lost, but one attached to an existing COM
+//! connection is not. Passing null disables retries.
+
+void Connection::setRetryPolicy(RetryPolicyPtr policy)
+{
+	detach();
+
+	m_state->m_retryPolicy = policy;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Set the number of objects requested per call to IEnumWbemClassObject::Next()
+//! when enumerating a query. The default of one object per call suits a local
+//! host, whereas a remote host needs larger batches to amortise the round trip.
+//! With ADAPTIVE_BATCH_SIZE the size is chosen by a BatchSizer from the
+//! duration of the previous calls.
+
+void Connection::setBatchSize(size_t size)
+{
+	detach();
+
+	m_state->m_batchSize = size;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Set the most objects an enumeration holds in memory at once, which limits
+//! both the adaptive and any fixed batch size.
+
+void Connection::setBatchBudget(size_t objects)
+{
+	ASSERT(objects != 0);
+
+	detach();
+
+	m_state->m_batchBudget = objects;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Set the limiter for the calls made to the host. The same limiter should be
+//! set on every connection to the host, such as those used by different
+//! threads, so that together they stay within its limits. Each attempt at
+//! getObject(), execQuery() and an object's execMethod() needs a slot and a
+//! token, whereas the calls to fetch the results of a query only need a slot.
+//! The time spent waiting is recorded as a LIMITER_WAIT operation. Passing
+//! null removes the limits.
+
+void Connection::setLimiter(HostLimiterPtr limiter)
+{
+	detach();
+
+	m_state->m_limiter = limiter;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Close the connection. The objects and iterators created from it keep their
+//! reference to the open connection, and so this only affects this copy. The
+//! settings, such as the statistics and retry policy, are kept.
 
 void Connection::close()
 {
-	m_services.Release();
-	m_locator.Release();
+	StatePtr state(new State);
+
+	state->m_customLocator = m_state->m_customLocator;
+	state->m_stats         = m_state->m_stats;
+	state->m_retryPolicy   = m_state->m_retryPolicy;
+	state->m_blanket       = m_state->m_blanket;
+	state->m_batchSize     = m_state->m_batchSize;
+	state->m_batchBudget   = m_state->m_batchBudget;
+	state->m_limiter       = m_state->m_limiter;
+
+	m_state = state;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -150,20 +387,17 @@ void Connection::close()
 
 Object Connection::getObject(const tstring& path) const
 {
-	const WCL::ComStr objectPath(path);
+	const Result<Object> object = tryGetObject(path);
 
-	IWbemClassObjectPtr object;
-
-	HRESULT result = m_services->GetObject(objectPath.Get(), WBEM_FLAG_RETURN_WBEM_COMPLETE,
-											nullptr, AttachTo(object), nullptr);
-
-	if (FAILED(result))
+	if (object.failed())
 	{
-		const tstring message = Core::fmt(TXT("Failed to get object from path '%s'"), path.c_str());
-		throw Exception(result, m_services, message.c_str());
+		const tstring    message = Core::fmt(TXT("Failed to get object from path '%s'"), path.c_str());
+		IWbemServicesPtr services = get();
+
+		throw Exception(object.result(), services, message.c_str());
 	}
 
-	return Object(object, *this);
+	return object.value();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -178,63 +412,364 @@ ObjectIterator Connection::execQuery(const tstring& query) const
 //! Execute the query.
 
 ObjectIterator Connection::execQuery(const tchar* query) const
+{
+	return execQuery(query, Deadline());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Execute the query, with a deadline and cancellation token for the enumeration.
+
+ObjectIterator Connection::execQuery(const tstring& query, const Deadline& deadline, CancellationTokenPtr token) const
+{
+	return execQuery(query.c_str(), deadline, token);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Execute the query, with a deadline and cancellation token for the enumeration.
+
+ObjectIterator Connection::execQuery(const tchar* query, const Deadline& deadline, CancellationTokenPtr token) const
+{
+	const Result<ObjectIterator> iterator = tryExecQuery(query, deadline, token);
+
+	if (iterator.failed())
+	{
+		IWbemServicesPtr services = get();
+
+		throw Exception(iterator.result(), services, TXT("Failed to execute a WMI query"));
+	}
+
+	return iterator.value();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get a single object using it's unique path, without throwing on failure.
+
+Result<Object> Connection::tryGetObject(const tstring& path) const
+{
+	ASSERT(m_state->m_affinity.isAccessible());
+
+	const WCL::ComStr objectPath(path);
+	const Deadline    budget = retryBudget();
+
+	IWbemClassObjectPtr object;
+	HRESULT             result;
+	size_t              retries = 0;
+
+	do
+	{
+		HostLimiter::Permit permit(m_state->m_limiter.get(), HostLimiter::REQUEST, Deadline(), m_state->m_stats.get());
+
+		ConnectionStats::Timer timer(m_state->m_stats.get(), ConnectionStats::GET_OBJECT);
+
+		result = get()->GetObject(objectPath.Get(), WBEM_FLAG_RETURN_WBEM_COMPLETE,
+									nullptr, AttachTo(object), nullptr);
+	}
+	while (FAILED(result) && retryAfter(result, retries, budget, Deadline()));
+
+	if (FAILED(result))
+		return Result<Object>::failure(result);
+
+	return Result<Object>::success(Object(object, *this));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Execute the query, without throwing on failure.
+
+Result<ObjectIterator> Connection::tryExecQuery(const tstring& query) const
+{
+	return tryExecQuery(query.c_str(), Deadline());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Execute the query, without throwing on failure.
+
+Result<ObjectIterator> Connection::tryExecQuery(const tchar* query) const
+{
+	return tryExecQuery(query, Deadline());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Execute the query, with a deadline and cancellation token, without throwing
+//! on failure.
+
+Result<ObjectIterator> Connection::tryExecQuery(const tstring& query, const Deadline& deadline, CancellationTokenPtr token) const
+{
+	return tryExecQuery(query.c_str(), deadline, token);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Execute the query, with a deadline and cancellation token, without throwing
+//! on failure. As the query is executed semi-synchronously an invalid query is
+//! often only reported when the first object is fetched and so that is included
+//! in the result too. The deadline and token are passed on to the iterator and
+//! so bound the entire enumeration.
+
+Result<ObjectIterator> Connection::tryExecQuery(const tchar* query, const Deadline& deadline, CancellationTokenPtr token) const
 {
 	ASSERT(isOpen());
+	ASSERT(m_state->m_affinity.isAccessible());
+
+	if ( (token.get() != nullptr) && token->isCancelled() )
+		return Result<ObjectIterator>::failure(WBEM_E_CALL_CANCELLED);
+
+	if (deadline.hasExpired())
+		return Result<ObjectIterator>::failure(WBEM_E_TIMED_OUT);
+
+	WCL::ComStr		language(L"WQL");
+	WCL::ComStr		queryText(query);
+	long			flags(WBEM_FLAG_RETURN_IMMEDIATELY | WBEM_FLAG_FORWARD_ONLY);
+	const Deadline	budget = retryBudget();
+
+	ObjectIterator	iterator;
+	HRESULT			result;
+	size_t			retries = 0;
+
+	do
+	{
+		IEnumWbemClassObjectPtr enumerator;
+
+		// Execute it, within the host's limits.
+		{
+			HostLimiter::Permit permit(m_state->m_limiter.get(), HostLimiter::REQUEST, deadline, m_state->m_stats.get());
+
+			if (!permit.acquired())
+				return Result<ObjectIterator>::failure(WBEM_E_TIMED_OUT);
 
-	WCL::ComStr	language(L"WQL");
-	WCL::ComStr	queryText(query);
-	long		flags(WBEM_FLAG_RETURN_IMMEDIATELY | WBEM_FLAG_FORWARD_ONLY);
+			ConnectionStats::Timer timer(m_state->m_stats.get(), ConnectionStats::EXEC_QUERY);
 
-	IEnumWbemClassObjectPtr enumerator;
+			result = get()->ExecQuery(language.Get(), queryText.Get(), flags,
+										nullptr, AttachTo(enumerator));
+		}
 
-	// Execute it.
-	HRESULT result = m_services->ExecQuery(language.Get(), queryText.Get(), flags,
-											nullptr, AttachTo(enumerator));
+		// The enumerator is a separate proxy and needs its own blanket.
+		if (SUCCEEDED(result) && m_state->m_proxy)
+			result = m_state->m_blanket.apply(enumerator.get());
+
+		if (SUCCEEDED(result))
+			iterator = ObjectIterator(enumerator, *this, deadline, token, result);
+	}
+	while (FAILED(result) && ((token.get() == nullptr) || !token->isCancelled())
+			&& retryAfter(result, retries, budget, deadline));
 
 	if (FAILED(result))
-		throw Exception(result, m_services, TXT("Failed to execute a WMI query"));
+		return Result<ObjectIterator>::failure(result);
 
-	return ObjectIterator(enumerator, *this);
+	return Result<ObjectIterator>::success(iterator);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 //! Execute a method on an object.
 
-void Connection::execMethod(IWbemServicesPtr connection, IWbemClassObjectPtr /*object*/,
+void Connection::execMethod(IWbemServicesPtr connection, IWbemClassObjectPtr object,
 							const tchar* path, const tchar* method, WCL::Variant& returnValue)
 {
-	ASSERT(connection.get() != nullptr);
+	execMethod(connection, object, path, method, IWbemClassObjectPtr(), returnValue);
+}
 
-	const WCL::ComStr objectPath(path);
-	const WCL::ComStr methodName(method);
+////////////////////////////////////////////////////////////////////////////////
+//! Execute a method on the object.
 
-	IWbemClassObjectPtr output;
+void Connection::execMethod(IWbemServicesPtr connection, IWbemClassObjectPtr object,
+							const tchar* path, const tchar* method, IWbemClassObjectPtr arguments, WCL::Variant& returnValue)
+{
+	IWbemClassObjectPtr results;
 
-	HRESULT result = connection->ExecMethod(objectPath.Get(), methodName.Get(), 0,
-											nullptr, nullptr, AttachTo(output), nullptr);
+	execMethod(connection, object, path, method, arguments, returnValue, results);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Execute a method on the object, returning its output parameters.
+
+void Connection::execMethod(IWbemServicesPtr connection, IWbemClassObjectPtr object, const tchar* path, const tchar* method,
+							IWbemClassObjectPtr arguments, WCL::Variant& returnValue, IWbemClassObjectPtr& results)
+{
+	const HRESULT result = tryExecMethod(connection, object, path, method, arguments, returnValue, results);
 
 	if (FAILED(result))
 	{
 		const tstring message = Core::fmt(TXT("Failed to execute method '%s' on object '%s'"), method, path);
 		throw Exception(result, connection, message.c_str());
 	}
+}
 
-	const WCL::ComStr RETURN_VALUE(TXT("ReturnValue"));
+////////////////////////////////////////////////////////////////////////////////
+//! Enable impersonation on a COM connection, using the default security
+//! blanket. The security blanket belongs to the proxy and so must also be set
+//! on a connection that has been marshalled to another apartment.
+
+HRESULT Connection::enableImpersonation(IWbemServicesPtr services)
+{
+	ASSERT(services.get() != nullptr);
+
+	return SecurityBlanket().apply(services.get());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Apply the security blanket to a new connection and update the state. An
+//! in-process provider has no proxy and so needs no security blanket, nor do
+//! the enumerators it returns.
+
+void Connection::attach(IWbemServicesPtr services)
+{
+	const HRESULT result = m_state->m_blanket.apply(services.get());
+
+	if (FAILED(result) && (result != E_NOINTERFACE))
+		throw Exception(result, services, TXT("Failed to set the security blanket on the WMI connection"));
+
+	setServices(services);
+
+	m_state->m_affinity  = ThreadAffinity();
+	m_state->m_templates = ArgumentTemplatesPtr(new ArgumentTemplates);
+	m_state->m_proxy     = (result != E_NOINTERFACE);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Give this copy of the connection its own state, so that changing it does
+//! not affect the other copies, such as those held by its objects.
 
-    result = output->Get(RETURN_VALUE.Get(), 0, &returnValue, NULL, 0);
+void Connection::detach()
+{
+	m_state = StatePtr(new State(*m_state));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Replace the underlying WMI connection shared by the copies. The previous
+//! one is released outside the lock, after any other thread has taken its own
+//! reference to it via get().
+
+void Connection::setServices(IWbemServicesPtr services) const
+{
+	IWbemServicesPtr previous;
+
+	{
+		CriticalSection::Lock lock(m_state->m_lock);
+
+		previous = m_state->m_services;
+		m_state->m_services = services;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Re-open a lost connection to the same namespace on the calling thread. The
+//! maximum wait flag is set so that a host that is still down does not stall
+//! the caller for the full DCOM timeout.
+
+HRESULT Connection::reconnect() const
+{
+	ASSERT(m_state->m_reconnectable);
+
+	IWbemLocatorPtr  locator = m_state->m_customLocator;
+	IWbemServicesPtr services;
+	HRESULT          result;
+
+	if (locator.get() == nullptr)
+	{
+		result = SharedLocator::tryGet(locator);
+
+		if (FAILED(result))
+			return result;
+	}
+
+	{
+		ConnectionStats::Timer timer(m_state->m_stats.get(), ConnectionStats::CONNECT_SERVER);
+
+		result = ConnectAttempt::connect(locator, m_state->m_target, WBEM_FLAG_CONNECT_USE_MAX_WAIT, services);
+	}
 
 	if (FAILED(result))
+		return result;
+
+	result = m_state->m_blanket.apply(services.get());
+
+	if (FAILED(result) && (result != E_NOINTERFACE))
+		return result;
+
+	setServices(services);
+
+	if (m_state->m_stats.get() != nullptr)
+		m_state->m_stats->recordEvent(ConnectionStats::RECONNECT);
+
+	return S_OK;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the time a call can spend retrying.
+
+Deadline Connection::retryBudget() const
+{
+	if (m_state->m_retryPolicy.get() == nullptr)
+		return Deadline();
+
+	return Deadline::after(m_state->m_retryPolicy->budget());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Decide whether to retry a failed call. A transient failure is retried after
+//! a back off and a lost connection is also re-opened first, which is itself
+//! retried if it fails. The retries stop when the policy's limit is reached or
+//! the next delay would pass either the retry budget or the call's deadline.
+
+bool Connection::retryAfter(HRESULT& result, size_t& retries, const Deadline& budget, const Deadline& deadline) const
+{
+	if (m_state->m_retryPolicy.get() == nullptr)
+		return false;
+
+	for (;;)
 	{
-		const tstring message = Core::fmt(TXT("Failed to get '%s' method return value"), method);
-		throw Exception(result, connection, message.c_str());
+		const RetryPolicy::Classification classification = RetryPolicy::classify(result);
+
+		if (classification == RetryPolicy::PERMANENT)
+			return false;
+
+		if ( (classification == RetryPolicy::DISCONNECTED) && !m_state->m_reconnectable )
+			return false;
+
+		if (retries == m_state->m_retryPolicy->maxRetries())
+			return false;
+
+		const uint delay = m_state->m_retryPolicy->delay(retries);
+
+		if ( (!budget.isInfinite() && (static_cast<long>(delay) >= budget.remaining()))
+		  || (!deadline.isInfinite() && (static_cast<long>(delay) >= deadline.remaining())) )
+			return false;
+
+		::Sleep(delay);
+
+		++retries;
+
+		if (m_state->m_stats.get() != nullptr)
+			m_state->m_stats->recordEvent(ConnectionStats::RETRY);
+
+		if (classification == RetryPolicy::TRANSIENT)
+			return true;
+
+		result = reconnect();
+
+		if (SUCCEEDED(result))
+			return true;
 	}
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-//! Execute a method on the object.
+//! Execute a method on the object, without throwing on failure. The arguments
+//! are optional. A failure to retrieve the method's return value is reported
+//! as a failure of the call.
 
-void Connection::execMethod(IWbemServicesPtr connection, IWbemClassObjectPtr /*object*/,
+HRESULT Connection::tryExecMethod(IWbemServicesPtr connection, IWbemClassObjectPtr object,
 							const tchar* path, const tchar* method, IWbemClassObjectPtr arguments, WCL::Variant& returnValue)
+{
+	IWbemClassObjectPtr results;
+
+	return tryExecMethod(connection, object, path, method, arguments, returnValue, results);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Execute a method on the object, returning its output parameters, without
+//! throwing on failure. The output parameters object also holds the return
+//! value and any out parameters, which can be read with Object::getArgument().
+
+HRESULT Connection::tryExecMethod(IWbemServicesPtr connection, IWbemClassObjectPtr /*object*/, const tchar* path, const tchar* method,
+							IWbemClassObjectPtr arguments, WCL::Variant& returnValue, IWbemClassObjectPtr& results)
 {
 	ASSERT(connection.get() != nullptr);
 
@@ -247,20 +782,16 @@ void Connection::execMethod(IWbemServicesPtr connection, IWbemClassObjectPtr /*o
 											nullptr, arguments.get(), AttachTo(output), nullptr);
 
 	if (FAILED(result))
-	{
-		const tstring message = Core::fmt(TXT("Failed to execute method '%s' on object '%s'"), method, path);
-		throw Exception(result, connection, message.c_str());
-	}
+		return result;
 
 	const WCL::ComStr RETURN_VALUE(TXT("ReturnValue"));
 
-    result = output->Get(RETURN_VALUE.Get(), 0, &returnValue, NULL, 0);
+	result = output->Get(RETURN_VALUE.Get(), 0, &returnValue, NULL, 0);
 
-	if (FAILED(result))
-	{
-		const tstring message = Core::fmt(TXT("Failed to get '%s' method return value"), method);
-		throw Exception(result, connection, message.c_str());
-	}
+	if (SUCCEEDED(result))
+		results = output;
+
+	return result;
 }
 
 //namespace WMI
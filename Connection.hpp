@@ -12,7 +12,20 @@
 #endif
 
 #include "Types.hpp"
+#include "ConnectionStats.hpp"
+#include "Result.hpp"
+#include "ThreadAffinity.hpp"
+#include "Deadline.hpp"
+#include "CancellationToken.hpp"
+#include "RetryPolicy.hpp"
+#include "ArgumentTemplates.hpp"
+#include "SecurityBlanket.hpp"
+#include "BatchSizer.hpp"
+#include "HostLimiter.hpp"
+#include "CriticalSection.hpp"
 #include <WCL/Variant.hpp>
+#include <Core/SharedPtr.hpp>
+#include <vector>
 
 namespace WMI
 {
@@ -22,10 +35,30 @@ class Object;
 class ObjectIterator;
 
 ////////////////////////////////////////////////////////////////////////////////
-//! A connection to the WMI provider on a host.
+//! A connection to the WMI provider on a host. The state of an open connection
+//! is shared by its copies, such as those held by the objects and iterators
+//! created from it, and so copying a connection is cheap. Changing a setting
+//! or re-opening the connection only affects the copy it is done to.
 
 class Connection
 {
+public:
+	//! A namespace on a host to try to connect to.
+	struct Target
+	{
+		//! Construction from the host, namespace and credentials.
+		Target(const tstring& host, const tstring& nmspace = DEFAULT_NAMESPACE,
+				const tstring& login = TXT(""), const tstring& password = TXT(""));
+
+		tstring	m_host;			//!< The host name.
+		tstring	m_namespace;	//!< The namespace.
+		tstring	m_login;		//!< The login, or empty for the current credentials.
+		tstring	m_password;		//!< The password.
+	};
+
+	//! A set of connection targets.
+	typedef std::vector<Target> Targets;
+
 public:
 	//! Default constructor.
 	Connection();
@@ -46,6 +79,60 @@ public:
 	//! Get the underlying COM connection.
 	IWbemServicesPtr get() const;
 
+	//! Get the thread and apartment the connection was opened on.
+	const ThreadAffinity& affinity() const;
+
+	//! Get the call statistics, if being collected.
+	const ConnectionStatsPtr& stats() const;
+
+	//! Set the call statistics to update.
+	void setStats(ConnectionStatsPtr stats);
+
+	//! Get the locator used to open connections instead of WMI's, if set.
+	const IWbemLocatorPtr& locator() const;
+
+	//! Set the locator used to open connections instead of WMI's.
+	void setLocator(IWbemLocatorPtr locator);
+
+	//! Get the namespace connected to, if it can be re-opened.
+	const Target& target() const;
+
+	//! Query if the connection can be re-opened when it is lost.
+	bool isReconnectable() const;
+
+	//! Get the security blanket applied to the proxies.
+	const SecurityBlanket& securityBlanket() const;
+
+	//! Set the security blanket to apply to the proxies.
+	void setSecurityBlanket(const SecurityBlanket& blanket);
+
+	//! Get the policy for retrying calls, if set.
+	const RetryPolicyPtr& retryPolicy() const;
+
+	//! Set the policy for retrying calls that fail with a transient error.
+	void setRetryPolicy(RetryPolicyPtr policy);
+
+	//! Get the cache of method argument definitions, if open.
+	const ArgumentTemplatesPtr& argumentTemplates() const;
+
+	//! Get the number of objects requested per call when enumerating.
+	size_t batchSize() const;
+
+	//! Set the number of objects requested per call when enumerating.
+	void setBatchSize(size_t size);
+
+	//! Get the most objects an enumeration holds in memory at once.
+	size_t batchBudget() const;
+
+	//! Set the most objects an enumeration holds in memory at once.
+	void setBatchBudget(size_t objects);
+
+	//! Get the limiter for the calls made to the host, if set.
+	const HostLimiterPtr& limiter() const;
+
+	//! Set the limiter for the calls made to the host.
+	void setLimiter(HostLimiterPtr limiter);
+
 	//
 	// Methods.
 	//
@@ -62,6 +149,19 @@ public:
 	//! Open a connection to a specific host and namespace.
 	void open(const tstring& host, const tstring& login, const tstring& password, const tstring& nmspace); // throw(WMI::Exception)
 
+	//! Open a connection to a specific host and namespace, giving up at a deadline.
+	void open(const tstring& host, const tstring& login, const tstring& password, const tstring& nmspace,
+				const Deadline& deadline); // throw(WMI::Exception)
+
+	//! Open a connection to the first of a set of namespaces to respond before a deadline.
+	size_t openFirst(const Targets& targets, const Deadline& deadline); // throw(WMI::Exception)
+
+	//! Attach the connection to an existing COM connection.
+	void open(IWbemServicesPtr services); // throw(WMI::Exception)
+
+	//! Attach the connection to an existing COM connection to a namespace it can re-open.
+	void open(IWbemServicesPtr services, const Target& target); // throw(WMI::Exception)
+
 	//! Close the connection.
 	void close();
 
@@ -74,6 +174,31 @@ public:
 	//! Execute the query.
 	ObjectIterator execQuery(const tchar* query) const; // throw(WMI::Exception)
 
+	//! Execute the query, with a deadline and cancellation token for the enumeration.
+	ObjectIterator execQuery(const tstring& query, const Deadline& deadline,
+								CancellationTokenPtr token = CancellationTokenPtr()) const; // throw(WMI::Exception)
+
+	//! Execute the query, with a deadline and cancellation token for the enumeration.
+	ObjectIterator execQuery(const tchar* query, const Deadline& deadline,
+								CancellationTokenPtr token = CancellationTokenPtr()) const; // throw(WMI::Exception)
+
+	//! Get a single object using it's unique path, without throwing on failure.
+	Result<Object> tryGetObject(const tstring& path) const;
+
+	//! Execute the query, without throwing on failure.
+	Result<ObjectIterator> tryExecQuery(const tstring& query) const;
+
+	//! Execute the query, without throwing on failure.
+	Result<ObjectIterator> tryExecQuery(const tchar* query) const;
+
+	//! Execute the query, with a deadline and cancellation token, without throwing on failure.
+	Result<ObjectIterator> tryExecQuery(const tstring& query, const Deadline& deadline,
+										CancellationTokenPtr token = CancellationTokenPtr()) const;
+
+	//! Execute the query, with a deadline and cancellation token, without throwing on failure.
+	Result<ObjectIterator> tryExecQuery(const tchar* query, const Deadline& deadline,
+										CancellationTokenPtr token = CancellationTokenPtr()) const;
+
 	//
 	// Methods.
 	//
@@ -86,6 +211,21 @@ public:
 	static void execMethod(IWbemServicesPtr connection, IWbemClassObjectPtr object,
 							const tchar* path, const tchar* method, IWbemClassObjectPtr arguments, WCL::Variant& returnValue); // throw(WMI::Exception)
 
+	//! Execute a method on the object, returning its output parameters.
+	static void execMethod(IWbemServicesPtr connection, IWbemClassObjectPtr object, const tchar* path, const tchar* method,
+							IWbemClassObjectPtr arguments, WCL::Variant& returnValue, IWbemClassObjectPtr& results); // throw(WMI::Exception)
+
+	//! Enable impersonation on a COM connection.
+	static HRESULT enableImpersonation(IWbemServicesPtr services);
+
+	//! Execute a method on the object, without throwing on failure.
+	static HRESULT tryExecMethod(IWbemServicesPtr connection, IWbemClassObjectPtr object,
+							const tchar* path, const tchar* method, IWbemClassObjectPtr arguments, WCL::Variant& returnValue);
+
+	//! Execute a method on the object, returning its output parameters, without throwing on failure.
+	static HRESULT tryExecMethod(IWbemServicesPtr connection, IWbemClassObjectPtr object, const tchar* path, const tchar* method,
+							IWbemClassObjectPtr arguments, WCL::Variant& returnValue, IWbemClassObjectPtr& results);
+
 	//
 	// Constants.
 	//
@@ -94,21 +234,172 @@ public:
 	static const tstring LOCALHOST;
 	//! The default namespace.
 	static const tstring DEFAULT_NAMESPACE;
+	//! The batch size for choosing the size from the latency of each call.
+	static const size_t ADAPTIVE_BATCH_SIZE = 0;
 
 private:
+	//! The state shared by the copies of a connection.
+	struct State
+	{
+		//! Default constructor.
+		State();
+
+		//! Copy constructor, which gives the copy its own lock.
+		State(const State& rhs);
+
+		IWbemLocatorPtr			m_customLocator;//!< The locator to use instead of WMI's, if set.
+		IWbemServicesPtr		m_services;		//!< The underlying WMI connection.
+		ConnectionStatsPtr		m_stats;		//!< The call statistics, if being collected.
+		ThreadAffinity			m_affinity;		//!< The thread the connection was opened on.
+		RetryPolicyPtr			m_retryPolicy;	//!< The policy for retrying calls, if set.
+		Target					m_target;		//!< The namespace connected to.
+		bool					m_reconnectable;//!< Can the connection be re-opened?
+		ArgumentTemplatesPtr	m_templates;	//!< The cached method argument definitions.
+		SecurityBlanket			m_blanket;		//!< The security blanket for the proxies.
+		bool					m_proxy;		//!< Is the connection a proxy?
+		size_t					m_batchSize;	//!< The objects requested per call when enumerating.
+		size_t					m_batchBudget;	//!< The most objects buffered by an enumeration.
+		HostLimiterPtr			m_limiter;		//!< The limiter for the host, if set.
+		mutable CriticalSection	m_lock;			//!< The lock guarding the WMI connection.
+
+	private:
+		// Disallow assignment.
+		State& operator=(const State&);
+	};
+
+	//! The shared state smart-pointer type.
+	typedef Core::SharedPtr<State> StatePtr;
+
 	//
 	// Members.
 	//
-	IWbemLocatorPtr				m_locator;		//!< The underlying WMI locator.
-	mutable IWbemServicesPtr	m_services;		//!< The underlying WMI connection.
+	StatePtr	m_state;	//!< The state, shared with the copies.
+
+	//
+	// Internal methods.
+	//
+
+	//! Give this copy its own state.
+	void detach();
+
+	//! Apply the security blanket to a new connection and update the state.
+	void attach(IWbemServicesPtr services); // throw(WMI::Exception)
+
+	//! Replace the underlying WMI connection shared by the copies.
+	void setServices(IWbemServicesPtr services) const;
+
+	//! Re-open a lost connection to the same namespace.
+	HRESULT reconnect() const;
+
+	//! Get the time a call can spend retrying.
+	Deadline retryBudget() const;
+
+	//! Decide whether to retry a failed call, backing off and reconnecting first.
+	bool retryAfter(HRESULT& result, size_t& retries, const Deadline& budget, const Deadline& deadline) const;
 };
 
 ////////////////////////////////////////////////////////////////////////////////
-//! Get the underlying COM connection.
+//! Construction from the host, namespace and credentials.
+
+inline Connection::Target::Target(const tstring& host, const tstring& nmspace,
+									const tstring& login, const tstring& password)
+	: m_host(host)
+	, m_namespace(nmspace)
+	, m_login(login)
+	, m_password(password)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the thread and apartment the connection was opened on. The connection,
+//! and the objects and iterators created from it, can only be used on threads
+//! in the same apartment unless it is marshalled with a MarshalledConnection.
+
+inline const ThreadAffinity& Connection::affinity() const
+{
+	return m_state->m_affinity;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the call statistics, if being collected.
+
+inline const ConnectionStatsPtr& Connection::stats() const
+{
+	return m_state->m_stats;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the security blanket applied to the proxies.
+
+inline const SecurityBlanket& Connection::securityBlanket() const
+{
+	return m_state->m_blanket;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the locator used to open connections instead of WMI's, if set.
+
+inline const IWbemLocatorPtr& Connection::locator() const
+{
+	return m_state->m_customLocator;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the namespace connected to, if the connection can be re-opened.
+
+inline const Connection::Target& Connection::target() const
+{
+	return m_state->m_target;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Query if the connection can be re-opened when it is lost.
+
+inline bool Connection::isReconnectable() const
+{
+	return m_state->m_reconnectable;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the policy for retrying calls, if set.
+
+inline const RetryPolicyPtr& Connection::retryPolicy() const
+{
+	return m_state->m_retryPolicy;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the cache of method argument definitions, if open. The cache is shared
+//! with the objects created from the connection.
+
+inline const ArgumentTemplatesPtr& Connection::argumentTemplates() const
+{
+	return m_state->m_templates;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the number of objects requested per call when enumerating, or
+//! ADAPTIVE_BATCH_SIZE if it is chosen from the latency of each call.
+
+inline size_t Connection::batchSize() const
+{
+	return m_state->m_batchSize;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the most objects an enumeration holds in memory at once.
+
+inline size_t Connection::batchBudget() const
+{
+	return m_state->m_batchBudget;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the limiter for the calls made to the host, if set.
 
-inline IWbemServicesPtr Connection::get() const
+inline const HostLimiterPtr& Connection::limiter() const
 {
-	return m_services;
+	return m_state->m_limiter;
 }
 
 //namespace WMI
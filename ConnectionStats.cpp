@@ -0,0 +1,288 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   ConnectionStats.cpp
+//! \brief  The ConnectionStats class definition.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include "ConnectionStats.hpp"
+#include <string.h>
+#include <math.h>
+
+namespace WMI
+{
+
+//! The number of bits used to select the sub-bucket.
+static const size_t SUB_BUCKET_BITS = 2;
+
+//! The highest power of two with its own set of buckets.
+static const size_t MAX_POWER = 39;
+
+////////////////////////////////////////////////////////////////////////////////
+//! Read a counter atomically, optionally resetting it.
+
+static uint64 readCounter(volatile LONGLONG& counter, bool reset)
+{
+	if (reset)
+		return static_cast<uint64>(::InterlockedExchange64(&counter, 0));
+
+	return static_cast<uint64>(::InterlockedCompareExchange64(&counter, 0, 0));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Default constructor.
+
+ConnectionStats::ConnectionStats()
+{
+	memset(const_cast<Counters*>(m_counters), 0, sizeof(m_counters));
+	memset(const_cast<LONGLONG*>(m_events), 0, sizeof(m_events));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Destructor.
+
+ConnectionStats::~ConnectionStats()
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Record a call to an operation.
+
+void ConnectionStats::record(Operation operation, uint64 microseconds, uint64 bytes, uint64 objects)
+{
+	ASSERT(operation < OPERATION_COUNT);
+
+	Counters&      counters = m_counters[operation];
+	const LONGLONG duration = static_cast<LONGLONG>(microseconds);
+
+	::InterlockedIncrement64(&counters.m_count);
+	::InterlockedExchangeAdd64(&counters.m_totalMicroseconds, duration);
+	::InterlockedIncrement64(&counters.m_buckets[bucketIndex(microseconds)]);
+
+	if (bytes != 0)
+		::InterlockedExchangeAdd64(&counters.m_bytes, static_cast<LONGLONG>(bytes));
+
+	if (objects != 0)
+		::InterlockedExchangeAdd64(&counters.m_objects, static_cast<LONGLONG>(objects));
+
+	LONGLONG max = counters.m_maxMicroseconds;
+
+	while (duration > max)
+	{
+		const LONGLONG previous = ::InterlockedCompareExchange64(&counters.m_maxMicroseconds, duration, max);
+
+		if (previous == max)
+			break;
+
+		max = previous;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Record an event.
+
+void ConnectionStats::recordEvent(Event event)
+{
+	ASSERT(event < EVENT_COUNT);
+
+	::InterlockedIncrement64(&m_events[event]);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Take a copy of the statistics. Each counter is read atomically but calls
+//! made during the copy may be partially included.
+
+void ConnectionStats::snapshot(Snapshot& snapshot) const
+{
+	copy(snapshot, false);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Take a copy of the statistics and reset them in the same pass so that no
+//! calls are lost between consecutive snapshots.
+
+void ConnectionStats::snapshotAndReset(Snapshot& snapshot)
+{
+	copy(snapshot, true);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Reset the statistics.
+
+void ConnectionStats::reset()
+{
+	Snapshot discarded;
+
+	copy(discarded, true);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the display name of an operation.
+
+const tchar* ConnectionStats::operationName(Operation operation)
+{
+	switch (operation)
+	{
+		case CONNECT_SERVER:	return TXT("ConnectServer");
+		case GET_OBJECT:		return TXT("GetObject");
+		case EXEC_QUERY:		return TXT("ExecQuery");
+		case ENUM_NEXT:			return TXT("Next");
+		case GET_PROPERTY:		return TXT("Get");
+		case EXEC_METHOD:		return TXT("ExecMethod");
+		case LIMITER_WAIT:		return TXT("LimiterWait");
+		case OPERATION_COUNT:	break;
+	}
+
+	ASSERT_FALSE();
+	return TXT("");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the display name of an event.
+
+const tchar* ConnectionStats::eventName(Event event)
+{
+	switch (event)
+	{
+		case RETRY:			return TXT("Retry");
+		case RECONNECT:		return TXT("Reconnect");
+		case EVENT_COUNT:	break;
+	}
+
+	ASSERT_FALSE();
+	return TXT("");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the bucket for a latency. Latencies below the number of sub-buckets
+//! have a bucket each, after which each power of two has 4 buckets.
+
+size_t ConnectionStats::bucketIndex(uint64 microseconds)
+{
+	if (microseconds < SUB_BUCKETS)
+		return static_cast<size_t>(microseconds);
+
+	size_t power = 0;
+
+	for (uint64 value = microseconds; value > 1; value >>= 1)
+		++power;
+
+	if (power > MAX_POWER)
+		return BUCKET_COUNT - 1;
+
+	const size_t subBucket = static_cast<size_t>(microseconds >> (power - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1);
+
+	return ((power - 1) * SUB_BUCKETS) + subBucket;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the smallest latency held by a bucket.
+
+uint64 ConnectionStats::bucketLowerBound(size_t bucket)
+{
+	ASSERT(bucket < BUCKET_COUNT);
+
+	if (bucket < SUB_BUCKETS)
+		return bucket;
+
+	const size_t power = (bucket / SUB_BUCKETS) + 1;
+	const size_t subBucket = bucket % SUB_BUCKETS;
+
+	return static_cast<uint64>(SUB_BUCKETS + subBucket) << (power - SUB_BUCKET_BITS);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the largest latency held by a bucket.
+
+uint64 ConnectionStats::bucketUpperBound(size_t bucket)
+{
+	ASSERT(bucket < BUCKET_COUNT);
+
+	if (bucket == (BUCKET_COUNT - 1))
+		return static_cast<uint64>(-1);
+
+	return bucketLowerBound(bucket + 1) - 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Estimate a latency percentile, from 0.0 to 100.0, from a snapshot. The
+//! result is the upper bound of the bucket, capped at the maximum latency.
+
+uint64 ConnectionStats::percentile(const OperationStats& stats, double percent)
+{
+	if (stats.m_count == 0)
+		return 0;
+
+	const double ratio = (percent < 0.0) ? 0.0 : (percent > 100.0) ? 1.0 : (percent / 100.0);
+	uint64       target = static_cast<uint64>(ceil(ratio * static_cast<double>(stats.m_count)));
+	uint64       total = 0;
+
+	if (target == 0)
+		target = 1;
+
+	for (size_t i = 0; i != BUCKET_COUNT; ++i)
+	{
+		total += stats.m_buckets[i];
+
+		if (total >= target)
+		{
+			const uint64 upper = bucketUpperBound(i);
+
+			return (upper < stats.m_maxMicroseconds) ? upper : stats.m_maxMicroseconds;
+		}
+	}
+
+	return stats.m_maxMicroseconds;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the mean latency from a snapshot.
+
+double ConnectionStats::mean(const OperationStats& stats)
+{
+	if (stats.m_count == 0)
+		return 0.0;
+
+	return static_cast<double>(stats.m_totalMicroseconds) / static_cast<double>(stats.m_count);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the mean number of objects returned per call from a snapshot. For
+//! ENUM_NEXT this is the mean batch size.
+
+double ConnectionStats::meanObjects(const OperationStats& stats)
+{
+	if (stats.m_count == 0)
+		return 0.0;
+
+	return static_cast<double>(stats.m_objects) / static_cast<double>(stats.m_count);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Copy, and optionally reset, the statistics.
+
+void ConnectionStats::copy(Snapshot& snapshot, bool reset) const
+{
+	Counters* counters = const_cast<Counters*>(m_counters);
+
+	for (size_t op = 0; op != OPERATION_COUNT; ++op)
+	{
+		OperationStats& stats = snapshot.m_operations[op];
+
+		stats.m_count             = readCounter(counters[op].m_count, reset);
+		stats.m_totalMicroseconds = readCounter(counters[op].m_totalMicroseconds, reset);
+		stats.m_maxMicroseconds   = readCounter(counters[op].m_maxMicroseconds, reset);
+		stats.m_bytes             = readCounter(counters[op].m_bytes, reset);
+		stats.m_objects           = readCounter(counters[op].m_objects, reset);
+
+		for (size_t i = 0; i != BUCKET_COUNT; ++i)
+			stats.m_buckets[i] = readCounter(counters[op].m_buckets[i], reset);
+	}
+
+	volatile LONGLONG* events = const_cast<volatile LONGLONG*>(m_events);
+
+	for (size_t event = 0; event != EVENT_COUNT; ++event)
+		snapshot.m_events[event] = readCounter(events[event], reset);
+}
+
+//namespace WMI
+}
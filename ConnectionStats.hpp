@@ -0,0 +1,225 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   ConnectionStats.hpp
+//! \brief  The ConnectionStats class declaration.
+//! \author Chris Oldwood
+
+// Check for previous inclusion
+#ifndef WMI_CONNECTIONSTATS_HPP
+#define WMI_CONNECTIONSTATS_HPP
+
+#if _MSC_VER > 1000
+#pragma once
+#endif
+
+#include "Stopwatch.hpp"
+#include <Core/NotCopyable.hpp>
+#include <Core/SharedPtr.hpp>
+
+namespace WMI
+{
+
+////////////////////////////////////////////////////////////////////////////////
+//! The call counts and latency histograms for the operations made through a
+//! connection. The counters are updated with interlocked operations so that a
+//! single instance can be shared by connections used on different threads.
+//!
+//! The latencies are held in microseconds in log-linear buckets, in the style
+//! of an HDR histogram, where each power of two is split into 4 linear
+//! sub-buckets. This bounds the relative error of a percentile to 25% with a
+//! small, fixed amount of memory.
+
+class ConnectionStats : private Core::NotCopyable
+{
+public:
+	//! The instrumented operations.
+	enum Operation
+	{
+		CONNECT_SERVER,		//!< IWbemLocator::ConnectServer().
+		GET_OBJECT,			//!< IWbemServices::GetObject().
+		EXEC_QUERY,			//!< IWbemServices::ExecQuery().
+		ENUM_NEXT,			//!< IEnumWbemClassObject::Next().
+		GET_PROPERTY,		//!< IWbemClassObject::Get().
+		EXEC_METHOD,		//!< IWbemServices::ExecMethod().
+		LIMITER_WAIT,		//!< The wait for a HostLimiter slot.
+
+		OPERATION_COUNT		//!< The number of operations.
+	};
+
+	//! The counted recovery events.
+	enum Event
+	{
+		RETRY,				//!< A call was retried after a transient failure.
+		RECONNECT,			//!< The connection was re-opened after being lost.
+
+		EVENT_COUNT			//!< The number of events.
+	};
+
+	//! The number of linear sub-buckets per power of two.
+	static const size_t SUB_BUCKETS = 4;
+	//! The number of latency buckets. The last covers all latencies above ~2^39us.
+	static const size_t BUCKET_COUNT = 156;
+
+	//! The statistics for a single operation.
+	struct OperationStats
+	{
+		uint64	m_count;				//!< The number of calls.
+		uint64	m_totalMicroseconds;	//!< The total duration of the calls.
+		uint64	m_maxMicroseconds;		//!< The duration of the slowest call.
+		uint64	m_bytes;				//!< The amount of string data returned.
+		uint64	m_objects;				//!< The number of objects returned.
+		uint64	m_buckets[BUCKET_COUNT];//!< The latency histogram.
+	};
+
+	//! A copy of the statistics for all operations.
+	struct Snapshot
+	{
+		OperationStats	m_operations[OPERATION_COUNT];	//!< The statistics by operation.
+		uint64			m_events[EVENT_COUNT];			//!< The event counts.
+	};
+
+	//! Times an operation and records it when it goes out of scope. When no
+	//! statistics are being collected the timer costs a single branch.
+	class Timer : private Core::NotCopyable
+	{
+	public:
+		//! Start timing an operation, if statistics are being collected.
+		Timer(ConnectionStats* stats, Operation operation);
+
+		//! Stop timing and record the operation.
+		~Timer();
+
+		//! Set the amount of string data returned by the operation.
+		void setBytes(uint64 bytes);
+
+		//! Set the number of objects returned by the operation.
+		void setObjects(uint64 objects);
+
+	private:
+		ConnectionStats*	m_stats;		//!< The statistics, if being collected.
+		Operation			m_operation;	//!< The operation being timed.
+		int64				m_start;		//!< The counter value at the start.
+		uint64				m_bytes;		//!< The amount of string data returned.
+		uint64				m_objects;		//!< The number of objects returned.
+	};
+
+public:
+	//! Default constructor.
+	ConnectionStats();
+
+	//! Destructor.
+	~ConnectionStats();
+
+	//
+	// Methods.
+	//
+
+	//! Record a call to an operation.
+	void record(Operation operation, uint64 microseconds, uint64 bytes = 0, uint64 objects = 0);
+
+	//! Record an event.
+	void recordEvent(Event event);
+
+	//! Take a copy of the statistics.
+	void snapshot(Snapshot& snapshot) const;
+
+	//! Take a copy of the statistics and reset them in the same pass.
+	void snapshotAndReset(Snapshot& snapshot);
+
+	//! Reset the statistics.
+	void reset();
+
+	//
+	// Class methods.
+	//
+
+	//! Get the display name of an operation.
+	static const tchar* operationName(Operation operation);
+
+	//! Get the display name of an event.
+	static const tchar* eventName(Event event);
+
+	//! Get the bucket for a latency.
+	static size_t bucketIndex(uint64 microseconds);
+
+	//! Get the smallest latency held by a bucket.
+	static uint64 bucketLowerBound(size_t bucket);
+
+	//! Get the largest latency held by a bucket.
+	static uint64 bucketUpperBound(size_t bucket);
+
+	//! Estimate a latency percentile, from 0.0 to 100.0, from a snapshot.
+	static uint64 percentile(const OperationStats& stats, double percent);
+
+	//! Get the mean latency from a snapshot.
+	static double mean(const OperationStats& stats);
+
+	//! Get the mean number of objects returned per call from a snapshot.
+	static double meanObjects(const OperationStats& stats);
+
+private:
+	//! The counters for a single operation.
+	struct Counters
+	{
+		volatile LONGLONG	m_count;					//!< The number of calls.
+		volatile LONGLONG	m_totalMicroseconds;		//!< The total duration of the calls.
+		volatile LONGLONG	m_maxMicroseconds;			//!< The duration of the slowest call.
+		volatile LONGLONG	m_bytes;					//!< The amount of string data returned.
+		volatile LONGLONG	m_objects;					//!< The number of objects returned.
+		volatile LONGLONG	m_buckets[BUCKET_COUNT];	//!< The latency histogram.
+	};
+
+	//
+	// Members.
+	//
+	Counters			m_counters[OPERATION_COUNT];	//!< The counters by operation.
+	volatile LONGLONG	m_events[EVENT_COUNT];			//!< The event counts.
+
+	//! Copy, and optionally reset, the statistics.
+	void copy(Snapshot& snapshot, bool reset) const;
+};
+
+//! The default ConnectionStats smart-pointer type.
+typedef Core::SharedPtr<ConnectionStats> ConnectionStatsPtr;
+
+////////////////////////////////////////////////////////////////////////////////
+//! Start timing an operation, if statistics are being collected.
+
+inline ConnectionStats::Timer::Timer(ConnectionStats* stats, Operation operation)
+	: m_stats(stats)
+	, m_operation(operation)
+	, m_start((stats != nullptr) ? Stopwatch::ticks() : 0)
+	, m_bytes(0)
+	, m_objects(0)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Stop timing and record the operation. Failed calls are recorded too.
+
+inline ConnectionStats::Timer::~Timer()
+{
+	if (m_stats != nullptr)
+		m_stats->record(m_operation, Stopwatch::ticksToMicroseconds(Stopwatch::ticks() - m_start), m_bytes, m_objects);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Set the amount of string data returned by the operation.
+
+inline void ConnectionStats::Timer::setBytes(uint64 bytes)
+{
+	m_bytes = bytes;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Set the number of objects returned by the operation, e.g. the batch size of
+//! an enumeration.
+
+inline void ConnectionStats::Timer::setObjects(uint64 objects)
+{
+	m_objects = objects;
+}
+
+//namespace WMI
+}
+
+#endif // WMI_CONNECTIONSTATS_HPP
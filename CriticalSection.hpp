@@ -0,0 +1,146 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   CriticalSection.hpp
+//! \brief  The CriticalSection class declaration.
+//! \author Chris Oldwood
+
+// Check for previous inclusion
+#ifndef WMI_CRITICALSECTION_HPP
+#define WMI_CRITICALSECTION_HPP
+
+#if _MSC_VER > 1000
+#pragma once
+#endif
+
+#include <Core/NotCopyable.hpp>
+
+namespace WMI
+{
+
+////////////////////////////////////////////////////////////////////////////////
+//! A wrapper around a Win32 critical section, used to guard state that is
+//! shared between threads.
+
+class CriticalSection : private Core::NotCopyable
+{
+public:
+	//! Default constructor.
+	CriticalSection();
+
+	//! Destructor.
+	~CriticalSection();
+
+	//
+	// Methods.
+	//
+
+	//! Acquire the lock.
+	void enter();
+
+	//! Release the lock.
+	void leave();
+
+	//! Acquires the lock for the lifetime of the object.
+	class Lock : private Core::NotCopyable
+	{
+	public:
+		//! Acquire the lock.
+		explicit Lock(CriticalSection& section);
+
+		//! Release the lock.
+		~Lock();
+
+	private:
+		CriticalSection&	m_section;	//!< The lock held.
+	};
+
+	//! Releases a held lock for the lifetime of the object.
+	class Unlock : private Core::NotCopyable
+	{
+	public:
+		//! Release the lock.
+		explicit Unlock(CriticalSection& section);
+
+		//! Re-acquire the lock.
+		~Unlock();
+
+	private:
+		CriticalSection&	m_section;	//!< The lock released.
+	};
+
+private:
+	//
+	// Members.
+	//
+	CRITICAL_SECTION	m_section;	//!< The underlying critical section.
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//! Default constructor.
+
+inline CriticalSection::CriticalSection()
+{
+	::InitializeCriticalSection(&m_section);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Destructor.
+
+inline CriticalSection::~CriticalSection()
+{
+	::DeleteCriticalSection(&m_section);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Acquire the lock.
+
+inline void CriticalSection::enter()
+{
+	::EnterCriticalSection(&m_section);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Release the lock.
+
+inline void CriticalSection::leave()
+{
+	::LeaveCriticalSection(&m_section);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Acquire the lock.
+
+inline CriticalSection::Lock::Lock(CriticalSection& section)
+	: m_section(section)
+{
+	m_section.enter();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Release the lock.
+
+inline CriticalSection::Lock::~Lock()
+{
+	m_section.leave();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Release the lock.
+
+inline CriticalSection::Unlock::Unlock(CriticalSection& section)
+	: m_section(section)
+{
+	m_section.leave();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Re-acquire the lock.
+
+inline CriticalSection::Unlock::~Unlock()
+{
+	m_section.enter();
+}
+
+//namespace WMI
+}
+
+#endif // WMI_CRITICALSECTION_HPP
@@ -112,5 +112,52 @@ CDateTime parseDateTime(const tstring& value)
 	return datetime;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+//! Read a number from a fixed number of digits.
+
+static bool readDigits(const tstring& value, size_t offset, size_t count, WORD& number)
+{
+	uint result = 0;
+
+	for (size_t i = offset; i != offset + count; ++i)
+	{
+		if ( (value[i] < TXT('0')) || (value[i] > TXT('9')) )
+			return false;
+
+		result = (result * 10) + (value[i] - TXT('0'));
+	}
+
+	number = static_cast<WORD>(result);
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Try and convert a WMI datetime, e.g. 20010203040506.123456+060, into a
+//! FILETIME, in 100ns units, keeping the microseconds. The UTC offset is
+//! ignored, which suits comparing the times of the objects on a single host.
+
+bool tryParseFileTime(const tstring& value, uint64& fileTime)
+{
+	SYSTEMTIME time = { 0, 0, 0, 0, 0, 0, 0, 0 };
+	WORD       microseconds[2] = { 0 };
+
+	if ( (value.length() < 21) || (value[14] != TXT('.'))
+	  || !readDigits(value, 0, 4, time.wYear) || !readDigits(value, 4, 2, time.wMonth)
+	  || !readDigits(value, 6, 2, time.wDay) || !readDigits(value, 8, 2, time.wHour)
+	  || !readDigits(value, 10, 2, time.wMinute) || !readDigits(value, 12, 2, time.wSecond)
+	  || !readDigits(value, 15, 3, microseconds[0]) || !readDigits(value, 18, 3, microseconds[1]) )
+		return false;
+
+	FILETIME result;
+
+	if (!::SystemTimeToFileTime(&time, &result))
+		return false;
+
+	const uint64 units = (static_cast<uint64>(result.dwHighDateTime) << 32) | result.dwLowDateTime;
+
+	fileTime = units + ((static_cast<uint64>(microseconds[0]) * 1000) + microseconds[1]) * 10;
+	return true;
+}
+
 //namespace WMI
 }
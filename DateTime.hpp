@@ -28,6 +28,12 @@ bool tryParseDateTime(const tstring& value, CDateTime& datetime, tstring& offset
 
 CDateTime parseDateTime(const tstring& value); // throws(Core::ParseException)
 
+////////////////////////////////////////////////////////////////////////////////
+// Try and convert a WMI datetime into a FILETIME, in 100ns units, keeping the
+// microseconds. The UTC offset is ignored.
+
+bool tryParseFileTime(const tstring& value, uint64& fileTime);
+
 //namespace WMI
 }
 
@@ -0,0 +1,86 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   Deadline.cpp
+//! \brief  The Deadline class definition.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include "Deadline.hpp"
+#include "Stopwatch.hpp"
+
+namespace WMI
+{
+
+////////////////////////////////////////////////////////////////////////////////
+//! Default constructor. Creates a deadline that never expires.
+
+Deadline::Deadline()
+	: m_expiry(0)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Query if the deadline never expires.
+
+bool Deadline::isInfinite() const
+{
+	return (m_expiry == 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Query if the deadline has passed.
+
+bool Deadline::hasExpired() const
+{
+	if (isInfinite())
+		return false;
+
+	return (Stopwatch::ticks() >= m_expiry);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the number of milliseconds remaining, rounded up, or WBEM_INFINITE if
+//! the deadline never expires. This is in the form expected by the timeout
+//! parameter of the WMI enumerator methods.
+
+long Deadline::remaining() const
+{
+	if (isInfinite())
+		return WBEM_INFINITE;
+
+	const int64 now = Stopwatch::ticks();
+
+	if (now >= m_expiry)
+		return 0;
+
+	const uint64 microseconds = Stopwatch::ticksToMicroseconds(m_expiry - now);
+	const uint64 milliseconds = (microseconds + 999) / 1000;
+
+	return (milliseconds < 0x7FFFFFFF) ? static_cast<long>(milliseconds) : 0x7FFFFFFF;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Create a deadline that expires a number of milliseconds from now.
+
+Deadline Deadline::after(uint milliseconds)
+{
+	Deadline deadline;
+
+	deadline.m_expiry = Stopwatch::ticks() + Stopwatch::microsecondsToTicks(static_cast<uint64>(milliseconds) * 1000);
+
+	// Avoid the value used for an infinite deadline.
+	if (deadline.m_expiry == 0)
+		deadline.m_expiry = 1;
+
+	return deadline;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Create a deadline that never expires.
+
+Deadline Deadline::infinite()
+{
+	return Deadline();
+}
+
+//namespace WMI
+}
@@ -0,0 +1,61 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   Deadline.hpp
+//! \brief  The Deadline class declaration.
+//! \author Chris Oldwood
+
+// Check for previous inclusion
+#ifndef WMI_DEADLINE_HPP
+#define WMI_DEADLINE_HPP
+
+#if _MSC_VER > 1000
+#pragma once
+#endif
+
+namespace WMI
+{
+
+////////////////////////////////////////////////////////////////////////////////
+//! The point in time by which an operation must complete. A default deadline
+//! never expires. Deadlines are absolute so that they can be passed down
+//! through a sequence of calls, each of which is given the time remaining.
+
+class Deadline
+{
+public:
+	//! Default constructor. Creates a deadline that never expires.
+	Deadline();
+
+	//
+	// Properties.
+	//
+
+	//! Query if the deadline never expires.
+	bool isInfinite() const;
+
+	//! Query if the deadline has passed.
+	bool hasExpired() const;
+
+	//! Get the number of milliseconds remaining, or WBEM_INFINITE.
+	long remaining() const;
+
+	//
+	// Class methods.
+	//
+
+	//! Create a deadline that expires a number of milliseconds from now.
+	static Deadline after(uint milliseconds);
+
+	//! Create a deadline that never expires.
+	static Deadline infinite();
+
+private:
+	//
+	// Members.
+	//
+	int64	m_expiry;	//!< The counter value at expiry, or 0 if infinite.
+};
+
+//namespace WMI
+}
+
+#endif // WMI_DEADLINE_HPP
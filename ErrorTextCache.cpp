@@ -0,0 +1,99 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   ErrorTextCache.cpp
+//! \brief  The ErrorTextCache class definition.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include "ErrorTextCache.hpp"
+#include "CriticalSection.hpp"
+#include <WCL/ComPtr.hpp>
+#include <WCL/ComStr.hpp>
+#include <wbemidl.h>
+#include <WCL/StrCvt.hpp>
+#include <Core/StringUtils.hpp>
+#include <map>
+
+#ifndef _MSC_VER
+WCL_DECLARE_IFACETRAITS(IWbemStatusCodeText, IID_IWbemStatusCodeText);
+#endif
+
+namespace WMI
+{
+
+//! The map of HRESULT to error text.
+typedef std::map<HRESULT, tstring> ErrorTexts;
+
+//! The lock guarding the cache.
+static CriticalSection s_lock;
+//! The cached error text.
+static ErrorTexts s_errorTexts;
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the text for an HRESULT, formatting it on first use. The text is
+//! formatted outside the lock so that a slow lookup does not block other
+//! threads; if two threads race, the first result is kept.
+
+tstring ErrorTextCache::lookup(HRESULT result)
+{
+	{
+		CriticalSection::Lock lock(s_lock);
+
+		ErrorTexts::const_iterator it = s_errorTexts.find(result);
+
+		if (it != s_errorTexts.end())
+			return it->second;
+	}
+
+	const tstring text = format(result);
+
+	CriticalSection::Lock lock(s_lock);
+
+	if (s_errorTexts.size() < MAX_ENTRIES)
+		s_errorTexts.insert(ErrorTexts::value_type(result, text));
+
+	return text;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the number of cached entries.
+
+size_t ErrorTextCache::size()
+{
+	CriticalSection::Lock lock(s_lock);
+
+	return s_errorTexts.size();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Discard all cached entries.
+
+void ErrorTextCache::clear()
+{
+	CriticalSection::Lock lock(s_lock);
+
+	s_errorTexts.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Format the text for an HRESULT, using the WMI specific text if available.
+
+tstring ErrorTextCache::format(HRESULT error)
+{
+	typedef WCL::ComPtr<IWbemStatusCodeText> IWbemStatusCodeTextPtr;
+
+	WCL::ComStr text;
+
+	// Use the WMI error lookup first.
+	IWbemStatusCodeTextPtr converter(CLSID_WbemStatusCodeText);
+
+	HRESULT result = converter->GetErrorCodeText(error, 0, 0, AttachTo(text));
+
+	if (SUCCEEDED(result))
+		return Core::trimCopy(W2T(text.Get()));
+
+	// Fall-back to using the standard error formatter.
+	return tstring(CStrCvt::FormatError(error));
+}
+
+//namespace WMI
+}
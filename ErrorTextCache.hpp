@@ -0,0 +1,54 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   ErrorTextCache.hpp
+//! \brief  The ErrorTextCache class declaration.
+//! \author Chris Oldwood
+
+// Check for previous inclusion
+#ifndef WMI_ERRORTEXTCACHE_HPP
+#define WMI_ERRORTEXTCACHE_HPP
+
+#if _MSC_VER > 1000
+#pragma once
+#endif
+
+namespace WMI
+{
+
+////////////////////////////////////////////////////////////////////////////////
+//! A process-wide cache of the text for HRESULT values. The WMI text is looked
+//! up via the IWbemStatusCodeText COM object, which is expensive to create, so
+//! the text for each HRESULT is only formatted once. The cache is bounded and
+//! any error seen once it is full is formatted each time instead.
+
+class ErrorTextCache
+{
+public:
+	//
+	// Class methods.
+	//
+
+	//! Get the text for an HRESULT, formatting it on first use.
+	static tstring lookup(HRESULT result); // throw(WCL::ComException)
+
+	//! Get the number of cached entries.
+	static size_t size();
+
+	//! Discard all cached entries.
+	static void clear();
+
+	//
+	// Constants.
+	//
+
+	//! The maximum number of cached entries.
+	static const size_t MAX_ENTRIES = 1024;
+
+private:
+	//! Format the text for an HRESULT.
+	static tstring format(HRESULT error); // throw(WCL::ComException)
+};
+
+//namespace WMI
+}
+
+#endif // WMI_ERRORTEXTCACHE_HPP
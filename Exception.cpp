@@ -5,16 +5,10 @@
 
 #include "Common.hpp"
 #include "Exception.hpp"
-#include <WCL/ComPtr.hpp>
-#include <WCL/ComStr.hpp>
-#include <wbemidl.h>
+#include "ErrorTextCache.hpp"
 #include <WCL/StrCvt.hpp>
 #include <Core/StringUtils.hpp>
 
-#ifndef _MSC_VER
-WCL_DECLARE_IFACETRAITS(IWbemStatusCodeText, IID_IWbemStatusCodeText);
-#endif
-
 namespace WMI
 {
 
@@ -35,11 +29,12 @@ Exception::~Exception() throw()
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-//! Format the error using the WMI or IErrorInfo details.
+//! Format the error using the WMI or IErrorInfo details. The error text is
+//! cached by HRESULT as the lookup dominates the cost of construction.
 
 void Exception::formatError(HRESULT result, IUnknown* object, const IID& iid, const tchar* operation)
 {
-	tstring wmiText(formatWmiError(result));
+	tstring wmiText(ErrorTextCache::lookup(result));
 
 	if (!wmiText.empty())
 	{
@@ -63,26 +58,5 @@ void Exception::formatError(HRESULT result, IUnknown* object, const IID& iid, co
 	}
 }
 
-////////////////////////////////////////////////////////////////////////////////
-//! Format the WMI specific HRESULT error.
-
-tstring Exception::formatWmiError(HRESULT error)
-{
-	typedef WCL::ComPtr<IWbemStatusCodeText> IWbemStatusCodeTextPtr;
-
-	WCL::ComStr text;
-
-	// Use the WMI error lookup first.
-	IWbemStatusCodeTextPtr converter(CLSID_WbemStatusCodeText);
-
-	HRESULT result = converter->GetErrorCodeText(error, 0, 0, AttachTo(text));
-
-	if (SUCCEEDED(result))
-		return Core::trimCopy(W2T(text.Get()));
-
-	// Fall-back to using the standard error formatter.
-	return tstring(CStrCvt::FormatError(error));
-}
-
 //namespace WMI
 }
@@ -39,9 +39,6 @@ private:
 
 	//! Format the error using the WMI or IErrorInfo details.
 	void formatError(HRESULT result, IUnknown* object, const IID& iid, const tchar* operation);
-
-	//! Format the WMI specific HRESULT error.
-	tstring formatWmiError(HRESULT error);
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,89 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   FileWriter.cpp
+//! \brief  The FileWriter class definition.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include "FileWriter.hpp"
+#include "Exception.hpp"
+#include <Core/StringUtils.hpp>
+#include <algorithm>
+
+namespace WMI
+{
+
+////////////////////////////////////////////////////////////////////////////////
+//! Create or truncate the file.
+
+FileWriter::FileWriter(const tstring& path, size_t bufferSize)
+	: BufferedWriter(bufferSize)
+	, m_path(path)
+	, m_file(INVALID_HANDLE_VALUE)
+{
+	m_file = ::CreateFile(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS,
+							FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+	if (m_file == INVALID_HANDLE_VALUE)
+	{
+		const tstring message = Core::fmt(TXT("Failed to create the file '%s'"), path.c_str());
+		throw Exception(HRESULT_FROM_WIN32(::GetLastError()), message.c_str());
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Destructor.
+
+FileWriter::~FileWriter()
+{
+	try
+	{
+		close();
+	}
+	catch (...)
+	{
+		if (m_file != INVALID_HANDLE_VALUE)
+			::CloseHandle(m_file);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Flush any buffered output and close the file.
+
+void FileWriter::close()
+{
+	if (m_file == INVALID_HANDLE_VALUE)
+		return;
+
+	flush();
+
+	::CloseHandle(m_file);
+	m_file = INVALID_HANDLE_VALUE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Write a block of output to the file.
+
+void FileWriter::writeBlock(const char* data, size_t length)
+{
+	ASSERT(isOpen());
+
+	const size_t MAX_CHUNK = 0x40000000;
+
+	while (length != 0)
+	{
+		const DWORD chunk = static_cast<DWORD>(std::min(length, MAX_CHUNK));
+		DWORD       written = 0;
+
+		if (!::WriteFile(m_file, data, chunk, &written, nullptr))
+		{
+			const tstring message = Core::fmt(TXT("Failed to write to the file '%s'"), m_path.c_str());
+			throw Exception(HRESULT_FROM_WIN32(::GetLastError()), message.c_str());
+		}
+
+		data   += written;
+		length -= written;
+	}
+}
+
+//namespace WMI
+}
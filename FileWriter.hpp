@@ -0,0 +1,72 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   FileWriter.hpp
+//! \brief  The FileWriter class declaration.
+//! \author Chris Oldwood
+
+// Check for previous inclusion
+#ifndef WMI_FILEWRITER_HPP
+#define WMI_FILEWRITER_HPP
+
+#if _MSC_VER > 1000
+#pragma once
+#endif
+
+#include "BufferedWriter.hpp"
+
+namespace WMI
+{
+
+////////////////////////////////////////////////////////////////////////////////
+//! A BufferedWriter that writes its output to a file.
+
+class FileWriter : public BufferedWriter
+{
+public:
+	//! Create or truncate the file.
+	FileWriter(const tstring& path, size_t bufferSize = DEFAULT_BUFFER_SIZE); // throw(WMI::Exception)
+
+	//! Destructor.
+	virtual ~FileWriter();
+
+	//
+	// Properties.
+	//
+
+	//! Query if the file is open.
+	bool isOpen() const;
+
+	//
+	// Methods.
+	//
+
+	//! Flush any buffered output and close the file.
+	void close(); // throw(WMI::Exception)
+
+protected:
+	//
+	// Internal methods.
+	//
+
+	//! Write a block of output to the file.
+	virtual void writeBlock(const char* data, size_t length); // throw(WMI::Exception)
+
+private:
+	//
+	// Members.
+	//
+	tstring	m_path;		//!< The path to the file.
+	HANDLE	m_file;		//!< The file handle.
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//! Query if the file is open.
+
+inline bool FileWriter::isOpen() const
+{
+	return (m_file != INVALID_HANDLE_VALUE);
+}
+
+//namespace WMI
+}
+
+#endif // WMI_FILEWRITER_HPP
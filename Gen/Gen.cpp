@@ -0,0 +1,156 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   Gen.cpp
+//! \brief  The typed wrapper code generator entry point.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include <tchar.h>
+#include <Core/Exception.hpp>
+#include <WCL/AutoCom.hpp>
+#include <WMI/Connection.hpp>
+#include <WMI/Object.hpp>
+#include <WMI/TypedObjectGenerator.hpp>
+#include <WMI/FileWriter.hpp>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+//! The command line settings.
+
+struct Settings
+{
+	//! A collection of strings.
+	typedef std::vector<tstring> Strings;
+
+	tstring	m_host;			//!< The host to read the class from.
+	tstring	m_namespace;	//!< The namespace of the class.
+	tstring	m_class;		//!< The class to generate.
+	tstring	m_output;		//!< The folder to write the files to.
+	Strings	m_defaults;		//!< The method argument defaults, as Method.Parameter=Value.
+
+	//! Default constructor.
+	Settings()
+		: m_host(TXT("."))
+		, m_namespace(TXT("root\\cimv2"))
+		, m_class()
+		, m_output(TXT("."))
+		, m_defaults()
+	{
+	}
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//! Display the command line usage.
+
+static void showUsage()
+{
+	_tprintf(TXT("USAGE: Gen --class <name> [--host <name>] [--namespace <name>] [--output <folder>]\n"));
+	_tprintf(TXT("           [--default <method>.<parameter>=<value> ...]\n"));
+	_tprintf(TXT("\n"));
+	_tprintf(TXT("--class      The WMI class to generate the wrapper for\n"));
+	_tprintf(TXT("--host       The host to read the class definition from (default: .)\n"));
+	_tprintf(TXT("--namespace  The namespace of the class (default: root\\cimv2)\n"));
+	_tprintf(TXT("--output     The folder to write the .hpp and .cpp files to (default: .)\n"));
+	_tprintf(TXT("--default    The default value of a trailing method argument, e.g. Terminate.Reason=0\n"));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Parse the command line into the settings. Returns false if invalid.
+
+static bool parseCmdLine(int argc, _TCHAR* argv[], Settings& settings)
+{
+	for (int i = 1; i < argc; i += 2)
+	{
+		const tstring option = argv[i];
+
+		if (i+1 == argc)
+			return false;
+
+		const tstring value = argv[i+1];
+
+		if (option == TXT("--class"))
+			settings.m_class = value;
+		else if (option == TXT("--host"))
+			settings.m_host = value;
+		else if (option == TXT("--namespace"))
+			settings.m_namespace = value;
+		else if (option == TXT("--output"))
+			settings.m_output = value;
+		else if (option == TXT("--default"))
+			settings.m_defaults.push_back(value);
+		else
+			return false;
+	}
+
+	return !settings.m_class.empty();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Apply the method argument defaults, each in the form Method.Parameter=Value,
+//! to the generator. Returns false if one is malformed or does not match.
+
+static bool applyDefaults(const Settings& settings, WMI::TypedObjectGenerator& generator)
+{
+	for (Settings::Strings::const_iterator it = settings.m_defaults.begin(); it != settings.m_defaults.end(); ++it)
+	{
+		const size_t dot = it->find(TXT('.'));
+		const size_t equals = it->find(TXT('='));
+
+		if ( (dot == tstring::npos) || (equals == tstring::npos) || (equals < dot)
+		  || !generator.setDefaultArgument(it->substr(0, dot), it->substr(dot+1, equals-dot-1), it->substr(equals+1)) )
+		{
+			_tprintf(TXT("ERROR: Invalid argument default '%s'\n"), it->c_str());
+			return false;
+		}
+	}
+
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Write the generated source to a file.
+
+static void writeFile(const tstring& path, const tstring& source)
+{
+	WMI::FileWriter writer(path);
+
+	writer.write(source.c_str(), source.length());
+	writer.close();
+
+	_tprintf(TXT("Generated %s\n"), path.c_str());
+}
+
+int _tmain(int argc, _TCHAR* argv[])
+{
+	try
+	{
+		Settings settings;
+
+		if (!parseCmdLine(argc, argv, settings))
+		{
+			showUsage();
+			return EXIT_FAILURE;
+		}
+
+		WCL::AutoCom    com(COINIT_APARTMENTTHREADED);
+		WMI::Connection connection;
+
+		connection.open(settings.m_host, TXT(""), TXT(""), settings.m_namespace);
+
+		const WMI::Object         definition = connection.getObject(settings.m_class);
+		WMI::TypedObjectGenerator generator(definition.get());
+		const tstring             path = settings.m_output + TXT("\\") + generator.className();
+
+		if (!applyDefaults(settings, generator))
+			return EXIT_FAILURE;
+
+		writeFile(path + TXT(".hpp"), generator.generateHeader());
+		writeFile(path + TXT(".cpp"), generator.generateSource());
+	}
+	catch (const Core::Exception& e)
+	{
+		_tprintf(TXT("ERROR: %s\n"), e.twhat());
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
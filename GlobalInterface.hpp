@@ -0,0 +1,83 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   GlobalInterface.hpp
+//! \brief  The GlobalInterface class declaration.
+//! \author Chris Oldwood
+
+// Check for previous inclusion
+#ifndef WMI_GLOBALINTERFACE_HPP
+#define WMI_GLOBALINTERFACE_HPP
+
+#if _MSC_VER > 1000
+#pragma once
+#endif
+
+#include "GlobalInterfaceTable.hpp"
+#include <Core/NotCopyable.hpp>
+#include <WCL/ComPtr.hpp>
+
+namespace WMI
+{
+
+////////////////////////////////////////////////////////////////////////////////
+//! An interface registered in the Global Interface Table for the lifetime of
+//! the object, so that it can be retrieved on a thread in another apartment.
+
+template<typename T>
+class GlobalInterface : private Core::NotCopyable
+{
+public:
+	//! Construction from the interface to register.
+	explicit GlobalInterface(const WCL::ComPtr<T>& object); // throw(WMI::Exception)
+
+	//! Destructor.
+	~GlobalInterface();
+
+	//
+	// Methods.
+	//
+
+	//! Retrieve the interface for use in the calling apartment.
+	WCL::ComPtr<T> get() const; // throw(WMI::Exception)
+
+private:
+	//
+	// Members.
+	//
+	DWORD	m_cookie;	//!< The registration cookie.
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//! Construction from the interface to register.
+
+template<typename T>
+inline GlobalInterface<T>::GlobalInterface(const WCL::ComPtr<T>& object)
+	: m_cookie(GlobalInterfaceTable::registerInterface(object.get(), WCL::IFaceTraits<T>::uuidof()))
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Destructor.
+
+template<typename T>
+inline GlobalInterface<T>::~GlobalInterface()
+{
+	GlobalInterfaceTable::revokeInterface(m_cookie);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Retrieve the interface for use in the calling apartment.
+
+template<typename T>
+inline WCL::ComPtr<T> GlobalInterface<T>::get() const
+{
+	WCL::ComPtr<T> object;
+
+	GlobalInterfaceTable::getInterface(m_cookie, WCL::IFaceTraits<T>::uuidof(), reinterpret_cast<void**>(AttachTo(object)));
+
+	return object;
+}
+
+//namespace WMI
+}
+
+#endif // WMI_GLOBALINTERFACE_HPP
@@ -0,0 +1,74 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   GlobalInterfaceTable.cpp
+//! \brief  The GlobalInterfaceTable class definition.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include "GlobalInterfaceTable.hpp"
+#include "Exception.hpp"
+
+#ifndef _MSC_VER
+WCL_DECLARE_IFACETRAITS(IGlobalInterfaceTable, IID_IGlobalInterfaceTable);
+#endif
+
+namespace WMI
+{
+
+//! The Global Interface Table smart-pointer type.
+typedef WCL::ComPtr<IGlobalInterfaceTable> IGlobalInterfaceTablePtr;
+
+////////////////////////////////////////////////////////////////////////////////
+//! Register an interface and return the cookie used to retrieve it. The table
+//! holds a reference to the object until the interface is revoked.
+
+DWORD GlobalInterfaceTable::registerInterface(IUnknown* object, const IID& iid)
+{
+	ASSERT(object != nullptr);
+
+	IGlobalInterfaceTablePtr table(CLSID_StdGlobalInterfaceTable);
+	DWORD                    cookie = 0;
+
+	HRESULT result = table->RegisterInterfaceInGlobal(object, iid, &cookie);
+
+	if (FAILED(result))
+		throw Exception(result, TXT("Failed to register an interface in the Global Interface Table"));
+
+	return cookie;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Revoke a previously registered interface. This can be called from any
+//! apartment and, as it is used during cleanup, any failure is ignored.
+
+void GlobalInterfaceTable::revokeInterface(DWORD cookie)
+{
+	IGlobalInterfaceTable* table = nullptr;
+
+	HRESULT result = ::CoCreateInstance(CLSID_StdGlobalInterfaceTable, nullptr, CLSCTX_INPROC_SERVER,
+										IID_IGlobalInterfaceTable, reinterpret_cast<void**>(&table));
+
+	if (SUCCEEDED(result))
+	{
+		table->RevokeInterfaceFromGlobal(cookie);
+		table->Release();
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Retrieve a registered interface for use in the calling apartment. This is
+//! a proxy when the interface was registered in a different apartment.
+
+void GlobalInterfaceTable::getInterface(DWORD cookie, const IID& iid, void** object)
+{
+	ASSERT(object != nullptr);
+
+	IGlobalInterfaceTablePtr table(CLSID_StdGlobalInterfaceTable);
+
+	HRESULT result = table->GetInterfaceFromGlobal(cookie, iid, object);
+
+	if (FAILED(result))
+		throw Exception(result, TXT("Failed to retrieve an interface from the Global Interface Table"));
+}
+
+//namespace WMI
+}
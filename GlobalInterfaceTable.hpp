@@ -0,0 +1,42 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   GlobalInterfaceTable.hpp
+//! \brief  The GlobalInterfaceTable class declaration.
+//! \author Chris Oldwood
+
+// Check for previous inclusion
+#ifndef WMI_GLOBALINTERFACETABLE_HPP
+#define WMI_GLOBALINTERFACETABLE_HPP
+
+#if _MSC_VER > 1000
+#pragma once
+#endif
+
+namespace WMI
+{
+
+////////////////////////////////////////////////////////////////////////////////
+//! Access to the process-wide COM Global Interface Table, which holds the
+//! interfaces that need to be retrieved in a different apartment. Use the
+//! GlobalInterface class to manage the lifetime of a registration.
+
+class GlobalInterfaceTable
+{
+public:
+	//
+	// Class methods.
+	//
+
+	//! Register an interface and return the cookie used to retrieve it.
+	static DWORD registerInterface(IUnknown* object, const IID& iid); // throw(WMI::Exception)
+
+	//! Revoke a previously registered interface.
+	static void revokeInterface(DWORD cookie);
+
+	//! Retrieve a registered interface for use in the calling apartment.
+	static void getInterface(DWORD cookie, const IID& iid, void** object); // throw(WMI::Exception)
+};
+
+//namespace WMI
+}
+
+#endif // WMI_GLOBALINTERFACETABLE_HPP
@@ -0,0 +1,285 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   HashJoin.hpp
+//! \brief  The HashJoin class declaration.
+//! \author Chris Oldwood
+
+// Check for previous inclusion
+#ifndef WMI_HASHJOIN_HPP
+#define WMI_HASHJOIN_HPP
+
+#if _MSC_VER > 1000
+#pragma once
+#endif
+
+#include "Types.hpp"
+#include <Core/NotCopyable.hpp>
+#include <vector>
+
+namespace WMI
+{
+
+////////////////////////////////////////////////////////////////////////////////
+//! Hash an integer key by multiplying by the golden ratio and folding the high
+//! bits down, as IDs such as process IDs are often multiples of a power of 2.
+
+inline size_t hashJoinKey(uint64 key)
+{
+	const uint64 hash = key * 0x9E3779B97F4A7C15ULL;
+
+	return static_cast<size_t>(hash ^ (hash >> 32));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Hash a signed integer key.
+
+inline size_t hashJoinKey(int64 key)
+{
+	return hashJoinKey(static_cast<uint64>(key));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Hash a 32-bit integer key.
+
+inline size_t hashJoinKey(uint32 key)
+{
+	return hashJoinKey(static_cast<uint64>(key));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Hash a signed 32-bit integer key.
+
+inline size_t hashJoinKey(int32 key)
+{
+	return hashJoinKey(static_cast<uint64>(static_cast<uint32>(key)));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Hash an unsigned long key, such as a DWORD, which is a distinct type from
+//! both uint32 and uint64 and so would otherwise be ambiguous.
+
+inline size_t hashJoinKey(unsigned long key)
+{
+	return hashJoinKey(static_cast<uint64>(key));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Hash a signed long key. It is hashed as the unsigned value of the same width
+//! so that a 32-bit long hashes the same as the equivalent int32.
+
+inline size_t hashJoinKey(long key)
+{
+	return hashJoinKey(static_cast<uint64>(static_cast<unsigned long>(key)));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Hash a string key with FNV-1a.
+
+inline size_t hashJoinKey(const tstring& key)
+{
+	uint32 hash = 2166136261u;
+
+	for (tstring::const_iterator it = key.begin(); it != key.end(); ++it)
+	{
+		hash ^= static_cast<uint32>(*it);
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! An inner equi-join of two materialised query results, e.g. Win32_Service to
+//! Win32_Process on ProcessId, done locally instead of with a query per object
+//! or a nested loop over both results.
+//!
+//! The keys are read with a const member function of each row type, such as
+//! &Win32_Process::ProcessId, which is called once per row. A hash table is
+//! built over the smaller side and then probed with each row of the larger one.
+//! The table is a flat array of chain heads plus a parallel array of links to
+//! the next row with the same hash, so that it is allocated once per join and
+//! reused by later joins of a similar size. The key type needs an equality
+//! operator and a hashJoinKey() overload.
+//!
+//! The matches are returned as the positions of the joined rows, rather than
+//! copies of them, ordered by the position in the larger side and then in the
+//! smaller one.
+
+template<typename L, typename R, typename K>
+class HashJoin : private Core::NotCopyable
+{
+public:
+	//! The rows of the left side.
+	typedef std::vector<L> LeftRows;
+	//! The rows of the right side.
+	typedef std::vector<R> RightRows;
+	//! The function that reads the key of a left row.
+	typedef K (L::*LeftKey)() const;
+	//! The function that reads the key of a right row.
+	typedef K (R::*RightKey)() const;
+
+	//! A pair of rows with equal keys.
+	struct Match
+	{
+		size_t	m_left;		//!< The position of the left row.
+		size_t	m_right;	//!< The position of the right row.
+	};
+
+	//! The matching rows.
+	typedef std::vector<Match> Matches;
+
+public:
+	//! Construction with the functions that read the keys.
+	HashJoin(LeftKey leftKey, RightKey rightKey);
+
+	//
+	// Properties.
+	//
+
+	//! Get the number of rows the last hash table was built from.
+	size_t buildRows() const;
+
+	//
+	// Methods.
+	//
+
+	//! Join the rows with equal keys, returning the number of matches.
+	size_t join(const LeftRows& left, const RightRows& right, Matches& matches); // throw(WMI::Exception)
+
+private:
+	//! The positions of the rows in the hash table.
+	typedef std::vector<size_t> Positions;
+	//! The keys of the rows in the hash table.
+	typedef std::vector<K> Keys;
+
+	//
+	// Members.
+	//
+	LeftKey		m_leftKey;		//!< The function that reads the key of a left row.
+	RightKey	m_rightKey;		//!< The function that reads the key of a right row.
+	Positions	m_heads;		//!< The first row in each chain, or the number of rows.
+	Positions	m_links;		//!< The next row in the same chain, or the number of rows.
+	Keys		m_keys;			//!< The key of each row in the table.
+
+	//
+	// Internal methods.
+	//
+
+	//! Build the hash table over a set of rows.
+	template<typename T>
+	void build(const std::vector<T>& rows, K (T::*key)() const);
+
+	//! Probe the hash table with a set of rows, appending the matches.
+	template<typename T>
+	void probe(const std::vector<T>& rows, K (T::*key)() const, bool probeIsLeft, Matches& matches) const;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//! Construction with the functions that read the keys.
+
+template<typename L, typename R, typename K>
+inline HashJoin<L, R, K>::HashJoin(LeftKey leftKey, RightKey rightKey)
+	: m_leftKey(leftKey)
+	, m_rightKey(rightKey)
+	, m_heads()
+	, m_links()
+	, m_keys()
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the number of rows the last hash table was built from.
+
+template<typename L, typename R, typename K>
+inline size_t HashJoin<L, R, K>::buildRows() const
+{
+	return m_keys.size();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Join the rows with equal keys, building the hash table over the smaller
+//! side. The matches replace the contents of the collection.
+
+template<typename L, typename R, typename K>
+size_t HashJoin<L, R, K>::join(const LeftRows& left, const RightRows& right, Matches& matches)
+{
+	matches.clear();
+
+	if (left.size() <= right.size())
+	{
+		build(left, m_leftKey);
+		probe(right, m_rightKey, false, matches);
+	}
+	else
+	{
+		build(right, m_rightKey);
+		probe(left, m_leftKey, true, matches);
+	}
+
+	return matches.size();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Build the hash table over a set of rows. The rows are linked in reverse so
+//! that each chain is walked in the order of the rows.
+
+template<typename L, typename R, typename K>
+template<typename T>
+void HashJoin<L, R, K>::build(const std::vector<T>& rows, K (T::*key)() const)
+{
+	const size_t count = rows.size();
+	size_t       buckets = 16;
+
+	while (buckets < (count * 2))
+		buckets *= 2;
+
+	m_heads.assign(buckets, count);
+	m_links.assign(count, count);
+	m_keys.clear();
+	m_keys.reserve(count);
+
+	for (typename std::vector<T>::const_iterator it = rows.begin(); it != rows.end(); ++it)
+		m_keys.push_back(((*it).*key)());
+
+	for (size_t i = count; i != 0; --i)
+	{
+		const size_t row = i - 1;
+		size_t&      head = m_heads[hashJoinKey(m_keys[row]) & (buckets - 1)];
+
+		m_links[row] = head;
+		head = row;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Probe the hash table with a set of rows, appending the matches.
+
+template<typename L, typename R, typename K>
+template<typename T>
+void HashJoin<L, R, K>::probe(const std::vector<T>& rows, K (T::*key)() const, bool probeIsLeft, Matches& matches) const
+{
+	const size_t count = m_keys.size();
+	const size_t mask = m_heads.size() - 1;
+
+	for (size_t i = 0; i != rows.size(); ++i)
+	{
+		const K value = (rows[i].*key)();
+
+		for (size_t row = m_heads[hashJoinKey(value) & mask]; row != count; row = m_links[row])
+		{
+			if (!(m_keys[row] == value))
+				continue;
+
+			Match match;
+
+			match.m_left  = (probeIsLeft) ? i : row;
+			match.m_right = (probeIsLeft) ? row : i;
+
+			matches.push_back(match);
+		}
+	}
+}
+
+//namespace WMI
+}
+
+#endif // WMI_HASHJOIN_HPP
@@ -0,0 +1,280 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   HostLimiter.cpp
+//! \brief  The HostLimiter class definition.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include "HostLimiter.hpp"
+#include "Stopwatch.hpp"
+#include "Exception.hpp"
+#include <algorithm>
+
+namespace WMI
+{
+
+////////////////////////////////////////////////////////////////////////////////
+//! Wait for a slot, if there is a limiter, and record the time spent waiting.
+//! A permit that gives up at the deadline is recorded too.
+
+HostLimiter::Permit::Permit(HostLimiter* limiter, Call call, const Deadline& deadline, ConnectionStats* stats)
+	: m_limiter(limiter)
+	, m_acquired(true)
+{
+	if (m_limiter == nullptr)
+		return;
+
+	uint64 waited = 0;
+
+	m_acquired = m_limiter->acquire(call, deadline, waited);
+
+	if (stats != nullptr)
+		stats->record(ConnectionStats::LIMITER_WAIT, waited);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Release the slot.
+
+HostLimiter::Permit::~Permit()
+{
+	if ( (m_limiter != nullptr) && m_acquired )
+		m_limiter->release();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Construction with the number of slots, the number of requests that can be
+//! started per second, or UNLIMITED_RATE, and the most requests that can be
+//! started at once after an idle period. The bucket starts full.
+
+HostLimiter::HostLimiter(size_t maxConcurrent, uint rate, size_t burst)
+	: m_maxConcurrent(maxConcurrent)
+	, m_rate(rate)
+	, m_burst(burst)
+	, m_lock()
+	, m_inFlight(0)
+	, m_tokens(static_cast<double>(burst))
+	, m_refilled(Stopwatch::ticks())
+	, m_queue()
+	, m_maxQueueLength(0)
+	, m_queued(0)
+	, m_timedOut(0)
+{
+	ASSERT(maxConcurrent != 0);
+	ASSERT(burst != 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Destructor.
+
+HostLimiter::~HostLimiter()
+{
+	ASSERT(m_inFlight == 0);
+	ASSERT(m_queue.empty());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the number of calls in flight.
+
+size_t HostLimiter::inFlight() const
+{
+	CriticalSection::Lock lock(m_lock);
+
+	return m_inFlight;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the number of callers waiting.
+
+size_t HostLimiter::queueLength() const
+{
+	CriticalSection::Lock lock(m_lock);
+
+	return m_queue.size();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the most callers that have waited at once.
+
+size_t HostLimiter::maxQueueLength() const
+{
+	CriticalSection::Lock lock(m_lock);
+
+	return m_maxQueueLength;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the number of calls that had to wait.
+
+size_t HostLimiter::queued() const
+{
+	CriticalSection::Lock lock(m_lock);
+
+	return m_queued;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the number of calls that gave up waiting at their deadline.
+
+size_t HostLimiter::timedOut() const
+{
+	CriticalSection::Lock lock(m_lock);
+
+	return m_timedOut;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Wait for a slot, giving up at a deadline. A caller that cannot start at once
+//! joins the back of the queue with its own event and sleeps until it reaches
+//! the head and either a slot is released or the next token is due. Returns
+//! false if the deadline passed first. The time spent waiting is returned in
+//! either case. An exception is thrown if the caller's event cannot be created.
+
+bool HostLimiter::acquire(Call call, const Deadline& deadline, uint64& waitedMicroseconds)
+{
+	waitedMicroseconds = 0;
+
+	CriticalSection::Lock lock(m_lock);
+
+	refill();
+
+	if (m_queue.empty() && canStart(call))
+	{
+		start(call);
+		return true;
+	}
+
+	const int64 startTime = Stopwatch::ticks();
+	HANDLE      event = ::CreateEvent(nullptr, FALSE, FALSE, nullptr);
+
+	if (event == NULL)
+		throw Exception(HRESULT_FROM_WIN32(::GetLastError()), TXT("Failed to create the event for a queued call"));
+
+	m_queue.push_back(event);
+	m_maxQueueLength = std::max(m_maxQueueLength, m_queue.size());
+	++m_queued;
+
+	bool acquired = false;
+
+	for (;;)
+	{
+		const bool isHead = (m_queue.front() == event);
+
+		if (isHead && canStart(call))
+		{
+			start(call);
+			m_queue.pop_front();
+			wakeHead();
+			acquired = true;
+			break;
+		}
+
+		if (deadline.hasExpired())
+		{
+			m_queue.erase(std::find(m_queue.begin(), m_queue.end(), event));
+
+			if (isHead)
+				wakeHead();
+
+			++m_timedOut;
+			break;
+		}
+
+		DWORD timeout = (isHead) ? timeToStart(call) : INFINITE;
+
+		if (!deadline.isInfinite())
+			timeout = std::min(timeout, static_cast<DWORD>(deadline.remaining()));
+
+		{
+			CriticalSection::Unlock unlock(m_lock);
+
+			::WaitForSingleObject(event, timeout);
+		}
+
+		refill();
+	}
+
+	::CloseHandle(event);
+
+	waitedMicroseconds = Stopwatch::ticksToMicroseconds(Stopwatch::ticks() - startTime);
+
+	return acquired;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Release a slot, waking the caller at the head of the queue.
+
+void HostLimiter::release()
+{
+	CriticalSection::Lock lock(m_lock);
+
+	ASSERT(m_inFlight != 0);
+
+	--m_inFlight;
+	wakeHead();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Add the tokens accrued since the last refill, up to the burst size.
+
+void HostLimiter::refill()
+{
+	if (m_rate == UNLIMITED_RATE)
+		return;
+
+	const int64  now = Stopwatch::ticks();
+	const double seconds = static_cast<double>(Stopwatch::ticksToMicroseconds(now - m_refilled)) / 1000000.0;
+
+	m_tokens   = std::min(static_cast<double>(m_burst), m_tokens + (seconds * m_rate));
+	m_refilled = now;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Query if a call can start now.
+
+bool HostLimiter::canStart(Call call) const
+{
+	if (m_inFlight >= m_maxConcurrent)
+		return false;
+
+	return (call == CONTINUATION) || (m_rate == UNLIMITED_RATE) || (m_tokens >= 1.0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Take a slot and, for a request, a token.
+
+void HostLimiter::start(Call call)
+{
+	++m_inFlight;
+
+	if ( (call == REQUEST) && (m_rate != UNLIMITED_RATE) )
+		m_tokens -= 1.0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the milliseconds until a call at the head of the queue can start, or
+//! INFINITE if it needs a slot to be released first.
+
+DWORD HostLimiter::timeToStart(Call call) const
+{
+	if (m_inFlight >= m_maxConcurrent)
+		return INFINITE;
+
+	if ( (call == CONTINUATION) || (m_rate == UNLIMITED_RATE) || (m_tokens >= 1.0) )
+		return 0;
+
+	const double milliseconds = ((1.0 - m_tokens) * 1000.0) / m_rate;
+
+	return static_cast<DWORD>(milliseconds) + 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Wake the caller at the head of the queue, if any, so that it can check
+//! whether it can start or how long it must wait for the next token.
+
+void HostLimiter::wakeHead()
+{
+	if (!m_queue.empty())
+		::SetEvent(m_queue.front());
+}
+
+//namespace WMI
+}
@@ -0,0 +1,195 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   HostLimiter.hpp
+//! \brief  The HostLimiter class declaration.
+//! \author Chris Oldwood
+
+// Check for previous inclusion
+#ifndef WMI_HOSTLIMITER_HPP
+#define WMI_HOSTLIMITER_HPP
+
+#if _MSC_VER > 1000
+#pragma once
+#endif
+
+#include "Deadline.hpp"
+#include "ConnectionStats.hpp"
+#include "CriticalSection.hpp"
+#include <Core/NotCopyable.hpp>
+#include <Core/SharedPtr.hpp>
+#include <deque>
+
+namespace WMI
+{
+
+////////////////////////////////////////////////////////////////////////////////
+//! Limits the calls made to a single host, to stop many threads overloading its
+//! provider host, which shows up as WBEM_E_QUOTA_VIOLATION failures. A call
+//! needs one of a fixed number of slots for as long as it is in flight and the
+//! calls that start new work also need a token from a bucket that is refilled
+//! at a steady rate, up to a burst size.
+//!
+//! Callers that are over either limit queue in the order they arrived. Only the
+//! caller at the head of the queue can take a slot, and so a stream of new
+//! callers cannot starve one that is already waiting. The limiter is shared by
+//! the connections to the host, on any thread.
+
+class HostLimiter : private Core::NotCopyable
+{
+public:
+	//! The kinds of call.
+	enum Call
+	{
+		REQUEST,		//!< A call that starts new work and so needs a token.
+		CONTINUATION	//!< A call that continues existing work, e.g. Next().
+	};
+
+	//! Holds a slot for the lifetime of the object.
+	class Permit : private Core::NotCopyable
+	{
+	public:
+		//! Wait for a slot, if limited, recording the wait in the statistics.
+		Permit(HostLimiter* limiter, Call call, const Deadline& deadline, ConnectionStats* stats); // throw(WMI::Exception)
+
+		//! Release the slot.
+		~Permit();
+
+		//! Query if a slot was acquired, or none was needed.
+		bool acquired() const;
+
+	private:
+		HostLimiter*	m_limiter;	//!< The limiter, if any.
+		bool			m_acquired;	//!< Was a slot acquired?
+	};
+
+public:
+	//! Construction with the number of slots, the rate and the burst size.
+	HostLimiter(size_t maxConcurrent = DEFAULT_MAX_CONCURRENT, uint rate = UNLIMITED_RATE,
+				size_t burst = DEFAULT_BURST);
+
+	//! Destructor.
+	~HostLimiter();
+
+	//
+	// Properties.
+	//
+
+	//! Get the most calls that can be in flight at once.
+	size_t maxConcurrent() const;
+
+	//! Get the number of requests started per second, or UNLIMITED_RATE.
+	uint rate() const;
+
+	//! Get the most requests that can be started at once after an idle period.
+	size_t burst() const;
+
+	//! Get the number of calls in flight.
+	size_t inFlight() const;
+
+	//! Get the number of callers waiting.
+	size_t queueLength() const;
+
+	//! Get the most callers that have waited at once.
+	size_t maxQueueLength() const;
+
+	//! Get the number of calls that had to wait.
+	size_t queued() const;
+
+	//! Get the number of calls that gave up waiting at their deadline.
+	size_t timedOut() const;
+
+	//
+	// Methods.
+	//
+
+	//! Wait for a slot, giving up at a deadline.
+	bool acquire(Call call, const Deadline& deadline, uint64& waitedMicroseconds); // throw(WMI::Exception)
+
+	//! Release a slot.
+	void release();
+
+	//
+	// Constants.
+	//
+
+	//! The default number of slots.
+	static const size_t DEFAULT_MAX_CONCURRENT = 4;
+	//! The rate for not limiting the requests started.
+	static const uint UNLIMITED_RATE = 0;
+	//! The default burst size.
+	static const size_t DEFAULT_BURST = 1;
+
+private:
+	//
+	// Members.
+	//
+	size_t				m_maxConcurrent;	//!< The number of slots.
+	uint				m_rate;				//!< The tokens added per second.
+	size_t				m_burst;			//!< The most tokens held.
+	mutable CriticalSection	m_lock;			//!< The lock guarding the state.
+	size_t				m_inFlight;			//!< The slots in use.
+	double				m_tokens;			//!< The tokens in the bucket.
+	int64				m_refilled;			//!< The counter value when last refilled.
+	std::deque<HANDLE>	m_queue;			//!< The waiting callers' events.
+	size_t				m_maxQueueLength;	//!< The most callers waiting at once.
+	size_t				m_queued;			//!< The number of calls that waited.
+	size_t				m_timedOut;			//!< The number of calls that gave up.
+
+	//
+	// Internal methods.
+	//
+
+	//! Add the tokens accrued since the last refill.
+	void refill();
+
+	//! Query if a call can start now.
+	bool canStart(Call call) const;
+
+	//! Take a slot and, for a request, a token.
+	void start(Call call);
+
+	//! Get the milliseconds until a call at the head of the queue can start.
+	DWORD timeToStart(Call call) const;
+
+	//! Wake the caller at the head of the queue.
+	void wakeHead();
+};
+
+//! The default HostLimiter smart-pointer type.
+typedef Core::SharedPtr<HostLimiter> HostLimiterPtr;
+
+////////////////////////////////////////////////////////////////////////////////
+//! Query if a slot was acquired, or none was needed.
+
+inline bool HostLimiter::Permit::acquired() const
+{
+	return m_acquired;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the most calls that can be in flight at once.
+
+inline size_t HostLimiter::maxConcurrent() const
+{
+	return m_maxConcurrent;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the number of requests started per second, or UNLIMITED_RATE.
+
+inline uint HostLimiter::rate() const
+{
+	return m_rate;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the most requests that can be started at once after an idle period.
+
+inline size_t HostLimiter::burst() const
+{
+	return m_burst;
+}
+
+//namespace WMI
+}
+
+#endif // WMI_HOSTLIMITER_HPP
@@ -0,0 +1,73 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   MarshalledConnection.cpp
+//! \brief  The MarshalledConnection class definition.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include "MarshalledConnection.hpp"
+
+#ifndef _MSC_VER
+WCL_DECLARE_IFACETRAITS(IWbemServices, IID_IWbemServices);
+#endif
+
+namespace WMI
+{
+
+////////////////////////////////////////////////////////////////////////////////
+//! Construction from the connection to hand off. This must be called on the
+//! thread that owns the connection.
+
+MarshalledConnection::MarshalledConnection(const Connection& connection)
+	: m_stats(connection.stats())
+	, m_blanket(connection.securityBlanket())
+	, m_limiter(connection.limiter())
+	, m_locator(connection.locator())
+	, m_retryPolicy(connection.retryPolicy())
+	, m_batchSize(connection.batchSize())
+	, m_batchBudget(connection.batchBudget())
+	, m_target(connection.target())
+	, m_reconnectable(connection.isReconnectable())
+	, m_services(connection.get())
+{
+	ASSERT(connection.isOpen());
+	ASSERT(connection.affinity().isAccessible());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Destructor.
+
+MarshalledConnection::~MarshalledConnection()
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get a connection that can be used on the calling thread. It has the same
+//! settings as the original connection, and shares its call statistics, host
+//! limiter and retry policy, so that a worker batches, retries and reconnects
+//! as the original would. A proxy for another apartment needs its own blanket,
+//! which is applied when it is opened. A custom locator is only used again to
+//! reconnect, and so must be usable from any apartment, as a MemoryLocator is.
+
+Connection MarshalledConnection::unmarshal() const
+{
+	IWbemServicesPtr services = m_services.get();
+	Connection       connection;
+
+	connection.setStats(m_stats);
+	connection.setSecurityBlanket(m_blanket);
+	connection.setLimiter(m_limiter);
+	connection.setLocator(m_locator);
+	connection.setRetryPolicy(m_retryPolicy);
+	connection.setBatchSize(m_batchSize);
+	connection.setBatchBudget(m_batchBudget);
+
+	if (m_reconnectable)
+		connection.open(services, m_target);
+	else
+		connection.open(services);
+
+	return connection;
+}
+
+//namespace WMI
+}
@@ -0,0 +1,70 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   MarshalledConnection.hpp
+//! \brief  The MarshalledConnection class declaration.
+//! \author Chris Oldwood
+
+// Check for previous inclusion
+#ifndef WMI_MARSHALLEDCONNECTION_HPP
+#define WMI_MARSHALLEDCONNECTION_HPP
+
+#if _MSC_VER > 1000
+#pragma once
+#endif
+
+#include "Connection.hpp"
+#include "GlobalInterface.hpp"
+#include <Core/SharedPtr.hpp>
+
+namespace WMI
+{
+
+////////////////////////////////////////////////////////////////////////////////
+//! A connection that has been registered in the Global Interface Table so that
+//! it can be handed to a thread in a different apartment. The connection is
+//! marshalled on the owning thread and then unmarshalled by each receiving
+//! thread, which gets its own proxy, or the original connection if it is in
+//! the same apartment. Unlike the connection, this can be released on any
+//! thread.
+
+class MarshalledConnection : private Core::NotCopyable
+{
+public:
+	//! Construction from the connection to hand off.
+	explicit MarshalledConnection(const Connection& connection); // throw(WMI::Exception)
+
+	//! Destructor.
+	~MarshalledConnection();
+
+	//
+	// Methods.
+	//
+
+	//! Get a connection that can be used on the calling thread.
+	Connection unmarshal() const; // throw(WMI::Exception)
+
+private:
+	//! The registered connection type.
+	typedef GlobalInterface<IWbemServices> Services;
+
+	//
+	// Members.
+	//
+	ConnectionStatsPtr	m_stats;			//!< The original connection's statistics.
+	SecurityBlanket		m_blanket;			//!< The original connection's security blanket.
+	HostLimiterPtr		m_limiter;			//!< The original connection's host limiter.
+	IWbemLocatorPtr		m_locator;			//!< The original connection's custom locator.
+	RetryPolicyPtr		m_retryPolicy;		//!< The original connection's retry policy.
+	size_t				m_batchSize;		//!< The original connection's batch size.
+	size_t				m_batchBudget;		//!< The original connection's batch budget.
+	Connection::Target	m_target;			//!< The namespace connected to.
+	bool				m_reconnectable;	//!< Can the connection be re-opened?
+	Services			m_services;			//!< The registered COM connection.
+};
+
+//! The default MarshalledConnection smart-pointer type.
+typedef Core::SharedPtr<MarshalledConnection> MarshalledConnectionPtr;
+
+//namespace WMI
+}
+
+#endif // WMI_MARSHALLEDCONNECTION_HPP
@@ -0,0 +1,42 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   MarshalledObject.cpp
+//! \brief  The MarshalledObject class definition.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include "MarshalledObject.hpp"
+
+#ifndef _MSC_VER
+WCL_DECLARE_IFACETRAITS(IWbemClassObject, IID_IWbemClassObject);
+#endif
+
+namespace WMI
+{
+
+////////////////////////////////////////////////////////////////////////////////
+//! Construction from the object to hand off. This must be called on the thread
+//! that owns the object's connection.
+
+MarshalledObject::MarshalledObject(const Object& object)
+	: m_connection(object.connection())
+	, m_object(object.get())
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Destructor.
+
+MarshalledObject::~MarshalledObject()
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get an object that can be used on the calling thread.
+
+Object MarshalledObject::unmarshal() const
+{
+	return Object(m_object.get(), m_connection.unmarshal());
+}
+
+//namespace WMI
+}
@@ -0,0 +1,58 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   MarshalledObject.hpp
+//! \brief  The MarshalledObject class declaration.
+//! \author Chris Oldwood
+
+// Check for previous inclusion
+#ifndef WMI_MARSHALLEDOBJECT_HPP
+#define WMI_MARSHALLEDOBJECT_HPP
+
+#if _MSC_VER > 1000
+#pragma once
+#endif
+
+#include "MarshalledConnection.hpp"
+#include "Object.hpp"
+
+namespace WMI
+{
+
+////////////////////////////////////////////////////////////////////////////////
+//! An object, along with its connection, that has been registered in the Global
+//! Interface Table so that it can be handed to a thread in another apartment,
+//! such as when results are enumerated on one thread and processed on a pool.
+
+class MarshalledObject : private Core::NotCopyable
+{
+public:
+	//! Construction from the object to hand off.
+	explicit MarshalledObject(const Object& object); // throw(WMI::Exception)
+
+	//! Destructor.
+	~MarshalledObject();
+
+	//
+	// Methods.
+	//
+
+	//! Get an object that can be used on the calling thread.
+	Object unmarshal() const; // throw(WMI::Exception)
+
+private:
+	//! The registered object type.
+	typedef GlobalInterface<IWbemClassObject> ObjectInterface;
+
+	//
+	// Members.
+	//
+	MarshalledConnection	m_connection;	//!< The object's connection.
+	ObjectInterface			m_object;		//!< The registered COM object.
+};
+
+//! The default MarshalledObject smart-pointer type.
+typedef Core::SharedPtr<MarshalledObject> MarshalledObjectPtr;
+
+//namespace WMI
+}
+
+#endif // WMI_MARSHALLEDOBJECT_HPP
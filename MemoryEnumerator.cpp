@@ -0,0 +1,246 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   MemoryEnumerator.cpp
+//! \brief  The MemoryEnumerator class definition.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include "MemoryEnumerator.hpp"
+#include "Stopwatch.hpp"
+#include <algorithm>
+
+#ifndef _MSC_VER
+WCL_DECLARE_IFACETRAITS(IEnumWbemClassObject, IID_IEnumWbemClassObject);
+#endif
+
+namespace WMI
+{
+
+////////////////////////////////////////////////////////////////////////////////
+//! Construction from the objects to serve once each.
+
+MemoryEnumerator::MemoryEnumerator(const Objects& objects)
+	: m_refCount(0)
+	, m_objects(objects)
+	, m_count(objects.size())
+	, m_next(0)
+	, m_latencies()
+	, m_waited(0)
+	, m_roundTrip(0)
+	, m_calls(0)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Construction from the objects to serve and the length of the sequence.
+
+MemoryEnumerator::MemoryEnumerator(const Objects& objects, size_t count)
+	: m_refCount(0)
+	, m_objects(objects)
+	, m_count(count)
+	, m_next(0)
+	, m_latencies()
+	, m_waited(0)
+	, m_roundTrip(0)
+	, m_calls(0)
+{
+	ASSERT(!m_objects.empty() || (m_count == 0));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Destructor.
+
+MemoryEnumerator::~MemoryEnumerator()
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get a reference counted COM interface to the enumerator.
+
+IEnumWbemClassObjectPtr MemoryEnumerator::getInterface()
+{
+	IEnumWbemClassObjectPtr enumerator;
+
+	AddRef();
+	*AttachTo(enumerator) = this;
+
+	return enumerator;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Set the delay, in microseconds, before each object is served to simulate a
+//! remote provider. The delays are applied cyclically, like the objects.
+
+void MemoryEnumerator::setLatencies(const Latencies& latencies)
+{
+	m_latencies = latencies;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Set the delay, in microseconds, at the start of each call to Next() to
+//! simulate the round trip to a remote host. Unlike the latencies it is paid
+//! once per call and so is amortised by requesting larger batches.
+
+void MemoryEnumerator::setRoundTrip(uint32 roundTrip)
+{
+	m_roundTrip = roundTrip;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Query the object for an interface.
+
+HRESULT STDMETHODCALLTYPE MemoryEnumerator::QueryInterface(REFIID iid, void** object)
+{
+	if (object == nullptr)
+		return E_POINTER;
+
+	if ( (iid == IID_IUnknown) || (iid == IID_IEnumWbemClassObject) )
+	{
+		*object = static_cast<IEnumWbemClassObject*>(this);
+		AddRef();
+		return S_OK;
+	}
+
+	*object = nullptr;
+	return E_NOINTERFACE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Increment the reference count.
+
+ULONG STDMETHODCALLTYPE MemoryEnumerator::AddRef()
+{
+	return ::InterlockedIncrement(&m_refCount);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Decrement the reference count.
+
+ULONG STDMETHODCALLTYPE MemoryEnumerator::Release()
+{
+	const LONG refCount = ::InterlockedDecrement(&m_refCount);
+
+	if (refCount == 0)
+		delete this;
+
+	return refCount;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Move back to the start of the sequence.
+
+HRESULT STDMETHODCALLTYPE MemoryEnumerator::Reset()
+{
+	m_next = 0;
+	m_waited = 0;
+
+	return WBEM_S_NO_ERROR;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the next batch of objects. Returns WBEM_S_FALSE if fewer objects than
+//! requested were available, or WBEM_S_TIMEDOUT if the latencies meant that
+//! the timeout, in milliseconds, expired first. Any time already spent waiting
+//! for an object is carried over to the next call, so that a stalled provider
+//! can be simulated with a large latency. The round trip is always paid in
+//! full and counts towards the timeout.
+
+HRESULT STDMETHODCALLTYPE MemoryEnumerator::Next(long timeout, ULONG count, IWbemClassObject** objects, ULONG* returned)
+{
+	if ( (objects == nullptr) || (returned == nullptr) )
+		return WBEM_E_INVALID_PARAMETER;
+
+	// A negative timeout is WBEM_INFINITE.
+	const bool   infinite = (timeout < 0);
+	const uint64 budget = infinite ? 0 : (static_cast<uint64>(timeout) * 1000);
+	const size_t available = std::min<size_t>(count, m_count - m_next);
+	uint64       spent = 0;
+	size_t       served = 0;
+	bool         timedOut = false;
+
+	++m_calls;
+
+	if (m_roundTrip != 0)
+	{
+		Stopwatch::wait(m_roundTrip);
+		spent += m_roundTrip;
+	}
+
+	for (; served != available; ++served)
+	{
+		if (!m_latencies.empty())
+		{
+			const uint64 outstanding = m_latencies[(m_next + served) % m_latencies.size()] - m_waited;
+
+			if (!infinite && ((spent + outstanding) > budget))
+			{
+				const uint64 remaining = (spent < budget) ? (budget - spent) : 0;
+
+				Stopwatch::wait(remaining);
+				m_waited += remaining;
+				timedOut = true;
+				break;
+			}
+
+			Stopwatch::wait(outstanding);
+			spent += outstanding;
+			m_waited = 0;
+		}
+
+		IWbemClassObject* object = m_objects[(m_next + served) % m_objects.size()].get();
+
+		object->AddRef();
+		objects[served] = object;
+	}
+
+	m_next += served;
+	*returned = static_cast<ULONG>(served);
+
+	if (timedOut)
+		return WBEM_S_TIMEDOUT;
+
+	return (served == count) ? WBEM_S_NO_ERROR : WBEM_S_FALSE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Asynchronous enumeration is not supported.
+
+HRESULT STDMETHODCALLTYPE MemoryEnumerator::NextAsync(ULONG /*count*/, IWbemObjectSink* /*sink*/)
+{
+	return WBEM_E_NOT_SUPPORTED;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Create a copy of the enumerator, including its position.
+
+HRESULT STDMETHODCALLTYPE MemoryEnumerator::Clone(IEnumWbemClassObject** copy)
+{
+	if (copy == nullptr)
+		return WBEM_E_INVALID_PARAMETER;
+
+	MemoryEnumerator* clone = new MemoryEnumerator(m_objects, m_count);
+
+	clone->m_next      = m_next;
+	clone->m_latencies = m_latencies;
+	clone->m_waited    = m_waited;
+	clone->m_roundTrip = m_roundTrip;
+	clone->AddRef();
+
+	*copy = clone;
+
+	return WBEM_S_NO_ERROR;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Skip over a number of objects.
+
+HRESULT STDMETHODCALLTYPE MemoryEnumerator::Skip(long /*timeout*/, ULONG count)
+{
+	const size_t available = std::min<size_t>(count, m_count - m_next);
+
+	m_next += available;
+
+	return (available == count) ? WBEM_S_NO_ERROR : WBEM_S_FALSE;
+}
+
+//namespace WMI
+}
@@ -0,0 +1,124 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   MemoryEnumerator.hpp
+//! \brief  The MemoryEnumerator class declaration.
+//! \author Chris Oldwood
+
+// Check for previous inclusion
+#ifndef WMI_MEMORYENUMERATOR_HPP
+#define WMI_MEMORYENUMERATOR_HPP
+
+#if _MSC_VER > 1000
+#pragma once
+#endif
+
+#include "Types.hpp"
+#include <Core/NotCopyable.hpp>
+#include <vector>
+
+namespace WMI
+{
+
+////////////////////////////////////////////////////////////////////////////////
+//! An in-process implementation of the IEnumWbemClassObject interface that
+//! serves a sequence of objects held in memory. The sequence can be longer than
+//! the set of objects, in which case they are served repeatedly, so that large
+//! result sets can be simulated without the memory cost.
+
+class MemoryEnumerator : public IEnumWbemClassObject, private Core::NotCopyable
+{
+public:
+	//! The collection of objects to serve.
+	typedef std::vector<IWbemClassObjectPtr> Objects;
+	//! The collection of delays, in microseconds.
+	typedef std::vector<uint32> Latencies;
+
+public:
+	//! Construction from the objects to serve once each.
+	explicit MemoryEnumerator(const Objects& objects);
+
+	//! Construction from the objects to serve and the length of the sequence.
+	MemoryEnumerator(const Objects& objects, size_t count);
+
+	//
+	// Properties.
+	//
+
+	//! Get the length of the sequence.
+	size_t count() const;
+
+	//! Get the number of calls made to Next().
+	size_t calls() const;
+
+	//
+	// Methods.
+	//
+
+	//! Get a reference counted COM interface to the enumerator.
+	IEnumWbemClassObjectPtr getInterface();
+
+	//! Set the delay before each object is served.
+	void setLatencies(const Latencies& latencies);
+
+	//! Set the delay at the start of each call to Next().
+	void setRoundTrip(uint32 roundTrip);
+
+	//
+	// IUnknown methods.
+	//
+
+	//! Query the object for an interface.
+	virtual HRESULT STDMETHODCALLTYPE QueryInterface(REFIID iid, void** object);
+
+	//! Increment the reference count.
+	virtual ULONG STDMETHODCALLTYPE AddRef();
+
+	//! Decrement the reference count.
+	virtual ULONG STDMETHODCALLTYPE Release();
+
+	//
+	// IEnumWbemClassObject methods.
+	//
+
+	virtual HRESULT STDMETHODCALLTYPE Reset();
+	virtual HRESULT STDMETHODCALLTYPE Next(long timeout, ULONG count, IWbemClassObject** objects, ULONG* returned);
+	virtual HRESULT STDMETHODCALLTYPE NextAsync(ULONG count, IWbemObjectSink* sink);
+	virtual HRESULT STDMETHODCALLTYPE Clone(IEnumWbemClassObject** copy);
+	virtual HRESULT STDMETHODCALLTYPE Skip(long timeout, ULONG count);
+
+private:
+	//
+	// Members.
+	//
+	LONG		m_refCount;		//!< The COM reference count.
+	Objects		m_objects;		//!< The objects to serve.
+	size_t		m_count;		//!< The length of the sequence.
+	size_t		m_next;			//!< The index of the next item in the sequence.
+	Latencies	m_latencies;	//!< The delay before serving each object.
+	uint64		m_waited;		//!< The time already spent waiting for the next object.
+	uint32		m_roundTrip;	//!< The delay at the start of each call.
+	size_t		m_calls;		//!< The number of calls to Next().
+
+	//! Destructor.
+	virtual ~MemoryEnumerator();
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the length of the sequence.
+
+inline size_t MemoryEnumerator::count() const
+{
+	return m_count;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the number of calls made to Next().
+
+inline size_t MemoryEnumerator::calls() const
+{
+	return m_calls;
+}
+
+//namespace WMI
+}
+
+#endif // WMI_MEMORYENUMERATOR_HPP
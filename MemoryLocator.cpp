@@ -0,0 +1,181 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   MemoryLocator.cpp
+//! \brief  The MemoryLocator class definition.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include "MemoryLocator.hpp"
+#include "Stopwatch.hpp"
+
+#ifndef _MSC_VER
+WCL_DECLARE_IFACETRAITS(IWbemServices, IID_IWbemServices);
+WCL_DECLARE_IFACETRAITS(IWbemLocator, IID_IWbemLocator);
+#endif
+
+namespace WMI
+{
+
+////////////////////////////////////////////////////////////////////////////////
+// Constants.
+
+//! The longest delay, in microseconds, when the maximum wait is requested.
+const uint64 MemoryLocator::MAX_WAIT = 2 * 60 * 1000 * 1000;
+
+////////////////////////////////////////////////////////////////////////////////
+//! Default constructor.
+
+MemoryLocator::MemoryLocator()
+	: m_refCount(0)
+	, m_namespaces()
+	, m_attempts(0)
+	, m_lastFlags(0)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Destructor.
+
+MemoryLocator::~MemoryLocator()
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the number of connections attempted.
+
+size_t MemoryLocator::attempts() const
+{
+	return static_cast<size_t>(m_attempts);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the flags passed to the most recent connection attempt.
+
+long MemoryLocator::lastFlags() const
+{
+	return m_lastFlags;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Add a namespace that is served by a provider after a delay, in microseconds.
+
+void MemoryLocator::addNamespace(const tstring& path, IWbemServicesPtr services, uint64 latency)
+{
+	ASSERT(services.get() != nullptr);
+
+	Namespace& entry = m_namespaces[path];
+
+	entry.m_services = services;
+	entry.m_result = WBEM_S_NO_ERROR;
+	entry.m_latency = latency;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Add a namespace that fails after a delay, in microseconds, such as on a dead
+//! host.
+
+void MemoryLocator::addFailure(const tstring& path, HRESULT result, uint64 latency)
+{
+	ASSERT(FAILED(result));
+
+	Namespace& entry = m_namespaces[path];
+
+	entry.m_services.Release();
+	entry.m_result = result;
+	entry.m_latency = latency;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get a reference counted COM interface to the locator.
+
+IWbemLocatorPtr MemoryLocator::getInterface()
+{
+	IWbemLocatorPtr locator;
+
+	AddRef();
+	*AttachTo(locator) = this;
+
+	return locator;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Query the object for an interface.
+
+HRESULT STDMETHODCALLTYPE MemoryLocator::QueryInterface(REFIID iid, void** object)
+{
+	if (object == nullptr)
+		return E_POINTER;
+
+	if ( (iid == IID_IUnknown) || (iid == IID_IWbemLocator) )
+	{
+		*object = static_cast<IWbemLocator*>(this);
+		AddRef();
+		return S_OK;
+	}
+
+	*object = nullptr;
+	return E_NOINTERFACE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Increment the reference count.
+
+ULONG STDMETHODCALLTYPE MemoryLocator::AddRef()
+{
+	return ::InterlockedIncrement(&m_refCount);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Decrement the reference count.
+
+ULONG STDMETHODCALLTYPE MemoryLocator::Release()
+{
+	const LONG refCount = ::InterlockedDecrement(&m_refCount);
+
+	if (refCount == 0)
+		delete this;
+
+	return refCount;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Connect to the provider for the namespace after its delay. The credentials,
+//! locale, authority and context are ignored.
+
+HRESULT STDMETHODCALLTYPE MemoryLocator::ConnectServer(const BSTR path, const BSTR /*user*/, const BSTR /*password*/, const BSTR /*locale*/,
+														long flags, const BSTR /*authority*/, IWbemContext* /*context*/, IWbemServices** services)
+{
+	if (services == nullptr)
+		return WBEM_E_INVALID_PARAMETER;
+
+	*services = nullptr;
+
+	::InterlockedIncrement(&m_attempts);
+	::InterlockedExchange(&m_lastFlags, flags);
+
+	Namespaces::const_iterator it = m_namespaces.find((path != nullptr) ? path : TXT(""));
+
+	if (it == m_namespaces.end())
+		return WBEM_E_INVALID_NAMESPACE;
+
+	const Namespace& entry = it->second;
+
+	if ( ((flags & WBEM_FLAG_CONNECT_USE_MAX_WAIT) != 0) && (entry.m_latency > MAX_WAIT) )
+	{
+		Stopwatch::wait(MAX_WAIT);
+
+		return WBEM_E_TRANSPORT_FAILURE;
+	}
+
+	Stopwatch::wait(entry.m_latency);
+
+	if (FAILED(entry.m_result))
+		return entry.m_result;
+
+	entry.m_services->AddRef();
+	*services = entry.m_services.get();
+
+	return WBEM_S_NO_ERROR;
+}
+
+//namespace WMI
+}
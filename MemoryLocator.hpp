@@ -0,0 +1,117 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   MemoryLocator.hpp
+//! \brief  The MemoryLocator class declaration.
+//! \author Chris Oldwood
+
+// Check for previous inclusion
+#ifndef WMI_MEMORYLOCATOR_HPP
+#define WMI_MEMORYLOCATOR_HPP
+
+#if _MSC_VER > 1000
+#pragma once
+#endif
+
+#include "Types.hpp"
+#include <Core/NotCopyable.hpp>
+#include <map>
+
+namespace WMI
+{
+
+////////////////////////////////////////////////////////////////////////////////
+//! An in-process implementation of the IWbemLocator interface that connects
+//! to in-memory providers, such as a ReplayServices, after a simulated delay.
+//! This allows the connection timeouts to be exercised without a dead host.
+//!
+//! Namespaces are matched on the full path, as formatted by the Connection,
+//! e.g. "\\\\HOST\\root\\cimv2". Any other path fails immediately with
+//! WBEM_E_INVALID_NAMESPACE. When WBEM_FLAG_CONNECT_USE_MAX_WAIT is passed the
+//! delay is capped at MAX_WAIT, after which the attempt fails, as with WMI.
+//!
+//! The namespaces must all be added before the locator is used, after which it
+//! can be called from any thread.
+
+class MemoryLocator : public IWbemLocator, private Core::NotCopyable
+{
+public:
+	//! Default constructor.
+	MemoryLocator();
+
+	//
+	// Properties.
+	//
+
+	//! Get the number of connections attempted.
+	size_t attempts() const;
+
+	//! Get the flags passed to the most recent connection attempt.
+	long lastFlags() const;
+
+	//
+	// Methods.
+	//
+
+	//! Add a namespace that is served by a provider after a delay.
+	void addNamespace(const tstring& path, IWbemServicesPtr services, uint64 latency);
+
+	//! Add a namespace that fails after a delay, such as on a dead host.
+	void addFailure(const tstring& path, HRESULT result, uint64 latency);
+
+	//! Get a reference counted COM interface to the locator.
+	IWbemLocatorPtr getInterface();
+
+	//
+	// IUnknown methods.
+	//
+
+	//! Query the object for an interface.
+	virtual HRESULT STDMETHODCALLTYPE QueryInterface(REFIID iid, void** object);
+
+	//! Increment the reference count.
+	virtual ULONG STDMETHODCALLTYPE AddRef();
+
+	//! Decrement the reference count.
+	virtual ULONG STDMETHODCALLTYPE Release();
+
+	//
+	// IWbemLocator methods.
+	//
+
+	virtual HRESULT STDMETHODCALLTYPE ConnectServer(const BSTR path, const BSTR user, const BSTR password, const BSTR locale,
+													long flags, const BSTR authority, IWbemContext* context, IWbemServices** services);
+
+	//
+	// Constants.
+	//
+
+	//! The longest delay, in microseconds, when the maximum wait is requested.
+	static const uint64 MAX_WAIT;
+
+private:
+	//! The outcome of connecting to a namespace.
+	struct Namespace
+	{
+		IWbemServicesPtr	m_services;		//!< The provider, if the connection succeeds.
+		HRESULT				m_result;		//!< The result of the connection.
+		uint64				m_latency;		//!< The delay, in microseconds.
+	};
+
+	//! The map of path to namespace.
+	typedef std::map<tstring, Namespace> Namespaces;
+
+	//
+	// Members.
+	//
+	LONG			m_refCount;		//!< The COM reference count.
+	Namespaces		m_namespaces;	//!< The namespaces, by path.
+	volatile LONG	m_attempts;		//!< The number of connections attempted.
+	volatile LONG	m_lastFlags;	//!< The flags of the most recent attempt.
+
+	//! Destructor.
+	virtual ~MemoryLocator();
+};
+
+//namespace WMI
+}
+
+#endif // WMI_MEMORYLOCATOR_HPP
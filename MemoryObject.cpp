@@ -0,0 +1,945 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   MemoryObject.cpp
+//! \brief  The MemoryObject class definition.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include "MemoryObject.hpp"
+#include <WCL/ComStr.hpp>
+#include <WCL/VariantVector.hpp>
+#include "Exception.hpp"
+#include <Core/StringUtils.hpp>
+#include <algorithm>
+
+#ifndef _MSC_VER
+WCL_DECLARE_IFACETRAITS(IWbemClassObject, IID_IWbemClassObject);
+#endif
+
+namespace WMI
+{
+
+//! The method enumeration position when not enumerating.
+static const size_t NOT_ENUMERATING = static_cast<size_t>(-1);
+
+////////////////////////////////////////////////////////////////////////////////
+//! Query if the property name is for a system property.
+
+static bool isSystemProperty(const tstring& name)
+{
+	return (name.compare(0, 2, TXT("__")) == 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Derive the CIM type from the type of a VARIANT value.
+
+static CIMTYPE deriveType(const VARIANT& value)
+{
+	const CIMTYPE array = (V_VT(&value) & VT_ARRAY) ? CIM_FLAG_ARRAY : 0;
+
+	switch (V_VT(&value) & VT_TYPEMASK)
+	{
+		case VT_I1:			return array | CIM_SINT8;
+		case VT_UI1:		return array | CIM_UINT8;
+		case VT_I2:			return array | CIM_SINT16;
+		case VT_UI2:		return array | CIM_UINT16;
+		case VT_I4:			return array | CIM_SINT32;
+		case VT_UI4:		return array | CIM_UINT32;
+		case VT_R4:			return array | CIM_REAL32;
+		case VT_R8:			return array | CIM_REAL64;
+		case VT_BOOL:		return array | CIM_BOOLEAN;
+		case VT_BSTR:		return array | CIM_STRING;
+		case VT_UNKNOWN:	return array | CIM_OBJECT;
+		default:			break;
+	}
+
+	return CIM_EMPTY;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Allocate a BSTR copy of a string.
+
+static BSTR allocString(const tstring& value)
+{
+	return ::SysAllocStringLen(value.data(), static_cast<UINT>(value.length()));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Format a property value for use in an object path or the object text.
+
+static tstring formatValue(const VARIANT& value, bool quoteStrings)
+{
+	if (V_VT(&value) == VT_BSTR)
+	{
+		const wchar_t* text = (V_BSTR(&value) != nullptr) ? V_BSTR(&value) : L"";
+
+		if (!quoteStrings)
+			return text;
+
+		tstring quoted(TXT("\""));
+
+		for (const wchar_t* it = text; *it != L'\0'; ++it)
+		{
+			if ( (*it == L'\\') || (*it == L'"') )
+				quoted += TXT('\\');
+
+			quoted += *it;
+		}
+
+		return quoted + TXT("\"");
+	}
+
+	WCL::Variant string;
+
+	if (FAILED(::VariantChangeType(&string, const_cast<VARIANT*>(&value), 0, VT_BSTR)))
+		return TXT("NULL");
+
+	return (V_BSTR(&string) != nullptr) ? V_BSTR(&string) : L"";
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Construction with the WMI class name.
+
+MemoryObject::MemoryObject(const tstring& className)
+	: m_refCount(0)
+	, m_className(className)
+	, m_properties()
+	, m_methods()
+	, m_nextMethod(NOT_ENUMERATING)
+{
+	setProperty(TXT("__CLASS"), className);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Destructor.
+
+MemoryObject::~MemoryObject()
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get a reference counted COM interface to the object.
+
+IWbemClassObjectPtr MemoryObject::getInterface()
+{
+	IWbemClassObjectPtr object;
+
+	AddRef();
+	*AttachTo(object) = this;
+
+	return object;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Set the value for a property, adding it if necessary.
+
+void MemoryObject::setProperty(const tstring& name, const VARIANT& value, CIMTYPE type, bool isKey)
+{
+	Property* property = findProperty(name.c_str());
+
+	if (property == nullptr)
+	{
+		m_properties.push_back(Property());
+
+		property = &m_properties.back();
+		property->m_name = name;
+	}
+
+	property->m_type  = (type != CIM_EMPTY) ? type : deriveType(value);
+	property->m_isKey = isKey;
+
+	HRESULT result = ::VariantCopy(&property->m_value, const_cast<VARIANT*>(&value));
+
+	ASSERT(SUCCEEDED(result));
+	(void)result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Set a string property value.
+
+void MemoryObject::setProperty(const tstring& name, const tstring& value, CIMTYPE type, bool isKey)
+{
+	WCL::Variant variant;
+
+	V_VT(&variant)   = VT_BSTR;
+	V_BSTR(&variant) = allocString(value);
+
+	setProperty(name, variant, type, isKey);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Set a 32-bit integer property value.
+
+void MemoryObject::setProperty(const tstring& name, int32 value, CIMTYPE type, bool isKey)
+{
+	setProperty(name, WCL::Variant(value), type, isKey);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Set the input and output parameters objects returned for a method.
+
+void MemoryObject::setMethod(const tstring& name, IWbemClassObjectPtr inParams, IWbemClassObjectPtr outParams)
+{
+	for (Methods::iterator it = m_methods.begin(); it != m_methods.end(); ++it)
+	{
+		if (_wcsicmp(it->m_name.c_str(), name.c_str()) == 0)
+		{
+			it->m_inParams  = inParams;
+			it->m_outParams = outParams;
+			return;
+		}
+	}
+
+	Method method;
+
+	method.m_name      = name;
+	method.m_inParams  = inParams;
+	method.m_outParams = outParams;
+
+	m_methods.push_back(method);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Create an in-memory copy of any object, including its system properties and
+//! the input and output parameters of its methods. Embedded objects are copied too, but
+//! arrays of embedded objects are not supported and are copied as nulls.
+
+IWbemClassObjectPtr MemoryObject::copy(IWbemClassObjectPtr source)
+{
+	ASSERT(source.get() != nullptr);
+
+	WCL::Variant className;
+
+	HRESULT result = source->Get(L"__CLASS", 0, &className, nullptr, nullptr);
+
+	if (FAILED(result))
+		throw Exception(result, source, TXT("Failed to retrieve the class name of the object to copy"));
+
+	MemoryObject*       object = new MemoryObject((V_VT(&className) == VT_BSTR) ? V_BSTR(&className) : L"");
+	IWbemClassObjectPtr instance = object->getInterface();
+
+	SAFEARRAY* names = nullptr;
+	SAFEARRAY* keys = nullptr;
+
+	result = source->GetNames(nullptr, WBEM_FLAG_ALWAYS, nullptr, &names);
+
+	if (FAILED(result))
+		throw Exception(result, source, TXT("Failed to retrieve the property names of the object to copy"));
+
+	WCL::VariantVector<BSTR> propertyNames(names, VT_BSTR, true);
+	std::vector<tstring>     keyNames;
+
+	if (SUCCEEDED(source->GetNames(nullptr, WBEM_FLAG_KEYS_ONLY, nullptr, &keys)))
+	{
+		WCL::VariantVector<BSTR> keyVector(keys, VT_BSTR, true);
+
+		keyNames.assign(keyVector.begin(), keyVector.end());
+	}
+
+	for (WCL::VariantVector<BSTR>::const_iterator it = propertyNames.begin(); it != propertyNames.end(); ++it)
+	{
+		const tstring name(*it);
+		WCL::Variant  value;
+		CIMTYPE       type = CIM_EMPTY;
+
+		result = source->Get(name.c_str(), 0, &value, &type, nullptr);
+
+		if (FAILED(result))
+		{
+			const tstring message = Core::fmt(TXT("Failed to retrieve the property '%s' of the object to copy"), name.c_str());
+			throw Exception(result, source, message.c_str());
+		}
+
+		if ( (V_VT(&value) == VT_UNKNOWN) || (V_VT(&value) == VT_DISPATCH) )
+		{
+			IWbemClassObjectPtr embedded;
+
+			if ( (V_UNKNOWN(&value) != nullptr)
+			  && SUCCEEDED(V_UNKNOWN(&value)->QueryInterface(IID_IWbemClassObject, reinterpret_cast<void**>(AttachTo(embedded)))) )
+			{
+				IWbemClassObjectPtr embeddedCopy = MemoryObject::copy(embedded);
+
+				::VariantClear(&value);
+				V_VT(&value)      = VT_UNKNOWN;
+				V_UNKNOWN(&value) = embeddedCopy.get();
+				V_UNKNOWN(&value)->AddRef();
+			}
+		}
+		else if ( (V_VT(&value) & VT_ARRAY) && (((V_VT(&value) & VT_TYPEMASK) == VT_UNKNOWN) || ((V_VT(&value) & VT_TYPEMASK) == VT_DISPATCH)) )
+		{
+			::VariantClear(&value);
+			V_VT(&value) = VT_NULL;
+		}
+
+		bool isKey = false;
+
+		for (size_t k = 0; (k != keyNames.size()) && !isKey; ++k)
+			isKey = (_wcsicmp(keyNames[k].c_str(), name.c_str()) == 0);
+
+		object->setProperty(name, value, type, isKey);
+	}
+
+	if (SUCCEEDED(source->BeginMethodEnumeration(0)))
+	{
+		for (;;)
+		{
+			BSTR                methodName = nullptr;
+			IWbemClassObjectPtr inParams;
+			IWbemClassObjectPtr outParams;
+
+			if (source->NextMethod(0, &methodName, AttachTo(inParams), AttachTo(outParams)) != WBEM_S_NO_ERROR)
+				break;
+
+			const tstring name(methodName);
+
+			::SysFreeString(methodName);
+
+			object->setMethod(name, (inParams.get() != nullptr) ? MemoryObject::copy(inParams) : inParams,
+								(outParams.get() != nullptr) ? MemoryObject::copy(outParams) : outParams);
+		}
+
+		source->EndMethodEnumeration();
+	}
+
+	return instance;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Query the object for an interface.
+
+HRESULT STDMETHODCALLTYPE MemoryObject::QueryInterface(REFIID iid, void** object)
+{
+	if (object == nullptr)
+		return E_POINTER;
+
+	if ( (iid == IID_IUnknown) || (iid == IID_IWbemClassObject) )
+	{
+		*object = static_cast<IWbemClassObject*>(this);
+		AddRef();
+		return S_OK;
+	}
+
+	*object = nullptr;
+	return E_NOINTERFACE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Increment the reference count.
+
+ULONG STDMETHODCALLTYPE MemoryObject::AddRef()
+{
+	return ::InterlockedIncrement(&m_refCount);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Decrement the reference count.
+
+ULONG STDMETHODCALLTYPE MemoryObject::Release()
+{
+	const LONG refCount = ::InterlockedDecrement(&m_refCount);
+
+	if (refCount == 0)
+		delete this;
+
+	return refCount;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Qualifiers are not supported.
+
+HRESULT STDMETHODCALLTYPE MemoryObject::GetQualifierSet(IWbemQualifierSet** /*qualifiers*/)
+{
+	return WBEM_E_NOT_SUPPORTED;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get a property value.
+
+HRESULT STDMETHODCALLTYPE MemoryObject::Get(LPCWSTR name, long /*flags*/, VARIANT* value, CIMTYPE* type, long* flavour)
+{
+	if (name == nullptr)
+		return WBEM_E_INVALID_PARAMETER;
+
+	if (flavour != nullptr)
+		*flavour = 0;
+
+	const Property* property = findProperty(name);
+
+	if (property != nullptr)
+	{
+		if (value != nullptr)
+		{
+			::VariantInit(value);
+
+			HRESULT result = ::VariantCopy(value, const_cast<WCL::Variant*>(&property->m_value));
+
+			if (FAILED(result))
+				return result;
+		}
+
+		if (type != nullptr)
+			*type = property->m_type;
+
+		return WBEM_S_NO_ERROR;
+	}
+
+	const bool relativePath = (_wcsicmp(name, L"__RELPATH") == 0);
+	const bool absolutePath = (_wcsicmp(name, L"__PATH") == 0);
+
+	if (!relativePath && !absolutePath)
+		return WBEM_E_NOT_FOUND;
+
+	tstring path = formatRelativePath();
+
+	if (absolutePath)
+	{
+		const Property* server = findProperty(L"__SERVER");
+		const Property* nmspace = findProperty(L"__NAMESPACE");
+
+		path = TXT("\\\\") + ((server != nullptr) ? formatValue(server->m_value, false) : tstring(TXT(".")))
+			 + TXT("\\") + ((nmspace != nullptr) ? formatValue(nmspace->m_value, false) : tstring(TXT("root\\cimv2")))
+			 + TXT(":") + path;
+	}
+
+	if (value != nullptr)
+	{
+		V_VT(value)   = VT_BSTR;
+		V_BSTR(value) = allocString(path);
+	}
+
+	if (type != nullptr)
+		*type = CIM_STRING;
+
+	return WBEM_S_NO_ERROR;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Set a property value.
+
+HRESULT STDMETHODCALLTYPE MemoryObject::Put(LPCWSTR name, long /*flags*/, VARIANT* value, CIMTYPE type)
+{
+	if (name == nullptr)
+		return WBEM_E_INVALID_PARAMETER;
+
+	const Property* existing = findProperty(name);
+	const bool      isKey = (existing != nullptr) && existing->m_isKey;
+
+	if ( (type == CIM_EMPTY) && (existing != nullptr) )
+		type = existing->m_type;
+
+	if (value != nullptr)
+	{
+		setProperty(name, *value, type, isKey);
+	}
+	else
+	{
+		WCL::Variant null;
+
+		V_VT(&null) = VT_NULL;
+
+		setProperty(name, null, type, isKey);
+	}
+
+	return WBEM_S_NO_ERROR;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Remove a property.
+
+HRESULT STDMETHODCALLTYPE MemoryObject::Delete(LPCWSTR name)
+{
+	if (name == nullptr)
+		return WBEM_E_INVALID_PARAMETER;
+
+	for (Properties::iterator it = m_properties.begin(); it != m_properties.end(); ++it)
+	{
+		if (_wcsicmp(it->m_name.c_str(), name) == 0)
+		{
+			m_properties.erase(it);
+			return WBEM_S_NO_ERROR;
+		}
+	}
+
+	return WBEM_E_NOT_FOUND;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the names of the properties. Only the key and origin flags are supported
+//! and all non-system properties are treated as local.
+
+HRESULT STDMETHODCALLTYPE MemoryObject::GetNames(LPCWSTR qualifierName, long flags, VARIANT* /*qualifierValue*/, SAFEARRAY** names)
+{
+	if (names == nullptr)
+		return WBEM_E_INVALID_PARAMETER;
+
+	if (qualifierName != nullptr)
+		return WBEM_E_NOT_SUPPORTED;
+
+	const long ORIGIN_MASK = WBEM_FLAG_LOCAL_ONLY | WBEM_FLAG_PROPAGATED_ONLY | WBEM_FLAG_SYSTEM_ONLY | WBEM_FLAG_NONSYSTEM_ONLY;
+
+	const long origin = (flags & ORIGIN_MASK);
+	const bool keysOnly = ((flags & WBEM_FLAG_KEYS_ONLY) != 0);
+	const bool wantSystem = (origin == 0) || (origin == WBEM_FLAG_SYSTEM_ONLY);
+	const bool wantLocal = (origin == 0) || (origin == WBEM_FLAG_LOCAL_ONLY) || (origin == WBEM_FLAG_NONSYSTEM_ONLY);
+
+	std::vector<tstring> matches;
+
+	for (Properties::const_iterator it = m_properties.begin(); it != m_properties.end(); ++it)
+	{
+		const bool isSystem = isSystemProperty(it->m_name);
+
+		if ( (isSystem && !wantSystem) || (!isSystem && !wantLocal) )
+			continue;
+
+		if (keysOnly && !it->m_isKey)
+			continue;
+
+		matches.push_back(it->m_name);
+	}
+
+	if (wantSystem && !keysOnly)
+	{
+		if (findProperty(L"__RELPATH") == nullptr)
+			matches.push_back(TXT("__RELPATH"));
+
+		if (findProperty(L"__PATH") == nullptr)
+			matches.push_back(TXT("__PATH"));
+	}
+
+	SAFEARRAY* array = ::SafeArrayCreateVector(VT_BSTR, 0, static_cast<ULONG>(matches.size()));
+
+	if (array == nullptr)
+		return WBEM_E_OUT_OF_MEMORY;
+
+	for (size_t i = 0; i != matches.size(); ++i)
+	{
+		WCL::ComStr name(matches[i]);
+		LONG        index = static_cast<LONG>(i);
+
+		HRESULT result = ::SafeArrayPutElement(array, &index, name.Get());
+
+		if (FAILED(result))
+		{
+			::SafeArrayDestroy(array);
+			return result;
+		}
+	}
+
+	*names = array;
+
+	return WBEM_S_NO_ERROR;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Property enumeration is not supported.
+
+HRESULT STDMETHODCALLTYPE MemoryObject::BeginEnumeration(long /*flags*/)
+{
+	return WBEM_E_NOT_SUPPORTED;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Property enumeration is not supported.
+
+HRESULT STDMETHODCALLTYPE MemoryObject::Next(long /*flags*/, BSTR* /*name*/, VARIANT* /*value*/, CIMTYPE* /*type*/, long* /*flavour*/)
+{
+	return WBEM_E_NOT_SUPPORTED;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Property enumeration is not supported.
+
+HRESULT STDMETHODCALLTYPE MemoryObject::EndEnumeration()
+{
+	return WBEM_E_NOT_SUPPORTED;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Qualifiers are not supported.
+
+HRESULT STDMETHODCALLTYPE MemoryObject::GetPropertyQualifierSet(LPCWSTR /*property*/, IWbemQualifierSet** /*qualifiers*/)
+{
+	return WBEM_E_NOT_SUPPORTED;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Create a deep copy of the object.
+
+HRESULT STDMETHODCALLTYPE MemoryObject::Clone(IWbemClassObject** copy)
+{
+	if (copy == nullptr)
+		return WBEM_E_INVALID_PARAMETER;
+
+	MemoryObject* clone = new MemoryObject(m_className);
+
+	clone->m_properties = m_properties;
+	clone->m_methods    = m_methods;
+	clone->AddRef();
+
+	*copy = clone;
+
+	return WBEM_S_NO_ERROR;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get a MOF style textual representation of the object.
+
+HRESULT STDMETHODCALLTYPE MemoryObject::GetObjectText(long /*flags*/, BSTR* text)
+{
+	if (text == nullptr)
+		return WBEM_E_INVALID_PARAMETER;
+
+	tstring mof = TXT("instance of ") + m_className + TXT("\n{\n");
+
+	for (Properties::const_iterator it = m_properties.begin(); it != m_properties.end(); ++it)
+	{
+		if (isSystemProperty(it->m_name) || (V_VT(&it->m_value) == VT_NULL))
+			continue;
+
+		mof += TXT("\t") + it->m_name + TXT(" = ") + formatValue(it->m_value, true) + TXT(";\n");
+	}
+
+	mof += TXT("};\n");
+
+	*text = allocString(mof);
+
+	return WBEM_S_NO_ERROR;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Class derivation is not supported.
+
+HRESULT STDMETHODCALLTYPE MemoryObject::SpawnDerivedClass(long /*flags*/, IWbemClassObject** /*newClass*/)
+{
+	return WBEM_E_NOT_SUPPORTED;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Create a new instance with the same properties, but with null values.
+
+HRESULT STDMETHODCALLTYPE MemoryObject::SpawnInstance(long /*flags*/, IWbemClassObject** newInstance)
+{
+	if (newInstance == nullptr)
+		return WBEM_E_INVALID_PARAMETER;
+
+	MemoryObject* instance = new MemoryObject(m_className);
+
+	instance->m_methods = m_methods;
+
+	for (Properties::const_iterator it = m_properties.begin(); it != m_properties.end(); ++it)
+	{
+		if (isSystemProperty(it->m_name))
+			continue;
+
+		WCL::Variant null;
+
+		V_VT(&null) = VT_NULL;
+
+		instance->setProperty(it->m_name, null, it->m_type, it->m_isKey);
+	}
+
+	instance->AddRef();
+
+	*newInstance = instance;
+
+	return WBEM_S_NO_ERROR;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Object comparison is not supported.
+
+HRESULT STDMETHODCALLTYPE MemoryObject::CompareTo(long /*flags*/, IWbemClassObject* /*compareTo*/)
+{
+	return WBEM_E_NOT_SUPPORTED;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the class that introduced the property, which is always this one.
+
+HRESULT STDMETHODCALLTYPE MemoryObject::GetPropertyOrigin(LPCWSTR name, BSTR* className)
+{
+	if ( (name == nullptr) || (className == nullptr) )
+		return WBEM_E_INVALID_PARAMETER;
+
+	if (findProperty(name) == nullptr)
+		return WBEM_E_NOT_FOUND;
+
+	*className = allocString(m_className);
+
+	return WBEM_S_NO_ERROR;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Query if the class derives from another, using the __DERIVATION property.
+
+HRESULT STDMETHODCALLTYPE MemoryObject::InheritsFrom(LPCWSTR ancestor)
+{
+	if (ancestor == nullptr)
+		return WBEM_E_INVALID_PARAMETER;
+
+	const Property* derivation = findProperty(L"__DERIVATION");
+
+	if ( (derivation == nullptr) || (V_VT(&derivation->m_value) != (VT_ARRAY | VT_BSTR)) )
+		return WBEM_S_FALSE;
+
+	SAFEARRAY* array = V_ARRAY(&derivation->m_value);
+	LONG       lower = 0, upper = -1;
+	BSTR*      classes = nullptr;
+
+	::SafeArrayGetLBound(array, 1, &lower);
+	::SafeArrayGetUBound(array, 1, &upper);
+
+	if (FAILED(::SafeArrayAccessData(array, reinterpret_cast<void**>(&classes))))
+		return WBEM_E_FAILED;
+
+	HRESULT result = WBEM_S_FALSE;
+
+	for (LONG i = 0; i <= (upper - lower); ++i)
+	{
+		if ( (classes[i] != nullptr) && (_wcsicmp(classes[i], ancestor) == 0) )
+			result = WBEM_S_NO_ERROR;
+	}
+
+	::SafeArrayUnaccessData(array);
+
+	return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get a copy of the input and output parameters objects for a method.
+
+HRESULT STDMETHODCALLTYPE MemoryObject::GetMethod(LPCWSTR name, long /*flags*/, IWbemClassObject** inSignature, IWbemClassObject** outSignature)
+{
+	if (name == nullptr)
+		return WBEM_E_INVALID_PARAMETER;
+
+	for (Methods::const_iterator it = m_methods.begin(); it != m_methods.end(); ++it)
+	{
+		if (_wcsicmp(it->m_name.c_str(), name) != 0)
+			continue;
+
+		return cloneSignatures(*it, inSignature, outSignature);
+	}
+
+	return WBEM_E_NOT_FOUND;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Add or replace a method.
+
+HRESULT STDMETHODCALLTYPE MemoryObject::PutMethod(LPCWSTR name, long /*flags*/, IWbemClassObject* inSignature, IWbemClassObject* outSignature)
+{
+	if (name == nullptr)
+		return WBEM_E_INVALID_PARAMETER;
+
+	IWbemClassObjectPtr inParams;
+	IWbemClassObjectPtr outParams;
+
+	if (inSignature != nullptr)
+	{
+		inSignature->AddRef();
+		*AttachTo(inParams) = inSignature;
+	}
+
+	if (outSignature != nullptr)
+	{
+		outSignature->AddRef();
+		*AttachTo(outParams) = outSignature;
+	}
+
+	setMethod(name, inParams, outParams);
+
+	return WBEM_S_NO_ERROR;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Remove a method.
+
+HRESULT STDMETHODCALLTYPE MemoryObject::DeleteMethod(LPCWSTR name)
+{
+	if (name == nullptr)
+		return WBEM_E_INVALID_PARAMETER;
+
+	for (Methods::iterator it = m_methods.begin(); it != m_methods.end(); ++it)
+	{
+		if (_wcsicmp(it->m_name.c_str(), name) == 0)
+		{
+			m_methods.erase(it);
+			return WBEM_S_NO_ERROR;
+		}
+	}
+
+	return WBEM_E_NOT_FOUND;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Start enumerating the methods.
+
+HRESULT STDMETHODCALLTYPE MemoryObject::BeginMethodEnumeration(long /*flags*/)
+{
+	m_nextMethod = 0;
+
+	return WBEM_S_NO_ERROR;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the next method and a copy of its input and output parameters objects.
+
+HRESULT STDMETHODCALLTYPE MemoryObject::NextMethod(long /*flags*/, BSTR* name, IWbemClassObject** inSignature, IWbemClassObject** outSignature)
+{
+	if (m_nextMethod == NOT_ENUMERATING)
+		return WBEM_E_UNEXPECTED;
+
+	if (m_nextMethod == m_methods.size())
+		return WBEM_S_NO_MORE_DATA;
+
+	const Method& method = m_methods[m_nextMethod++];
+
+	if (name != nullptr)
+		*name = allocString(method.m_name);
+
+	return cloneSignatures(method, inSignature, outSignature);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Finish enumerating the methods.
+
+HRESULT STDMETHODCALLTYPE MemoryObject::EndMethodEnumeration()
+{
+	m_nextMethod = NOT_ENUMERATING;
+
+	return WBEM_S_NO_ERROR;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Qualifiers are not supported.
+
+HRESULT STDMETHODCALLTYPE MemoryObject::GetMethodQualifierSet(LPCWSTR /*method*/, IWbemQualifierSet** /*qualifiers*/)
+{
+	return WBEM_E_NOT_SUPPORTED;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the class that introduced the method, which is always this one.
+
+HRESULT STDMETHODCALLTYPE MemoryObject::GetMethodOrigin(LPCWSTR methodName, BSTR* className)
+{
+	if ( (methodName == nullptr) || (className == nullptr) )
+		return WBEM_E_INVALID_PARAMETER;
+
+	for (Methods::const_iterator it = m_methods.begin(); it != m_methods.end(); ++it)
+	{
+		if (_wcsicmp(it->m_name.c_str(), methodName) == 0)
+		{
+			*className = allocString(m_className);
+			return WBEM_S_NO_ERROR;
+		}
+	}
+
+	return WBEM_E_NOT_FOUND;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Find a property by name.
+
+MemoryObject::Property* MemoryObject::findProperty(const wchar_t* name)
+{
+	for (Properties::iterator it = m_properties.begin(); it != m_properties.end(); ++it)
+	{
+		if (_wcsicmp(it->m_name.c_str(), name) == 0)
+			return &*it;
+	}
+
+	return nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Find a property by name.
+
+const MemoryObject::Property* MemoryObject::findProperty(const wchar_t* name) const
+{
+	return const_cast<MemoryObject*>(this)->findProperty(name);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Predicate used to order the key properties by name.
+
+static bool compareNames(const tstring& lhs, const tstring& rhs)
+{
+	return (_wcsicmp(lhs.c_str(), rhs.c_str()) < 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Format the relative path from the key properties, which are listed in name
+//! order. An object without keys is treated as a singleton.
+
+tstring MemoryObject::formatRelativePath() const
+{
+	std::vector<tstring> keys;
+
+	for (Properties::const_iterator it = m_properties.begin(); it != m_properties.end(); ++it)
+	{
+		if (it->m_isKey)
+			keys.push_back(it->m_name);
+	}
+
+	if (keys.empty())
+		return m_className + TXT("=@");
+
+	std::sort(keys.begin(), keys.end(), compareNames);
+
+	tstring path = m_className + TXT(".");
+
+	for (size_t i = 0; i != keys.size(); ++i)
+	{
+		const Property* key = findProperty(keys[i].c_str());
+
+		if (i != 0)
+			path += TXT(",");
+
+		path += key->m_name + TXT("=") + formatValue(key->m_value, true);
+	}
+
+	return path;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Copy the input and output parameters objects of a method. A method without
+//! parameters of either kind has a null object for them.
+
+HRESULT MemoryObject::cloneSignatures(const Method& method, IWbemClassObject** inSignature, IWbemClassObject** outSignature)
+{
+	if (inSignature != nullptr)
+		*inSignature = nullptr;
+
+	if (outSignature != nullptr)
+		*outSignature = nullptr;
+
+	if ( (inSignature != nullptr) && (method.m_inParams.get() != nullptr) )
+	{
+		HRESULT result = method.m_inParams->Clone(inSignature);
+
+		if (FAILED(result))
+			return result;
+	}
+
+	if ( (outSignature != nullptr) && (method.m_outParams.get() != nullptr) )
+	{
+		HRESULT result = method.m_outParams->Clone(outSignature);
+
+		if (FAILED(result))
+		{
+			if ( (inSignature != nullptr) && (*inSignature != nullptr) )
+			{
+				(*inSignature)->Release();
+				*inSignature = nullptr;
+			}
+
+			return result;
+		}
+	}
+
+	return WBEM_S_NO_ERROR;
+}
+
+//namespace WMI
+}
@@ -0,0 +1,171 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   MemoryObject.hpp
+//! \brief  The MemoryObject class declaration.
+//! \author Chris Oldwood
+
+// Check for previous inclusion
+#ifndef WMI_MEMORYOBJECT_HPP
+#define WMI_MEMORYOBJECT_HPP
+
+#if _MSC_VER > 1000
+#pragma once
+#endif
+
+#include "Types.hpp"
+#include <Core/NotCopyable.hpp>
+#include <WCL/Variant.hpp>
+#include <vector>
+
+namespace WMI
+{
+
+////////////////////////////////////////////////////////////////////////////////
+//! An in-process implementation of the IWbemClassObject interface that holds
+//! its property values in memory. It allows code written against the WMI COM
+//! types to be exercised without a WMI provider, e.g. by tests and benchmarks.
+//! The __CLASS property is set on construction and the __RELPATH and __PATH
+//! properties are synthesised from the key properties unless set explicitly.
+//! \note Property names are compared case-insensitively, as with WMI.
+
+class MemoryObject : public IWbemClassObject, private Core::NotCopyable
+{
+public:
+	//! Construction with the WMI class name.
+	explicit MemoryObject(const tstring& className);
+
+	//
+	// Properties.
+	//
+
+	//! Get the WMI class name.
+	const tstring& className() const;
+
+	//
+	// Methods.
+	//
+
+	//! Get a reference counted COM interface to the object.
+	IWbemClassObjectPtr getInterface();
+
+	//! Set the value for a property, adding it if necessary.
+	void setProperty(const tstring& name, const VARIANT& value, CIMTYPE type, bool isKey = false);
+
+	//! Set a string property value.
+	void setProperty(const tstring& name, const tstring& value, CIMTYPE type = CIM_STRING, bool isKey = false);
+
+	//! Set a 32-bit integer property value.
+	void setProperty(const tstring& name, int32 value, CIMTYPE type = CIM_SINT32, bool isKey = false);
+
+	//! Set the input and output parameters objects returned for a method.
+	void setMethod(const tstring& name, IWbemClassObjectPtr inParams,
+					IWbemClassObjectPtr outParams = IWbemClassObjectPtr());
+
+	//! Create an in-memory copy of any object.
+	static IWbemClassObjectPtr copy(IWbemClassObjectPtr source); // throw(WMI::Exception)
+
+	//
+	// IUnknown methods.
+	//
+
+	//! Query the object for an interface.
+	virtual HRESULT STDMETHODCALLTYPE QueryInterface(REFIID iid, void** object);
+
+	//! Increment the reference count.
+	virtual ULONG STDMETHODCALLTYPE AddRef();
+
+	//! Decrement the reference count.
+	virtual ULONG STDMETHODCALLTYPE Release();
+
+	//
+	// IWbemClassObject methods.
+	//
+
+	virtual HRESULT STDMETHODCALLTYPE GetQualifierSet(IWbemQualifierSet** qualifiers);
+	virtual HRESULT STDMETHODCALLTYPE Get(LPCWSTR name, long flags, VARIANT* value, CIMTYPE* type, long* flavour);
+	virtual HRESULT STDMETHODCALLTYPE Put(LPCWSTR name, long flags, VARIANT* value, CIMTYPE type);
+	virtual HRESULT STDMETHODCALLTYPE Delete(LPCWSTR name);
+	virtual HRESULT STDMETHODCALLTYPE GetNames(LPCWSTR qualifierName, long flags, VARIANT* qualifierValue, SAFEARRAY** names);
+	virtual HRESULT STDMETHODCALLTYPE BeginEnumeration(long flags);
+	virtual HRESULT STDMETHODCALLTYPE Next(long flags, BSTR* name, VARIANT* value, CIMTYPE* type, long* flavour);
+	virtual HRESULT STDMETHODCALLTYPE EndEnumeration();
+	virtual HRESULT STDMETHODCALLTYPE GetPropertyQualifierSet(LPCWSTR property, IWbemQualifierSet** qualifiers);
+	virtual HRESULT STDMETHODCALLTYPE Clone(IWbemClassObject** copy);
+	virtual HRESULT STDMETHODCALLTYPE GetObjectText(long flags, BSTR* text);
+	virtual HRESULT STDMETHODCALLTYPE SpawnDerivedClass(long flags, IWbemClassObject** newClass);
+	virtual HRESULT STDMETHODCALLTYPE SpawnInstance(long flags, IWbemClassObject** newInstance);
+	virtual HRESULT STDMETHODCALLTYPE CompareTo(long flags, IWbemClassObject* compareTo);
+	virtual HRESULT STDMETHODCALLTYPE GetPropertyOrigin(LPCWSTR name, BSTR* className);
+	virtual HRESULT STDMETHODCALLTYPE InheritsFrom(LPCWSTR ancestor);
+	virtual HRESULT STDMETHODCALLTYPE GetMethod(LPCWSTR name, long flags, IWbemClassObject** inSignature, IWbemClassObject** outSignature);
+	virtual HRESULT STDMETHODCALLTYPE PutMethod(LPCWSTR name, long flags, IWbemClassObject* inSignature, IWbemClassObject* outSignature);
+	virtual HRESULT STDMETHODCALLTYPE DeleteMethod(LPCWSTR name);
+	virtual HRESULT STDMETHODCALLTYPE BeginMethodEnumeration(long flags);
+	virtual HRESULT STDMETHODCALLTYPE NextMethod(long flags, BSTR* name, IWbemClassObject** inSignature, IWbemClassObject** outSignature);
+	virtual HRESULT STDMETHODCALLTYPE EndMethodEnumeration();
+	virtual HRESULT STDMETHODCALLTYPE GetMethodQualifierSet(LPCWSTR method, IWbemQualifierSet** qualifiers);
+	virtual HRESULT STDMETHODCALLTYPE GetMethodOrigin(LPCWSTR methodName, BSTR* className);
+
+private:
+	//! A single property.
+	struct Property
+	{
+		tstring			m_name;		//!< The property name.
+		CIMTYPE			m_type;		//!< The CIM type.
+		WCL::Variant	m_value;	//!< The property value.
+		bool			m_isKey;	//!< Is the property a key?
+	};
+
+	//! A single method.
+	struct Method
+	{
+		tstring				m_name;		//!< The method name.
+		IWbemClassObjectPtr	m_inParams;	//!< The input parameters object.
+		IWbemClassObjectPtr	m_outParams;//!< The output parameters object.
+	};
+
+	//! The property collection type.
+	typedef std::vector<Property> Properties;
+	//! The method collection type.
+	typedef std::vector<Method> Methods;
+
+	//
+	// Members.
+	//
+	LONG		m_refCount;		//!< The COM reference count.
+	tstring		m_className;	//!< The WMI class name.
+	Properties	m_properties;	//!< The property values.
+	Methods		m_methods;		//!< The methods.
+	size_t		m_nextMethod;	//!< The method enumeration position.
+
+	//! Destructor.
+	virtual ~MemoryObject();
+
+	//
+	// Internal methods.
+	//
+
+	//! Find a property by name.
+	Property* findProperty(const wchar_t* name);
+
+	//! Find a property by name.
+	const Property* findProperty(const wchar_t* name) const;
+
+	//! Format the relative path from the key properties.
+	tstring formatRelativePath() const;
+
+	//! Copy the input and output parameters objects of a method.
+	static HRESULT cloneSignatures(const Method& method, IWbemClassObject** inSignature, IWbemClassObject** outSignature);
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the WMI class name.
+
+inline const tstring& MemoryObject::className() const
+{
+	return m_className;
+}
+
+//namespace WMI
+}
+
+#endif // WMI_MEMORYOBJECT_HPP
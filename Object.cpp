@@ -6,10 +6,13 @@
 #include "Common.hpp"
 #include "Object.hpp"
 #include "Exception.hpp"
+#include "ObjectIterator.hpp"
+#include "CriticalSection.hpp"
 #include <WCL/VariantVector.hpp>
 #include <Core/StringUtils.hpp>
 #include <iterator>
 #include <algorithm>
+#include <map>
 
 #ifndef _MSC_VER
 WCL_DECLARE_IFACETRAITS(IWbemServices, IID_IWbemServices);
@@ -19,6 +22,52 @@ WCL_DECLARE_IFACETRAITS(IWbemClassObject, IID_IWbemClassObject);
 namespace WMI
 {
 
+//! The lock guarding the objects' cached paths.
+static CriticalSection s_pathLock;
+
+////////////////////////////////////////////////////////////////////////////////
+//! Format a property value as a WQL literal. Strings are quoted and escaped,
+//! and other types are converted to their textual form. The conversion uses
+//! the invariant locale so that, for example, a real number is not written
+//! with a decimal comma that WQL would not parse.
+
+static tstring formatLiteral(const VARIANT& value)
+{
+	if (V_VT(&value) == VT_BOOL)
+		return (V_BOOL(&value) != VARIANT_FALSE) ? TXT("TRUE") : TXT("FALSE");
+
+	WCL::Variant text;
+
+	HRESULT result = ::VariantChangeTypeEx(&text, const_cast<VARIANT*>(&value), LOCALE_INVARIANT, 0, VT_BSTR);
+
+	if (FAILED(result))
+		throw Exception(result, TXT("Failed to format a key property value for a query"));
+
+	if (V_VT(&value) != VT_BSTR)
+		return V_BSTR(&text);
+
+	tstring literal = TXT("'");
+
+	for (const wchar_t* it = V_BSTR(&text); *it != L'\0'; ++it)
+	{
+		if ( (*it == L'\\') || (*it == L'\'') )
+			literal += TXT('\\');
+
+		literal += *it;
+	}
+
+	return literal + TXT("'");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Append a clause for the WHERE part of an association query, if it has a value.
+
+static void appendClause(tstring& clauses, const tchar* keyword, const tstring& value)
+{
+	if (!value.empty())
+		clauses += Core::fmt(TXT(" %s = %s"), keyword, value.c_str());
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 //! Default constructor.
 
@@ -32,6 +81,18 @@ Object::Object()
 Object::Object(IWbemClassObjectPtr object, const Connection& connection)
 	: m_object(object)
 	, m_connection(connection)
+	, m_path()
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Copy constructor. The cached path is not copied, as another thread could be
+//! caching it, and is parsed again if needed.
+
+Object::Object(const Object& rhs)
+	: m_object(rhs.m_object)
+	, m_connection(rhs.m_connection)
+	, m_path()
 {
 }
 
@@ -42,6 +103,21 @@ Object::~Object()
 {
 }
 
+////////////////////////////////////////////////////////////////////////////////
+//! Assignment operator. The cached path is discarded rather than copied.
+
+Object& Object::operator=(const Object& rhs)
+{
+	if (this != &rhs)
+	{
+		m_object = rhs.m_object;
+		m_connection = rhs.m_connection;
+		m_path = ObjectPath();
+	}
+
+	return *this;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 //! Query if the object has the named property.
 
@@ -100,38 +176,79 @@ size_t Object::getPropertyNames(PropertyNames& names, PropertyTypes types) const
 
 void Object::getProperty(const tstring& name, WCL::Variant& value) const
 {
-	HRESULT result = m_object->Get(WCL::ComStr(name).Get(), 0, &value, nullptr, nullptr);
+	const HRESULT result = tryGetProperty(name, value);
 
 	if (FAILED(result))
 		throw Exception(result, m_object, TXT("Failed to retrieve an objects' property value"));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-//! Create the object used to pass arguments to a method.
+//! Get the value for a property, without throwing on failure. This is the
+//! cheaper way to probe for a property that may not exist.
 
-IWbemClassObjectPtr Object::createArgumentsObject(const tstring& className, const tstring& methodName) const
+HRESULT Object::tryGetProperty(const tstring& name, WCL::Variant& value) const
 {
-	IWbemServicesPtr    connection = m_connection.get();
-	WCL::ComStr         comClassName(className);
-	IWbemClassObjectPtr objectClass;
+	ASSERT(m_connection.affinity().isAccessible());
 
-	HRESULT result = connection->GetObject(comClassName.Get(), 0, nullptr, AttachTo(objectClass), nullptr);
+	ConnectionStats::Timer timer(m_connection.stats().get(), ConnectionStats::GET_PROPERTY);
 
-	if (FAILED(result))
+	HRESULT result = m_object->Get(WCL::ComStr(name).Get(), 0, &value, nullptr, nullptr);
+
+	if (SUCCEEDED(result) && (V_VT(&value) == VT_BSTR))
+		timer.setBytes(::SysStringByteLen(V_BSTR(&value)));
+
+	return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Create the object used to pass arguments to a method. The definition of the
+//! arguments is fetched once per connection and a new instance is spawned from
+//! it for each call. The object is null if the method takes no arguments.
+
+IWbemClassObjectPtr Object::createArgumentsObject(const tstring& className, const tstring& methodName) const
+{
+	IWbemServicesPtr            connection = m_connection.get();
+	const ArgumentTemplatesPtr& templates = m_connection.argumentTemplates();
+	IWbemClassObjectPtr         definition;
+
+	if ( (templates.get() == nullptr) || !templates->find(className, methodName, definition) )
 	{
-		const tstring message = Core::fmt(TXT("Failed to get WMI class definition for '%s'"), className.c_str());
-		throw Exception(result, connection, message.c_str());
+		WCL::ComStr         comClassName(className);
+		IWbemClassObjectPtr objectClass;
+
+		HRESULT result = connection->GetObject(comClassName.Get(), 0, nullptr, AttachTo(objectClass), nullptr);
+
+		if (FAILED(result))
+		{
+			const tstring message = Core::fmt(TXT("Failed to get WMI class definition for '%s'"), className.c_str());
+			throw Exception(result, connection, message.c_str());
+		}
+
+		WCL::ComStr comMethodName(methodName);
+
+		result = objectClass->GetMethod(comMethodName.Get(), 0, AttachTo(definition), nullptr);
+
+		if (FAILED(result))
+		{
+			const tstring message = Core::fmt(TXT("Failed to create WMI arguments object for method '%s'"), methodName.c_str());
+			throw Exception(result, connection, message.c_str());
+		}
+
+		if (templates.get() != nullptr)
+			templates->add(className, methodName, definition);
 	}
 
-	WCL::ComStr         comMethodName(methodName);
+	if (definition.get() == nullptr)
+		return definition;
+
 	IWbemClassObjectPtr arguments;
 
-	result = objectClass->GetMethod(comMethodName.Get(), 0, AttachTo(arguments), nullptr);
+	HRESULT result = definition->SpawnInstance(0, AttachTo(arguments));
 
 	if (FAILED(result))
 	{
 		const tstring message = Core::fmt(TXT("Failed to create WMI arguments object for method '%s'"), methodName.c_str());
-		throw Exception(result, connection, message.c_str());
+		throw Exception(result, definition, message.c_str());
 	}
 
 	return arguments;
@@ -142,19 +259,60 @@ IWbemClassObjectPtr Object::createArgumentsObject(const tstring& className, cons
 
 void Object::execMethod(const tchar* method, WCL::Variant& returnValue)
 {
-	ASSERT(m_connection.isOpen());
-
-	Connection::execMethod(m_connection.get(), get(), relativePath().c_str(), method, returnValue);
+	execMethod(method, IWbemClassObjectPtr(), returnValue);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 //! Execute a method on the object.
 
 void Object::execMethod(const tchar* method, IWbemClassObjectPtr arguments, WCL::Variant& returnValue)
+{
+	IWbemClassObjectPtr results;
+
+	execMethod(method, arguments, returnValue, results);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Execute a method on the object, returning its output parameters. The
+//! arguments are optional.
+
+void Object::execMethod(const tchar* method, IWbemClassObjectPtr arguments, WCL::Variant& returnValue, IWbemClassObjectPtr& results)
+{
+	ASSERT(m_connection.isOpen());
+
+	const tstring       path = relativePath();
+	HostLimiter::Permit permit(m_connection.limiter().get(), HostLimiter::REQUEST, Deadline(), m_connection.stats().get());
+
+	ConnectionStats::Timer timer(m_connection.stats().get(), ConnectionStats::EXEC_METHOD);
+
+	Connection::execMethod(m_connection.get(), get(), path.c_str(), method, arguments, returnValue, results);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Execute a method on the object, without throwing on failure.
+
+HRESULT Object::tryExecMethod(const tchar* method, WCL::Variant& returnValue)
+{
+	return tryExecMethod(method, IWbemClassObjectPtr(), returnValue);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Execute a method on the object, without throwing on failure.
+
+HRESULT Object::tryExecMethod(const tchar* method, IWbemClassObjectPtr arguments, WCL::Variant& returnValue)
 {
 	ASSERT(m_connection.isOpen());
 
-	Connection::execMethod(m_connection.get(), get(), relativePath().c_str(), method, arguments, returnValue);
+	const Result<tstring> path = tryGetProperty<tstring>(TXT("__RelPath"));
+
+	if (path.failed())
+		return path.result();
+
+	HostLimiter::Permit permit(m_connection.limiter().get(), HostLimiter::REQUEST, Deadline(), m_connection.stats().get());
+
+	ConnectionStats::Timer timer(m_connection.stats().get(), ConnectionStats::EXEC_METHOD);
+
+	return Connection::tryExecMethod(m_connection.get(), get(), path.value().c_str(), method, arguments, returnValue);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -174,12 +332,250 @@ void Object::setArgument(IWbemClassObjectPtr arguments, const tstring& name, con
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-//! Refresh the state of the object.
+//! Get an output argument's value, returning false if the method did not set
+//! it, e.g. because it failed.
+
+bool Object::getArgument(IWbemClassObjectPtr results, const tstring& name, WCL::Variant& value)
+{
+	if (results.get() == nullptr)
+		return false;
+
+	WCL::ComStr comName(name);
+
+	HRESULT result = results->Get(comName.Get(), 0, &value, nullptr, nullptr);
+
+	if (FAILED(result))
+	{
+		const tstring message = Core::fmt(TXT("Failed to get '%s' argument"), name.c_str());
+		throw Exception(result, results, message.c_str());
+	}
+
+	return (V_VT(&value) != VT_NULL) && (V_VT(&value) != VT_EMPTY);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Refresh the state of the object. The object is fetched again by path and so
+//! the connection's retry policy, if any, applies.
 
 void Object::refresh()
 {
 	m_object = m_connection.getObject(relativePath()).get();
 }
 
+////////////////////////////////////////////////////////////////////////////////
+//! Query the objects associated with this one, optionally only those through a
+//! specific association class, of a specific class, or where this object plays
+//! a specific role, e.g. the Antecedent in a Win32_DependentService.
+
+ObjectIterator Object::associators(const tstring& assocClass, const tstring& resultClass, const tstring& role) const
+{
+	const tstring query = formatAssociatorsQuery(relativePath(), assocClass, resultClass, role);
+
+	return m_connection.execQuery(query.c_str());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Query the association objects that refer to this one, optionally only those
+//! of a specific class or where this object plays a specific role.
+
+ObjectIterator Object::references(const tstring& resultClass, const tstring& role) const
+{
+	const tstring query = formatReferencesQuery(relativePath(), resultClass, role);
+
+	return m_connection.execQuery(query.c_str());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! The parsed path to the class or instance. The path is fetched and parsed on
+//! first use and then cached, as it does not change when the object is
+//! refreshed, and is shared by relativePath(), execMethod() and refresh(). The
+//! full path is preferred but an object that has not come from a namespace,
+//! such as a method's arguments, only has a relative one.
+//!
+//! The cache is guarded by a lock so that a const object can be shared between
+//! threads. The path is fetched and parsed outside the lock and a path that has
+//! been cached is never changed, so the reference returned stays valid until
+//! the object is assigned to or destroyed.
+
+const ObjectPath& Object::path() const
+{
+	{
+		CriticalSection::Lock lock(s_pathLock);
+
+		if (!m_path.empty())
+			return m_path;
+	}
+
+	WCL::Variant value;
+
+	if (FAILED(tryGetProperty(TXT("__Path"), value)) || (V_VT(&value) != VT_BSTR))
+		getProperty(TXT("__RelPath"), value);
+
+	const ObjectPath parsed(WCL::getValue<tstring>(value));
+
+	CriticalSection::Lock lock(s_pathLock);
+
+	if (m_path.empty())
+		m_path = parsed;
+
+	return m_path;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Format the WQL predicate that selects the instance by its keys, e.g.
+//! "Name = 'Alerter'". Multiple keys are combined with AND, in name order. An
+//! object with no keys, such as a singleton, has an empty predicate.
+
+tstring Object::keyPredicate() const
+{
+	PropertyNames keys;
+
+	getPropertyNames(keys, KEY_PROPERTIES);
+
+	tstring predicate;
+
+	for (PropertyNames::const_iterator it = keys.begin(); it != keys.end(); ++it)
+	{
+		WCL::Variant value;
+
+		getProperty(*it, value);
+
+		if (!predicate.empty())
+			predicate += TXT(" AND ");
+
+		predicate += *it + TXT(" = ") + formatLiteral(value);
+	}
+
+	return predicate;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Refresh the state of a set of objects with a query per class, instead of a
+//! call per object. The objects are grouped by class and each group is
+//! selected by its key values, in batches, and the results are matched back
+//! to the objects by path. The objects must share a connection. Objects that
+//! no longer exist are left unchanged and their positions are returned, in
+//! ascending order, replacing the collection's previous contents.
+
+void Object::refreshAll(const Objects& objects, Indices& vanished, size_t batchSize)
+{
+	ASSERT(batchSize != 0);
+
+	typedef std::map<tstring, Indices> ClassMap;
+
+	ClassMap classes;
+	Indices  missing;
+
+	for (size_t i = 0; i != objects.size(); ++i)
+		classes[objects[i]->getProperty<tstring>(TXT("__CLASS"))].push_back(i);
+
+	for (ClassMap::const_iterator it = classes.begin(); it != classes.end(); ++it)
+	{
+		const Indices& members = it->second;
+
+		for (size_t begin = 0; begin < members.size(); begin += batchSize)
+		{
+			const size_t  end = (members.size() - begin > batchSize) ? (begin + batchSize) : members.size();
+			const Indices batch(members.begin() + begin, members.begin() + end);
+
+			refreshBatch(objects, it->first, batch, missing);
+		}
+	}
+
+	std::sort(missing.begin(), missing.end());
+	vanished.swap(missing);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Refresh a batch of objects of the same class with a single query. Objects
+//! with no keys cannot be selected by a predicate and are refreshed by path.
+
+void Object::refreshBatch(const Objects& objects, const tstring& className, const Indices& batch, Indices& vanished)
+{
+	typedef std::multimap<tstring, size_t> PathMap;
+
+	PathMap paths;
+	tstring predicate;
+
+	for (Indices::const_iterator it = batch.begin(); it != batch.end(); ++it)
+	{
+		Object&       object = *objects[*it];
+		const tstring keys = object.keyPredicate();
+
+		if (keys.empty())
+		{
+			const Result<Object> current = object.m_connection.tryGetObject(object.relativePath());
+
+			if (current.succeeded())
+				object.m_object = current.value().get();
+			else if (current.result() == WBEM_E_NOT_FOUND)
+				vanished.push_back(*it);
+			else
+				throw Exception(current.result(), TXT("Failed to refresh an object"));
+
+			continue;
+		}
+
+		if (!predicate.empty())
+			predicate += TXT(" OR ");
+
+		predicate += TXT("(") + keys + TXT(")");
+
+		paths.insert(std::make_pair(object.relativePath(), *it));
+	}
+
+	if (paths.empty())
+		return;
+
+	const Connection& connection = objects[paths.begin()->second]->m_connection;
+	const tstring     query = TXT("SELECT * FROM ") + className + TXT(" WHERE ") + predicate;
+
+	const ObjectIterator end;
+
+	for (ObjectIterator it = connection.execQuery(query); it != end; ++it)
+	{
+		const std::pair<PathMap::iterator, PathMap::iterator> matches = paths.equal_range(it->relativePath());
+
+		for (PathMap::iterator match = matches.first; match != matches.second; ++match)
+			objects[match->second]->m_object = it->get();
+
+		paths.erase(matches.first, matches.second);
+	}
+
+	for (PathMap::const_iterator it = paths.begin(); it != paths.end(); ++it)
+		vanished.push_back(it->second);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Format the ASSOCIATORS OF query for the objects associated with an object,
+//! e.g. ASSOCIATORS OF {Win32_Service.Name="X"} WHERE AssocClass = Y. An empty
+//! class or role is left out, as is the WHERE when there are no clauses.
+
+tstring Object::formatAssociatorsQuery(const tstring& path, const tstring& assocClass,
+										const tstring& resultClass, const tstring& role)
+{
+	tstring clauses;
+
+	appendClause(clauses, TXT("AssocClass"), assocClass);
+	appendClause(clauses, TXT("ResultClass"), resultClass);
+	appendClause(clauses, TXT("Role"), role);
+
+	return TXT("ASSOCIATORS OF {") + path + TXT("}") + (clauses.empty() ? tstring() : TXT(" WHERE") + clauses);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Format the REFERENCES OF query for the association objects that refer to an
+//! object, e.g. REFERENCES OF {Win32_Service.Name="X"} WHERE ResultClass = Y.
+
+tstring Object::formatReferencesQuery(const tstring& path, const tstring& resultClass, const tstring& role)
+{
+	tstring clauses;
+
+	appendClause(clauses, TXT("ResultClass"), resultClass);
+	appendClause(clauses, TXT("Role"), role);
+
+	return TXT("REFERENCES OF {") + path + TXT("}") + (clauses.empty() ? tstring() : TXT(" WHERE") + clauses);
+}
+
 //namespace WMI
 }
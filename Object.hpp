@@ -13,8 +13,10 @@
 
 #include "Types.hpp"
 #include <set>
+#include <vector>
 #include <WCL/Variant.hpp>
 #include "Connection.hpp"
+#include "ObjectPath.hpp"
 
 namespace WMI
 {
@@ -27,6 +29,10 @@ class Object
 public:
 	//! A set of property names.
 	typedef std::set<tstring> PropertyNames;
+	//! A collection of objects to refresh together.
+	typedef std::vector<Object*> Objects;
+	//! The positions of objects in a collection.
+	typedef std::vector<size_t> Indices;
 
 	//! The property type query flags.
 	enum PropertyTypes
@@ -36,6 +42,7 @@ public:
 		LOCAL_PROPERTIES		= WBEM_FLAG_LOCAL_ONLY,
 		PROPAGATED_PROPERTIES	= WBEM_FLAG_PROPAGATED_ONLY,
 		SYSTEM_PROPERTIES		= WBEM_FLAG_SYSTEM_ONLY,
+		KEY_PROPERTIES			= WBEM_FLAG_KEYS_ONLY,
 	};
 
 public:
@@ -45,9 +52,15 @@ public:
 	//! Construction from the underlying COM object and connection.
 	Object(IWbemClassObjectPtr object, const Connection& connection);
 
+	//! Copy constructor.
+	Object(const Object& rhs);
+
 	//! Destructor.
 	virtual ~Object();
 
+	//! Assignment operator.
+	Object& operator=(const Object& rhs);
+
 	//
 	// Properties.
 	//
@@ -75,6 +88,13 @@ public:
 	template<typename T>
 	T getProperty(const tstring& name) const; // throw(WMI::Exception, ComException)
 
+	//! Get the value for a property, without throwing on failure.
+	HRESULT tryGetProperty(const tstring& name, WCL::Variant& value) const;
+
+	//! Get the property value for an object as a typed value, without throwing on failure.
+	template<typename T>
+	Result<T> tryGetProperty(const tstring& name) const; // throw(ComException)
+
 	//
 	// WMI Object property short-hands.
 	//
@@ -85,6 +105,12 @@ public:
 	//! Relative path to the class or instance.
 	tstring relativePath() const;
 
+	//! The parsed path to the class or instance.
+	const ObjectPath& path() const; // throw(WMI::Exception)
+
+	//! Format the WQL predicate that selects the instance by its keys.
+	tstring keyPredicate() const; // throw(WMI::Exception)
+
 	//
 	// WMI Object methods.
 	//
@@ -98,9 +124,21 @@ public:
 	//! Execute a method on the object.
 	void execMethod(const tchar* method, IWbemClassObjectPtr arguments, WCL::Variant& returnValue); // throw(WMI::Exception)
 
+	//! Execute a method on the object, returning its output parameters.
+	void execMethod(const tchar* method, IWbemClassObjectPtr arguments, WCL::Variant& returnValue, IWbemClassObjectPtr& results); // throw(WMI::Exception)
+
+	//! Execute a method on the object, without throwing on failure.
+	HRESULT tryExecMethod(const tchar* method, WCL::Variant& returnValue);
+
+	//! Execute a method on the object, without throwing on failure.
+	HRESULT tryExecMethod(const tchar* method, IWbemClassObjectPtr arguments, WCL::Variant& returnValue);
+
 	//! Set an argument's value.
 	static void setArgument(IWbemClassObjectPtr arguments, const tstring& name, const WCL::Variant& value);
 
+	//! Get an output argument's value, if it was set.
+	static bool getArgument(IWbemClassObjectPtr results, const tstring& name, WCL::Variant& value); // throw(WMI::Exception)
+
 	//
 	// Methods.
 	//
@@ -108,6 +146,35 @@ public:
 	//! Refresh the state of the object.
 	void refresh();
 
+	//! Query the objects associated with this one.
+	ObjectIterator associators(const tstring& assocClass = TXT(""), const tstring& resultClass = TXT(""),
+								const tstring& role = TXT("")) const; // throw(WMI::Exception)
+
+	//! Query the association objects that refer to this one.
+	ObjectIterator references(const tstring& resultClass = TXT(""), const tstring& role = TXT("")) const; // throw(WMI::Exception)
+
+	//
+	// Class methods.
+	//
+
+	//! Format the ASSOCIATORS OF query for the objects associated with an object.
+	static tstring formatAssociatorsQuery(const tstring& path, const tstring& assocClass,
+											const tstring& resultClass, const tstring& role);
+
+	//! Format the REFERENCES OF query for the association objects that refer to an object.
+	static tstring formatReferencesQuery(const tstring& path, const tstring& resultClass, const tstring& role);
+
+	//! Refresh the state of a set of objects with a query per class.
+	static void refreshAll(const Objects& objects, Indices& vanished,
+							size_t batchSize = REFRESH_BATCH_SIZE); // throw(WMI::Exception)
+
+	//
+	// Constants.
+	//
+
+	//! The default maximum number of objects refreshed by a single query.
+	static const size_t REFRESH_BATCH_SIZE = 50;
+
 private:
 	//
 	// Members.
@@ -115,6 +182,14 @@ private:
 	//
 	mutable IWbemClassObjectPtr	m_object;		//! The underlying COM object.
 	Connection					m_connection;	//! The object's connection.
+	mutable ObjectPath			m_path;			//! The cached path, parsed on first use.
+
+	//
+	// Internal methods.
+	//
+
+	//! Refresh a batch of objects of the same class with a single query.
+	static void refreshBatch(const Objects& objects, const tstring& className, const Indices& batch, Indices& vanished); // throw(WMI::Exception)
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -146,12 +221,34 @@ inline T Object::getProperty(const tstring& name) const
 	return WCL::getValue<T>(value);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+//! Get the property value for an object as a typed value, without throwing if
+//! the property cannot be retrieved. A value that cannot be converted to the
+//! type still throws as that is a programming error.
+
+template<typename T>
+inline Result<T> Object::tryGetProperty(const tstring& name) const
+{
+	WCL::Variant  value;
+	const HRESULT result = tryGetProperty(name, value);
+
+	if (FAILED(result))
+		return Result<T>::failure(result);
+
+	return Result<T>::success(WCL::getValue<T>(value));
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 //! Full path to the class or instance - including server and namespace.
 
 inline tstring Object::absolutePath() const
 {
-	return getProperty<tstring>(TXT("__Path"));
+	const ObjectPath& objectPath = path();
+
+	if (objectPath.isRelative())
+		return getProperty<tstring>(TXT("__Path"));
+
+	return objectPath.toString();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -159,7 +256,7 @@ inline tstring Object::absolutePath() const
 
 inline tstring Object::relativePath() const
 {
-	return getProperty<tstring>(TXT("__RelPath"));
+	return path().relativePath();
 }
 
 //namespace WMI
@@ -6,7 +6,9 @@
 #include "Common.hpp"
 #include "ObjectIterator.hpp"
 #include "Exception.hpp"
+#include "Stopwatch.hpp"
 #include <Core/BadLogicException.hpp>
+#include <algorithm>
 
 #ifndef _MSC_VER
 WCL_DECLARE_IFACETRAITS(IWbemClassObject, IID_IWbemClassObject);
@@ -16,6 +18,10 @@ WCL_DECLARE_IFACETRAITS(IEnumWbemClassObject, IID_IEnumWbemClassObject);
 namespace WMI
 {
 
+//! The longest time, in milliseconds, to wait for an object before checking
+//! the cancellation token.
+static const long CANCELLATION_POLL_INTERVAL = 100;
+
 ////////////////////////////////////////////////////////////////////////////////
 //! Constructor for the End iterator.
 
@@ -23,6 +29,9 @@ ObjectIterator::ObjectIterator()
 	: m_enumerator()
 	, m_connection()
 	, m_value()
+	, m_deadline()
+	, m_token()
+	, m_batch()
 {
 }
 
@@ -33,10 +42,45 @@ ObjectIterator::ObjectIterator(IEnumWbemClassObjectPtr enumerator, const Connect
 	: m_enumerator(enumerator)
 	, m_connection(connection)
 	, m_value()
+	, m_deadline()
+	, m_token()
+	, m_batch(new Batch(connection.batchSize(), connection.batchBudget()))
 {
 	increment();
 }
 
+////////////////////////////////////////////////////////////////////////////////
+//! Constructor for the Begin iterator that returns any error from fetching the
+//! first object instead of throwing.
+
+ObjectIterator::ObjectIterator(IEnumWbemClassObjectPtr enumerator, const Connection& connection, HRESULT& result)
+	: m_enumerator(enumerator)
+	, m_connection(connection)
+	, m_value()
+	, m_deadline()
+	, m_token()
+	, m_batch(new Batch(connection.batchSize(), connection.batchBudget()))
+{
+	result = tryIncrement();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Constructor for a Begin iterator with a deadline and cancellation token that
+//! apply to the entire enumeration. Any error from fetching the first object is
+//! returned instead of thrown.
+
+ObjectIterator::ObjectIterator(IEnumWbemClassObjectPtr enumerator, const Connection& connection,
+								const Deadline& deadline, CancellationTokenPtr token, HRESULT& result)
+	: m_enumerator(enumerator)
+	, m_connection(connection)
+	, m_value()
+	, m_deadline(deadline)
+	, m_token(token)
+	, m_batch(new Batch(connection.batchSize(), connection.batchBudget()))
+{
+	result = tryIncrement();
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 //! Destructor.
 
@@ -79,35 +123,171 @@ bool ObjectIterator::equals(const ObjectIterator& rhs) const
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-//! Move the iterator forward.
+//! Get the number of objects that will be requested by the next call to the
+//! enumerator, or zero for the End iterator.
 
-void ObjectIterator::increment()
+size_t ObjectIterator::batchSize() const
 {
-	ASSERT(m_enumerator.get() != nullptr);
+	if (m_batch.get() == nullptr)
+		return 0;
 
-	// Request the next item.
-	IWbemClassObjectPtr	value;
-	ULONG				avail = 0;
+	return m_batch->size();
+}
 
-	HRESULT result = m_enumerator->Next(WBEM_INFINITE, 1, AttachTo(value), &avail);
+////////////////////////////////////////////////////////////////////////////////
+//! Move the iterator forward.
+
+void ObjectIterator::increment()
+{
+	const HRESULT result = tryIncrement();
 
 	if (FAILED(result))
 		throw Exception(result, m_enumerator, TXT("Failed to advance the WMI object enumerator"));
+}
 
-	// Continued enumeration?
-	if (avail != 0)
+////////////////////////////////////////////////////////////////////////////////
+//! Move the iterator forward, without throwing on failure. The iterator is
+//! left unchanged if the next batch of objects cannot be fetched.
+
+HRESULT ObjectIterator::tryIncrement()
+{
+	ASSERT(m_enumerator.get() != nullptr);
+	ASSERT(m_connection.affinity().isAccessible());
+
+	Batch& batch = *m_batch;
+
+	// Current batch exhausted?
+	if (batch.m_next == batch.m_objects.size())
 	{
-		ASSERT(avail == 1);
+		if (!batch.m_finished)
+		{
+			const HRESULT result = fetch();
+
+			if (FAILED(result))
+				return result;
+		}
 
-		m_value.reset(new Object(value, m_connection));
+		// End reached.
+		if (batch.m_objects.empty())
+		{
+			reset();
+			return WBEM_S_FALSE;
+		}
 	}
-	// End reached.
-	else
+
+	m_value.reset(new Object(batch.m_objects[batch.m_next], m_connection));
+
+	// Only the current value holds the object from now on.
+	batch.m_objects[batch.m_next++].Release();
+
+	return WBEM_S_NO_ERROR;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Fetch the next batch of objects from the enumerator. A batch smaller than
+//! requested means that the end of the sequence has been reached.
+//!
+//! When there is a deadline or cancellation token the wait for the batch is
+//! split into slices, with WBEM_S_TIMEDOUT returned by the enumerator at the
+//! end of each, so that the deadline and token can be checked. Any objects that
+//! arrived before a slice ended are returned as a smaller batch. An expired
+//! deadline fails with WBEM_E_TIMED_OUT and a cancellation with
+//! WBEM_E_CALL_CANCELLED. The query is abandoned when the iterator is destroyed.
+//!
+//! A slot is taken from the connection's host limiter, if set, for the call but
+//! not between calls, so that nested queries to the same host cannot deadlock.
+//!
+//! In the adaptive mode the duration of each call that was not cut short by the
+//! end of a slice is recorded to choose the size of the next batch.
+
+HRESULT ObjectIterator::fetch()
+{
+	Batch& batch = *m_batch;
+
+	const size_t size = batch.size();
+	ULONG avail = 0;
+	int64 start = 0;
+
+	HRESULT result;
+
+	// Only grow the buffer so that enumerating doesn't allocate per batch.
+	if (batch.m_buffer.size() < size)
+		batch.m_buffer.resize(size, static_cast<IWbemClassObject*>(nullptr));
+
+	HostLimiter::Permit permit(m_connection.limiter().get(), HostLimiter::CONTINUATION, m_deadline, m_connection.stats().get());
+
+	if (!permit.acquired())
+		return WBEM_E_TIMED_OUT;
+
 	{
-		ASSERT(result == S_FALSE);
+		ConnectionStats::Timer timer(m_connection.stats().get(), ConnectionStats::ENUM_NEXT);
+
+		do
+		{
+			if ( (m_token.get() != nullptr) && m_token->isCancelled() )
+				return WBEM_E_CALL_CANCELLED;
+
+			long timeout = m_deadline.remaining();
 
-		reset();
+			if (timeout == 0)
+				return WBEM_E_TIMED_OUT;
+
+			if ( (m_token.get() != nullptr) && (m_deadline.isInfinite() || (timeout > CANCELLATION_POLL_INTERVAL)) )
+				timeout = CANCELLATION_POLL_INTERVAL;
+
+			start = Stopwatch::ticks();
+			result = m_enumerator->Next(timeout, static_cast<ULONG>(size), &batch.m_buffer[0], &avail);
+		}
+		while ( (result == WBEM_S_TIMEDOUT) && (avail == 0) );
+
+		timer.setObjects(avail);
 	}
+
+	if (FAILED(result))
+		return result;
+
+	ASSERT(avail <= size);
+
+	if ( (batch.m_size == Connection::ADAPTIVE_BATCH_SIZE) && (result != WBEM_S_TIMEDOUT) )
+		batch.m_sizer.record(avail, Stopwatch::ticksToMicroseconds(Stopwatch::ticks() - start));
+
+	batch.m_objects.clear();
+	batch.m_next = 0;
+
+	for (ULONG i = 0; i != avail; ++i)
+		batch.m_objects.push_back(IWbemClassObjectPtr(batch.m_buffer[i]));
+
+	if (result == WBEM_S_FALSE)
+		batch.m_finished = true;
+
+	return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Construction with the fixed batch size, or ADAPTIVE_BATCH_SIZE, and the most
+//! objects to fetch at once.
+
+ObjectIterator::Batch::Batch(size_t size, size_t budget)
+	: m_objects()
+	, m_buffer()
+	, m_next(0)
+	, m_finished(false)
+	, m_size(size)
+	, m_budget(budget)
+	, m_sizer(budget)
+{
+	ASSERT(budget != 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the number of objects to request next.
+
+size_t ObjectIterator::Batch::size() const
+{
+	if (m_size == Connection::ADAPTIVE_BATCH_SIZE)
+		return m_sizer.size();
+
+	return std::min(m_size, m_budget);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -117,6 +297,7 @@ void ObjectIterator::reset()
 {
 	m_value.reset();
 	m_enumerator.Release();
+	m_batch.reset();
 }
 
 //namespace WMI
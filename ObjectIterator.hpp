@@ -14,7 +14,11 @@
 #include <WCL/ComPtr.hpp>
 #include <wbemidl.h>
 #include "Object.hpp"
+#include "Deadline.hpp"
+#include "CancellationToken.hpp"
+#include "BatchSizer.hpp"
 #include <Core/SharedPtr.hpp>
+#include <vector>
 
 namespace WMI
 {
@@ -23,6 +27,10 @@ namespace WMI
 //! The iterator type used for collections of WBEM Class Objects.
 //! \note Although the iterator is copyable it only creates a shallow copy of
 //! the underlying COM object and so cannot be independently advanced.
+//!
+//! The objects are requested from the enumerator in batches, whose size is set
+//! on the connection. In the adaptive mode the size is tuned from the duration
+//! of each call, within the connection's budget for the objects held at once.
 
 class ObjectIterator
 {
@@ -33,6 +41,13 @@ public:
 	//! Constructor for the Begin iterator.
 	ObjectIterator(IEnumWbemClassObjectPtr enumerator, const Connection& connection); // throw(WMI::Exception)
 
+	//! Constructor for the Begin iterator that returns any error instead of throwing.
+	ObjectIterator(IEnumWbemClassObjectPtr enumerator, const Connection& connection, HRESULT& result);
+
+	//! Constructor for a Begin iterator with a deadline and cancellation token.
+	ObjectIterator(IEnumWbemClassObjectPtr enumerator, const Connection& connection,
+					const Deadline& deadline, CancellationTokenPtr token, HRESULT& result);
+
 	//! Destructor.
 	~ObjectIterator();
 
@@ -56,16 +71,47 @@ public:
 	//! Compare to another iterator for equivalence.
 	bool equals(const ObjectIterator& rhs) const;
 
+	//
+	// Properties.
+	//
+
+	//! Get the number of objects that will be requested by the next call.
+	size_t batchSize() const;
+
 private:
 	//! The value shared pointer type.
 	typedef Core::SharedPtr<Object> ValuePtr;
 
+	//! The objects fetched ahead of the current one, shared by the copies.
+	struct Batch
+	{
+		//! Construction with the fixed size, or adaptive, and the budget.
+		Batch(size_t size, size_t budget);
+
+		//! Get the number of objects to request next.
+		size_t size() const;
+
+		std::vector<IWbemClassObjectPtr> m_objects;	//!< The last batch fetched.
+		std::vector<IWbemClassObject*> m_buffer;	//!< The raw pointers filled by Next(), reused between batches.
+		size_t		m_next;		//!< The index of the next object to return.
+		bool		m_finished;	//!< Has the last object been fetched?
+		size_t		m_size;		//!< The fixed batch size, or 0 if adaptive.
+		size_t		m_budget;	//!< The most objects to fetch at once.
+		BatchSizer	m_sizer;	//!< Chooses the adaptive batch size.
+	};
+
+	//! The batch shared pointer type.
+	typedef Core::SharedPtr<Batch> BatchPtr;
+
 	//
 	// Members.
 	//
 	IEnumWbemClassObjectPtr	m_enumerator;	//!< The underlying WMI iterator.
 	Connection				m_connection;	//!< The iterator's connection.
 	ValuePtr				m_value;		//!< The current iterator value.
+	Deadline				m_deadline;		//!< The deadline for the enumeration.
+	CancellationTokenPtr	m_token;		//!< The token used to cancel the enumeration.
+	BatchPtr				m_batch;		//!< The objects fetched but not yet returned.
 
 	//
 	// Internal methods.
@@ -74,6 +120,12 @@ private:
 	//! Move the iterator forward.
 	void increment();
 
+	//! Move the iterator forward, without throwing on failure.
+	HRESULT tryIncrement();
+
+	//! Fetch the next batch of objects from the enumerator.
+	HRESULT fetch();
+
 	//! Move the iterator to the End.
 	void reset();
 };
@@ -0,0 +1,294 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   ObjectPath.cpp
+//! \brief  The ObjectPath class definition.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include "ObjectPath.hpp"
+#include "Exception.hpp"
+#include <Core/StringUtils.hpp>
+
+namespace WMI
+{
+
+////////////////////////////////////////////////////////////////////////////////
+//! Query if a character separates the server from the namespace.
+
+static bool isSeparator(tchar c)
+{
+	return (c == TXT('\\')) || (c == TXT('/'));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Default constructor.
+
+ObjectPath::ObjectPath()
+	: m_text()
+	, m_relative(0)
+	, m_keys()
+	, m_singleton(false)
+{
+	m_server.m_offset = m_namespace.m_offset = m_class.m_offset = 0;
+	m_server.m_length = m_namespace.m_length = m_class.m_length = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Construction by parsing the path, which may be absolute or relative.
+
+ObjectPath::ObjectPath(const tstring& path)
+	: m_text(path)
+	, m_relative(0)
+	, m_keys()
+	, m_singleton(false)
+{
+	m_server.m_offset = m_namespace.m_offset = m_class.m_offset = 0;
+	m_server.m_length = m_namespace.m_length = m_class.m_length = 0;
+
+	parse();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the name of a key. The name is empty when it is implied, as in a path
+//! to a class with a single key, e.g. Win32_Directory="C:\\".
+
+tstring ObjectPath::keyName(size_t index) const
+{
+	ASSERT(index < m_keys.size());
+
+	return copy(m_keys[index].m_name);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the value of a key, with any quotes and escaping removed. Only values
+//! that contain escape characters need to be unescaped.
+
+tstring ObjectPath::keyValue(size_t index) const
+{
+	ASSERT(index < m_keys.size());
+
+	const Key& key = m_keys[index];
+
+	if (!key.m_escaped)
+		return copy(key.m_value);
+
+	const tchar* it = m_text.c_str() + key.m_value.m_offset;
+	const tchar* end = it + key.m_value.m_length;
+
+	tstring value;
+
+	value.reserve(key.m_value.m_length);
+
+	for (; it != end; ++it)
+	{
+		if (*it == TXT('\\'))
+			++it;
+
+		value += *it;
+	}
+
+	return value;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Find the value of a key by name, ignoring case as WMI does. An implied key
+//! name only matches an empty name.
+
+bool ObjectPath::findKey(const tstring& name, tstring& value) const
+{
+	for (size_t i = 0; i != m_keys.size(); ++i)
+	{
+		const Range& key = m_keys[i].m_name;
+
+		if ( (key.m_length == name.length())
+		  && (_wcsnicmp(m_text.c_str() + key.m_offset, name.c_str(), key.m_length) == 0) )
+		{
+			value = keyValue(i);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Parse the path text. The server, which may contain dots, is skipped first
+//! and then the namespace is separated from the class by the first colon
+//! before the keys.
+
+void ObjectPath::parse()
+{
+	const size_t length = m_text.length();
+
+	size_t start = 0;
+
+	if ( (length > 2) && isSeparator(m_text[0]) && isSeparator(m_text[1]) )
+	{
+		size_t separator = 2;
+
+		while ( (separator != length) && !isSeparator(m_text[separator]) )
+			++separator;
+
+		if ( (separator == 2) || (separator == length) )
+			throwInvalid();
+
+		m_server.m_offset = 2;
+		m_server.m_length = separator - 2;
+
+		start = separator + 1;
+	}
+
+	// Find the end of the class name, and any namespace before it.
+	size_t end = start;
+	size_t colon = tstring::npos;
+
+	for (; end != length; ++end)
+	{
+		const tchar c = m_text[end];
+
+		if ( (c == TXT('.')) || (c == TXT('=')) || (c == TXT('"')) )
+			break;
+
+		if ( (c == TXT(':')) && (colon == tstring::npos) )
+			colon = end;
+	}
+
+	if (colon != tstring::npos)
+	{
+		m_namespace.m_offset = start;
+		m_namespace.m_length = colon - start;
+		m_relative = colon + 1;
+	}
+	else if (start != 0)
+	{
+		throwInvalid();
+	}
+
+	m_class.m_offset = m_relative;
+	m_class.m_length = end - m_relative;
+
+	if (m_class.m_length == 0)
+		throwInvalid();
+
+	// A path to a class.
+	if (end == length)
+		return;
+
+	if (m_text[end] == TXT('.'))
+	{
+		parseKeys(end + 1);
+	}
+	else if (m_text[end] == TXT('='))
+	{
+		if (m_text.compare(end + 1, tstring::npos, TXT("@")) == 0)
+		{
+			m_singleton = true;
+			return;
+		}
+
+		Key key;
+
+		key.m_name.m_offset = end;
+		key.m_name.m_length = 0;
+
+		if (parseValue(end + 1, key) != length)
+			throwInvalid();
+
+		m_keys.push_back(key);
+	}
+	else
+	{
+		throwInvalid();
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Parse the named keys, e.g. Name="Alerter",Type=1, starting after the class
+//! name.
+
+void ObjectPath::parseKeys(size_t offset)
+{
+	const size_t length = m_text.length();
+
+	for (;;)
+	{
+		const size_t equals = m_text.find(TXT('='), offset);
+
+		if ( (equals == tstring::npos) || (equals == offset) )
+			throwInvalid();
+
+		Key key;
+
+		key.m_name.m_offset = offset;
+		key.m_name.m_length = equals - offset;
+
+		offset = parseValue(equals + 1, key);
+
+		m_keys.push_back(key);
+
+		if (offset == length)
+			break;
+
+		if (m_text[offset] != TXT(','))
+			throwInvalid();
+
+		++offset;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Parse a key value, returning the position after it. A string value is
+//! quoted and may contain backslash escaped characters, other values run up to
+//! the next key.
+
+size_t ObjectPath::parseValue(size_t offset, Key& key)
+{
+	const size_t length = m_text.length();
+
+	key.m_escaped = false;
+
+	if ( (offset != length) && (m_text[offset] == TXT('"')) )
+	{
+		size_t end = offset + 1;
+
+		for (; (end < length) && (m_text[end] != TXT('"')); ++end)
+		{
+			if (m_text[end] == TXT('\\'))
+			{
+				key.m_escaped = true;
+				++end;
+			}
+		}
+
+		if (end >= length)
+			throwInvalid();
+
+		key.m_value.m_offset = offset + 1;
+		key.m_value.m_length = end - offset - 1;
+
+		return end + 1;
+	}
+
+	size_t end = offset;
+
+	while ( (end != length) && (m_text[end] != TXT(',')) )
+		++end;
+
+	if (end == offset)
+		throwInvalid();
+
+	key.m_value.m_offset = offset;
+	key.m_value.m_length = end - offset;
+
+	return end;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Throw an exception for an invalid path.
+
+void ObjectPath::throwInvalid() const
+{
+	throw Exception(WBEM_E_INVALID_OBJECT_PATH, Core::fmt(TXT("Failed to parse the object path '%s'"), m_text.c_str()).c_str());
+}
+
+//namespace WMI
+}
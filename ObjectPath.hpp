@@ -0,0 +1,212 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   ObjectPath.hpp
+//! \brief  The ObjectPath class declaration.
+//! \author Chris Oldwood
+
+// Check for previous inclusion
+#ifndef WMI_OBJECTPATH_HPP
+#define WMI_OBJECTPATH_HPP
+
+#if _MSC_VER > 1000
+#pragma once
+#endif
+
+#include <vector>
+
+namespace WMI
+{
+
+////////////////////////////////////////////////////////////////////////////////
+//! A parsed WMI object path, e.g. \\\\HOST\\root\\cimv2:Win32_Service.Name="Alerter".
+//! The path is held as the original text with the position of each part, and
+//! so a part is only copied when it is requested. The server and namespace are
+//! optional, as in a relative path. A singleton has the key "@" and a class
+//! with a single key may omit the key name.
+
+class ObjectPath
+{
+public:
+	//! Default constructor.
+	ObjectPath();
+
+	//! Construction by parsing the path.
+	explicit ObjectPath(const tstring& path); // throw(WMI::Exception)
+
+	//
+	// Properties.
+	//
+
+	//! Query if the path is empty.
+	bool empty() const;
+
+	//! Query if the path has no server or namespace.
+	bool isRelative() const;
+
+	//! Query if the path is to a singleton instance.
+	bool isSingleton() const;
+
+	//! Get the server name.
+	tstring server() const;
+
+	//! Get the namespace.
+	tstring nmspace() const;
+
+	//! Get the class name.
+	tstring className() const;
+
+	//! Get the relative path, i.e. the class and keys.
+	tstring relativePath() const;
+
+	//! Get the full path as parsed.
+	const tstring& toString() const;
+
+	//! Get the number of keys.
+	size_t keyCount() const;
+
+	//! Get the name of a key. The name is empty when it is implied.
+	tstring keyName(size_t index) const;
+
+	//! Get the value of a key, with any quotes and escaping removed.
+	tstring keyValue(size_t index) const;
+
+	//
+	// Methods.
+	//
+
+	//! Find the value of a key by name, ignoring case.
+	bool findKey(const tstring& name, tstring& value) const;
+
+private:
+	//! A part of the path.
+	struct Range
+	{
+		size_t	m_offset;	//!< The position of the first character.
+		size_t	m_length;	//!< The number of characters.
+	};
+
+	//! A key and its value.
+	struct Key
+	{
+		Range	m_name;		//!< The key name, which may be empty.
+		Range	m_value;	//!< The value, inside any quotes.
+		bool	m_escaped;	//!< Whether the value contains escape characters.
+	};
+
+	//! The collection of keys.
+	typedef std::vector<Key> Keys;
+
+	//
+	// Members.
+	//
+	tstring	m_text;			//!< The path as parsed.
+	Range	m_server;		//!< The server name.
+	Range	m_namespace;	//!< The namespace.
+	Range	m_class;		//!< The class name.
+	size_t	m_relative;		//!< The position of the relative path.
+	Keys	m_keys;			//!< The keys, in path order.
+	bool	m_singleton;	//!< Whether the path is to a singleton.
+
+	//
+	// Internal methods.
+	//
+
+	//! Parse the path text.
+	void parse(); // throw(WMI::Exception)
+
+	//! Parse the named keys, starting after the class name.
+	void parseKeys(size_t offset); // throw(WMI::Exception)
+
+	//! Parse a key value, returning the position after it.
+	size_t parseValue(size_t offset, Key& key); // throw(WMI::Exception)
+
+	//! Throw an exception for an invalid path.
+	void throwInvalid() const; // throw(WMI::Exception)
+
+	//! Copy a part of the path.
+	tstring copy(const Range& range) const;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//! Query if the path is empty.
+
+inline bool ObjectPath::empty() const
+{
+	return m_text.empty();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Query if the path has no server or namespace.
+
+inline bool ObjectPath::isRelative() const
+{
+	return (m_relative == 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Query if the path is to a singleton instance.
+
+inline bool ObjectPath::isSingleton() const
+{
+	return m_singleton;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the server name.
+
+inline tstring ObjectPath::server() const
+{
+	return copy(m_server);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the namespace.
+
+inline tstring ObjectPath::nmspace() const
+{
+	return copy(m_namespace);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the class name.
+
+inline tstring ObjectPath::className() const
+{
+	return copy(m_class);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the relative path, i.e. the class and keys.
+
+inline tstring ObjectPath::relativePath() const
+{
+	return m_text.substr(m_relative);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the full path as parsed.
+
+inline const tstring& ObjectPath::toString() const
+{
+	return m_text;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the number of keys.
+
+inline size_t ObjectPath::keyCount() const
+{
+	return m_keys.size();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Copy a part of the path.
+
+inline tstring ObjectPath::copy(const Range& range) const
+{
+	return m_text.substr(range.m_offset, range.m_length);
+}
+
+//namespace WMI
+}
+
+#endif // WMI_OBJECTPATH_HPP
@@ -0,0 +1,46 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   ParallelForEach.cpp
+//! \brief  The ParallelForEach class definition.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include "ParallelForEach.hpp"
+#include "ObjectIterator.hpp"
+#include "MemoryObject.hpp"
+
+namespace WMI
+{
+
+////////////////////////////////////////////////////////////////////////////////
+//! Construction with the number of workers, or one per processor if 0.
+
+ParallelForEach::ParallelForEach(size_t workers)
+	: m_pool(workers)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Destructor.
+
+ParallelForEach::~ParallelForEach()
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Read the remaining rows of a query into memory. The rows are copied so that
+//! they can be read on any thread without marshalling. Returns the number of
+//! rows added.
+
+size_t ParallelForEach::materialise(ObjectIterator it, Rows& rows)
+{
+	const size_t         count = rows.size();
+	const ObjectIterator end;
+
+	for (; it != end; ++it)
+		rows.push_back(MemoryObject::copy(it->get()));
+
+	return rows.size() - count;
+}
+
+//namespace WMI
+}
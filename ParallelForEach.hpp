@@ -0,0 +1,187 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   ParallelForEach.hpp
+//! \brief  The ParallelForEach class declaration.
+//! \author Chris Oldwood
+
+// Check for previous inclusion
+#ifndef WMI_PARALLELFOREACH_HPP
+#define WMI_PARALLELFOREACH_HPP
+
+#if _MSC_VER > 1000
+#pragma once
+#endif
+
+#include "WorkStealingPool.hpp"
+#include "MarshalledConnection.hpp"
+#include "Object.hpp"
+#include <vector>
+
+namespace WMI
+{
+
+// Forward declarations.
+class ObjectIterator;
+
+////////////////////////////////////////////////////////////////////////////////
+//! Applies a function to every row of a query result on a WorkStealingPool.
+//! The result is first materialised as in-memory copies of the objects, which
+//! are not tied to an apartment, and each worker gets its own connection via
+//! a MarshalledConnection.
+//!
+//! The function is a copyable Reducer type with the signature
+//! void operator()(const Object& row). Each worker gets its own copy of the
+//! reducer, which is initialised from a prototype, and so can accumulate
+//! results without any locking. The per-worker reducers are returned so that
+//! the caller can merge them.
+
+class ParallelForEach : private Core::NotCopyable
+{
+public:
+	//! The materialised rows of a query.
+	typedef std::vector<IWbemClassObjectPtr> Rows;
+
+public:
+	//! Construction with the number of workers, or one per processor if 0.
+	explicit ParallelForEach(size_t workers = 0);
+
+	//! Destructor.
+	~ParallelForEach();
+
+	//
+	// Properties.
+	//
+
+	//! Get the number of workers.
+	size_t workers() const;
+
+	//
+	// Methods.
+	//
+
+	//! Apply a reducer to every row, returning the reducer used by each worker.
+	template<typename Reducer>
+	void run(const Connection& connection, const Rows& rows, const Reducer& prototype,
+				std::vector<Reducer>& reducers, size_t chunkSize = WorkStealingPool::DEFAULT_CHUNK_SIZE); // throw(WMI::Exception)
+
+	//
+	// Class methods.
+	//
+
+	//! Read the remaining rows of a query into memory.
+	static size_t materialise(ObjectIterator it, Rows& rows); // throw(WMI::Exception)
+
+private:
+	//! The pool task that applies the reducers to the rows.
+	template<typename Reducer>
+	class ForEachTask : public WorkStealingPool::Task
+	{
+	public:
+		//! Constructor.
+		ForEachTask(const Connection& connection, const Rows& rows, std::vector<Reducer>& reducers); // throw(WMI::Exception)
+
+		//! Destructor.
+		virtual ~ForEachTask();
+
+		//! Unmarshal the connection for the worker.
+		virtual void startWorker(size_t worker); // throw(WMI::Exception)
+
+		//! Apply the worker's reducer to a range of rows.
+		virtual void process(size_t worker, size_t begin, size_t end);
+
+		//! Release the worker's connection.
+		virtual void stopWorker(size_t worker);
+
+	private:
+		//
+		// Members.
+		//
+		MarshalledConnection	m_connection;	//!< The connection to hand to the workers.
+		const Rows&				m_rows;			//!< The rows to process.
+		std::vector<Reducer>&	m_reducers;		//!< The reducers, by worker.
+		std::vector<Connection>	m_connections;	//!< The unmarshalled connections, by worker.
+	};
+
+	//
+	// Members.
+	//
+	WorkStealingPool	m_pool;		//!< The worker threads.
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the number of workers.
+
+inline size_t ParallelForEach::workers() const
+{
+	return m_pool.workers();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Apply a reducer to every row, returning the reducer used by each worker.
+//! The connection must be usable on the calling thread.
+
+template<typename Reducer>
+inline void ParallelForEach::run(const Connection& connection, const Rows& rows, const Reducer& prototype,
+									std::vector<Reducer>& reducers, size_t chunkSize)
+{
+	reducers.assign(m_pool.workers(), prototype);
+
+	ForEachTask<Reducer> task(connection, rows, reducers);
+
+	m_pool.run(task, rows.size(), chunkSize);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Constructor.
+
+template<typename Reducer>
+inline ParallelForEach::ForEachTask<Reducer>::ForEachTask(const Connection& connection, const Rows& rows, std::vector<Reducer>& reducers)
+	: m_connection(connection)
+	, m_rows(rows)
+	, m_reducers(reducers)
+	, m_connections(reducers.size())
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Destructor.
+
+template<typename Reducer>
+inline ParallelForEach::ForEachTask<Reducer>::~ForEachTask()
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Unmarshal the connection for the worker.
+
+template<typename Reducer>
+inline void ParallelForEach::ForEachTask<Reducer>::startWorker(size_t worker)
+{
+	m_connections[worker] = m_connection.unmarshal();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Apply the worker's reducer to a range of rows.
+
+template<typename Reducer>
+inline void ParallelForEach::ForEachTask<Reducer>::process(size_t worker, size_t begin, size_t end)
+{
+	Reducer&          reducer = m_reducers[worker];
+	const Connection& connection = m_connections[worker];
+
+	for (size_t i = begin; i != end; ++i)
+		reducer(Object(m_rows[i], connection));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Release the worker's connection, which must be done in its apartment.
+
+template<typename Reducer>
+inline void ParallelForEach::ForEachTask<Reducer>::stopWorker(size_t worker)
+{
+	m_connections[worker].close();
+}
+
+//namespace WMI
+}
+
+#endif // WMI_PARALLELFOREACH_HPP
@@ -0,0 +1,615 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   PollScheduler.cpp
+//! \brief  The PollScheduler class definition.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include "PollScheduler.hpp"
+#include "ObjectIterator.hpp"
+#include "Exception.hpp"
+#include "RetryPolicy.hpp"
+#include "Stopwatch.hpp"
+#include <WCL/AutoCom.hpp>
+#include <process.h>
+#include <algorithm>
+#include <limits.h>
+#include <set>
+
+namespace WMI
+{
+
+//! The polls for a class on a host that are due on the same tick.
+struct DueQuery
+{
+	//! Default constructor.
+	DueQuery()
+		: m_properties()
+		, m_all(false)
+		, m_targets()
+	{
+	}
+
+	std::set<tstring>					m_properties;	//!< The union of the properties.
+	bool								m_all;			//!< Does a poll need all the properties?
+	std::vector<PollScheduler::Target>	m_targets;		//!< The polls.
+};
+
+//! The due queries for a host, by class.
+typedef std::map<tstring, DueQuery> DueQueries;
+//! The due queries, by host.
+typedef std::map<size_t, DueQueries> DueHosts;
+
+////////////////////////////////////////////////////////////////////////////////
+//! Destructor.
+
+PollScheduler::Sink::~Sink()
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Construction with the number of workers and the tick length in milliseconds.
+
+PollScheduler::PollScheduler(size_t workers, uint tickLength)
+	: m_workers(workers)
+	, m_tickLength(tickLength)
+	, m_jitter(DEFAULT_JITTER)
+	, m_random()
+	, m_lock()
+	, m_hosts()
+	, m_hostIndex()
+	, m_polls()
+	, m_wheel()
+	, m_expired()
+	, m_skipped(0)
+	, m_coalesced(0)
+	, m_queue()
+	, m_stopEvent(::CreateEvent(nullptr, TRUE, FALSE, nullptr))
+	, m_queued(::CreateSemaphore(nullptr, 0, LONG_MAX, nullptr))
+	, m_threads()
+{
+	ASSERT(workers != 0);
+	ASSERT(tickLength != 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Destructor.
+
+PollScheduler::~PollScheduler()
+{
+	stop();
+
+	::CloseHandle(m_queued);
+	::CloseHandle(m_stopEvent);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Set the largest phase, in milliseconds, given to a host added later. With a
+//! jitter of zero all hosts are polled on the same ticks.
+
+void PollScheduler::setJitter(uint jitter)
+{
+	CriticalSection::Lock lock(m_lock);
+
+	m_jitter = jitter;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the number of cycles skipped because the host was busy.
+
+size_t PollScheduler::skippedCycles() const
+{
+	CriticalSection::Lock lock(m_lock);
+
+	return m_skipped;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the number of polls that shared another poll's query.
+
+size_t PollScheduler::coalescedPolls() const
+{
+	CriticalSection::Lock lock(m_lock);
+
+	return m_coalesced;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Query if the timer and worker threads are running.
+
+bool PollScheduler::isRunning() const
+{
+	return !m_threads.empty();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Add a host whose connection is opened with the current credentials.
+
+void PollScheduler::addHost(const tstring& host)
+{
+	CriticalSection::Lock lock(m_lock);
+
+	findHost(host, IWbemServicesPtr());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Add a host whose connection is attached to an existing COM connection, such
+//! as one opened with other credentials. The connection must be usable from
+//! the multi-threaded apartment.
+
+void PollScheduler::addHost(const tstring& host, IWbemServicesPtr services)
+{
+	CriticalSection::Lock lock(m_lock);
+
+	findHost(host, services);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Add a poll for the instances of a class on a host, which is added if it is
+//! not known. The interval, in milliseconds, is rounded up to whole ticks and
+//! an empty set of properties queries them all. The sink must outlive the
+//! scheduler. Returns the poll's identifier.
+
+size_t PollScheduler::addPoll(const tstring& host, const tstring& className, const Properties& properties,
+								uint interval, Sink& sink)
+{
+	ASSERT(interval != 0);
+
+	CriticalSection::Lock lock(m_lock);
+
+	Poll poll;
+
+	poll.m_host       = findHost(host, IWbemServicesPtr());
+	poll.m_className  = className;
+	poll.m_properties = properties;
+	poll.m_interval   = std::max<uint64>((interval + m_tickLength - 1) / m_tickLength, 1);
+	poll.m_sink       = &sink;
+	poll.m_active     = true;
+
+	m_polls.push_back(poll);
+
+	const size_t index = m_polls.size() - 1;
+
+	m_wheel.schedule(index, nextDue(poll, m_wheel.now()));
+
+	return index;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Remove a poll. A cycle for the poll that is already queued or running still
+//! passes its results to the sink.
+
+void PollScheduler::removePoll(size_t poll)
+{
+	CriticalSection::Lock lock(m_lock);
+
+	ASSERT(poll < m_polls.size());
+
+	m_polls[poll].m_active = false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Start the timer and worker threads. The ticks carry on from where the
+//! schedule was last advanced.
+
+void PollScheduler::start()
+{
+	ASSERT(!isRunning());
+
+	::ResetEvent(m_stopEvent);
+
+	for (size_t i = 0; i != (m_workers + 1); ++i)
+	{
+		const uintptr_t thread = _beginthreadex(nullptr, 0, (i == 0) ? timerThread : workerThread, this, 0, nullptr);
+
+		if (thread == 0)
+		{
+			stop();
+			throw Exception(E_OUTOFMEMORY, TXT("Failed to start a poll scheduler thread"));
+		}
+
+		m_threads.push_back(reinterpret_cast<HANDLE>(thread));
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Stop polling, waiting for any running cycles to finish. The cycles still
+//! waiting for a worker are discarded.
+
+void PollScheduler::stop()
+{
+	if (!isRunning())
+		return;
+
+	::SetEvent(m_stopEvent);
+
+	waitForThreads();
+
+	CriticalSection::Lock lock(m_lock);
+
+	for (std::deque<Cycle>::const_iterator it = m_queue.begin(); it != m_queue.end(); ++it)
+		complete(it->m_host);
+
+	m_queue.clear();
+
+	while (::WaitForSingleObject(m_queued, 0) == WAIT_OBJECT_0)
+		;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Advance the schedule to a tick and collect the cycles that are due. Each due
+//! poll is rescheduled for its next aligned tick. The polls for a class on a
+//! host are coalesced into a single query, and the hosts that are busy are
+//! skipped. The hosts collected are busy until the cycle is executed.
+
+void PollScheduler::collect(uint64 tick, Cycles& cycles)
+{
+	CriticalSection::Lock lock(m_lock);
+
+	m_expired.clear();
+	m_wheel.advance(tick, m_expired);
+
+	DueHosts due;
+
+	for (TimerWheel::Timers::const_iterator it = m_expired.begin(); it != m_expired.end(); ++it)
+	{
+		const Poll& poll = m_polls[*it];
+
+		if (!poll.m_active)
+			continue;
+
+		m_wheel.schedule(*it, nextDue(poll, tick));
+
+		DueQuery&    query = due[poll.m_host][poll.m_className];
+		const Target target = { *it, poll.m_sink };
+
+		if (poll.m_properties.empty())
+			query.m_all = true;
+		else
+			query.m_properties.insert(poll.m_properties.begin(), poll.m_properties.end());
+
+		query.m_targets.push_back(target);
+	}
+
+	for (DueHosts::const_iterator host = due.begin(); host != due.end(); ++host)
+	{
+		Host& state = *m_hosts[host->first];
+
+		if (state.m_busy != 0)
+		{
+			++m_skipped;
+			continue;
+		}
+
+		::InterlockedExchange(&state.m_busy, 1);
+
+		cycles.push_back(Cycle());
+
+		Cycle& cycle = cycles.back();
+
+		cycle.m_host    = host->first;
+		cycle.m_timeout = UINT_MAX;
+
+		for (DueQueries::const_iterator it = host->second.begin(); it != host->second.end(); ++it)
+		{
+			const DueQuery&  dueQuery = it->second;
+			const Properties properties = dueQuery.m_all ? Properties()
+									: Properties(dueQuery.m_properties.begin(), dueQuery.m_properties.end());
+
+			cycle.m_queries.push_back(Query());
+
+			Query& query = cycle.m_queries.back();
+
+			query.m_className = it->first;
+			query.m_text      = formatQuery(it->first, properties);
+			query.m_targets   = dueQuery.m_targets;
+
+			m_coalesced += dueQuery.m_targets.size() - 1;
+
+			for (std::vector<Target>::const_iterator target = query.m_targets.begin(); target != query.m_targets.end(); ++target)
+			{
+				const uint64 period = m_polls[target->m_poll].m_interval * m_tickLength;
+
+				cycle.m_timeout = static_cast<uint>(std::min<uint64>(cycle.m_timeout, period));
+			}
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Run the queries for a cycle on the calling thread, passing the results to
+//! the sinks, and then mark the host as no longer busy. A failure to open the
+//! connection or run a query is passed to the sinks instead. A connection that
+//! is lost is re-opened on the next cycle.
+
+void PollScheduler::execute(const Cycle& cycle)
+{
+	Host* host = nullptr;
+
+	{
+		CriticalSection::Lock lock(m_lock);
+
+		ASSERT(cycle.m_host < m_hosts.size());
+
+		host = m_hosts[cycle.m_host].get();
+	}
+
+	try
+	{
+		runQueries(*host, cycle);
+	}
+	catch (...)
+	{
+		complete(cycle.m_host);
+		throw;
+	}
+
+	complete(cycle.m_host);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Find a host, or add it with a random phase. Any existing COM connection
+//! replaces the one already supplied for the host.
+
+size_t PollScheduler::findHost(const tstring& host, IWbemServicesPtr services)
+{
+	HostIndex::const_iterator it = m_hostIndex.find(host);
+
+	if (it != m_hostIndex.end())
+	{
+		if (services.get() != nullptr)
+			m_hosts[it->second]->m_services = services;
+
+		return it->second;
+	}
+
+	const uint64 maxPhase = m_jitter / m_tickLength;
+	const double random = m_random.next();
+
+	HostPtr state(new Host);
+
+	state->m_name     = host;
+	state->m_services = services;
+	state->m_phase    = static_cast<uint64>(random * static_cast<double>(maxPhase + 1));
+	state->m_busy     = 0;
+
+	m_hosts.push_back(state);
+	m_hostIndex[host] = m_hosts.size() - 1;
+
+	return m_hosts.size() - 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the first tick after another that a poll is aligned to, i.e. its host's
+//! phase plus a whole number of intervals.
+
+uint64 PollScheduler::nextDue(const Poll& poll, uint64 tick) const
+{
+	const uint64 phase = m_hosts[poll.m_host]->m_phase;
+
+	if (tick < phase)
+		return phase;
+
+	return phase + ((((tick - phase) / poll.m_interval) + 1) * poll.m_interval);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Open the connection to a host, if needed, and run a cycle's queries. An open
+//! that takes longer than the shortest of the cycle's poll intervals is given
+//! up on, so that an unreachable host does not hold up its next cycle.
+
+void PollScheduler::runQueries(Host& host, const Cycle& cycle)
+{
+	if (!host.m_connection.isOpen())
+	{
+		IWbemServicesPtr services;
+
+		{
+			CriticalSection::Lock lock(m_lock);
+
+			services = host.m_services;
+		}
+
+		try
+		{
+			if (services.get() != nullptr)
+				host.m_connection.open(services);
+			else
+				host.m_connection.open(host.m_name, TXT(""), TXT(""), Connection::DEFAULT_NAMESPACE,
+										Deadline::after(cycle.m_timeout));
+		}
+		catch (const Exception& e)
+		{
+			for (std::vector<Query>::const_iterator it = cycle.m_queries.begin(); it != cycle.m_queries.end(); ++it)
+				notifyFailure(*it, host.m_name, e);
+
+			return;
+		}
+	}
+
+	for (std::vector<Query>::const_iterator query = cycle.m_queries.begin(); query != cycle.m_queries.end(); ++query)
+	{
+		Objects objects;
+
+		try
+		{
+			ObjectIterator end;
+
+			for (ObjectIterator it = host.m_connection.execQuery(query->m_text); it != end; ++it)
+				objects.push_back(*it);
+		}
+		catch (const Exception& e)
+		{
+			if (RetryPolicy::classify(e.m_result) == RetryPolicy::DISCONNECTED)
+				host.m_connection.close();
+
+			notifyFailure(*query, host.m_name, e);
+			continue;
+		}
+
+		for (std::vector<Target>::const_iterator it = query->m_targets.begin(); it != query->m_targets.end(); ++it)
+			it->m_sink->onResults(it->m_poll, host.m_name, objects);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Mark a host as no longer busy.
+
+void PollScheduler::complete(size_t host)
+{
+	CriticalSection::Lock lock(m_lock);
+
+	::InterlockedExchange(&m_hosts[host]->m_busy, 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Run the timer until stopped, queuing the due cycles for the workers.
+
+void PollScheduler::runTimer()
+{
+	uint64 origin = 0;
+
+	{
+		CriticalSection::Lock lock(m_lock);
+
+		origin = m_wheel.now();
+	}
+
+	const int64 start = Stopwatch::ticks();
+	Cycles      cycles;
+
+	while (::WaitForSingleObject(m_stopEvent, m_tickLength) == WAIT_TIMEOUT)
+	{
+		const uint64 elapsed = Stopwatch::ticksToMicroseconds(Stopwatch::ticks() - start) / 1000;
+
+		cycles.clear();
+		collect(origin + (elapsed / m_tickLength), cycles);
+
+		if (cycles.empty())
+			continue;
+
+		{
+			CriticalSection::Lock lock(m_lock);
+
+			m_queue.insert(m_queue.end(), cycles.begin(), cycles.end());
+		}
+
+		::ReleaseSemaphore(m_queued, static_cast<LONG>(cycles.size()), nullptr);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Run a worker until stopped, executing the queued cycles. A sink that throws,
+//! whatever the exception, does not stop the worker.
+
+void PollScheduler::runWorker()
+{
+	WCL::AutoCom com(COINIT_MULTITHREADED);
+
+	const HANDLE handles[] = { m_stopEvent, m_queued };
+
+	while (::WaitForMultipleObjects(2, handles, FALSE, INFINITE) == (WAIT_OBJECT_0 + 1))
+	{
+		Cycle cycle;
+
+		{
+			CriticalSection::Lock lock(m_lock);
+
+			if (m_queue.empty())
+				continue;
+
+			cycle = m_queue.front();
+			m_queue.pop_front();
+		}
+
+		try
+		{
+			execute(cycle);
+		}
+		catch (const Core::Exception& /*e*/)
+		{
+		}
+		catch (const std::exception& /*e*/)
+		{
+		}
+		catch (...)
+		{
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Wait for the threads to exit and close them. The calling thread may be in
+//! a single-threaded apartment and so messages are pumped while waiting.
+
+void PollScheduler::waitForThreads()
+{
+	while (!m_threads.empty())
+	{
+		DWORD index = 0;
+
+		HRESULT result = ::CoWaitForMultipleHandles(0, INFINITE, static_cast<ULONG>(m_threads.size()), &m_threads.front(), &index);
+
+		if (FAILED(result))
+		{
+			::WaitForMultipleObjects(static_cast<DWORD>(m_threads.size()), &m_threads.front(), TRUE, INFINITE);
+			index = 0;
+		}
+
+		::CloseHandle(m_threads[index]);
+		m_threads.erase(m_threads.begin() + index);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Format the WQL query for a class and set of properties, or all of them if
+//! the set is empty.
+
+tstring PollScheduler::formatQuery(const tstring& className, const Properties& properties)
+{
+	tstring query = TXT("SELECT ");
+
+	if (properties.empty())
+		query += TXT("*");
+
+	for (Properties::const_iterator it = properties.begin(); it != properties.end(); ++it)
+	{
+		if (it != properties.begin())
+			query += TXT(", ");
+
+		query += *it;
+	}
+
+	return query + TXT(" FROM ") + className;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Pass a failure to the sinks of a query's polls.
+
+void PollScheduler::notifyFailure(const Query& query, const tstring& host, const Exception& error)
+{
+	for (std::vector<Target>::const_iterator it = query.m_targets.begin(); it != query.m_targets.end(); ++it)
+		it->m_sink->onFailure(it->m_poll, host, error);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! The timer thread function.
+
+unsigned __stdcall PollScheduler::timerThread(void* parameter)
+{
+	static_cast<PollScheduler*>(parameter)->runTimer();
+
+	return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! The worker thread function.
+
+unsigned __stdcall PollScheduler::workerThread(void* parameter)
+{
+	static_cast<PollScheduler*>(parameter)->runWorker();
+
+	return 0;
+}
+
+//namespace WMI
+}
@@ -0,0 +1,273 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   PollScheduler.hpp
+//! \brief  The PollScheduler class declaration.
+//! \author Chris Oldwood
+
+// Check for previous inclusion
+#ifndef WMI_POLLSCHEDULER_HPP
+#define WMI_POLLSCHEDULER_HPP
+
+#if _MSC_VER > 1000
+#pragma once
+#endif
+
+#include "Connection.hpp"
+#include "Object.hpp"
+#include "TimerWheel.hpp"
+#include "CriticalSection.hpp"
+#include "Random.hpp"
+#include <Core/NotCopyable.hpp>
+#include <Core/SharedPtr.hpp>
+#include <vector>
+#include <deque>
+#include <map>
+
+namespace WMI
+{
+
+// Forward declarations.
+class Exception;
+
+////////////////////////////////////////////////////////////////////////////////
+//! Runs periodic queries for the instances of a class against a set of hosts,
+//! with one connection per host, and passes the results to registered sinks.
+//! The polls are held on a TimerWheel and a timer thread hands the due ones to
+//! a set of worker threads.
+//!
+//! Each host is given a random phase, up to the jitter, so that the hosts are
+//! not all polled on the same tick. Within a host the polls are aligned to
+//! their interval and so the polls for the same class that fall due on the same
+//! tick, e.g. a 5s and a 30s poll every 30s, are coalesced into a single query
+//! for the union of their properties. A host whose previous cycle of queries
+//! is still running is skipped until the polls are next due.
+//!
+//! The workers join the multi-threaded apartment and open each host's
+//! connection on first use. The sinks are called on the worker threads.
+
+class PollScheduler : private Core::NotCopyable
+{
+public:
+	//! The collection of objects returned by a poll.
+	typedef std::vector<Object> Objects;
+	//! The collection of properties to query.
+	typedef std::vector<tstring> Properties;
+
+	//! The receiver of the results of one or more polls.
+	class Sink
+	{
+	public:
+		//! Called with the objects returned by a poll.
+		virtual void onResults(size_t poll, const tstring& host, const Objects& objects) = 0;
+
+		//! Called when a poll fails.
+		virtual void onFailure(size_t poll, const tstring& host, const Exception& error) = 0;
+
+	protected:
+		//! Destructor.
+		virtual ~Sink();
+	};
+
+	//! A poll whose results are taken from a query.
+	struct Target
+	{
+		size_t	m_poll;		//!< The poll.
+		Sink*	m_sink;		//!< The poll's sink.
+	};
+
+	//! A query made on behalf of one or more polls.
+	struct Query
+	{
+		tstring				m_className;	//!< The class queried.
+		tstring				m_text;			//!< The WQL query.
+		std::vector<Target>	m_targets;		//!< The polls to pass the results to.
+	};
+
+	//! The queries due for a host on a tick.
+	struct Cycle
+	{
+		size_t				m_host;		//!< The host.
+		std::vector<Query>	m_queries;	//!< The queries, one per class.
+		uint				m_timeout;	//!< The most milliseconds to spend opening the connection.
+	};
+
+	//! A collection of cycles.
+	typedef std::vector<Cycle> Cycles;
+
+public:
+	//! Construction with the number of workers and the tick length in milliseconds.
+	explicit PollScheduler(size_t workers = DEFAULT_WORKERS, uint tickLength = DEFAULT_TICK_LENGTH);
+
+	//! Destructor.
+	~PollScheduler();
+
+	//
+	// Properties.
+	//
+
+	//! Get the length of a tick, in milliseconds.
+	uint tickLength() const;
+
+	//! Get the largest phase, in milliseconds, given to a host.
+	uint jitter() const;
+
+	//! Set the largest phase, in milliseconds, given to a host added later.
+	void setJitter(uint jitter);
+
+	//! Get the number of cycles skipped because the host was busy.
+	size_t skippedCycles() const;
+
+	//! Get the number of polls that shared another poll's query.
+	size_t coalescedPolls() const;
+
+	//! Query if the timer and worker threads are running.
+	bool isRunning() const;
+
+	//
+	// Methods.
+	//
+
+	//! Add a host whose connection is opened with the current credentials.
+	void addHost(const tstring& host);
+
+	//! Add a host whose connection is attached to an existing COM connection.
+	void addHost(const tstring& host, IWbemServicesPtr services);
+
+	//! Add a poll for the instances of a class on a host.
+	size_t addPoll(const tstring& host, const tstring& className, const Properties& properties,
+					uint interval, Sink& sink);
+
+	//! Remove a poll.
+	void removePoll(size_t poll);
+
+	//! Start polling.
+	void start(); // throw(WMI::Exception)
+
+	//! Stop polling, waiting for any running cycles to finish.
+	void stop();
+
+	//! Advance the schedule to a tick and collect the cycles that are due.
+	void collect(uint64 tick, Cycles& cycles);
+
+	//! Run the queries for a cycle on the calling thread.
+	void execute(const Cycle& cycle);
+
+	//
+	// Constants.
+	//
+
+	//! The default number of worker threads.
+	static const size_t DEFAULT_WORKERS = 4;
+	//! The default length of a tick, in milliseconds.
+	static const uint DEFAULT_TICK_LENGTH = 100;
+	//! The default largest phase, in milliseconds, given to a host.
+	static const uint DEFAULT_JITTER = 5000;
+
+private:
+	//! A host that is polled.
+	struct Host
+	{
+		tstring				m_name;			//!< The host name.
+		IWbemServicesPtr	m_services;		//!< The existing COM connection, if supplied.
+		Connection			m_connection;	//!< The connection, once opened.
+		uint64				m_phase;		//!< The tick its polls are aligned to.
+		volatile LONG		m_busy;			//!< Is a cycle queued or running?
+	};
+
+	//! A periodic query.
+	struct Poll
+	{
+		size_t		m_host;			//!< The host.
+		tstring		m_className;	//!< The class queried.
+		Properties	m_properties;	//!< The properties queried, or empty for all.
+		uint64		m_interval;		//!< The period, in ticks.
+		Sink*		m_sink;			//!< The receiver of the results.
+		bool		m_active;		//!< Has the poll not been removed?
+	};
+
+	//! The host smart-pointer type.
+	typedef Core::SharedPtr<Host> HostPtr;
+	//! The collection of hosts.
+	typedef std::vector<HostPtr> Hosts;
+	//! The map of host name to host.
+	typedef std::map<tstring, size_t> HostIndex;
+	//! The collection of polls.
+	typedef std::vector<Poll> Polls;
+
+	//
+	// Members.
+	//
+	size_t				m_workers;		//!< The number of worker threads.
+	uint				m_tickLength;	//!< The length of a tick.
+	uint				m_jitter;		//!< The largest phase given to a host.
+	Random				m_random;		//!< The source of the hosts' phases.
+	mutable CriticalSection	m_lock;		//!< The lock guarding the schedule.
+	Hosts				m_hosts;		//!< The hosts.
+	HostIndex			m_hostIndex;	//!< The hosts, by name.
+	Polls				m_polls;		//!< The polls.
+	TimerWheel			m_wheel;		//!< The due ticks of the polls.
+	TimerWheel::Timers	m_expired;		//!< The polls found due by the last tick.
+	size_t				m_skipped;		//!< The number of cycles skipped.
+	size_t				m_coalesced;	//!< The number of polls that shared a query.
+	std::deque<Cycle>	m_queue;		//!< The cycles waiting for a worker.
+	HANDLE				m_stopEvent;	//!< Signalled to stop the threads.
+	HANDLE				m_queued;		//!< Counts the cycles waiting for a worker.
+	std::vector<HANDLE>	m_threads;		//!< The timer and worker threads.
+
+	//
+	// Internal methods.
+	//
+
+	//! Find or add a host.
+	size_t findHost(const tstring& host, IWbemServicesPtr services);
+
+	//! Get the first tick after another that a poll is aligned to.
+	uint64 nextDue(const Poll& poll, uint64 tick) const;
+
+	//! Open the connection to a host, if needed, and run a cycle's queries.
+	void runQueries(Host& host, const Cycle& cycle);
+
+	//! Mark a host as no longer busy.
+	void complete(size_t host);
+
+	//! Run the timer until stopped.
+	void runTimer();
+
+	//! Run a worker until stopped.
+	void runWorker();
+
+	//! Wait for the threads to exit and close them.
+	void waitForThreads();
+
+	//! Format the WQL query for a class and set of properties.
+	static tstring formatQuery(const tstring& className, const Properties& properties);
+
+	//! Pass a failure to the sinks of a query's polls.
+	static void notifyFailure(const Query& query, const tstring& host, const Exception& error);
+
+	//! The timer thread function.
+	static unsigned __stdcall timerThread(void* parameter);
+
+	//! The worker thread function.
+	static unsigned __stdcall workerThread(void* parameter);
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the length of a tick, in milliseconds.
+
+inline uint PollScheduler::tickLength() const
+{
+	return m_tickLength;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the largest phase, in milliseconds, given to a host.
+
+inline uint PollScheduler::jitter() const
+{
+	return m_jitter;
+}
+
+//namespace WMI
+}
+
+#endif // WMI_POLLSCHEDULER_HPP
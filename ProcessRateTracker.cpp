@@ -0,0 +1,308 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   ProcessRateTracker.cpp
+//! \brief  The ProcessRateTracker class definition.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include "ProcessRateTracker.hpp"
+#include "Connection.hpp"
+#include "Object.hpp"
+#include "ObjectIterator.hpp"
+#include "DateTime.hpp"
+#include <Core/StringUtils.hpp>
+
+namespace WMI
+{
+
+//! The smallest table size.
+static const size_t MIN_TABLE_SIZE = 16;
+
+//! The number of 100ns units per second.
+static const double UNITS_PER_SECOND = 10000000.0;
+
+////////////////////////////////////////////////////////////////////////////////
+// Constants.
+
+//! The query for the Win32_Process counters.
+const tchar* ProcessRateTracker::PROCESS_QUERY = TXT("SELECT ProcessId, CreationDate, KernelModeTime, UserModeTime,")
+												 TXT(" ReadTransferCount, WriteTransferCount, ReadOperationCount,")
+												 TXT(" WriteOperationCount, PageFaults FROM Win32_Process");
+//! The query for the Win32_PerfRawData_PerfProc_Process counters.
+const tchar* ProcessRateTracker::PERF_RAW_DATA_QUERY = TXT("SELECT IDProcess, ElapsedTime, PercentProcessorTime,")
+													   TXT(" IODataBytesPersec, IODataOperationsPersec, PageFaultsPersec,")
+													   TXT(" Timestamp_Sys100NS, Frequency_Sys100NS")
+													   TXT(" FROM Win32_PerfRawData_PerfProc_Process WHERE Name <> '_Total'");
+
+////////////////////////////////////////////////////////////////////////////////
+//! Read an unsigned counter, which is passed as a BSTR if it is 64-bit. A null
+//! value, such as the creation time of the idle process, is read as zero.
+
+static uint64 readCounter(const Object& object, const tchar* name)
+{
+	WCL::Variant value;
+
+	object.getProperty(name, value);
+
+	if ( (V_VT(&value) == VT_NULL) || (V_VT(&value) == VT_EMPTY) )
+		return 0;
+
+	if (V_VT(&value) == VT_BSTR)
+		return Core::parse<uint64>(WCL::getValue<tstring>(value));
+
+	return static_cast<uint32>(WCL::getValue<int32>(value));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Read a WMI datetime as a FILETIME in 100ns units. The UTC offset is ignored
+//! as it is the same for all processes on a host. A null or malformed value is
+//! read as zero.
+
+static uint64 readCreationTime(const Object& object, const tchar* name)
+{
+	WCL::Variant value;
+
+	object.getProperty(name, value);
+
+	uint64 time = 0;
+
+	if ( (V_VT(&value) != VT_BSTR) || !tryParseFileTime(WCL::getValue<tstring>(value), time) )
+		return 0;
+
+	return time;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Default constructor.
+
+ProcessRateTracker::ProcessRateTracker()
+	: m_table()
+	, m_next()
+	, m_size(0)
+	, m_timestamp(0)
+	, m_reused(0)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Destructor.
+
+ProcessRateTracker::~ProcessRateTracker()
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Compute the rates from a snapshot taken at a time, in 100ns units, e.g. from
+//! now(). A process whose counters carry their own sample time, such as those
+//! from the performance data, has its rates computed over the interval between
+//! its samples instead, as the provider samples its counters at its own pace.
+//! The rates are returned in the same order as the snapshot and are only valid
+//! for those processes that were also in the previous snapshot. The counters
+//! replace the previous ones and the processes not in the snapshot are
+//! forgotten.
+
+void ProcessRateTracker::update(uint64 timestamp, const Snapshot& snapshot, RatesCollection& rates)
+{
+	size_t capacity = MIN_TABLE_SIZE;
+
+	while (capacity < (snapshot.size() * 2))
+		capacity *= 2;
+
+	if (m_next.size() < capacity)
+		m_next.resize(capacity);
+
+	for (Table::iterator it = m_next.begin(); it != m_next.end(); ++it)
+		it->m_used = false;
+
+	const double seconds = ( (m_timestamp != 0) && (timestamp > m_timestamp) )
+						 ? static_cast<double>(timestamp - m_timestamp) / UNITS_PER_SECOND : 0.0;
+	size_t       size = 0;
+
+	rates.resize(snapshot.size());
+
+	for (size_t i = 0; i != snapshot.size(); ++i)
+	{
+		const Counters& current = snapshot[i];
+		Rates&          result = rates[i];
+
+		result.m_processId = current.m_processId;
+		result.m_valid = false;
+		result.m_cpuPercent = 0.0;
+		result.m_ioBytesPerSec = 0.0;
+		result.m_ioOperationsPerSec = 0.0;
+		result.m_pageFaultsPerSec = 0.0;
+
+		Entry& entry = m_next[find(m_next, current.m_processId)];
+
+		// Ignore a duplicate, e.g. the idle process in the performance data.
+		if (entry.m_used)
+			continue;
+
+		entry.m_used = true;
+		entry.m_counters = current;
+		++size;
+
+		if (m_table.empty())
+			continue;
+
+		const Entry& previous = m_table[find(m_table, current.m_processId)];
+
+		if (!previous.m_used)
+			continue;
+
+		if (previous.m_counters.m_created != current.m_created)
+		{
+			++m_reused;
+			continue;
+		}
+
+		const double interval = sampleInterval(previous.m_counters, current, seconds);
+
+		if (interval != 0.0)
+			computeRates(previous.m_counters, current, interval, result);
+	}
+
+	m_table.swap(m_next);
+	m_size = size;
+	m_timestamp = timestamp;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Forget all processes.
+
+void ProcessRateTracker::reset()
+{
+	m_table.clear();
+	m_next.clear();
+	m_size = 0;
+	m_timestamp = 0;
+	m_reused = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Read the counters for all processes on a host with a single query.
+
+void ProcessRateTracker::query(const Connection& connection, Source source, Snapshot& snapshot)
+{
+	const tchar* text = (source == WIN32_PROCESS) ? PROCESS_QUERY : PERF_RAW_DATA_QUERY;
+
+	snapshot.clear();
+
+	ObjectIterator end;
+
+	for (ObjectIterator it = connection.execQuery(text); it != end; ++it)
+		snapshot.push_back((source == WIN32_PROCESS) ? fromProcess(*it) : fromPerfRawData(*it));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Read the counters from a Win32_Process object. The I/O counters exclude
+//! the "other" transfers so that they match the performance data.
+
+ProcessRateTracker::Counters ProcessRateTracker::fromProcess(const Object& process)
+{
+	Counters counters;
+
+	counters.m_processId    = static_cast<uint32>(readCounter(process, TXT("ProcessId")));
+	counters.m_created      = readCreationTime(process, TXT("CreationDate"));
+	counters.m_cpuTime      = readCounter(process, TXT("KernelModeTime")) + readCounter(process, TXT("UserModeTime"));
+	counters.m_ioBytes      = readCounter(process, TXT("ReadTransferCount")) + readCounter(process, TXT("WriteTransferCount"));
+	counters.m_ioOperations = readCounter(process, TXT("ReadOperationCount")) + readCounter(process, TXT("WriteOperationCount"));
+	counters.m_pageFaults   = readCounter(process, TXT("PageFaults"));
+	counters.m_timestamp    = 0;
+	counters.m_frequency    = 0;
+
+	return counters;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Read the counters from a Win32_PerfRawData_PerfProc_Process object. The raw
+//! value of the elapsed time counter is the time the process was started. The
+//! sample time is the provider's own, from Timestamp_Sys100NS.
+
+ProcessRateTracker::Counters ProcessRateTracker::fromPerfRawData(const Object& process)
+{
+	Counters counters;
+
+	counters.m_processId    = static_cast<uint32>(readCounter(process, TXT("IDProcess")));
+	counters.m_created      = readCounter(process, TXT("ElapsedTime"));
+	counters.m_cpuTime      = readCounter(process, TXT("PercentProcessorTime"));
+	counters.m_ioBytes      = readCounter(process, TXT("IODataBytesPersec"));
+	counters.m_ioOperations = readCounter(process, TXT("IODataOperationsPersec"));
+	counters.m_pageFaults   = readCounter(process, TXT("PageFaultsPersec"));
+	counters.m_timestamp    = readCounter(process, TXT("Timestamp_Sys100NS"));
+	counters.m_frequency    = readCounter(process, TXT("Frequency_Sys100NS"));
+
+	return counters;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the current time, in 100ns units.
+
+uint64 ProcessRateTracker::now()
+{
+	FILETIME time;
+
+	::GetSystemTimeAsFileTime(&time);
+
+	return (static_cast<uint64>(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Find the slot for a process ID, either its own or the empty one it belongs
+//! in, by linear probing. The ID is mixed first as they are multiples of 4.
+
+size_t ProcessRateTracker::find(const Table& table, uint32 processId)
+{
+	ASSERT(!table.empty());
+
+	const size_t mask = table.size() - 1;
+	uint32       hash = processId * 0x9E3779B1u;
+
+	hash ^= (hash >> 15);
+
+	for (size_t slot = hash & mask; ; slot = (slot + 1) & mask)
+	{
+		const Entry& entry = table[slot];
+
+		if (!entry.m_used || (entry.m_counters.m_processId == processId))
+			return slot;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the number of seconds between two samples of a process's counters. If
+//! both carry a sample time the interval is taken from them, otherwise the
+//! interval between the snapshots is used. The result is zero if the time has
+//! not moved forward.
+
+double ProcessRateTracker::sampleInterval(const Counters& previous, const Counters& current, double seconds)
+{
+	if ( (previous.m_timestamp == 0) || (current.m_timestamp == 0) || (current.m_frequency == 0) )
+		return seconds;
+
+	if (current.m_timestamp <= previous.m_timestamp)
+		return 0.0;
+
+	return static_cast<double>(current.m_timestamp - previous.m_timestamp) / static_cast<double>(current.m_frequency);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Compute the rates of a process from its previous and current counters. A
+//! counter that has gone backwards leaves the rates invalid.
+
+void ProcessRateTracker::computeRates(const Counters& previous, const Counters& current, double seconds, Rates& rates)
+{
+	if ( (current.m_cpuTime < previous.m_cpuTime) || (current.m_ioBytes < previous.m_ioBytes)
+	  || (current.m_ioOperations < previous.m_ioOperations) || (current.m_pageFaults < previous.m_pageFaults) )
+		return;
+
+	const double cpuSeconds = static_cast<double>(current.m_cpuTime - previous.m_cpuTime) / UNITS_PER_SECOND;
+
+	rates.m_valid              = true;
+	rates.m_cpuPercent         = (cpuSeconds * 100.0) / seconds;
+	rates.m_ioBytesPerSec      = static_cast<double>(current.m_ioBytes - previous.m_ioBytes) / seconds;
+	rates.m_ioOperationsPerSec = static_cast<double>(current.m_ioOperations - previous.m_ioOperations) / seconds;
+	rates.m_pageFaultsPerSec   = static_cast<double>(current.m_pageFaults - previous.m_pageFaults) / seconds;
+}
+
+//namespace WMI
+}
@@ -0,0 +1,180 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   ProcessRateTracker.hpp
+//! \brief  The ProcessRateTracker class declaration.
+//! \author Chris Oldwood
+
+// Check for previous inclusion
+#ifndef WMI_PROCESSRATETRACKER_HPP
+#define WMI_PROCESSRATETRACKER_HPP
+
+#if _MSC_VER > 1000
+#pragma once
+#endif
+
+#include <Core/NotCopyable.hpp>
+#include <vector>
+
+namespace WMI
+{
+
+// Forward declarations.
+class Object;
+class Connection;
+
+////////////////////////////////////////////////////////////////////////////////
+//! Computes the CPU, I/O and page fault rates of the processes on a host from
+//! the raw counters in successive snapshots of either Win32_Process or
+//! Win32_PerfRawData_PerfProc_Process.
+//!
+//! The previous counters are held in a flat open-addressing table keyed by the
+//! process ID, which is rebuilt into a second table on each update so that the
+//! processes that have exited are dropped without any deletion logic and no
+//! memory is allocated once the tables have grown to fit. A process ID that
+//! has been reused is detected by a change in the creation time, and the new
+//! process starts afresh rather than being charged the old one's counters.
+
+class ProcessRateTracker : private Core::NotCopyable
+{
+public:
+	//! The class the counters are read from.
+	enum Source
+	{
+		WIN32_PROCESS,		//!< Win32_Process.
+		PERF_RAW_DATA		//!< Win32_PerfRawData_PerfProc_Process.
+	};
+
+	//! The raw counters for a process.
+	struct Counters
+	{
+		uint32	m_processId;	//!< The process ID.
+		uint64	m_created;		//!< The creation time, which identifies a reused ID.
+		uint64	m_cpuTime;		//!< The kernel and user time, in 100ns units.
+		uint64	m_ioBytes;		//!< The bytes read and written.
+		uint64	m_ioOperations;	//!< The read and write operations.
+		uint64	m_pageFaults;	//!< The page faults.
+		uint64	m_timestamp;	//!< The time the counters were sampled, or 0 if unknown.
+		uint64	m_frequency;	//!< The timestamp's units per second, or 0 if unknown.
+	};
+
+	//! The rates for a process over the last interval.
+	struct Rates
+	{
+		uint32	m_processId;			//!< The process ID.
+		bool	m_valid;				//!< Were the previous counters known?
+		double	m_cpuPercent;			//!< The CPU time, as a percentage of one processor.
+		double	m_ioBytesPerSec;		//!< The bytes read and written per second.
+		double	m_ioOperationsPerSec;	//!< The read and write operations per second.
+		double	m_pageFaultsPerSec;		//!< The page faults per second.
+	};
+
+	//! The counters for all processes at a point in time.
+	typedef std::vector<Counters> Snapshot;
+	//! The rates for all processes, in the same order as the snapshot.
+	typedef std::vector<Rates> RatesCollection;
+
+public:
+	//! Default constructor.
+	ProcessRateTracker();
+
+	//! Destructor.
+	~ProcessRateTracker();
+
+	//
+	// Properties.
+	//
+
+	//! Get the number of processes being tracked.
+	size_t size() const;
+
+	//! Get the number of process IDs found to have been reused.
+	size_t reusedIds() const;
+
+	//
+	// Methods.
+	//
+
+	//! Compute the rates from a snapshot taken at a time, in 100ns units.
+	void update(uint64 timestamp, const Snapshot& snapshot, RatesCollection& rates);
+
+	//! Forget all processes.
+	void reset();
+
+	//
+	// Class methods.
+	//
+
+	//! Read the counters for all processes on a host.
+	static void query(const Connection& connection, Source source, Snapshot& snapshot); // throw(WMI::Exception)
+
+	//! Read the counters from a Win32_Process object.
+	static Counters fromProcess(const Object& process); // throw(WMI::Exception)
+
+	//! Read the counters from a Win32_PerfRawData_PerfProc_Process object.
+	static Counters fromPerfRawData(const Object& process); // throw(WMI::Exception)
+
+	//! Get the current time, in 100ns units.
+	static uint64 now();
+
+	//
+	// Constants.
+	//
+
+	//! The query for the Win32_Process counters.
+	static const tchar* PROCESS_QUERY;
+	//! The query for the Win32_PerfRawData_PerfProc_Process counters.
+	static const tchar* PERF_RAW_DATA_QUERY;
+
+private:
+	//! A slot in the table of previous counters.
+	struct Entry
+	{
+		bool		m_used;			//!< Is the slot in use?
+		Counters	m_counters;		//!< The counters.
+	};
+
+	//! The table of previous counters.
+	typedef std::vector<Entry> Table;
+
+	//
+	// Members.
+	//
+	Table	m_table;		//!< The counters from the previous snapshot.
+	Table	m_next;			//!< The table being built from the current snapshot.
+	size_t	m_size;			//!< The number of processes in the table.
+	uint64	m_timestamp;	//!< The time of the previous snapshot, or 0.
+	size_t	m_reused;		//!< The number of reused process IDs found.
+
+	//
+	// Internal methods.
+	//
+
+	//! Find the slot for a process ID, either its own or the empty one it belongs in.
+	static size_t find(const Table& table, uint32 processId);
+
+	//! Get the number of seconds between two samples of a process's counters.
+	static double sampleInterval(const Counters& previous, const Counters& current, double seconds);
+
+	//! Compute the rates of a process from its previous and current counters.
+	static void computeRates(const Counters& previous, const Counters& current, double seconds, Rates& rates);
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the number of processes being tracked.
+
+inline size_t ProcessRateTracker::size() const
+{
+	return m_size;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the number of process IDs found to have been reused.
+
+inline size_t ProcessRateTracker::reusedIds() const
+{
+	return m_reused;
+}
+
+//namespace WMI
+}
+
+#endif // WMI_PROCESSRATETRACKER_HPP
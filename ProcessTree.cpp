@@ -0,0 +1,288 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   ProcessTree.cpp
+//! \brief  The ProcessTree class definition.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include "ProcessTree.hpp"
+#include "Connection.hpp"
+#include "Object.hpp"
+#include "ObjectIterator.hpp"
+#include "DateTime.hpp"
+#include <Core/StringUtils.hpp>
+#include <algorithm>
+
+namespace WMI
+{
+
+////////////////////////////////////////////////////////////////////////////////
+// Constants.
+
+//! The query for the processes.
+const tchar* ProcessTree::QUERY = TXT("SELECT ProcessId, ParentProcessId, CreationDate FROM Win32_Process");
+
+////////////////////////////////////////////////////////////////////////////////
+//! Order the processes by ID.
+
+static bool lessById(const ProcessTree::Process& lhs, const ProcessTree::Process& rhs)
+{
+	return (lhs.m_processId < rhs.m_processId);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Compare the processes by ID.
+
+static bool equalById(const ProcessTree::Process& lhs, const ProcessTree::Process& rhs)
+{
+	return (lhs.m_processId == rhs.m_processId);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Default constructor.
+
+ProcessTree::ProcessTree()
+	: m_processes()
+	, m_offsets(1, 0)
+	, m_children()
+	, m_reused(0)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Destructor.
+
+ProcessTree::~ProcessTree()
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Build the tree from a snapshot of the processes, replacing the previous one.
+//! A duplicate process ID is ignored. A process is only linked to its parent
+//! when the parent was created no later than it, so that a parent that has
+//! exited and had its ID reused does not appear to adopt its children.
+
+void ProcessTree::build(const Processes& processes)
+{
+	m_processes = processes;
+
+	std::sort(m_processes.begin(), m_processes.end(), lessById);
+	m_processes.erase(std::unique(m_processes.begin(), m_processes.end(), equalById), m_processes.end());
+
+	const size_t count = m_processes.size();
+	Children     parents(count, count);
+
+	m_offsets.assign(count + 1, 0);
+	m_reused = 0;
+
+	for (size_t i = 0; i != count; ++i)
+	{
+		const Process& process = m_processes[i];
+
+		if (process.m_parentId == process.m_processId)
+			continue;
+
+		const size_t parent = find(process.m_parentId);
+
+		if (parent == count)
+			continue;
+
+		if (m_processes[parent].m_created > process.m_created)
+		{
+			++m_reused;
+			continue;
+		}
+
+		parents[i] = parent;
+		++m_offsets[parent + 1];
+	}
+
+	for (size_t i = 0; i != count; ++i)
+		m_offsets[i + 1] += m_offsets[i];
+
+	Offsets next(m_offsets.begin(), m_offsets.end() - 1);
+
+	m_children.resize(m_offsets[count]);
+
+	for (size_t i = 0; i != count; ++i)
+	{
+		if (parents[i] != count)
+			m_children[next[parents[i]]++] = i;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Build the tree from the processes on a host with a single query.
+
+void ProcessTree::build(const Connection& connection)
+{
+	Processes processes;
+
+	ObjectIterator end;
+
+	for (ObjectIterator it = connection.execQuery(QUERY); it != end; ++it)
+		processes.push_back(fromProcess(*it));
+
+	build(processes);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the IDs of the immediate children of a process, in order of ID.
+
+void ProcessTree::children(uint32 processId, ProcessIds& children) const
+{
+	children.clear();
+
+	const size_t process = find(processId);
+
+	if (process == m_processes.size())
+		return;
+
+	for (size_t i = m_offsets[process]; i != m_offsets[process + 1]; ++i)
+		children.push_back(m_processes[m_children[i]].m_processId);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the IDs of a process and all its descendants, with every process ahead
+//! of its children. The result is empty if the process is not in the tree.
+//! Each process is only visited once so that a cycle, which can only come from
+//! processes with the same creation time, neither loops forever nor lists a
+//! process twice.
+
+void ProcessTree::subtree(uint32 processId, ProcessIds& processIds) const
+{
+	processIds.clear();
+
+	const size_t root = find(processId);
+
+	if (root == m_processes.size())
+		return;
+
+	std::vector<bool> visited(m_processes.size(), false);
+	Children          pending(1, root);
+
+	while (!pending.empty())
+	{
+		const size_t process = pending.back();
+
+		pending.pop_back();
+
+		if (visited[process])
+			continue;
+
+		visited[process] = true;
+		processIds.push_back(m_processes[process].m_processId);
+
+		for (size_t i = m_offsets[process + 1]; i != m_offsets[process]; --i)
+			pending.push_back(m_children[i - 1]);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Terminate a process and all its descendants by executing Win32_Process's
+//! Terminate() method on each one, parents first so that a parent
+//! cannot start replacements for its children. The outcome for every process
+//! is returned, as one that has already exited will fail, and the number that
+//! were terminated is the result. As the processes are addressed by ID, each
+//! one is fetched first and only terminated if its creation time matches the
+//! tree's, so that an unrelated process that has since been given the ID of
+//! one that exited is left alone; it is reported as WBEM_E_NOT_FOUND.
+
+size_t ProcessTree::terminate(const Connection& connection, uint32 processId, uint32 reason, Terminations& terminations) const
+{
+	const tchar* CLASS_NAME = TXT("Win32_Process");
+	const tchar* TERMINATE = TXT("Terminate");
+
+	ProcessIds processIds;
+
+	terminations.clear();
+	subtree(processId, processIds);
+
+	if (processIds.empty())
+		return 0;
+
+	const Object        definition = connection.getObject(CLASS_NAME);
+	IWbemClassObjectPtr arguments = definition.createArgumentsObject(CLASS_NAME, TERMINATE);
+
+	Object::setArgument(arguments, TXT("Reason"), WCL::Variant(static_cast<int32>(reason)));
+
+	size_t terminated = 0;
+
+	for (ProcessIds::const_iterator it = processIds.begin(); it != processIds.end(); ++it)
+	{
+		const tstring path = Core::fmt(TXT("%s.Handle=\"%u\""), CLASS_NAME, *it);
+		WCL::Variant  returnValue;
+		Termination   termination = { *it, S_OK, 0 };
+
+		const Result<Object> current = connection.tryGetObject(path);
+
+		if (current.failed())
+		{
+			termination.m_result = current.result();
+			terminations.push_back(termination);
+			continue;
+		}
+
+		Object process = current.value();
+
+		if (fromProcess(process).m_created != m_processes[find(*it)].m_created)
+		{
+			termination.m_result = WBEM_E_NOT_FOUND;
+			terminations.push_back(termination);
+			continue;
+		}
+
+		termination.m_result = process.tryExecMethod(TERMINATE, arguments, returnValue);
+
+		if (SUCCEEDED(termination.m_result))
+		{
+			termination.m_returnValue = WCL::getValue<uint32>(WCL::Variant(returnValue, VT_UI4));
+
+			if (termination.m_returnValue == 0)
+				++terminated;
+		}
+
+		terminations.push_back(termination);
+	}
+
+	return terminated;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Read the identity of a process from a Win32_Process object. A null creation
+//! time, such as that of the idle process, is read as zero.
+
+ProcessTree::Process ProcessTree::fromProcess(const Object& process)
+{
+	Process result;
+
+	result.m_processId = static_cast<uint32>(process.getProperty<int32>(TXT("ProcessId")));
+	result.m_parentId  = static_cast<uint32>(process.getProperty<int32>(TXT("ParentProcessId")));
+	result.m_created   = 0;
+
+	WCL::Variant created;
+
+	process.getProperty(TXT("CreationDate"), created);
+
+	if ( (V_VT(&created) != VT_BSTR) || !tryParseFileTime(WCL::getValue<tstring>(created), result.m_created) )
+		result.m_created = 0;
+
+	return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Find the position of a process, or size() if it is not in the tree.
+
+size_t ProcessTree::find(uint32 processId) const
+{
+	Process key = { processId, 0, 0 };
+
+	Processes::const_iterator it = std::lower_bound(m_processes.begin(), m_processes.end(), key, lessById);
+
+	if ( (it == m_processes.end()) || (it->m_processId != processId) )
+		return m_processes.size();
+
+	return static_cast<size_t>(it - m_processes.begin());
+}
+
+//namespace WMI
+}
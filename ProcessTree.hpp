@@ -0,0 +1,165 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   ProcessTree.hpp
+//! \brief  The ProcessTree class declaration.
+//! \author Chris Oldwood
+
+// Check for previous inclusion
+#ifndef WMI_PROCESSTREE_HPP
+#define WMI_PROCESSTREE_HPP
+
+#if _MSC_VER > 1000
+#pragma once
+#endif
+
+#include <Core/NotCopyable.hpp>
+#include <vector>
+
+namespace WMI
+{
+
+// Forward declarations.
+class Object;
+class Connection;
+
+////////////////////////////////////////////////////////////////////////////////
+//! An index of the parent/child relationships between the processes on a host,
+//! built from a single query of Win32_Process, so that a whole process tree can
+//! be enumerated or terminated without a query per level.
+//!
+//! The processes are held sorted by ID and the children of each one are held
+//! in a single contiguous array, with a second array of offsets marking where
+//! each process's children start (the CSR layout used for sparse graphs). A
+//! process is only treated as the child of its parent ID when that process was
+//! created before it, as otherwise the parent has exited and its ID has been
+//! reused by an unrelated process.
+
+class ProcessTree : private Core::NotCopyable
+{
+public:
+	//! The identity of a process and its parent.
+	struct Process
+	{
+		uint32	m_processId;	//!< The process ID.
+		uint32	m_parentId;		//!< The ID of the parent process.
+		uint64	m_created;		//!< The creation time, in 100ns units.
+	};
+
+	//! The outcome of terminating a single process.
+	struct Termination
+	{
+		uint32	m_processId;	//!< The process ID.
+		HRESULT	m_result;		//!< The result of executing the method.
+		uint32	m_returnValue;	//!< The value returned by Terminate(), 0 on success.
+	};
+
+	//! A collection of processes.
+	typedef std::vector<Process> Processes;
+	//! A collection of process IDs.
+	typedef std::vector<uint32> ProcessIds;
+	//! The outcomes of terminating a process tree.
+	typedef std::vector<Termination> Terminations;
+
+public:
+	//! Default constructor.
+	ProcessTree();
+
+	//! Destructor.
+	~ProcessTree();
+
+	//
+	// Properties.
+	//
+
+	//! Get the number of processes in the tree.
+	size_t size() const;
+
+	//! Get the number of parent IDs found to have been reused.
+	size_t reusedIds() const;
+
+	//! Query if a process is in the tree.
+	bool contains(uint32 processId) const;
+
+	//
+	// Methods.
+	//
+
+	//! Build the tree from a snapshot of the processes.
+	void build(const Processes& processes);
+
+	//! Build the tree from the processes on a host with a single query.
+	void build(const Connection& connection); // throw(WMI::Exception)
+
+	//! Get the IDs of the immediate children of a process.
+	void children(uint32 processId, ProcessIds& children) const;
+
+	//! Get the IDs of a process and all its descendants, parents first.
+	void subtree(uint32 processId, ProcessIds& processIds) const;
+
+	//! Terminate a process and all its descendants, parents first.
+	size_t terminate(const Connection& connection, uint32 processId, uint32 reason, Terminations& terminations) const; // throw(WMI::Exception)
+
+	//
+	// Class methods.
+	//
+
+	//! Read the identity of a process from a Win32_Process object.
+	static Process fromProcess(const Object& process); // throw(WMI::Exception)
+
+	//
+	// Constants.
+	//
+
+	//! The query for the processes.
+	static const tchar* QUERY;
+
+private:
+	//! The offsets into the children, indexed by a process's position.
+	typedef std::vector<size_t> Offsets;
+	//! The positions of the children of every process.
+	typedef std::vector<size_t> Children;
+
+	//
+	// Members.
+	//
+	Processes	m_processes;	//!< The processes, sorted by ID.
+	Offsets		m_offsets;		//!< Where each process's children start, plus the end.
+	Children	m_children;		//!< The children of all processes, grouped by parent.
+	size_t		m_reused;		//!< The number of reused parent IDs found.
+
+	//
+	// Internal methods.
+	//
+
+	//! Find the position of a process, or size() if it is not in the tree.
+	size_t find(uint32 processId) const;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the number of processes in the tree.
+
+inline size_t ProcessTree::size() const
+{
+	return m_processes.size();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the number of processes whose parent ID was found to belong to a newer,
+//! unrelated process.
+
+inline size_t ProcessTree::reusedIds() const
+{
+	return m_reused;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Query if a process is in the tree.
+
+inline bool ProcessTree::contains(uint32 processId) const
+{
+	return (find(processId) != m_processes.size());
+}
+
+//namespace WMI
+}
+
+#endif // WMI_PROCESSTREE_HPP
@@ -0,0 +1,52 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   Random.cpp
+//! \brief  The Random class definition.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include "Random.hpp"
+
+namespace WMI
+{
+
+////////////////////////////////////////////////////////////////////////////////
+//! Default constructor.
+
+Random::Random()
+	: m_state(0)
+{
+	uint32 seed = ::GetCurrentThreadId() ^ ::GetTickCount()
+				^ static_cast<uint32>(reinterpret_cast<size_t>(this));
+
+	if (seed == 0)
+		seed = 1;
+
+	m_state = static_cast<LONG>(seed);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the next number in the range [0, 1). The state is advanced with an
+//! xorshift step that is swapped in atomically so that concurrent callers
+//! each draw a different number.
+
+double Random::next() const
+{
+	uint32 current, next;
+
+	do
+	{
+		current = static_cast<uint32>(m_state);
+		next = current;
+
+		next ^= next << 13;
+		next ^= next >> 17;
+		next ^= next << 5;
+	}
+	while (static_cast<uint32>(::InterlockedCompareExchange(&m_state, static_cast<LONG>(next),
+																static_cast<LONG>(current))) != current);
+
+	return static_cast<double>(next) / 4294967296.0;
+}
+
+//namespace WMI
+}
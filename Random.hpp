@@ -0,0 +1,47 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   Random.hpp
+//! \brief  The Random class declaration.
+//! \author Chris Oldwood
+
+// Check for previous inclusion
+#ifndef WMI_RANDOM_HPP
+#define WMI_RANDOM_HPP
+
+#if _MSC_VER > 1000
+#pragma once
+#endif
+
+namespace WMI
+{
+
+////////////////////////////////////////////////////////////////////////////////
+//! A source of random numbers for spreading out work, such as the jitter in a
+//! retry delay. Unlike the CRT's rand(), which has per-thread state that always
+//! starts from the same seed, each generator is seeded from the thread, the
+//! time and its own address so that threads and processes do not draw the same
+//! sequence. A generator can be shared by many threads.
+
+class Random
+{
+public:
+	//! Default constructor.
+	Random();
+
+	//
+	// Methods.
+	//
+
+	//! Get the next number in the range [0, 1).
+	double next() const;
+
+private:
+	//
+	// Members.
+	//
+	mutable volatile LONG	m_state;	//!< The generator's state, never zero.
+};
+
+//namespace WMI
+}
+
+#endif // WMI_RANDOM_HPP
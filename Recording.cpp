@@ -0,0 +1,605 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   Recording.cpp
+//! \brief  The Recording class definition.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include "Recording.hpp"
+#include "MemoryObject.hpp"
+#include "FileWriter.hpp"
+#include "Exception.hpp"
+#include <Core/StringUtils.hpp>
+#include <WCL/VariantVector.hpp>
+#include <string.h>
+
+#ifndef _MSC_VER
+WCL_DECLARE_IFACETRAITS(IWbemClassObject, IID_IWbemClassObject);
+#endif
+
+namespace WMI
+{
+
+////////////////////////////////////////////////////////////////////////////////
+// A recording file is a sequence of little-endian values:-
+//
+// file     := "WMIR" version:uint32 count:uint32 call*
+// call     := operation:uint32 result:int32 latency:uint32 target:string
+//             method:string count:uint32 (latency:uint32 object)*
+// object   := class:string count:uint32 property* count:uint32 method*
+// property := name:string type:uint32 flags:uint32 variant
+// method   := name:string present:uint32 object?
+// variant  := vt:uint16 value
+// string   := length:uint32 UTF-16 characters
+
+//! The value at the start of a recording file.
+static const char RECORDING_MAGIC[4] = { 'W', 'M', 'I', 'R' };
+
+//! The current version of the file format.
+static const uint32 RECORDING_VERSION = 1;
+
+//! The property flag for a key property.
+static const uint32 KEY_PROPERTY = 0x0001;
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the size of a fixed-size VARIANT type or 0 if not a fixed-size type.
+
+static size_t fixedSize(VARTYPE type)
+{
+	switch (type)
+	{
+		case VT_I1:
+		case VT_UI1:	return 1;
+		case VT_I2:
+		case VT_UI2:
+		case VT_BOOL:	return 2;
+		case VT_I4:
+		case VT_UI4:
+		case VT_INT:
+		case VT_UINT:
+		case VT_R4:		return 4;
+		case VT_I8:
+		case VT_UI8:
+		case VT_R8:
+		case VT_CY:
+		case VT_DATE:	return 8;
+		default:		break;
+	}
+
+	return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Write a 32-bit value.
+
+static void writeUInt32(BufferedWriter& writer, uint32 value)
+{
+	writer.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Write a length prefixed string.
+
+static void writeString(BufferedWriter& writer, const wchar_t* text, size_t length)
+{
+	writeUInt32(writer, static_cast<uint32>(length));
+	writer.write(reinterpret_cast<const char*>(text), length * sizeof(wchar_t));
+}
+
+static void writeObject(BufferedWriter& writer, IWbemClassObjectPtr object);
+
+////////////////////////////////////////////////////////////////////////////////
+//! Write a VARIANT value. Unsupported types are written as nulls.
+
+static void writeVariant(BufferedWriter& writer, const VARIANT& value)
+{
+	const VARTYPE type = static_cast<VARTYPE>(V_VT(&value) & VT_TYPEMASK);
+	const bool    isArray = ((V_VT(&value) & VT_ARRAY) != 0);
+
+	if (isArray && (V_ARRAY(&value) != nullptr) && ((type == VT_BSTR) || (fixedSize(type) != 0)))
+	{
+		SAFEARRAY* array = V_ARRAY(&value);
+		LONG       lower = 0, upper = -1;
+		void*      data = nullptr;
+
+		::SafeArrayGetLBound(array, 1, &lower);
+		::SafeArrayGetUBound(array, 1, &upper);
+
+		if (SUCCEEDED(::SafeArrayAccessData(array, &data)))
+		{
+			const uint32 count = static_cast<uint32>(upper - lower + 1);
+			const VARTYPE vt = V_VT(&value);
+
+			writer.write(reinterpret_cast<const char*>(&vt), sizeof(vt));
+			writeUInt32(writer, count);
+
+			if (type == VT_BSTR)
+			{
+				const BSTR* strings = static_cast<const BSTR*>(data);
+
+				for (uint32 i = 0; i != count; ++i)
+					writeString(writer, (strings[i] != nullptr) ? strings[i] : L"", ::SysStringLen(strings[i]));
+			}
+			else
+			{
+				writer.write(static_cast<const char*>(data), count * fixedSize(type));
+			}
+
+			::SafeArrayUnaccessData(array);
+			return;
+		}
+	}
+	else if (!isArray && (type == VT_BSTR))
+	{
+		const VARTYPE vt = VT_BSTR;
+
+		writer.write(reinterpret_cast<const char*>(&vt), sizeof(vt));
+		writeString(writer, (V_BSTR(&value) != nullptr) ? V_BSTR(&value) : L"", ::SysStringLen(V_BSTR(&value)));
+		return;
+	}
+	else if (!isArray && (type == VT_UNKNOWN) && (V_UNKNOWN(&value) != nullptr))
+	{
+		IWbemClassObjectPtr object;
+
+		if (SUCCEEDED(V_UNKNOWN(&value)->QueryInterface(IID_IWbemClassObject, reinterpret_cast<void**>(AttachTo(object)))))
+		{
+			const VARTYPE vt = VT_UNKNOWN;
+
+			writer.write(reinterpret_cast<const char*>(&vt), sizeof(vt));
+			writeObject(writer, object);
+			return;
+		}
+	}
+	else if (!isArray && (fixedSize(type) != 0))
+	{
+		const VARTYPE vt = type;
+
+		writer.write(reinterpret_cast<const char*>(&vt), sizeof(vt));
+		writer.write(reinterpret_cast<const char*>(&V_UI1(&value)), fixedSize(type));
+		return;
+	}
+
+	const VARTYPE vt = VT_NULL;
+
+	writer.write(reinterpret_cast<const char*>(&vt), sizeof(vt));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Write an object, including its system properties and methods.
+
+static void writeObject(BufferedWriter& writer, IWbemClassObjectPtr object)
+{
+	SAFEARRAY* names = nullptr;
+	SAFEARRAY* keys = nullptr;
+
+	HRESULT result = object->GetNames(nullptr, WBEM_FLAG_ALWAYS, nullptr, &names);
+
+	if (FAILED(result))
+		throw Exception(result, object, TXT("Failed to retrieve the property names of a recorded object"));
+
+	WCL::VariantVector<BSTR> propertyNames(names, VT_BSTR, true);
+	std::vector<tstring>     keyNames;
+
+	if (SUCCEEDED(object->GetNames(nullptr, WBEM_FLAG_KEYS_ONLY, nullptr, &keys)))
+	{
+		WCL::VariantVector<BSTR> keyVector(keys, VT_BSTR, true);
+
+		keyNames.assign(keyVector.begin(), keyVector.end());
+	}
+
+	WCL::Variant className;
+
+	object->Get(L"__CLASS", 0, &className, nullptr, nullptr);
+
+	if (V_VT(&className) == VT_BSTR)
+		writeString(writer, V_BSTR(&className), ::SysStringLen(V_BSTR(&className)));
+	else
+		writeString(writer, L"", 0);
+
+	writeUInt32(writer, static_cast<uint32>(propertyNames.size()));
+
+	for (WCL::VariantVector<BSTR>::const_iterator it = propertyNames.begin(); it != propertyNames.end(); ++it)
+	{
+		const tstring name(*it);
+		WCL::Variant  value;
+		CIMTYPE       type = CIM_EMPTY;
+		uint32        flags = 0;
+
+		result = object->Get(name.c_str(), 0, &value, &type, nullptr);
+
+		if (FAILED(result))
+		{
+			const tstring message = Core::fmt(TXT("Failed to retrieve the recorded property '%s'"), name.c_str());
+			throw Exception(result, object, message.c_str());
+		}
+
+		for (size_t k = 0; k != keyNames.size(); ++k)
+		{
+			if (_wcsicmp(keyNames[k].c_str(), name.c_str()) == 0)
+				flags |= KEY_PROPERTY;
+		}
+
+		writeString(writer, name.c_str(), name.length());
+		writeUInt32(writer, static_cast<uint32>(type));
+		writeUInt32(writer, flags);
+		writeVariant(writer, value);
+	}
+
+	std::vector<tstring>             methodNames;
+	std::vector<IWbemClassObjectPtr> methodParams;
+
+	if (SUCCEEDED(object->BeginMethodEnumeration(0)))
+	{
+		for (;;)
+		{
+			BSTR                methodName = nullptr;
+			IWbemClassObjectPtr inParams;
+
+			if (object->NextMethod(0, &methodName, AttachTo(inParams), nullptr) != WBEM_S_NO_ERROR)
+				break;
+
+			methodNames.push_back(methodName);
+			methodParams.push_back(inParams);
+
+			::SysFreeString(methodName);
+		}
+
+		object->EndMethodEnumeration();
+	}
+
+	writeUInt32(writer, static_cast<uint32>(methodNames.size()));
+
+	for (size_t i = 0; i != methodNames.size(); ++i)
+	{
+		writeString(writer, methodNames[i].c_str(), methodNames[i].length());
+		writeUInt32(writer, (methodParams[i].get() != nullptr) ? 1 : 0);
+
+		if (methodParams[i].get() != nullptr)
+			writeObject(writer, methodParams[i]);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Throw the exception used to report a malformed recording.
+
+static void throwCorrupt()
+{
+	throw Exception(HRESULT_FROM_WIN32(ERROR_INVALID_DATA), TXT("The recording is corrupt or truncated"));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Read a block of bytes.
+
+static void readBytes(const byte*& it, const byte* end, void* buffer, size_t size)
+{
+	if (static_cast<size_t>(end - it) < size)
+		throwCorrupt();
+
+	memcpy(buffer, it, size);
+	it += size;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Read a 32-bit value.
+
+static uint32 readUInt32(const byte*& it, const byte* end)
+{
+	uint32 value;
+
+	readBytes(it, end, &value, sizeof(value));
+
+	return value;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Read a length prefixed string.
+
+static tstring readString(const byte*& it, const byte* end)
+{
+	const uint32 length = readUInt32(it, end);
+
+	if ((static_cast<size_t>(end - it) / sizeof(wchar_t)) < length)
+		throwCorrupt();
+
+	const wchar_t* text = reinterpret_cast<const wchar_t*>(it);
+
+	it += length * sizeof(wchar_t);
+
+	return tstring(text, text + length);
+}
+
+static IWbemClassObjectPtr readObject(const byte*& it, const byte* end);
+
+////////////////////////////////////////////////////////////////////////////////
+//! Read a VARIANT value.
+
+static void readVariant(const byte*& it, const byte* end, WCL::Variant& value)
+{
+	VARTYPE vt;
+
+	readBytes(it, end, &vt, sizeof(vt));
+
+	const VARTYPE type = static_cast<VARTYPE>(vt & VT_TYPEMASK);
+
+	if (vt & VT_ARRAY)
+	{
+		const uint32 count = readUInt32(it, end);
+		const size_t size = fixedSize(type);
+
+		if ( (type != VT_BSTR) && (size == 0) )
+			throwCorrupt();
+
+		if ( (size != 0) && ((static_cast<size_t>(end - it) / size) < count) )
+			throwCorrupt();
+
+		SAFEARRAY* array = ::SafeArrayCreateVector(type, 0, count);
+
+		if (array == nullptr)
+			throw Exception(E_OUTOFMEMORY, TXT("Failed to allocate a recorded array"));
+
+		V_VT(&value)    = vt;
+		V_ARRAY(&value) = array;
+
+		void* data = nullptr;
+
+		::SafeArrayAccessData(array, &data);
+
+		if (type == VT_BSTR)
+		{
+			BSTR* strings = static_cast<BSTR*>(data);
+
+			try
+			{
+				for (uint32 i = 0; i != count; ++i)
+				{
+					const tstring string = readString(it, end);
+
+					strings[i] = ::SysAllocStringLen(string.data(), static_cast<UINT>(string.length()));
+				}
+			}
+			catch (...)
+			{
+				::SafeArrayUnaccessData(array);
+				throw;
+			}
+		}
+		else
+		{
+			readBytes(it, end, data, count * size);
+		}
+
+		::SafeArrayUnaccessData(array);
+	}
+	else if (type == VT_BSTR)
+	{
+		const tstring string = readString(it, end);
+
+		V_VT(&value)   = VT_BSTR;
+		V_BSTR(&value) = ::SysAllocStringLen(string.data(), static_cast<UINT>(string.length()));
+	}
+	else if (type == VT_UNKNOWN)
+	{
+		IWbemClassObjectPtr object = readObject(it, end);
+
+		V_VT(&value)      = VT_UNKNOWN;
+		V_UNKNOWN(&value) = object.get();
+		V_UNKNOWN(&value)->AddRef();
+	}
+	else if ( (type == VT_NULL) || (type == VT_EMPTY) )
+	{
+		V_VT(&value) = type;
+	}
+	else
+	{
+		const size_t size = fixedSize(type);
+
+		if (size == 0)
+			throwCorrupt();
+
+		V_VT(&value) = type;
+		V_I8(&value) = 0;
+		readBytes(it, end, &V_UI1(&value), size);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Read an object as an in-memory object.
+
+static IWbemClassObjectPtr readObject(const byte*& it, const byte* end)
+{
+	MemoryObject*       object = new MemoryObject(readString(it, end));
+	IWbemClassObjectPtr result = object->getInterface();
+
+	const uint32 properties = readUInt32(it, end);
+
+	for (uint32 i = 0; i != properties; ++i)
+	{
+		const tstring  name = readString(it, end);
+		const CIMTYPE  type = static_cast<CIMTYPE>(readUInt32(it, end));
+		const uint32   flags = readUInt32(it, end);
+		WCL::Variant   value;
+
+		readVariant(it, end, value);
+
+		object->setProperty(name, value, type, (flags & KEY_PROPERTY) != 0);
+	}
+
+	const uint32 methods = readUInt32(it, end);
+
+	for (uint32 i = 0; i != methods; ++i)
+	{
+		const tstring       name = readString(it, end);
+		IWbemClassObjectPtr inParams;
+
+		if (readUInt32(it, end) != 0)
+			inParams = readObject(it, end);
+
+		object->setMethod(name, inParams);
+	}
+
+	return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Default constructor.
+
+Recording::Recording()
+	: m_calls()
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Destructor.
+
+Recording::~Recording()
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Add a call and return its index.
+
+size_t Recording::addCall(Operation operation, const tstring& target, const tstring& method, HRESULT result, uint32 latency)
+{
+	Call call;
+
+	call.m_operation = operation;
+	call.m_target    = target;
+	call.m_method    = method;
+	call.m_result    = result;
+	call.m_latency   = latency;
+
+	m_calls.push_back(call);
+
+	return m_calls.size() - 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Add a copy of an object returned by a call, along with the time taken to
+//! fetch it.
+
+void Recording::addObject(size_t call, IWbemClassObjectPtr object, uint32 latency)
+{
+	ASSERT(call < m_calls.size());
+
+	m_calls[call].m_objects.push_back(MemoryObject::copy(object));
+	m_calls[call].m_latencies.push_back(latency);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Remove all the calls.
+
+void Recording::clear()
+{
+	m_calls.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Write the recording to a file.
+
+void Recording::save(const tstring& path) const
+{
+	FileWriter file(path);
+
+	file.write(RECORDING_MAGIC, sizeof(RECORDING_MAGIC));
+	writeUInt32(file, RECORDING_VERSION);
+	writeUInt32(file, static_cast<uint32>(m_calls.size()));
+
+	for (Calls::const_iterator it = m_calls.begin(); it != m_calls.end(); ++it)
+	{
+		writeUInt32(file, it->m_operation);
+		writeUInt32(file, static_cast<uint32>(it->m_result));
+		writeUInt32(file, it->m_latency);
+		writeString(file, it->m_target.c_str(), it->m_target.length());
+		writeString(file, it->m_method.c_str(), it->m_method.length());
+		writeUInt32(file, static_cast<uint32>(it->m_objects.size()));
+
+		for (size_t i = 0; i != it->m_objects.size(); ++i)
+		{
+			writeUInt32(file, it->m_latencies[i]);
+			writeObject(file, it->m_objects[i]);
+		}
+	}
+
+	file.close();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Replace the recording with one read from a file.
+
+void Recording::load(const tstring& path)
+{
+	HANDLE file = ::CreateFile(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+								FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		const tstring message = Core::fmt(TXT("Failed to open the recording '%s'"), path.c_str());
+		throw Exception(HRESULT_FROM_WIN32(::GetLastError()), message.c_str());
+	}
+
+	std::vector<byte> buffer;
+	LARGE_INTEGER     size;
+	DWORD             read = 0;
+	bool              succeeded = false;
+
+	if (::GetFileSizeEx(file, &size) && (size.QuadPart < 0x7FFFFFFF))
+	{
+		buffer.resize(static_cast<size_t>(size.QuadPart) + 1);
+
+		succeeded = ::ReadFile(file, &buffer[0], static_cast<DWORD>(size.QuadPart), &read, nullptr)
+				 && (read == static_cast<DWORD>(size.QuadPart));
+	}
+
+	const DWORD error = ::GetLastError();
+
+	::CloseHandle(file);
+
+	if (!succeeded)
+	{
+		const tstring message = Core::fmt(TXT("Failed to read the recording '%s'"), path.c_str());
+		throw Exception(HRESULT_FROM_WIN32((error != NO_ERROR) ? error : ERROR_INVALID_DATA), message.c_str());
+	}
+
+	const byte* it = &buffer[0];
+	const byte* end = it + read;
+	char        magic[4];
+
+	readBytes(it, end, magic, sizeof(magic));
+
+	if ( (memcmp(magic, RECORDING_MAGIC, sizeof(magic)) != 0) || (readUInt32(it, end) != RECORDING_VERSION) )
+	{
+		const tstring message = Core::fmt(TXT("The file '%s' is not a supported recording"), path.c_str());
+		throw Exception(HRESULT_FROM_WIN32(ERROR_INVALID_DATA), message.c_str());
+	}
+
+	Calls        calls;
+	const uint32 count = readUInt32(it, end);
+
+	for (uint32 i = 0; i != count; ++i)
+	{
+		Call call;
+
+		call.m_operation = static_cast<Operation>(readUInt32(it, end));
+		call.m_result    = static_cast<HRESULT>(readUInt32(it, end));
+		call.m_latency   = readUInt32(it, end);
+		call.m_target    = readString(it, end);
+		call.m_method    = readString(it, end);
+
+		if ( (call.m_operation != GET_OBJECT) && (call.m_operation != EXEC_QUERY) && (call.m_operation != EXEC_METHOD) )
+			throwCorrupt();
+
+		const uint32 objects = readUInt32(it, end);
+
+		for (uint32 j = 0; j != objects; ++j)
+		{
+			call.m_latencies.push_back(readUInt32(it, end));
+			call.m_objects.push_back(readObject(it, end));
+		}
+
+		calls.push_back(call);
+	}
+
+	m_calls.swap(calls);
+}
+
+//namespace WMI
+}
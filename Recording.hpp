@@ -0,0 +1,113 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   Recording.hpp
+//! \brief  The Recording class declaration.
+//! \author Chris Oldwood
+
+// Check for previous inclusion
+#ifndef WMI_RECORDING_HPP
+#define WMI_RECORDING_HPP
+
+#if _MSC_VER > 1000
+#pragma once
+#endif
+
+#include "Types.hpp"
+#include <Core/NotCopyable.hpp>
+#include <Core/SharedPtr.hpp>
+#include <vector>
+
+namespace WMI
+{
+
+////////////////////////////////////////////////////////////////////////////////
+//! The calls made on a WMI connection, along with their results and timings,
+//! as captured by the RecordingServices and served by the ReplayServices. The
+//! objects are held as in-memory copies so that the recording is independent
+//! of the provider it was captured from.
+
+class Recording : private Core::NotCopyable
+{
+public:
+	//! The recorded operations.
+	enum Operation
+	{
+		GET_OBJECT  = 1,	//!< IWbemServices::GetObject().
+		EXEC_QUERY  = 2,	//!< IWbemServices::ExecQuery().
+		EXEC_METHOD = 3,	//!< IWbemServices::ExecMethod().
+	};
+
+	//! The collection of objects returned by a call.
+	typedef std::vector<IWbemClassObjectPtr> Objects;
+	//! The collection of delays, in microseconds.
+	typedef std::vector<uint32> Latencies;
+
+	//! A single call.
+	struct Call
+	{
+		Operation	m_operation;	//!< The operation.
+		tstring		m_target;		//!< The object path or query.
+		tstring		m_method;		//!< The method name, if a method call.
+		HRESULT		m_result;		//!< The result of the call.
+		uint32		m_latency;		//!< The duration of the call in microseconds.
+		Objects		m_objects;		//!< The objects returned.
+		Latencies	m_latencies;	//!< The time taken to fetch each object.
+	};
+
+	//! The collection of calls.
+	typedef std::vector<Call> Calls;
+
+public:
+	//! Default constructor.
+	Recording();
+
+	//! Destructor.
+	~Recording();
+
+	//
+	// Properties.
+	//
+
+	//! Get the calls in the order they were made.
+	const Calls& calls() const;
+
+	//
+	// Methods.
+	//
+
+	//! Add a call and return its index.
+	size_t addCall(Operation operation, const tstring& target, const tstring& method, HRESULT result, uint32 latency);
+
+	//! Add a copy of an object returned by a call.
+	void addObject(size_t call, IWbemClassObjectPtr object, uint32 latency); // throw(WMI::Exception)
+
+	//! Remove all the calls.
+	void clear();
+
+	//! Write the recording to a file.
+	void save(const tstring& path) const; // throw(WMI::Exception)
+
+	//! Replace the recording with one read from a file.
+	void load(const tstring& path); // throw(WMI::Exception)
+
+private:
+	//
+	// Members.
+	//
+	Calls	m_calls;	//!< The recorded calls.
+};
+
+//! The default Recording smart-pointer type.
+typedef Core::SharedPtr<Recording> RecordingPtr;
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the calls in the order they were made.
+
+inline const Recording::Calls& Recording::calls() const
+{
+	return m_calls;
+}
+
+//namespace WMI
+}
+
+#endif // WMI_RECORDING_HPP
@@ -0,0 +1,161 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   RecordingEnumerator.cpp
+//! \brief  The RecordingEnumerator class definition.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include "RecordingEnumerator.hpp"
+#include "Stopwatch.hpp"
+
+#ifndef _MSC_VER
+WCL_DECLARE_IFACETRAITS(IEnumWbemClassObject, IID_IEnumWbemClassObject);
+WCL_DECLARE_IFACETRAITS(IWbemClassObject, IID_IWbemClassObject);
+#endif
+
+namespace WMI
+{
+
+////////////////////////////////////////////////////////////////////////////////
+//! Construction from the enumerator to record and the call to add to.
+
+RecordingEnumerator::RecordingEnumerator(IEnumWbemClassObjectPtr enumerator, RecordingPtr recording, size_t call)
+	: m_refCount(0)
+	, m_enumerator(enumerator)
+	, m_recording(recording)
+	, m_call(call)
+{
+	ASSERT(m_enumerator.get() != nullptr);
+	ASSERT(m_recording.get() != nullptr);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Destructor.
+
+RecordingEnumerator::~RecordingEnumerator()
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get a reference counted COM interface to the enumerator.
+
+IEnumWbemClassObjectPtr RecordingEnumerator::getInterface()
+{
+	IEnumWbemClassObjectPtr enumerator;
+
+	AddRef();
+	*AttachTo(enumerator) = this;
+
+	return enumerator;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Query the object for an interface.
+
+HRESULT STDMETHODCALLTYPE RecordingEnumerator::QueryInterface(REFIID iid, void** object)
+{
+	if (object == nullptr)
+		return E_POINTER;
+
+	if ( (iid == IID_IUnknown) || (iid == IID_IEnumWbemClassObject) )
+	{
+		*object = static_cast<IEnumWbemClassObject*>(this);
+		AddRef();
+		return S_OK;
+	}
+
+	*object = nullptr;
+	return E_NOINTERFACE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Increment the reference count.
+
+ULONG STDMETHODCALLTYPE RecordingEnumerator::AddRef()
+{
+	return ::InterlockedIncrement(&m_refCount);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Decrement the reference count.
+
+ULONG STDMETHODCALLTYPE RecordingEnumerator::Release()
+{
+	const LONG refCount = ::InterlockedDecrement(&m_refCount);
+
+	if (refCount == 0)
+		delete this;
+
+	return refCount;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Move back to the start of the sequence.
+
+HRESULT STDMETHODCALLTYPE RecordingEnumerator::Reset()
+{
+	return m_enumerator->Reset();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the next batch of objects and record them. The time taken to fetch the
+//! batch is shared equally between the objects. If an object cannot be copied
+//! the batch is discarded so that the recording is not silently incomplete.
+
+HRESULT STDMETHODCALLTYPE RecordingEnumerator::Next(long timeout, ULONG count, IWbemClassObject** objects, ULONG* returned)
+{
+	Stopwatch stopwatch;
+
+	HRESULT result = m_enumerator->Next(timeout, count, objects, returned);
+
+	if (SUCCEEDED(result) && (objects != nullptr) && (returned != nullptr) && (*returned != 0))
+	{
+		const uint32 latency = static_cast<uint32>(stopwatch.elapsedMicroseconds() / *returned);
+
+		try
+		{
+			for (ULONG i = 0; i != *returned; ++i)
+			{
+				IWbemClassObjectPtr object(objects[i], true);
+
+				m_recording->addObject(m_call, object, latency);
+			}
+		}
+		catch (const Core::Exception&)
+		{
+			for (ULONG i = 0; i != *returned; ++i)
+				objects[i]->Release();
+
+			*returned = 0;
+			return WBEM_E_FAILED;
+		}
+	}
+
+	return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Asynchronous enumeration is not recorded.
+
+HRESULT STDMETHODCALLTYPE RecordingEnumerator::NextAsync(ULONG /*count*/, IWbemObjectSink* /*sink*/)
+{
+	return WBEM_E_NOT_SUPPORTED;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Create a copy of the underlying enumerator. The copy is not recorded.
+
+HRESULT STDMETHODCALLTYPE RecordingEnumerator::Clone(IEnumWbemClassObject** copy)
+{
+	return m_enumerator->Clone(copy);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Skip over a number of objects. The skipped objects are not recorded.
+
+HRESULT STDMETHODCALLTYPE RecordingEnumerator::Skip(long timeout, ULONG count)
+{
+	return m_enumerator->Skip(timeout, count);
+}
+
+//namespace WMI
+}
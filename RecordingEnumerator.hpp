@@ -0,0 +1,78 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   RecordingEnumerator.hpp
+//! \brief  The RecordingEnumerator class declaration.
+//! \author Chris Oldwood
+
+// Check for previous inclusion
+#ifndef WMI_RECORDINGENUMERATOR_HPP
+#define WMI_RECORDINGENUMERATOR_HPP
+
+#if _MSC_VER > 1000
+#pragma once
+#endif
+
+#include "Types.hpp"
+#include "Recording.hpp"
+#include <Core/NotCopyable.hpp>
+
+namespace WMI
+{
+
+////////////////////////////////////////////////////////////////////////////////
+//! An IEnumWbemClassObject decorator, created by the RecordingServices, that
+//! adds a copy of each object served by the underlying enumerator to a call in
+//! the recording, along with the time taken to fetch it.
+
+class RecordingEnumerator : public IEnumWbemClassObject, private Core::NotCopyable
+{
+public:
+	//! Construction from the enumerator to record and the call to add to.
+	RecordingEnumerator(IEnumWbemClassObjectPtr enumerator, RecordingPtr recording, size_t call);
+
+	//
+	// Methods.
+	//
+
+	//! Get a reference counted COM interface to the enumerator.
+	IEnumWbemClassObjectPtr getInterface();
+
+	//
+	// IUnknown methods.
+	//
+
+	//! Query the object for an interface.
+	virtual HRESULT STDMETHODCALLTYPE QueryInterface(REFIID iid, void** object);
+
+	//! Increment the reference count.
+	virtual ULONG STDMETHODCALLTYPE AddRef();
+
+	//! Decrement the reference count.
+	virtual ULONG STDMETHODCALLTYPE Release();
+
+	//
+	// IEnumWbemClassObject methods.
+	//
+
+	virtual HRESULT STDMETHODCALLTYPE Reset();
+	virtual HRESULT STDMETHODCALLTYPE Next(long timeout, ULONG count, IWbemClassObject** objects, ULONG* returned);
+	virtual HRESULT STDMETHODCALLTYPE NextAsync(ULONG count, IWbemObjectSink* sink);
+	virtual HRESULT STDMETHODCALLTYPE Clone(IEnumWbemClassObject** copy);
+	virtual HRESULT STDMETHODCALLTYPE Skip(long timeout, ULONG count);
+
+private:
+	//
+	// Members.
+	//
+	LONG					m_refCount;		//!< The COM reference count.
+	IEnumWbemClassObjectPtr	m_enumerator;	//!< The underlying enumerator.
+	RecordingPtr			m_recording;	//!< The recording to add to.
+	size_t					m_call;			//!< The index of the call in the recording.
+
+	//! Destructor.
+	virtual ~RecordingEnumerator();
+};
+
+//namespace WMI
+}
+
+#endif // WMI_RECORDINGENUMERATOR_HPP
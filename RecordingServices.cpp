@@ -0,0 +1,350 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   RecordingServices.cpp
+//! \brief  The RecordingServices class definition.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include "RecordingServices.hpp"
+#include "RecordingEnumerator.hpp"
+#include "Stopwatch.hpp"
+
+#ifndef _MSC_VER
+WCL_DECLARE_IFACETRAITS(IWbemServices, IID_IWbemServices);
+WCL_DECLARE_IFACETRAITS(IEnumWbemClassObject, IID_IEnumWbemClassObject);
+WCL_DECLARE_IFACETRAITS(IWbemClassObject, IID_IWbemClassObject);
+#endif
+
+namespace WMI
+{
+
+////////////////////////////////////////////////////////////////////////////////
+//! Convert a possibly null BSTR argument to a string.
+
+static tstring toString(const BSTR value)
+{
+	return (value != nullptr) ? tstring(value) : tstring();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the call duration in microseconds.
+
+static uint32 latency(const Stopwatch& stopwatch)
+{
+	return static_cast<uint32>(stopwatch.elapsedMicroseconds());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Construction from the connection to record and the recording to add to.
+
+RecordingServices::RecordingServices(IWbemServicesPtr services, RecordingPtr recording)
+	: m_refCount(0)
+	, m_services(services)
+	, m_recording(recording)
+{
+	ASSERT(m_services.get() != nullptr);
+	ASSERT(m_recording.get() != nullptr);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Destructor.
+
+RecordingServices::~RecordingServices()
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get a reference counted COM interface to the connection.
+
+IWbemServicesPtr RecordingServices::getInterface()
+{
+	IWbemServicesPtr services;
+
+	AddRef();
+	*AttachTo(services) = this;
+
+	return services;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Query the object for an interface.
+
+HRESULT STDMETHODCALLTYPE RecordingServices::QueryInterface(REFIID iid, void** object)
+{
+	if (object == nullptr)
+		return E_POINTER;
+
+	if ( (iid == IID_IUnknown) || (iid == IID_IWbemServices) )
+	{
+		*object = static_cast<IWbemServices*>(this);
+		AddRef();
+		return S_OK;
+	}
+
+	*object = nullptr;
+	return E_NOINTERFACE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Increment the reference count.
+
+ULONG STDMETHODCALLTYPE RecordingServices::AddRef()
+{
+	return ::InterlockedIncrement(&m_refCount);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Decrement the reference count.
+
+ULONG STDMETHODCALLTYPE RecordingServices::Release()
+{
+	const LONG refCount = ::InterlockedDecrement(&m_refCount);
+
+	if (refCount == 0)
+		delete this;
+
+	return refCount;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Forwarded without recording.
+
+HRESULT STDMETHODCALLTYPE RecordingServices::OpenNamespace(const BSTR nmspace, long flags, IWbemContext* context, IWbemServices** services, IWbemCallResult** callResult)
+{
+	return m_services->OpenNamespace(nmspace, flags, context, services, callResult);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Forwarded without recording.
+
+HRESULT STDMETHODCALLTYPE RecordingServices::CancelAsyncCall(IWbemObjectSink* sink)
+{
+	return m_services->CancelAsyncCall(sink);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Forwarded without recording.
+
+HRESULT STDMETHODCALLTYPE RecordingServices::QueryObjectSink(long flags, IWbemObjectSink** sink)
+{
+	return m_services->QueryObjectSink(flags, sink);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get a single object and record it.
+
+HRESULT STDMETHODCALLTYPE RecordingServices::GetObject(const BSTR path, long flags, IWbemContext* context, IWbemClassObject** object, IWbemCallResult** callResult)
+{
+	Stopwatch stopwatch;
+
+	HRESULT result = m_services->GetObject(path, flags, context, object, callResult);
+
+	const size_t call = m_recording->addCall(Recording::GET_OBJECT, toString(path), tstring(), result, latency(stopwatch));
+
+	if (SUCCEEDED(result) && (object != nullptr) && (*object != nullptr))
+	{
+		try
+		{
+			m_recording->addObject(call, IWbemClassObjectPtr(*object, true), 0);
+		}
+		catch (const Core::Exception&)
+		{
+			(*object)->Release();
+			*object = nullptr;
+			return WBEM_E_FAILED;
+		}
+	}
+
+	return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Forwarded without recording.
+
+HRESULT STDMETHODCALLTYPE RecordingServices::GetObjectAsync(const BSTR path, long flags, IWbemContext* context, IWbemObjectSink* sink)
+{
+	return m_services->GetObjectAsync(path, flags, context, sink);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Forwarded without recording.
+
+HRESULT STDMETHODCALLTYPE RecordingServices::PutClass(IWbemClassObject* object, long flags, IWbemContext* context, IWbemCallResult** callResult)
+{
+	return m_services->PutClass(object, flags, context, callResult);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Forwarded without recording.
+
+HRESULT STDMETHODCALLTYPE RecordingServices::PutClassAsync(IWbemClassObject* object, long flags, IWbemContext* context, IWbemObjectSink* sink)
+{
+	return m_services->PutClassAsync(object, flags, context, sink);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Forwarded without recording.
+
+HRESULT STDMETHODCALLTYPE RecordingServices::DeleteClass(const BSTR className, long flags, IWbemContext* context, IWbemCallResult** callResult)
+{
+	return m_services->DeleteClass(className, flags, context, callResult);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Forwarded without recording.
+
+HRESULT STDMETHODCALLTYPE RecordingServices::DeleteClassAsync(const BSTR className, long flags, IWbemContext* context, IWbemObjectSink* sink)
+{
+	return m_services->DeleteClassAsync(className, flags, context, sink);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Forwarded without recording.
+
+HRESULT STDMETHODCALLTYPE RecordingServices::CreateClassEnum(const BSTR superclass, long flags, IWbemContext* context, IEnumWbemClassObject** enumerator)
+{
+	return m_services->CreateClassEnum(superclass, flags, context, enumerator);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Forwarded without recording.
+
+HRESULT STDMETHODCALLTYPE RecordingServices::CreateClassEnumAsync(const BSTR superclass, long flags, IWbemContext* context, IWbemObjectSink* sink)
+{
+	return m_services->CreateClassEnumAsync(superclass, flags, context, sink);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Forwarded without recording.
+
+HRESULT STDMETHODCALLTYPE RecordingServices::PutInstance(IWbemClassObject* instance, long flags, IWbemContext* context, IWbemCallResult** callResult)
+{
+	return m_services->PutInstance(instance, flags, context, callResult);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Forwarded without recording.
+
+HRESULT STDMETHODCALLTYPE RecordingServices::PutInstanceAsync(IWbemClassObject* instance, long flags, IWbemContext* context, IWbemObjectSink* sink)
+{
+	return m_services->PutInstanceAsync(instance, flags, context, sink);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Forwarded without recording.
+
+HRESULT STDMETHODCALLTYPE RecordingServices::DeleteInstance(const BSTR path, long flags, IWbemContext* context, IWbemCallResult** callResult)
+{
+	return m_services->DeleteInstance(path, flags, context, callResult);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Forwarded without recording.
+
+HRESULT STDMETHODCALLTYPE RecordingServices::DeleteInstanceAsync(const BSTR path, long flags, IWbemContext* context, IWbemObjectSink* sink)
+{
+	return m_services->DeleteInstanceAsync(path, flags, context, sink);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Forwarded without recording.
+
+HRESULT STDMETHODCALLTYPE RecordingServices::CreateInstanceEnum(const BSTR className, long flags, IWbemContext* context, IEnumWbemClassObject** enumerator)
+{
+	return m_services->CreateInstanceEnum(className, flags, context, enumerator);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Forwarded without recording.
+
+HRESULT STDMETHODCALLTYPE RecordingServices::CreateInstanceEnumAsync(const BSTR className, long flags, IWbemContext* context, IWbemObjectSink* sink)
+{
+	return m_services->CreateInstanceEnumAsync(className, flags, context, sink);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Execute a query and return an enumerator that records the results as they
+//! are fetched.
+
+HRESULT STDMETHODCALLTYPE RecordingServices::ExecQuery(const BSTR language, const BSTR query, long flags, IWbemContext* context, IEnumWbemClassObject** enumerator)
+{
+	Stopwatch stopwatch;
+
+	HRESULT result = m_services->ExecQuery(language, query, flags, context, enumerator);
+
+	const size_t call = m_recording->addCall(Recording::EXEC_QUERY, toString(query), tstring(), result, latency(stopwatch));
+
+	if (SUCCEEDED(result) && (enumerator != nullptr) && (*enumerator != nullptr))
+	{
+		IEnumWbemClassObjectPtr results(*enumerator);
+		RecordingEnumerator*    recorder = new RecordingEnumerator(results, m_recording, call);
+
+		recorder->AddRef();
+		*enumerator = recorder;
+	}
+
+	return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Forwarded without recording.
+
+HRESULT STDMETHODCALLTYPE RecordingServices::ExecQueryAsync(const BSTR language, const BSTR query, long flags, IWbemContext* context, IWbemObjectSink* sink)
+{
+	return m_services->ExecQueryAsync(language, query, flags, context, sink);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Forwarded without recording.
+
+HRESULT STDMETHODCALLTYPE RecordingServices::ExecNotificationQuery(const BSTR language, const BSTR query, long flags, IWbemContext* context, IEnumWbemClassObject** enumerator)
+{
+	return m_services->ExecNotificationQuery(language, query, flags, context, enumerator);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Forwarded without recording.
+
+HRESULT STDMETHODCALLTYPE RecordingServices::ExecNotificationQueryAsync(const BSTR language, const BSTR query, long flags, IWbemContext* context, IWbemObjectSink* sink)
+{
+	return m_services->ExecNotificationQueryAsync(language, query, flags, context, sink);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Execute a method and record the output parameters. The input parameters
+//! are not recorded.
+
+HRESULT STDMETHODCALLTYPE RecordingServices::ExecMethod(const BSTR path, const BSTR method, long flags, IWbemContext* context, IWbemClassObject* inParams, IWbemClassObject** outParams, IWbemCallResult** callResult)
+{
+	Stopwatch stopwatch;
+
+	HRESULT result = m_services->ExecMethod(path, method, flags, context, inParams, outParams, callResult);
+
+	const size_t call = m_recording->addCall(Recording::EXEC_METHOD, toString(path), toString(method), result, latency(stopwatch));
+
+	if (SUCCEEDED(result) && (outParams != nullptr) && (*outParams != nullptr))
+	{
+		try
+		{
+			m_recording->addObject(call, IWbemClassObjectPtr(*outParams, true), 0);
+		}
+		catch (const Core::Exception&)
+		{
+			(*outParams)->Release();
+			*outParams = nullptr;
+			return WBEM_E_FAILED;
+		}
+	}
+
+	return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Forwarded without recording.
+
+HRESULT STDMETHODCALLTYPE RecordingServices::ExecMethodAsync(const BSTR path, const BSTR method, long flags, IWbemContext* context, IWbemClassObject* inParams, IWbemObjectSink* sink)
+{
+	return m_services->ExecMethodAsync(path, method, flags, context, inParams, sink);
+}
+
+//namespace WMI
+}
@@ -0,0 +1,111 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   RecordingServices.hpp
+//! \brief  The RecordingServices class declaration.
+//! \author Chris Oldwood
+
+// Check for previous inclusion
+#ifndef WMI_RECORDINGSERVICES_HPP
+#define WMI_RECORDINGSERVICES_HPP
+
+#if _MSC_VER > 1000
+#pragma once
+#endif
+
+#include "Types.hpp"
+#include "Recording.hpp"
+#include <Core/NotCopyable.hpp>
+
+namespace WMI
+{
+
+////////////////////////////////////////////////////////////////////////////////
+//! An IWbemServices decorator that forwards every call to the underlying
+//! connection and adds the object, query and method calls to a recording,
+//! along with their results and timings. The recording can then be saved and
+//! served later by the ReplayServices.
+
+class RecordingServices : public IWbemServices, private Core::NotCopyable
+{
+public:
+	//! Construction from the connection to record and the recording to add to.
+	RecordingServices(IWbemServicesPtr services, RecordingPtr recording);
+
+	//
+	// Properties.
+	//
+
+	//! Get the recording.
+	RecordingPtr recording() const;
+
+	//
+	// Methods.
+	//
+
+	//! Get a reference counted COM interface to the connection.
+	IWbemServicesPtr getInterface();
+
+	//
+	// IUnknown methods.
+	//
+
+	//! Query the object for an interface.
+	virtual HRESULT STDMETHODCALLTYPE QueryInterface(REFIID iid, void** object);
+
+	//! Increment the reference count.
+	virtual ULONG STDMETHODCALLTYPE AddRef();
+
+	//! Decrement the reference count.
+	virtual ULONG STDMETHODCALLTYPE Release();
+
+	//
+	// IWbemServices methods.
+	//
+
+	virtual HRESULT STDMETHODCALLTYPE OpenNamespace(const BSTR nmspace, long flags, IWbemContext* context, IWbemServices** services, IWbemCallResult** callResult);
+	virtual HRESULT STDMETHODCALLTYPE CancelAsyncCall(IWbemObjectSink* sink);
+	virtual HRESULT STDMETHODCALLTYPE QueryObjectSink(long flags, IWbemObjectSink** sink);
+	virtual HRESULT STDMETHODCALLTYPE GetObject(const BSTR path, long flags, IWbemContext* context, IWbemClassObject** object, IWbemCallResult** callResult);
+	virtual HRESULT STDMETHODCALLTYPE GetObjectAsync(const BSTR path, long flags, IWbemContext* context, IWbemObjectSink* sink);
+	virtual HRESULT STDMETHODCALLTYPE PutClass(IWbemClassObject* object, long flags, IWbemContext* context, IWbemCallResult** callResult);
+	virtual HRESULT STDMETHODCALLTYPE PutClassAsync(IWbemClassObject* object, long flags, IWbemContext* context, IWbemObjectSink* sink);
+	virtual HRESULT STDMETHODCALLTYPE DeleteClass(const BSTR className, long flags, IWbemContext* context, IWbemCallResult** callResult);
+	virtual HRESULT STDMETHODCALLTYPE DeleteClassAsync(const BSTR className, long flags, IWbemContext* context, IWbemObjectSink* sink);
+	virtual HRESULT STDMETHODCALLTYPE CreateClassEnum(const BSTR superclass, long flags, IWbemContext* context, IEnumWbemClassObject** enumerator);
+	virtual HRESULT STDMETHODCALLTYPE CreateClassEnumAsync(const BSTR superclass, long flags, IWbemContext* context, IWbemObjectSink* sink);
+	virtual HRESULT STDMETHODCALLTYPE PutInstance(IWbemClassObject* instance, long flags, IWbemContext* context, IWbemCallResult** callResult);
+	virtual HRESULT STDMETHODCALLTYPE PutInstanceAsync(IWbemClassObject* instance, long flags, IWbemContext* context, IWbemObjectSink* sink);
+	virtual HRESULT STDMETHODCALLTYPE DeleteInstance(const BSTR path, long flags, IWbemContext* context, IWbemCallResult** callResult);
+	virtual HRESULT STDMETHODCALLTYPE DeleteInstanceAsync(const BSTR path, long flags, IWbemContext* context, IWbemObjectSink* sink);
+	virtual HRESULT STDMETHODCALLTYPE CreateInstanceEnum(const BSTR className, long flags, IWbemContext* context, IEnumWbemClassObject** enumerator);
+	virtual HRESULT STDMETHODCALLTYPE CreateInstanceEnumAsync(const BSTR className, long flags, IWbemContext* context, IWbemObjectSink* sink);
+	virtual HRESULT STDMETHODCALLTYPE ExecQuery(const BSTR language, const BSTR query, long flags, IWbemContext* context, IEnumWbemClassObject** enumerator);
+	virtual HRESULT STDMETHODCALLTYPE ExecQueryAsync(const BSTR language, const BSTR query, long flags, IWbemContext* context, IWbemObjectSink* sink);
+	virtual HRESULT STDMETHODCALLTYPE ExecNotificationQuery(const BSTR language, const BSTR query, long flags, IWbemContext* context, IEnumWbemClassObject** enumerator);
+	virtual HRESULT STDMETHODCALLTYPE ExecNotificationQueryAsync(const BSTR language, const BSTR query, long flags, IWbemContext* context, IWbemObjectSink* sink);
+	virtual HRESULT STDMETHODCALLTYPE ExecMethod(const BSTR path, const BSTR method, long flags, IWbemContext* context, IWbemClassObject* inParams, IWbemClassObject** outParams, IWbemCallResult** callResult);
+	virtual HRESULT STDMETHODCALLTYPE ExecMethodAsync(const BSTR path, const BSTR method, long flags, IWbemContext* context, IWbemClassObject* inParams, IWbemObjectSink* sink);
+
+private:
+	//
+	// Members.
+	//
+	LONG				m_refCount;		//!< The COM reference count.
+	IWbemServicesPtr	m_services;		//!< The underlying connection.
+	RecordingPtr		m_recording;	//!< The recording to add to.
+
+	//! Destructor.
+	virtual ~RecordingServices();
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the recording.
+
+inline RecordingPtr RecordingServices::recording() const
+{
+	return m_recording;
+}
+
+//namespace WMI
+}
+
+#endif // WMI_RECORDINGSERVICES_HPP
@@ -0,0 +1,404 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   ReplayServices.cpp
+//! \brief  The ReplayServices class definition.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include "ReplayServices.hpp"
+#include "MemoryEnumerator.hpp"
+#include "Stopwatch.hpp"
+#include <Core/StringUtils.hpp>
+
+#ifndef _MSC_VER
+WCL_DECLARE_IFACETRAITS(IEnumWbemClassObject, IID_IEnumWbemClassObject);
+WCL_DECLARE_IFACETRAITS(IWbemClassObject, IID_IWbemClassObject);
+WCL_DECLARE_IFACETRAITS(IWbemServices, IID_IWbemServices);
+#endif
+
+namespace WMI
+{
+
+////////////////////////////////////////////////////////////////////////////////
+//! Construction from the recording to serve.
+
+ReplayServices::ReplayServices(RecordingPtr recording, bool simulateLatency)
+	: m_refCount(0)
+	, m_recording(recording)
+	, m_simulate(simulateLatency)
+	, m_calls()
+	, m_lock()
+	, m_marshaller(nullptr)
+{
+	ASSERT(m_recording.get() != nullptr);
+
+	const Recording::Calls& calls = m_recording->calls();
+
+	for (size_t i = 0; i != calls.size(); ++i)
+	{
+		const tstring key = formatKey(calls[i].m_operation, calls[i].m_target, calls[i].m_method);
+		Matches&      matches = m_calls[key];
+
+		if (matches.m_calls.empty())
+			matches.m_next = 0;
+
+		matches.m_calls.push_back(i);
+	}
+
+	// Without the marshaller the provider is tied to the first apartment it is
+	// marshalled from.
+	::CoCreateFreeThreadedMarshaler(static_cast<IWbemServices*>(this), &m_marshaller);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Destructor.
+
+ReplayServices::~ReplayServices()
+{
+	if (m_marshaller != nullptr)
+		m_marshaller->Release();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get a reference counted COM interface to the connection.
+
+IWbemServicesPtr ReplayServices::getInterface()
+{
+	IWbemServicesPtr services;
+
+	AddRef();
+	*AttachTo(services) = this;
+
+	return services;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Query the object for an interface.
+
+HRESULT STDMETHODCALLTYPE ReplayServices::QueryInterface(REFIID iid, void** object)
+{
+	if (object == nullptr)
+		return E_POINTER;
+
+	if ( (iid == IID_IUnknown) || (iid == IID_IWbemServices) )
+	{
+		*object = static_cast<IWbemServices*>(this);
+		AddRef();
+		return S_OK;
+	}
+
+	if ( (iid == IID_IMarshal) && (m_marshaller != nullptr) )
+		return m_marshaller->QueryInterface(iid, object);
+
+	*object = nullptr;
+	return E_NOINTERFACE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Increment the reference count.
+
+ULONG STDMETHODCALLTYPE ReplayServices::AddRef()
+{
+	return ::InterlockedIncrement(&m_refCount);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Decrement the reference count.
+
+ULONG STDMETHODCALLTYPE ReplayServices::Release()
+{
+	const LONG refCount = ::InterlockedDecrement(&m_refCount);
+
+	if (refCount == 0)
+		delete this;
+
+	return refCount;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Not supported.
+
+HRESULT STDMETHODCALLTYPE ReplayServices::OpenNamespace(const BSTR /*nmspace*/, long /*flags*/, IWbemContext* /*context*/, IWbemServices** /*services*/, IWbemCallResult** /*callResult*/)
+{
+	return WBEM_E_NOT_SUPPORTED;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Not supported.
+
+HRESULT STDMETHODCALLTYPE ReplayServices::CancelAsyncCall(IWbemObjectSink* /*sink*/)
+{
+	return WBEM_E_NOT_SUPPORTED;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Not supported.
+
+HRESULT STDMETHODCALLTYPE ReplayServices::QueryObjectSink(long /*flags*/, IWbemObjectSink** /*sink*/)
+{
+	return WBEM_E_NOT_SUPPORTED;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Serve a copy of the next recorded object for the path.
+
+HRESULT STDMETHODCALLTYPE ReplayServices::GetObject(const BSTR path, long /*flags*/, IWbemContext* /*context*/, IWbemClassObject** object, IWbemCallResult** callResult)
+{
+	if (object == nullptr)
+		return WBEM_E_INVALID_PARAMETER;
+
+	*object = nullptr;
+
+	if (callResult != nullptr)
+		*callResult = nullptr;
+
+	const Recording::Call* call = findCall(Recording::GET_OBJECT, path, nullptr);
+
+	if (call == nullptr)
+		return WBEM_E_NOT_FOUND;
+
+	if (m_simulate)
+		Stopwatch::wait(call->m_latency);
+
+	if (FAILED(call->m_result))
+		return call->m_result;
+
+	if (call->m_objects.empty())
+		return WBEM_E_NOT_FOUND;
+
+	return call->m_objects.front()->Clone(object);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Not supported.
+
+HRESULT STDMETHODCALLTYPE ReplayServices::GetObjectAsync(const BSTR /*path*/, long /*flags*/, IWbemContext* /*context*/, IWbemObjectSink* /*sink*/)
+{
+	return WBEM_E_NOT_SUPPORTED;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Not supported.
+
+HRESULT STDMETHODCALLTYPE ReplayServices::PutClass(IWbemClassObject* /*object*/, long /*flags*/, IWbemContext* /*context*/, IWbemCallResult** /*callResult*/)
+{
+	return WBEM_E_NOT_SUPPORTED;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Not supported.
+
+HRESULT STDMETHODCALLTYPE ReplayServices::PutClassAsync(IWbemClassObject* /*object*/, long /*flags*/, IWbemContext* /*context*/, IWbemObjectSink* /*sink*/)
+{
+	return WBEM_E_NOT_SUPPORTED;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Not supported.
+
+HRESULT STDMETHODCALLTYPE ReplayServices::DeleteClass(const BSTR /*className*/, long /*flags*/, IWbemContext* /*context*/, IWbemCallResult** /*callResult*/)
+{
+	return WBEM_E_NOT_SUPPORTED;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Not supported.
+
+HRESULT STDMETHODCALLTYPE ReplayServices::DeleteClassAsync(const BSTR /*className*/, long /*flags*/, IWbemContext* /*context*/, IWbemObjectSink* /*sink*/)
+{
+	return WBEM_E_NOT_SUPPORTED;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Not supported.
+
+HRESULT STDMETHODCALLTYPE ReplayServices::CreateClassEnum(const BSTR /*superclass*/, long /*flags*/, IWbemContext* /*context*/, IEnumWbemClassObject** /*enumerator*/)
+{
+	return WBEM_E_NOT_SUPPORTED;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Not supported.
+
+HRESULT STDMETHODCALLTYPE ReplayServices::CreateClassEnumAsync(const BSTR /*superclass*/, long /*flags*/, IWbemContext* /*context*/, IWbemObjectSink* /*sink*/)
+{
+	return WBEM_E_NOT_SUPPORTED;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Not supported.
+
+HRESULT STDMETHODCALLTYPE ReplayServices::PutInstance(IWbemClassObject* /*instance*/, long /*flags*/, IWbemContext* /*context*/, IWbemCallResult** /*callResult*/)
+{
+	return WBEM_E_NOT_SUPPORTED;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Not supported.
+
+HRESULT STDMETHODCALLTYPE ReplayServices::PutInstanceAsync(IWbemClassObject* /*instance*/, long /*flags*/, IWbemContext* /*context*/, IWbemObjectSink* /*sink*/)
+{
+	return WBEM_E_NOT_SUPPORTED;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Not supported.
+
+HRESULT STDMETHODCALLTYPE ReplayServices::DeleteInstance(const BSTR /*path*/, long /*flags*/, IWbemContext* /*context*/, IWbemCallResult** /*callResult*/)
+{
+	return WBEM_E_NOT_SUPPORTED;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Not supported.
+
+HRESULT STDMETHODCALLTYPE ReplayServices::DeleteInstanceAsync(const BSTR /*path*/, long /*flags*/, IWbemContext* /*context*/, IWbemObjectSink* /*sink*/)
+{
+	return WBEM_E_NOT_SUPPORTED;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Not supported.
+
+HRESULT STDMETHODCALLTYPE ReplayServices::CreateInstanceEnum(const BSTR /*className*/, long /*flags*/, IWbemContext* /*context*/, IEnumWbemClassObject** /*enumerator*/)
+{
+	return WBEM_E_NOT_SUPPORTED;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Not supported.
+
+HRESULT STDMETHODCALLTYPE ReplayServices::CreateInstanceEnumAsync(const BSTR /*className*/, long /*flags*/, IWbemContext* /*context*/, IWbemObjectSink* /*sink*/)
+{
+	return WBEM_E_NOT_SUPPORTED;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Serve the objects from the next recorded execution of the query.
+
+HRESULT STDMETHODCALLTYPE ReplayServices::ExecQuery(const BSTR /*language*/, const BSTR query, long /*flags*/, IWbemContext* /*context*/, IEnumWbemClassObject** enumerator)
+{
+	if (enumerator == nullptr)
+		return WBEM_E_INVALID_PARAMETER;
+
+	*enumerator = nullptr;
+
+	const Recording::Call* call = findCall(Recording::EXEC_QUERY, query, nullptr);
+
+	if (call == nullptr)
+		return WBEM_E_NOT_FOUND;
+
+	if (m_simulate)
+		Stopwatch::wait(call->m_latency);
+
+	if (FAILED(call->m_result))
+		return call->m_result;
+
+	MemoryEnumerator* results = new MemoryEnumerator(call->m_objects);
+
+	if (m_simulate)
+		results->setLatencies(call->m_latencies);
+
+	results->AddRef();
+	*enumerator = results;
+
+	return call->m_result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Not supported.
+
+HRESULT STDMETHODCALLTYPE ReplayServices::ExecQueryAsync(const BSTR /*language*/, const BSTR /*query*/, long /*flags*/, IWbemContext* /*context*/, IWbemObjectSink* /*sink*/)
+{
+	return WBEM_E_NOT_SUPPORTED;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Not supported.
+
+HRESULT STDMETHODCALLTYPE ReplayServices::ExecNotificationQuery(const BSTR /*language*/, const BSTR /*query*/, long /*flags*/, IWbemContext* /*context*/, IEnumWbemClassObject** /*enumerator*/)
+{
+	return WBEM_E_NOT_SUPPORTED;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Not supported.
+
+HRESULT STDMETHODCALLTYPE ReplayServices::ExecNotificationQueryAsync(const BSTR /*language*/, const BSTR /*query*/, long /*flags*/, IWbemContext* /*context*/, IWbemObjectSink* /*sink*/)
+{
+	return WBEM_E_NOT_SUPPORTED;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Serve a copy of the output parameters from the next recorded execution of
+//! the method. The input parameters are ignored.
+
+HRESULT STDMETHODCALLTYPE ReplayServices::ExecMethod(const BSTR path, const BSTR method, long /*flags*/, IWbemContext* /*context*/, IWbemClassObject* /*inParams*/, IWbemClassObject** outParams, IWbemCallResult** callResult)
+{
+	if (outParams != nullptr)
+		*outParams = nullptr;
+
+	if (callResult != nullptr)
+		*callResult = nullptr;
+
+	const Recording::Call* call = findCall(Recording::EXEC_METHOD, path, method);
+
+	if (call == nullptr)
+		return WBEM_E_NOT_FOUND;
+
+	if (m_simulate)
+		Stopwatch::wait(call->m_latency);
+
+	if (FAILED(call->m_result))
+		return call->m_result;
+
+	if ( (outParams != nullptr) && !call->m_objects.empty() )
+	{
+		HRESULT result = call->m_objects.front()->Clone(outParams);
+
+		if (FAILED(result))
+			return result;
+	}
+
+	return call->m_result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Not supported.
+
+HRESULT STDMETHODCALLTYPE ReplayServices::ExecMethodAsync(const BSTR /*path*/, const BSTR /*method*/, long /*flags*/, IWbemContext* /*context*/, IWbemClassObject* /*inParams*/, IWbemObjectSink* /*sink*/)
+{
+	return WBEM_E_NOT_SUPPORTED;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Create the key used to match a call.
+
+tstring ReplayServices::formatKey(Recording::Operation operation, const tstring& target, const tstring& method)
+{
+	return Core::fmt(TXT("%d|%s|%s"), operation, target.c_str(), method.c_str());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Find the next recorded call for a key, or null if there are none.
+
+const Recording::Call* ReplayServices::findCall(Recording::Operation operation, const BSTR target, const BSTR method)
+{
+	const tstring key = formatKey(operation, (target != nullptr) ? target : TXT(""), (method != nullptr) ? method : TXT(""));
+
+	CallMap::iterator it = m_calls.find(key);
+
+	if (it == m_calls.end())
+		return nullptr;
+
+	CriticalSection::Lock lock(m_lock);
+
+	Matches&     matches = it->second;
+	const size_t index = matches.m_calls[matches.m_next];
+
+	matches.m_next = (matches.m_next + 1) % matches.m_calls.size();
+
+	return &m_recording->calls()[index];
+}
+
+//namespace WMI
+}
@@ -0,0 +1,148 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   ReplayServices.hpp
+//! \brief  The ReplayServices class declaration.
+//! \author Chris Oldwood
+
+// Check for previous inclusion
+#ifndef WMI_REPLAYSERVICES_HPP
+#define WMI_REPLAYSERVICES_HPP
+
+#if _MSC_VER > 1000
+#pragma once
+#endif
+
+#include "Types.hpp"
+#include "Recording.hpp"
+#include "CriticalSection.hpp"
+#include <Core/NotCopyable.hpp>
+#include <map>
+
+namespace WMI
+{
+
+////////////////////////////////////////////////////////////////////////////////
+//! An in-process implementation of the IWbemServices interface that serves the
+//! object, query and method calls captured by the RecordingServices, so that
+//! code can be run and benchmarked offline against a deterministic provider.
+//!
+//! Calls are matched on their operation, object path or query, and method
+//! name. When the same call was recorded more than once the results are served
+//! in the order they were recorded, wrapping around at the end. Method
+//! arguments are not compared. The recorded latencies can optionally be
+//! simulated. Any other call fails with WBEM_E_NOT_SUPPORTED.
+//!
+//! The provider aggregates the free-threaded marshaller and so, like a remote
+//! provider, can be handed to and called from any apartment.
+
+class ReplayServices : public IWbemServices, private Core::NotCopyable
+{
+public:
+	//! Construction from the recording to serve. The recording is indexed on
+	//! construction and so must not be modified afterwards.
+	ReplayServices(RecordingPtr recording, bool simulateLatency);
+
+	//
+	// Properties.
+	//
+
+	//! Get the recording.
+	RecordingPtr recording() const;
+
+	//
+	// Methods.
+	//
+
+	//! Get a reference counted COM interface to the connection.
+	IWbemServicesPtr getInterface();
+
+	//
+	// IUnknown methods.
+	//
+
+	//! Query the object for an interface.
+	virtual HRESULT STDMETHODCALLTYPE QueryInterface(REFIID iid, void** object);
+
+	//! Increment the reference count.
+	virtual ULONG STDMETHODCALLTYPE AddRef();
+
+	//! Decrement the reference count.
+	virtual ULONG STDMETHODCALLTYPE Release();
+
+	//
+	// IWbemServices methods.
+	//
+
+	virtual HRESULT STDMETHODCALLTYPE OpenNamespace(const BSTR nmspace, long flags, IWbemContext* context, IWbemServices** services, IWbemCallResult** callResult);
+	virtual HRESULT STDMETHODCALLTYPE CancelAsyncCall(IWbemObjectSink* sink);
+	virtual HRESULT STDMETHODCALLTYPE QueryObjectSink(long flags, IWbemObjectSink** sink);
+	virtual HRESULT STDMETHODCALLTYPE GetObject(const BSTR path, long flags, IWbemContext* context, IWbemClassObject** object, IWbemCallResult** callResult);
+	virtual HRESULT STDMETHODCALLTYPE GetObjectAsync(const BSTR path, long flags, IWbemContext* context, IWbemObjectSink* sink);
+	virtual HRESULT STDMETHODCALLTYPE PutClass(IWbemClassObject* object, long flags, IWbemContext* context, IWbemCallResult** callResult);
+	virtual HRESULT STDMETHODCALLTYPE PutClassAsync(IWbemClassObject* object, long flags, IWbemContext* context, IWbemObjectSink* sink);
+	virtual HRESULT STDMETHODCALLTYPE DeleteClass(const BSTR className, long flags, IWbemContext* context, IWbemCallResult** callResult);
+	virtual HRESULT STDMETHODCALLTYPE DeleteClassAsync(const BSTR className, long flags, IWbemContext* context, IWbemObjectSink* sink);
+	virtual HRESULT STDMETHODCALLTYPE CreateClassEnum(const BSTR superclass, long flags, IWbemContext* context, IEnumWbemClassObject** enumerator);
+	virtual HRESULT STDMETHODCALLTYPE CreateClassEnumAsync(const BSTR superclass, long flags, IWbemContext* context, IWbemObjectSink* sink);
+	virtual HRESULT STDMETHODCALLTYPE PutInstance(IWbemClassObject* instance, long flags, IWbemContext* context, IWbemCallResult** callResult);
+	virtual HRESULT STDMETHODCALLTYPE PutInstanceAsync(IWbemClassObject* instance, long flags, IWbemContext* context, IWbemObjectSink* sink);
+	virtual HRESULT STDMETHODCALLTYPE DeleteInstance(const BSTR path, long flags, IWbemContext* context, IWbemCallResult** callResult);
+	virtual HRESULT STDMETHODCALLTYPE DeleteInstanceAsync(const BSTR path, long flags, IWbemContext* context, IWbemObjectSink* sink);
+	virtual HRESULT STDMETHODCALLTYPE CreateInstanceEnum(const BSTR className, long flags, IWbemContext* context, IEnumWbemClassObject** enumerator);
+	virtual HRESULT STDMETHODCALLTYPE CreateInstanceEnumAsync(const BSTR className, long flags, IWbemContext* context, IWbemObjectSink* sink);
+	virtual HRESULT STDMETHODCALLTYPE ExecQuery(const BSTR language, const BSTR query, long flags, IWbemContext* context, IEnumWbemClassObject** enumerator);
+	virtual HRESULT STDMETHODCALLTYPE ExecQueryAsync(const BSTR language, const BSTR query, long flags, IWbemContext* context, IWbemObjectSink* sink);
+	virtual HRESULT STDMETHODCALLTYPE ExecNotificationQuery(const BSTR language, const BSTR query, long flags, IWbemContext* context, IEnumWbemClassObject** enumerator);
+	virtual HRESULT STDMETHODCALLTYPE ExecNotificationQueryAsync(const BSTR language, const BSTR query, long flags, IWbemContext* context, IWbemObjectSink* sink);
+	virtual HRESULT STDMETHODCALLTYPE ExecMethod(const BSTR path, const BSTR method, long flags, IWbemContext* context, IWbemClassObject* inParams, IWbemClassObject** outParams, IWbemCallResult** callResult);
+	virtual HRESULT STDMETHODCALLTYPE ExecMethodAsync(const BSTR path, const BSTR method, long flags, IWbemContext* context, IWbemClassObject* inParams, IWbemObjectSink* sink);
+
+private:
+	//! The indices of the calls with the same key.
+	typedef std::vector<size_t> Indices;
+
+	//! The recorded calls and next call to serve for a key.
+	struct Matches
+	{
+		Indices		m_calls;		//!< The indices of the recorded calls.
+		size_t		m_next;			//!< The next entry to serve.
+	};
+
+	//! The map of call key to recorded calls.
+	typedef std::map<tstring, Matches> CallMap;
+
+	//
+	// Members.
+	//
+	LONG				m_refCount;		//!< The COM reference count.
+	RecordingPtr		m_recording;	//!< The recording to serve.
+	bool				m_simulate;		//!< Wait for the recorded latencies?
+	CallMap				m_calls;		//!< The calls indexed by key.
+	CriticalSection		m_lock;			//!< The lock guarding the next calls to serve.
+	IUnknown*			m_marshaller;	//!< The free-threaded marshaller, if created.
+
+	//! Destructor.
+	virtual ~ReplayServices();
+
+	//
+	// Internal methods.
+	//
+
+	//! Create the key used to match a call.
+	static tstring formatKey(Recording::Operation operation, const tstring& target, const tstring& method);
+
+	//! Find the next recorded call for a key.
+	const Recording::Call* findCall(Recording::Operation operation, const BSTR target, const BSTR method);
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the recording.
+
+inline RecordingPtr ReplayServices::recording() const
+{
+	return m_recording;
+}
+
+//namespace WMI
+}
+
+#endif // WMI_REPLAYSERVICES_HPP
@@ -0,0 +1,147 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   Result.hpp
+//! \brief  The Result class declaration.
+//! \author Chris Oldwood
+
+// Check for previous inclusion
+#ifndef WMI_RESULT_HPP
+#define WMI_RESULT_HPP
+
+#if _MSC_VER > 1000
+#pragma once
+#endif
+
+namespace WMI
+{
+
+////////////////////////////////////////////////////////////////////////////////
+//! The outcome of a non-throwing call, which is either a value or the HRESULT
+//! of the failure. This is used by the tryXxx() variants of the API where a
+//! failure is expected often enough, such as when probing for an optional
+//! property, that the cost of throwing and catching a WMI::Exception matters.
+
+template<typename T>
+class Result
+{
+public:
+	//! Construction from a call's result and value.
+	Result(HRESULT result, const T& value);
+
+	//
+	// Properties.
+	//
+
+	//! Query if the call succeeded.
+	bool succeeded() const;
+
+	//! Query if the call failed.
+	bool failed() const;
+
+	//! Get the result of the call.
+	HRESULT result() const;
+
+	//! Get the value. The call must have succeeded.
+	const T& value() const;
+
+	//! Get the value, or a default if the call failed.
+	T valueOr(const T& defaultValue) const;
+
+	//
+	// Class methods.
+	//
+
+	//! Create the result for a successful call.
+	static Result success(const T& value);
+
+	//! Create the result for a failed call.
+	static Result failure(HRESULT result);
+
+private:
+	//
+	// Members.
+	//
+	HRESULT	m_result;	//!< The result of the call.
+	T		m_value;	//!< The value, if the call succeeded.
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//! Construction from a call's result and value.
+
+template<typename T>
+inline Result<T>::Result(HRESULT result, const T& value)
+	: m_result(result)
+	, m_value(value)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Query if the call succeeded.
+
+template<typename T>
+inline bool Result<T>::succeeded() const
+{
+	return SUCCEEDED(m_result);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Query if the call failed.
+
+template<typename T>
+inline bool Result<T>::failed() const
+{
+	return FAILED(m_result);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the result of the call.
+
+template<typename T>
+inline HRESULT Result<T>::result() const
+{
+	return m_result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the value. The call must have succeeded.
+
+template<typename T>
+inline const T& Result<T>::value() const
+{
+	ASSERT(succeeded());
+
+	return m_value;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the value, or a default if the call failed.
+
+template<typename T>
+inline T Result<T>::valueOr(const T& defaultValue) const
+{
+	return succeeded() ? m_value : defaultValue;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Create the result for a successful call.
+
+template<typename T>
+inline Result<T> Result<T>::success(const T& value)
+{
+	return Result(S_OK, value);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Create the result for a failed call.
+
+template<typename T>
+inline Result<T> Result<T>::failure(HRESULT result)
+{
+	ASSERT(FAILED(result));
+
+	return Result(result, T());
+}
+
+//namespace WMI
+}
+
+#endif // WMI_RESULT_HPP
@@ -0,0 +1,589 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   ResultExporter.cpp
+//! \brief  The ResultExporter class definition.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include "ResultExporter.hpp"
+#include "Exception.hpp"
+#include <Core/StringUtils.hpp>
+#include <float.h>
+#include <locale.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifndef _MSC_VER
+WCL_DECLARE_IFACETRAITS(IWbemClassObject, IID_IWbemClassObject);
+#endif
+
+namespace WMI
+{
+
+////////////////////////////////////////////////////////////////////////////////
+//! The "C" locale, used to format numbers with a '.' decimal point whatever
+//! locale the host application has set, as JSON and CSV both require it.
+
+class InvariantLocale
+{
+public:
+	//! Default constructor.
+	InvariantLocale()
+		: m_locale(_create_locale(LC_NUMERIC, "C"))
+	{
+	}
+
+	//! Destructor.
+	~InvariantLocale()
+	{
+		if (m_locale != nullptr)
+			_free_locale(m_locale);
+	}
+
+	//
+	// Members.
+	//
+	_locale_t	m_locale;	//!< The locale handle.
+};
+
+//! The shared invariant locale.
+static InvariantLocale s_invariantLocale;
+
+////////////////////////////////////////////////////////////////////////////////
+//! Query if the character must be escaped in a JSON string.
+
+static inline bool isJsonSpecial(wchar_t c)
+{
+	return (c < 0x20) || (c == L'"') || (c == L'\\');
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Query if the character requires a CSV field to be quoted.
+
+static inline bool isCsvSpecial(wchar_t c)
+{
+	return (c == L',') || (c == L'"') || (c == L'\r') || (c == L'\n');
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Query if the string is a well-formed decimal integer.
+
+static bool isInteger(const wchar_t* text, size_t length)
+{
+	if ( (length != 0) && (*text == L'-') )
+	{
+		++text;
+		--length;
+	}
+
+	if (length == 0)
+		return false;
+
+	for (const wchar_t* end = text + length; text != end; ++text)
+	{
+		if ( (*text < L'0') || (*text > L'9') )
+			return false;
+	}
+
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Query if the range of characters are all decimal digits.
+
+static bool isDigits(const wchar_t* text, size_t count)
+{
+	for (const wchar_t* end = text + count; text != end; ++text)
+	{
+		if ( (*text < L'0') || (*text > L'9') )
+			return false;
+	}
+
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Construction with the columns taken from the first object.
+
+ResultExporter::ResultExporter(BufferedWriter& writer, Format format)
+	: m_writer(writer)
+	, m_format(format)
+	, m_columns()
+	, m_headerWritten(false)
+	, m_rows(0)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Construction with an explicit set of columns.
+
+ResultExporter::ResultExporter(BufferedWriter& writer, Format format, const Columns& columns)
+	: m_writer(writer)
+	, m_format(format)
+	, m_columns(columns)
+	, m_headerWritten(false)
+	, m_rows(0)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Destructor.
+
+ResultExporter::~ResultExporter()
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Write all the remaining objects from the iterator and flush the writer. When
+//! the columns were supplied a CSV header is written even if there are no rows.
+
+size_t ResultExporter::writeAll(ObjectIterator it)
+{
+	const ObjectIterator end;
+	const size_t         first = m_rows;
+
+	for (; it != end; ++it)
+		writeRow(*it);
+
+	if ( (m_format == CSV) && !m_headerWritten && !m_columns.empty() )
+		writeHeader();
+
+	m_writer.flush();
+
+	return m_rows - first;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Write a single object. Properties the object does not have are written as
+//! null values.
+
+void ResultExporter::writeRow(const Object& object)
+{
+	if (m_columns.empty())
+	{
+		Object::PropertyNames names;
+
+		object.getPropertyNames(names);
+
+		m_columns.assign(names.begin(), names.end());
+	}
+
+	if ( (m_format == CSV) && !m_headerWritten )
+		writeHeader();
+
+	IWbemClassObjectPtr instance = object.get();
+
+	if (m_format == NDJSON)
+		m_writer.write('{');
+
+	for (size_t i = 0; i != m_columns.size(); ++i)
+	{
+		const tstring& name = m_columns[i];
+
+		if (i != 0)
+			m_writer.write(',');
+
+		if (m_format == NDJSON)
+		{
+			writeString(name.c_str(), name.length(), false);
+			m_writer.write(':');
+		}
+
+		WCL::Variant value;
+		CIMTYPE      type = CIM_EMPTY;
+
+		HRESULT result = instance->Get(name.c_str(), 0, &value, &type, nullptr);
+
+		if (result == WBEM_E_NOT_FOUND)
+		{
+			writeNull();
+			continue;
+		}
+
+		if (FAILED(result))
+		{
+			const tstring message = Core::fmt(TXT("Failed to retrieve the property '%s' for export"), name.c_str());
+			throw Exception(result, instance, message.c_str());
+		}
+
+		writeValue(value, type);
+	}
+
+	if (m_format == NDJSON)
+		m_writer.write("}\n", 2);
+	else
+		m_writer.write("\r\n", 2);
+
+	++m_rows;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Write the CSV header row.
+
+void ResultExporter::writeHeader()
+{
+	ASSERT(m_format == CSV);
+
+	for (size_t i = 0; i != m_columns.size(); ++i)
+	{
+		if (i != 0)
+			m_writer.write(',');
+
+		writeString(m_columns[i].c_str(), m_columns[i].length(), false);
+	}
+
+	m_writer.write("\r\n", 2);
+
+	m_headerWritten = true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Write a property value.
+
+void ResultExporter::writeValue(const VARIANT& value, CIMTYPE type)
+{
+	if (V_VT(&value) & VT_ARRAY)
+		writeArray(value, type & ~CIM_FLAG_ARRAY);
+	else
+		writeScalar(value, type & ~CIM_FLAG_ARRAY, false);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Write an array property value. Each element is written by making a shallow
+//! VARIANT copy of it so that the scalar formatting can be reused.
+
+void ResultExporter::writeArray(const VARIANT& value, CIMTYPE type)
+{
+	SAFEARRAY* array = V_ARRAY(&value);
+	void*      data = nullptr;
+
+	if ( (array == nullptr) || FAILED(::SafeArrayAccessData(array, &data)) )
+	{
+		writeNull();
+		return;
+	}
+
+	const VARTYPE elementType = static_cast<VARTYPE>(V_VT(&value) & VT_TYPEMASK);
+	const size_t  elementSize = array->cbElements;
+	const char    separator = (m_format == CSV) ? ';' : ',';
+	LONG          lower = 0, upper = -1;
+
+	::SafeArrayGetLBound(array, 1, &lower);
+	::SafeArrayGetUBound(array, 1, &upper);
+
+	m_writer.write((m_format == CSV) ? '"' : '[');
+
+	for (LONG i = 0; i <= (upper - lower); ++i)
+	{
+		const BYTE* element = static_cast<const BYTE*>(data) + (i * elementSize);
+
+		if (i != 0)
+			m_writer.write(separator);
+
+		if (elementType == VT_VARIANT)
+		{
+			writeScalar(*reinterpret_cast<const VARIANT*>(element), type, (m_format == CSV));
+		}
+		else if (elementSize <= sizeof(LONGLONG))
+		{
+			VARIANT shallow;
+
+			V_VT(&shallow) = elementType;
+			V_I8(&shallow) = 0;
+			memcpy(&V_UI1(&shallow), element, elementSize);
+
+			writeScalar(shallow, type, (m_format == CSV));
+		}
+		else
+		{
+			writeNull();
+		}
+	}
+
+	m_writer.write((m_format == CSV) ? '"' : ']');
+
+	::SafeArrayUnaccessData(array);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Write a single value. The CIM type is used to distinguish the unsigned,
+//! 64-bit and datetime values that WMI passes in other VARIANT types.
+
+void ResultExporter::writeScalar(const VARIANT& value, CIMTYPE type, bool inQuotes)
+{
+	switch (V_VT(&value))
+	{
+		case VT_EMPTY:
+		case VT_NULL:
+			writeNull();
+			break;
+
+		case VT_BOOL:
+			m_writer.write((V_BOOL(&value) != VARIANT_FALSE) ? "true" : "false");
+			break;
+
+		case VT_I1:		writeInteger(V_I1(&value));				break;
+		case VT_UI1:	writeUnsigned(V_UI1(&value));			break;
+		case VT_UI2:	writeUnsigned(V_UI2(&value));			break;
+		case VT_UI4:	writeUnsigned(V_UI4(&value));			break;
+		case VT_UINT:	writeUnsigned(V_UINT(&value));			break;
+		case VT_INT:	writeInteger(V_INT(&value));			break;
+		case VT_I8:		writeInteger(V_I8(&value));				break;
+		case VT_UI8:	writeUnsigned(V_UI8(&value));			break;
+		case VT_R4:		writeReal(V_R4(&value), 9);				break;
+		case VT_R8:		writeReal(V_R8(&value), 17);			break;
+
+		case VT_I2:
+			if (type == CIM_UINT16)
+				writeUnsigned(static_cast<uint16>(V_I2(&value)));
+			else
+				writeInteger(V_I2(&value));
+			break;
+
+		case VT_I4:
+			if (type == CIM_UINT32)
+				writeUnsigned(static_cast<uint32>(V_I4(&value)));
+			else
+				writeInteger(V_I4(&value));
+			break;
+
+		case VT_BSTR:
+		{
+			const wchar_t* text = (V_BSTR(&value) != nullptr) ? V_BSTR(&value) : L"";
+			const size_t   length = (V_BSTR(&value) != nullptr) ? ::SysStringLen(V_BSTR(&value)) : 0;
+
+			if (type == CIM_DATETIME)
+			{
+				writeDateTime(text, length, inQuotes);
+			}
+			else if ( ((type == CIM_UINT64) || (type == CIM_SINT64)) && isInteger(text, length) )
+			{
+				m_writer.write(text, length);
+			}
+			else
+			{
+				writeString(text, length, inQuotes);
+			}
+		}
+		break;
+
+		default:
+		{
+			WCL::Variant string;
+
+			if (SUCCEEDED(::VariantChangeType(&string, const_cast<VARIANT*>(&value), 0, VT_BSTR)))
+				writeString(V_BSTR(&string), ::SysStringLen(V_BSTR(&string)), inQuotes);
+			else
+				writeNull();
+		}
+		break;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Write a string value, quoting and escaping it as required. The text is
+//! written in runs between the characters that need escaping to avoid any
+//! intermediate copies.
+
+void ResultExporter::writeString(const wchar_t* text, size_t length, bool inQuotes)
+{
+	const wchar_t* it = text;
+	const wchar_t* end = text + length;
+
+	if (m_format == NDJSON)
+	{
+		m_writer.write('"');
+
+		while (it != end)
+		{
+			const wchar_t* run = it;
+
+			while ( (it != end) && !isJsonSpecial(*it) )
+				++it;
+
+			m_writer.write(run, it - run);
+
+			if (it == end)
+				break;
+
+			switch (*it)
+			{
+				case L'"':	m_writer.write("\\\"", 2);	break;
+				case L'\\':	m_writer.write("\\\\", 2);	break;
+				case L'\n':	m_writer.write("\\n", 2);	break;
+				case L'\r':	m_writer.write("\\r", 2);	break;
+				case L'\t':	m_writer.write("\\t", 2);	break;
+				default:
+				{
+					char escape[8];
+
+					_snprintf(escape, sizeof(escape), "\\u%04x", static_cast<unsigned>(*it));
+					m_writer.write(escape, 6);
+				}
+				break;
+			}
+
+			++it;
+		}
+
+		m_writer.write('"');
+	}
+	else
+	{
+		bool quote = inQuotes;
+
+		for (const wchar_t* c = text; (c != end) && !quote; ++c)
+			quote = isCsvSpecial(*c);
+
+		if (!quote)
+		{
+			m_writer.write(text, length);
+			return;
+		}
+
+		if (!inQuotes)
+			m_writer.write('"');
+
+		while (it != end)
+		{
+			const wchar_t* run = it;
+
+			while ( (it != end) && (*it != L'"') )
+				++it;
+
+			m_writer.write(run, it - run);
+
+			if (it == end)
+				break;
+
+			m_writer.write("\"\"", 2);
+			++it;
+		}
+
+		if (!inQuotes)
+			m_writer.write('"');
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Write a WMI datetime value in ISO 8601 format. The WMI format is
+//! YYYYMMDDHHMMSS.FFFFFF+UUU where UUU is the offset from UTC in minutes.
+//! Intervals and wildcarded values are written as plain strings.
+
+void ResultExporter::writeDateTime(const wchar_t* text, size_t length, bool inQuotes)
+{
+	const bool valid = (length == 25) && isDigits(text, 14) && (text[14] == L'.') && isDigits(text+15, 6)
+					&& ((text[21] == L'+') || (text[21] == L'-')) && isDigits(text+22, 3);
+
+	if (!valid)
+	{
+		writeString(text, length, inQuotes);
+		return;
+	}
+
+	const int offset = ((text[22] - L'0') * 100) + ((text[23] - L'0') * 10) + (text[24] - L'0');
+
+	char iso[40];
+	char* out = iso;
+
+	if (m_format == NDJSON)
+		*out++ = '"';
+
+	for (size_t i = 0; i != 14; ++i)
+	{
+		switch (i)
+		{
+			case 4: case 6:		*out++ = '-';	break;
+			case 8:				*out++ = 'T';	break;
+			case 10: case 12:	*out++ = ':';	break;
+			default:							break;
+		}
+
+		*out++ = static_cast<char>(text[i]);
+	}
+
+	*out++ = '.';
+
+	for (size_t i = 15; i != 21; ++i)
+		*out++ = static_cast<char>(text[i]);
+
+	*out++ = static_cast<char>(text[21]);
+	*out++ = static_cast<char>('0' + ((offset / 60) / 10));
+	*out++ = static_cast<char>('0' + ((offset / 60) % 10));
+	*out++ = ':';
+	*out++ = static_cast<char>('0' + ((offset % 60) / 10));
+	*out++ = static_cast<char>('0' + ((offset % 60) % 10));
+
+	if (m_format == NDJSON)
+		*out++ = '"';
+
+	m_writer.write(iso, out - iso);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Write a signed integer value.
+
+void ResultExporter::writeInteger(int64 value)
+{
+	if (value < 0)
+	{
+		m_writer.write('-');
+		writeUnsigned(static_cast<uint64>(-(value + 1)) + 1);
+	}
+	else
+	{
+		writeUnsigned(static_cast<uint64>(value));
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Write an unsigned integer value.
+
+void ResultExporter::writeUnsigned(uint64 value)
+{
+	char  digits[24];
+	char* end = digits + sizeof(digits);
+	char* begin = end;
+
+	do
+	{
+		*--begin = static_cast<char>('0' + (value % 10));
+		value /= 10;
+	}
+	while (value != 0);
+
+	m_writer.write(begin, end - begin);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Write a floating-point value. Non-finite values are written as nulls as
+//! they have no JSON representation. The value is formatted in the invariant
+//! locale so that the decimal point does not depend on the host's locale.
+
+void ResultExporter::writeReal(double value, int precision)
+{
+	if ( (value != value) || (value > DBL_MAX) || (value < -DBL_MAX) )
+	{
+		writeNull();
+		return;
+	}
+
+	char buffer[32];
+
+	const int length = _snprintf_l(buffer, sizeof(buffer), "%.*g", s_invariantLocale.m_locale, precision, value);
+
+	ASSERT((length > 0) && (length < static_cast<int>(sizeof(buffer))));
+
+	m_writer.write(buffer, length);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Write a null value.
+
+void ResultExporter::writeNull()
+{
+	if (m_format == NDJSON)
+		m_writer.write("null", 4);
+}
+
+//namespace WMI
+}
@@ -0,0 +1,140 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   ResultExporter.hpp
+//! \brief  The ResultExporter class declaration.
+//! \author Chris Oldwood
+
+// Check for previous inclusion
+#ifndef WMI_RESULTEXPORTER_HPP
+#define WMI_RESULTEXPORTER_HPP
+
+#if _MSC_VER > 1000
+#pragma once
+#endif
+
+#include "ObjectIterator.hpp"
+#include "BufferedWriter.hpp"
+#include <Core/NotCopyable.hpp>
+#include <vector>
+
+namespace WMI
+{
+
+////////////////////////////////////////////////////////////////////////////////
+//! Streams the objects from a query to a BufferedWriter as either CSV or
+//! newline delimited JSON. Each row is written as soon as it is fetched so the
+//! memory used is independent of the number of rows.
+//!
+//! The columns are either supplied by the caller or taken from the non-system
+//! properties of the first object. 64-bit integers, which WMI passes as
+//! strings, are written as numbers; datetimes are written in ISO 8601 format;
+//! and arrays are written as JSON arrays or as a single quoted CSV field with
+//! the elements separated by semi-colons.
+
+class ResultExporter : private Core::NotCopyable
+{
+public:
+	//! The output formats.
+	enum Format
+	{
+		CSV,		//!< Comma separated values with a header row.
+		NDJSON,		//!< One JSON object per line.
+	};
+
+	//! The ordered collection of property names to export.
+	typedef std::vector<tstring> Columns;
+
+public:
+	//! Construction with the columns taken from the first object.
+	ResultExporter(BufferedWriter& writer, Format format);
+
+	//! Construction with an explicit set of columns.
+	ResultExporter(BufferedWriter& writer, Format format, const Columns& columns);
+
+	//! Destructor.
+	~ResultExporter();
+
+	//
+	// Properties.
+	//
+
+	//! Get the columns being exported.
+	const Columns& columns() const;
+
+	//! Get the number of rows written so far.
+	size_t rowCount() const;
+
+	//
+	// Methods.
+	//
+
+	//! Write all the remaining objects from the iterator and flush the writer.
+	size_t writeAll(ObjectIterator it); // throw(WMI::Exception)
+
+	//! Write a single object.
+	void writeRow(const Object& object); // throw(WMI::Exception)
+
+private:
+	//
+	// Members.
+	//
+	BufferedWriter&	m_writer;			//!< The output destination.
+	Format			m_format;			//!< The output format.
+	Columns			m_columns;			//!< The properties to export.
+	bool			m_headerWritten;	//!< Has the CSV header been written?
+	size_t			m_rows;				//!< The number of rows written.
+
+	//
+	// Internal methods.
+	//
+
+	//! Write the CSV header row.
+	void writeHeader();
+
+	//! Write a property value.
+	void writeValue(const VARIANT& value, CIMTYPE type);
+
+	//! Write an array property value.
+	void writeArray(const VARIANT& value, CIMTYPE type);
+
+	//! Write a single value.
+	void writeScalar(const VARIANT& value, CIMTYPE type, bool inQuotes);
+
+	//! Write a string value, quoting and escaping it as required.
+	void writeString(const wchar_t* text, size_t length, bool inQuotes);
+
+	//! Write a WMI datetime value in ISO 8601 format.
+	void writeDateTime(const wchar_t* text, size_t length, bool inQuotes);
+
+	//! Write a signed integer value.
+	void writeInteger(int64 value);
+
+	//! Write an unsigned integer value.
+	void writeUnsigned(uint64 value);
+
+	//! Write a floating-point value.
+	void writeReal(double value, int precision);
+
+	//! Write a null value.
+	void writeNull();
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the columns being exported.
+
+inline const ResultExporter::Columns& ResultExporter::columns() const
+{
+	return m_columns;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the number of rows written so far.
+
+inline size_t ResultExporter::rowCount() const
+{
+	return m_rows;
+}
+
+//namespace WMI
+}
+
+#endif // WMI_RESULTEXPORTER_HPP
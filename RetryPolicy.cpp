@@ -0,0 +1,97 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   RetryPolicy.cpp
+//! \brief  The RetryPolicy class definition.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include "RetryPolicy.hpp"
+
+namespace WMI
+{
+
+//! The errors caused by a lost connection.
+static const HRESULT DISCONNECTED_ERRORS[] =
+{
+	HRESULT_FROM_WIN32(RPC_S_SERVER_UNAVAILABLE),
+	HRESULT_FROM_WIN32(RPC_S_CALL_FAILED),
+	HRESULT_FROM_WIN32(RPC_S_CALL_FAILED_DNE),
+	RPC_E_DISCONNECTED,
+	RPC_E_SERVER_DIED,
+	RPC_E_SERVER_DIED_DNE,
+	CO_E_OBJNOTCONNECTED,
+	WBEM_E_TRANSPORT_FAILURE,
+};
+
+//! The errors caused by a busy host.
+static const HRESULT TRANSIENT_ERRORS[] =
+{
+	HRESULT_FROM_WIN32(RPC_S_SERVER_TOO_BUSY),
+	RPC_E_CALL_REJECTED,
+	RPC_E_SERVERCALL_RETRYLATER,
+	WBEM_E_SERVER_TOO_BUSY,
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//! Construction with the limits and the delays, in milliseconds.
+
+RetryPolicy::RetryPolicy(size_t maxRetries, uint initialDelay, uint maxDelay, uint budget)
+	: m_maxRetries(maxRetries)
+	, m_initialDelay(initialDelay)
+	, m_maxDelay(maxDelay)
+	, m_budget(budget)
+	, m_random()
+{
+	ASSERT(m_initialDelay <= m_maxDelay);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the delay, in milliseconds, before a retry, with a random jitter.
+
+uint RetryPolicy::delay(size_t retry) const
+{
+	return delay(retry, m_random.next());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the delay, in milliseconds, before a retry, given a random number in the
+//! range [0, 1). The first retry is number 0. The ceiling doubles with each
+//! retry, up to the maximum, and the delay is at least half the ceiling.
+
+uint RetryPolicy::delay(size_t retry, double random) const
+{
+	ASSERT((random >= 0.0) && (random < 1.0));
+
+	uint ceiling = m_initialDelay;
+
+	for (size_t i = 0; (i != retry) && (ceiling < m_maxDelay); ++i)
+		ceiling = (ceiling > (m_maxDelay / 2)) ? m_maxDelay : (ceiling * 2);
+
+	const uint half = ceiling / 2;
+
+	return half + static_cast<uint>(random * static_cast<double>(ceiling - half + 1));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Classify the result of a failed call. A lost connection, such as after the
+//! remote host has been rebooted, needs to be re-opened before a retry, whereas
+//! a busy host can be retried as is. All other failures are permanent.
+
+RetryPolicy::Classification RetryPolicy::classify(HRESULT result)
+{
+	for (size_t i = 0; i != ARRAY_SIZE(DISCONNECTED_ERRORS); ++i)
+	{
+		if (result == DISCONNECTED_ERRORS[i])
+			return DISCONNECTED;
+	}
+
+	for (size_t i = 0; i != ARRAY_SIZE(TRANSIENT_ERRORS); ++i)
+	{
+		if (result == TRANSIENT_ERRORS[i])
+			return TRANSIENT;
+	}
+
+	return PERMANENT;
+}
+
+//namespace WMI
+}
@@ -0,0 +1,139 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   RetryPolicy.hpp
+//! \brief  The RetryPolicy class declaration.
+//! \author Chris Oldwood
+
+// Check for previous inclusion
+#ifndef WMI_RETRYPOLICY_HPP
+#define WMI_RETRYPOLICY_HPP
+
+#if _MSC_VER > 1000
+#pragma once
+#endif
+
+#include "Random.hpp"
+#include <Core/SharedPtr.hpp>
+
+namespace WMI
+{
+
+////////////////////////////////////////////////////////////////////////////////
+//! The policy for retrying idempotent calls that fail with a transient error,
+//! such as when a remote host is busy or has been rebooted. Failures are
+//! classified from their HRESULT and the delay between retries grows
+//! exponentially, with a random jitter so that many clients do not retry a
+//! recovering host in lockstep. The retries for a single call are limited by
+//! both a count and an overall time budget.
+
+class RetryPolicy
+{
+public:
+	//! The classes of failure.
+	enum Classification
+	{
+		PERMANENT,		//!< Retrying will not help.
+		TRANSIENT,		//!< The call can be retried on the same connection.
+		DISCONNECTED	//!< The call can be retried once the connection is re-opened.
+	};
+
+public:
+	//! Construction with the limits and the delays, in milliseconds.
+	RetryPolicy(size_t maxRetries = DEFAULT_MAX_RETRIES, uint initialDelay = DEFAULT_INITIAL_DELAY,
+				uint maxDelay = DEFAULT_MAX_DELAY, uint budget = DEFAULT_BUDGET);
+
+	//
+	// Properties.
+	//
+
+	//! Get the maximum number of retries for a call.
+	size_t maxRetries() const;
+
+	//! Get the delay, in milliseconds, before the first retry.
+	uint initialDelay() const;
+
+	//! Get the longest delay, in milliseconds, between retries.
+	uint maxDelay() const;
+
+	//! Get the time, in milliseconds, a call can spend retrying.
+	uint budget() const;
+
+	//
+	// Methods.
+	//
+
+	//! Get the delay before a retry, with a random jitter.
+	uint delay(size_t retry) const;
+
+	//! Get the delay before a retry, given a random number in the range [0, 1).
+	uint delay(size_t retry, double random) const;
+
+	//
+	// Class methods.
+	//
+
+	//! Classify the result of a failed call.
+	static Classification classify(HRESULT result);
+
+	//
+	// Constants.
+	//
+
+	//! The default maximum number of retries for a call.
+	static const size_t DEFAULT_MAX_RETRIES = 3;
+	//! The default delay, in milliseconds, before the first retry.
+	static const uint DEFAULT_INITIAL_DELAY = 100;
+	//! The default longest delay, in milliseconds, between retries.
+	static const uint DEFAULT_MAX_DELAY = 5000;
+	//! The default time, in milliseconds, a call can spend retrying.
+	static const uint DEFAULT_BUDGET = 30000;
+
+private:
+	//
+	// Members.
+	//
+	size_t	m_maxRetries;	//!< The maximum number of retries for a call.
+	uint	m_initialDelay;	//!< The delay before the first retry.
+	uint	m_maxDelay;		//!< The longest delay between retries.
+	uint	m_budget;		//!< The time a call can spend retrying.
+	Random	m_random;		//!< The source of the jitter.
+};
+
+//! The default RetryPolicy smart-pointer type.
+typedef Core::SharedPtr<RetryPolicy> RetryPolicyPtr;
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the maximum number of retries for a call.
+
+inline size_t RetryPolicy::maxRetries() const
+{
+	return m_maxRetries;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the delay, in milliseconds, before the first retry.
+
+inline uint RetryPolicy::initialDelay() const
+{
+	return m_initialDelay;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the longest delay, in milliseconds, between retries.
+
+inline uint RetryPolicy::maxDelay() const
+{
+	return m_maxDelay;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the time, in milliseconds, a call can spend retrying.
+
+inline uint RetryPolicy::budget() const
+{
+	return m_budget;
+}
+
+//namespace WMI
+}
+
+#endif // WMI_RETRYPOLICY_HPP
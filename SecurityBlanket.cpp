@@ -0,0 +1,46 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   SecurityBlanket.cpp
+//! \brief  The SecurityBlanket class definition.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include "SecurityBlanket.hpp"
+
+namespace WMI
+{
+
+////////////////////////////////////////////////////////////////////////////////
+//! Default constructor.
+
+SecurityBlanket::SecurityBlanket()
+	: m_authnLevel(RPC_C_AUTHN_LEVEL_CALL)
+	, m_impLevel(RPC_C_IMP_LEVEL_IMPERSONATE)
+	, m_capabilities(EOAC_NONE)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Construction from the authentication and impersonation levels.
+
+SecurityBlanket::SecurityBlanket(DWORD authnLevel, DWORD impLevel, DWORD capabilities)
+	: m_authnLevel(authnLevel)
+	, m_impLevel(impLevel)
+	, m_capabilities(capabilities)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Apply the blanket to a proxy. The authentication and authorisation services
+//! are negotiated by COM. An in-process object has no proxy, in which case
+//! E_NOINTERFACE is returned.
+
+HRESULT SecurityBlanket::apply(IUnknown* proxy) const
+{
+	ASSERT(proxy != nullptr);
+
+	return ::CoSetProxyBlanket(proxy, RPC_C_AUTHN_DEFAULT, RPC_C_AUTHZ_DEFAULT, nullptr,
+								m_authnLevel, m_impLevel, nullptr, m_capabilities);
+}
+
+//namespace WMI
+}
@@ -0,0 +1,90 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   SecurityBlanket.hpp
+//! \brief  The SecurityBlanket class declaration.
+//! \author Chris Oldwood
+
+// Check for previous inclusion
+#ifndef WMI_SECURITYBLANKET_HPP
+#define WMI_SECURITYBLANKET_HPP
+
+#if _MSC_VER > 1000
+#pragma once
+#endif
+
+namespace WMI
+{
+
+////////////////////////////////////////////////////////////////////////////////
+//! The authentication and impersonation settings for the COM proxies used to
+//! talk to a WMI provider. A blanket belongs to a proxy rather than to the
+//! object behind it, and so each proxy returned by a call, such as a query's
+//! enumerator, otherwise falls back to the process-wide defaults. The default
+//! blanket authenticates each call and allows the provider to impersonate the
+//! caller, which is what most WMI providers require.
+
+class SecurityBlanket
+{
+public:
+	//! Default constructor.
+	SecurityBlanket();
+
+	//! Construction from the authentication and impersonation levels.
+	SecurityBlanket(DWORD authnLevel, DWORD impLevel, DWORD capabilities = EOAC_NONE);
+
+	//
+	// Properties.
+	//
+
+	//! Get the authentication level, e.g. RPC_C_AUTHN_LEVEL_CALL.
+	DWORD authnLevel() const;
+
+	//! Get the impersonation level, e.g. RPC_C_IMP_LEVEL_IMPERSONATE.
+	DWORD impLevel() const;
+
+	//! Get the proxy capabilities, e.g. EOAC_NONE.
+	DWORD capabilities() const;
+
+	//
+	// Methods.
+	//
+
+	//! Apply the blanket to a proxy.
+	HRESULT apply(IUnknown* proxy) const;
+
+private:
+	//
+	// Members.
+	//
+	DWORD	m_authnLevel;	//!< The authentication level.
+	DWORD	m_impLevel;		//!< The impersonation level.
+	DWORD	m_capabilities;	//!< The proxy capabilities.
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the authentication level, e.g. RPC_C_AUTHN_LEVEL_CALL.
+
+inline DWORD SecurityBlanket::authnLevel() const
+{
+	return m_authnLevel;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the impersonation level, e.g. RPC_C_IMP_LEVEL_IMPERSONATE.
+
+inline DWORD SecurityBlanket::impLevel() const
+{
+	return m_impLevel;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the proxy capabilities, e.g. EOAC_NONE.
+
+inline DWORD SecurityBlanket::capabilities() const
+{
+	return m_capabilities;
+}
+
+//namespace WMI
+}
+
+#endif // WMI_SECURITYBLANKET_HPP
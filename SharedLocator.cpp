@@ -0,0 +1,111 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   SharedLocator.cpp
+//! \brief  The SharedLocator class definition.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include "SharedLocator.hpp"
+#include "Exception.hpp"
+#include "CriticalSection.hpp"
+#include "ThreadAffinity.hpp"
+
+#ifndef _MSC_VER
+WCL_DECLARE_IFACETRAITS(IWbemLocator, IID_IWbemLocator);
+#endif
+
+namespace WMI
+{
+
+//! The lock guarding the shared locator.
+static CriticalSection s_lock;
+
+//! The shared locator and the apartment it was created in.
+struct SharedState
+{
+	IWbemLocatorPtr	m_locator;	//!< The locator.
+	ThreadAffinity	m_affinity;	//!< The apartment it was created in.
+};
+
+//! The shared locator, or null if not yet created. This is not destroyed at
+//! exit as that may be after COM has been uninitialised.
+static SharedState* s_shared = nullptr;
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the locator for the calling thread, creating it if required.
+
+IWbemLocatorPtr SharedLocator::get()
+{
+	IWbemLocatorPtr locator;
+
+	const HRESULT result = tryGet(locator);
+
+	if (FAILED(result))
+		throw Exception(result, TXT("Failed to create the WMI locator"));
+
+	return locator;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the locator for the calling thread, without throwing on failure. The
+//! shared locator is returned if the calling thread can use it, otherwise a
+//! new one is created just for the caller.
+
+HRESULT SharedLocator::tryGet(IWbemLocatorPtr& locator)
+{
+	CriticalSection::Lock lock(s_lock);
+
+	if ( (s_shared != nullptr) && s_shared->m_affinity.isAccessible() )
+	{
+		locator = s_shared->m_locator;
+		return S_OK;
+	}
+
+	IWbemLocatorPtr created;
+
+	const HRESULT result = ::CoCreateInstance(CLSID_WbemLocator, nullptr, CLSCTX_INPROC_SERVER,
+												IID_IWbemLocator, reinterpret_cast<void**>(AttachTo(created)));
+
+	if (FAILED(result))
+		return result;
+
+	if (s_shared == nullptr)
+	{
+		s_shared = new SharedState;
+		s_shared->m_locator = created;
+	}
+
+	locator = created;
+
+	return S_OK;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Query if the shared locator has been created.
+
+bool SharedLocator::isCreated()
+{
+	CriticalSection::Lock lock(s_lock);
+
+	return (s_shared != nullptr);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Release the shared locator. This must be called in the apartment it was
+//! created in, before that apartment is uninitialised. A subsequent connection
+//! creates a new one.
+
+void SharedLocator::release()
+{
+	CriticalSection::Lock lock(s_lock);
+
+	if (s_shared != nullptr)
+	{
+		ASSERT(s_shared->m_affinity.isAccessible());
+
+		delete s_shared;
+		s_shared = nullptr;
+	}
+}
+
+//namespace WMI
+}
@@ -0,0 +1,50 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   SharedLocator.hpp
+//! \brief  The SharedLocator class declaration.
+//! \author Chris Oldwood
+
+// Check for previous inclusion
+#ifndef WMI_SHAREDLOCATOR_HPP
+#define WMI_SHAREDLOCATOR_HPP
+
+#if _MSC_VER > 1000
+#pragma once
+#endif
+
+#include "Types.hpp"
+
+namespace WMI
+{
+
+////////////////////////////////////////////////////////////////////////////////
+//! The WMI locator shared by the connections in the process. The locator is
+//! created on first use and then reused by any thread that can access it, i.e.
+//! the creating thread or, when created in the multi-threaded apartment, any
+//! thread in the MTA. A thread in another apartment is given a new locator.
+//! The shared locator must be released before the apartment it was created in
+//! is uninitialised.
+
+class SharedLocator
+{
+public:
+	//
+	// Class methods.
+	//
+
+	//! Get the locator for the calling thread, creating it if required.
+	static IWbemLocatorPtr get(); // throw(WMI::Exception)
+
+	//! Get the locator for the calling thread, without throwing on failure.
+	static HRESULT tryGet(IWbemLocatorPtr& locator);
+
+	//! Query if the shared locator has been created.
+	static bool isCreated();
+
+	//! Release the shared locator.
+	static void release();
+};
+
+//namespace WMI
+}
+
+#endif // WMI_SHAREDLOCATOR_HPP
@@ -0,0 +1,114 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   SnapshotFormat.hpp
+//! \brief  The binary snapshot file format definitions.
+//! \author Chris Oldwood
+
+// Check for previous inclusion
+#ifndef WMI_SNAPSHOTFORMAT_HPP
+#define WMI_SNAPSHOTFORMAT_HPP
+
+#if _MSC_VER > 1000
+#pragma once
+#endif
+
+namespace WMI
+{
+
+////////////////////////////////////////////////////////////////////////////////
+// A snapshot file is laid out as follows, with all offsets relative to the
+// start of the file and all blocks aligned on an 8 byte boundary:-
+//
+// SnapshotHeader
+// SnapshotColumn[columnCount]
+// Column blocks: a null bitmap of (rowCount+7)/8 bytes followed by rowCount
+//                values of the column's storage width.
+// String table:  SnapshotString[stringCount] followed by the nul terminated
+//                UTF-16 characters of each string.
+//
+// String values are stored as an index into the string table, which holds a
+// single copy of each distinct string.
+
+//! The value at the start of a snapshot file.
+static const char SNAPSHOT_MAGIC[4] = { 'W', 'M', 'I', 'S' };
+
+//! The current version of the file format.
+static const uint32 SNAPSHOT_VERSION = 1;
+
+//! The ways a column's values are stored.
+enum SnapshotStorage
+{
+	SNAPSHOT_SIGNED   = 1,	//!< An int64 per value.
+	SNAPSHOT_UNSIGNED = 2,	//!< A uint64 per value.
+	SNAPSHOT_REAL     = 3,	//!< A double per value.
+	SNAPSHOT_BOOLEAN  = 4,	//!< A uint8 per value.
+	SNAPSHOT_STRING   = 5,	//!< A uint32 string table index per value.
+};
+
+//! The column flags.
+enum SnapshotColumnFlags
+{
+	SNAPSHOT_KEY_COLUMN = 0x0001,	//!< The column is a key property.
+};
+
+//! The file header.
+struct SnapshotHeader
+{
+	char	m_magic[4];				//!< SNAPSHOT_MAGIC.
+	uint32	m_version;				//!< The file format version.
+	uint32	m_headerSize;			//!< The size of this structure.
+	uint32	m_classNameIndex;		//!< The string index of the WMI class name.
+	uint64	m_rowCount;				//!< The number of rows.
+	uint32	m_columnCount;			//!< The number of columns.
+	uint32	m_stringCount;			//!< The number of entries in the string table.
+	uint64	m_stringTableOffset;	//!< The offset of the string table.
+	uint64	m_fileSize;				//!< The size of the entire file.
+};
+
+//! A column definition.
+struct SnapshotColumn
+{
+	uint32	m_nameIndex;	//!< The string index of the property name.
+	uint32	m_cimType;		//!< The CIM type of the property.
+	uint32	m_storage;		//!< How the values are stored.
+	uint32	m_flags;		//!< The column flags.
+	uint64	m_nullsOffset;	//!< The offset of the null bitmap.
+	uint64	m_valuesOffset;	//!< The offset of the values.
+};
+
+//! A string table entry.
+struct SnapshotString
+{
+	uint32	m_offset;	//!< The offset of the first character, in characters.
+	uint32	m_length;	//!< The length of the string, in characters.
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the size of a single value for the storage type.
+
+inline size_t snapshotValueSize(uint32 storage)
+{
+	switch (storage)
+	{
+		case SNAPSHOT_SIGNED:	return sizeof(int64);
+		case SNAPSHOT_UNSIGNED:	return sizeof(uint64);
+		case SNAPSHOT_REAL:		return sizeof(double);
+		case SNAPSHOT_BOOLEAN:	return sizeof(uint8);
+		case SNAPSHOT_STRING:	return sizeof(uint32);
+		default:				break;
+	}
+
+	return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Round a size or offset up to the block alignment.
+
+inline uint64 snapshotAlign(uint64 value)
+{
+	return (value + 7) & ~static_cast<uint64>(7);
+}
+
+//namespace WMI
+}
+
+#endif // WMI_SNAPSHOTFORMAT_HPP
@@ -0,0 +1,470 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   SnapshotReader.cpp
+//! \brief  The SnapshotReader class definition.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include "SnapshotReader.hpp"
+#include "MemoryObject.hpp"
+#include "Exception.hpp"
+#include <Core/BadLogicException.hpp>
+#include <Core/StringUtils.hpp>
+#include <string.h>
+
+namespace WMI
+{
+
+////////////////////////////////////////////////////////////////////////////////
+//! Format a 64-bit value as a string, as WMI does.
+
+static BSTR formatInteger(uint64 value, bool isNegative)
+{
+	wchar_t  digits[24];
+	wchar_t* end = digits + ARRAY_SIZE(digits);
+	wchar_t* begin = end;
+
+	do
+	{
+		*--begin = static_cast<wchar_t>(L'0' + (value % 10));
+		value /= 10;
+	}
+	while (value != 0);
+
+	if (isNegative)
+		*--begin = L'-';
+
+	return ::SysAllocStringLen(begin, static_cast<UINT>(end - begin));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Query if a range lies within a region of a given size. The offset and
+//! length are read from the file and so are not added together, as the sum
+//! could wrap around.
+
+static bool isWithin(uint64 offset, uint64 length, uint64 size)
+{
+	return (offset <= size) && (length <= (size - offset));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Open and validate the snapshot file.
+
+SnapshotReader::SnapshotReader(const tstring& path)
+	: m_path(path)
+	, m_file(INVALID_HANDLE_VALUE)
+	, m_mapping(NULL)
+	, m_base(nullptr)
+	, m_header(nullptr)
+	, m_columns(nullptr)
+	, m_strings(nullptr)
+	, m_chars(nullptr)
+{
+	try
+	{
+		m_file = ::CreateFile(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+								FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+
+		if (m_file == INVALID_HANDLE_VALUE)
+		{
+			const tstring message = Core::fmt(TXT("Failed to open the snapshot '%s'"), path.c_str());
+			throw Exception(HRESULT_FROM_WIN32(::GetLastError()), message.c_str());
+		}
+
+		LARGE_INTEGER fileSize;
+
+		if (!::GetFileSizeEx(m_file, &fileSize))
+		{
+			const tstring message = Core::fmt(TXT("Failed to query the size of the snapshot '%s'"), path.c_str());
+			throw Exception(HRESULT_FROM_WIN32(::GetLastError()), message.c_str());
+		}
+
+		if (static_cast<uint64>(fileSize.QuadPart) < sizeof(SnapshotHeader))
+		{
+			const tstring message = Core::fmt(TXT("The file '%s' is not a snapshot"), path.c_str());
+			throw Exception(HRESULT_FROM_WIN32(ERROR_INVALID_DATA), message.c_str());
+		}
+
+		m_mapping = ::CreateFileMapping(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+		if (m_mapping == NULL)
+		{
+			const tstring message = Core::fmt(TXT("Failed to map the snapshot '%s'"), path.c_str());
+			throw Exception(HRESULT_FROM_WIN32(::GetLastError()), message.c_str());
+		}
+
+		m_base = static_cast<const byte*>(::MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+
+		if (m_base == nullptr)
+		{
+			const tstring message = Core::fmt(TXT("Failed to map the snapshot '%s'"), path.c_str());
+			throw Exception(HRESULT_FROM_WIN32(::GetLastError()), message.c_str());
+		}
+
+		m_header = reinterpret_cast<const SnapshotHeader*>(m_base);
+
+		validate(static_cast<uint64>(fileSize.QuadPart));
+
+		m_columns = reinterpret_cast<const SnapshotColumn*>(m_base + m_header->m_headerSize);
+		m_strings = reinterpret_cast<const SnapshotString*>(m_base + m_header->m_stringTableOffset);
+		m_chars   = reinterpret_cast<const wchar_t*>(m_strings + m_header->m_stringCount);
+	}
+	catch (...)
+	{
+		if (m_base != nullptr)
+			::UnmapViewOfFile(m_base);
+
+		if (m_mapping != NULL)
+			::CloseHandle(m_mapping);
+
+		if (m_file != INVALID_HANDLE_VALUE)
+			::CloseHandle(m_file);
+
+		throw;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Destructor.
+
+SnapshotReader::~SnapshotReader()
+{
+	::UnmapViewOfFile(m_base);
+	::CloseHandle(m_mapping);
+	::CloseHandle(m_file);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the WMI class name.
+
+const wchar_t* SnapshotReader::className() const
+{
+	size_t length = 0;
+
+	return lookupString(m_header->m_classNameIndex, length);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the property name of a column.
+
+const wchar_t* SnapshotReader::columnName(size_t column) const
+{
+	ASSERT(column < columnCount());
+
+	size_t length = 0;
+
+	return lookupString(m_columns[column].m_nameIndex, length);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Try and find the column for a property. The name is matched
+//! case-insensitively, as with WMI.
+
+bool SnapshotReader::tryFindColumn(const tstring& name, size_t& column) const
+{
+	for (size_t i = 0; i != columnCount(); ++i)
+	{
+		if (_wcsicmp(columnName(i), name.c_str()) == 0)
+		{
+			column = i;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Find the column for a property.
+
+size_t SnapshotReader::findColumn(const tstring& name) const
+{
+	size_t column = 0;
+
+	if (!tryFindColumn(name, column))
+		throw Core::BadLogicException(Core::fmt(TXT("The snapshot does not contain the property '%s'"), name.c_str()));
+
+	return column;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get a signed integer value.
+
+int64 SnapshotReader::getSigned(size_t row, size_t column) const
+{
+	int64 value;
+
+	memcpy(&value, getValue(row, column, SNAPSHOT_SIGNED), sizeof(value));
+
+	return value;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get an unsigned integer value.
+
+uint64 SnapshotReader::getUnsigned(size_t row, size_t column) const
+{
+	uint64 value;
+
+	memcpy(&value, getValue(row, column, SNAPSHOT_UNSIGNED), sizeof(value));
+
+	return value;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get a floating-point value.
+
+double SnapshotReader::getReal(size_t row, size_t column) const
+{
+	double value;
+
+	memcpy(&value, getValue(row, column, SNAPSHOT_REAL), sizeof(value));
+
+	return value;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get a boolean value.
+
+bool SnapshotReader::getBoolean(size_t row, size_t column) const
+{
+	return (*getValue(row, column, SNAPSHOT_BOOLEAN) != 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get a string value. The string points into the file and remains valid for
+//! the lifetime of the reader. A null value is returned as an empty string.
+
+const wchar_t* SnapshotReader::getString(size_t row, size_t column) const
+{
+	size_t length = 0;
+
+	return getString(row, column, length);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get a string value and its length.
+
+const wchar_t* SnapshotReader::getString(size_t row, size_t column, size_t& length) const
+{
+	uint32 index;
+
+	memcpy(&index, getValue(row, column, SNAPSHOT_STRING), sizeof(index));
+
+	if (isNull(row, column))
+	{
+		length = 0;
+		return L"";
+	}
+
+	if (index >= m_header->m_stringCount)
+	{
+		const tstring message = Core::fmt(TXT("The snapshot '%s' is corrupt or truncated"), m_path.c_str());
+		throw Exception(HRESULT_FROM_WIN32(ERROR_INVALID_DATA), message.c_str());
+	}
+
+	return lookupString(index, length);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Create an in-memory object from a row. The values are stored in the same
+//! VARIANT types that WMI uses for each CIM type, e.g. 64-bit integers are
+//! stored as strings, so that the typed classes can be used on the object.
+//! This copies every value in the row; the typed accessors, such as
+//! getString(), read directly from the mapping instead.
+
+IWbemClassObjectPtr SnapshotReader::getObject(size_t row) const
+{
+	ASSERT(row < rowCount());
+
+	MemoryObject*       object = new MemoryObject(className());
+	IWbemClassObjectPtr result = object->getInterface();
+
+	for (size_t column = 0; column != columnCount(); ++column)
+	{
+		const CIMTYPE type = columnType(column);
+		WCL::Variant  value;
+
+		if (isNull(row, column))
+		{
+			V_VT(&value) = VT_NULL;
+		}
+		else
+		{
+			switch (type)
+			{
+				case CIM_SINT8:
+				case CIM_SINT16:
+					V_VT(&value) = VT_I2;
+					V_I2(&value) = static_cast<SHORT>(getSigned(row, column));
+					break;
+
+				case CIM_SINT32:
+					V_VT(&value) = VT_I4;
+					V_I4(&value) = static_cast<LONG>(getSigned(row, column));
+					break;
+
+				case CIM_SINT64:
+				{
+					const int64 signedValue = getSigned(row, column);
+					const bool  isNegative = (signedValue < 0);
+					const uint64 magnitude = isNegative ? (static_cast<uint64>(-(signedValue + 1)) + 1) : static_cast<uint64>(signedValue);
+
+					V_VT(&value)   = VT_BSTR;
+					V_BSTR(&value) = formatInteger(magnitude, isNegative);
+				}
+				break;
+
+				case CIM_UINT8:
+					V_VT(&value)  = VT_UI1;
+					V_UI1(&value) = static_cast<BYTE>(getUnsigned(row, column));
+					break;
+
+				case CIM_CHAR16:
+					V_VT(&value) = VT_I2;
+					V_I2(&value) = static_cast<SHORT>(getUnsigned(row, column));
+					break;
+
+				case CIM_UINT16:
+				case CIM_UINT32:
+					V_VT(&value) = VT_I4;
+					V_I4(&value) = static_cast<LONG>(getUnsigned(row, column));
+					break;
+
+				case CIM_UINT64:
+					V_VT(&value)   = VT_BSTR;
+					V_BSTR(&value) = formatInteger(getUnsigned(row, column), false);
+					break;
+
+				case CIM_REAL32:
+					V_VT(&value) = VT_R4;
+					V_R4(&value) = static_cast<float>(getReal(row, column));
+					break;
+
+				case CIM_REAL64:
+					V_VT(&value) = VT_R8;
+					V_R8(&value) = getReal(row, column);
+					break;
+
+				case CIM_BOOLEAN:
+					V_VT(&value)   = VT_BOOL;
+					V_BOOL(&value) = getBoolean(row, column) ? VARIANT_TRUE : VARIANT_FALSE;
+					break;
+
+				default:
+				{
+					size_t         length = 0;
+					const wchar_t* text = getString(row, column, length);
+
+					V_VT(&value)   = VT_BSTR;
+					V_BSTR(&value) = ::SysAllocStringLen(text, static_cast<UINT>(length));
+				}
+				break;
+			}
+		}
+
+		object->setProperty(columnName(column), value, type, isKeyColumn(column));
+	}
+
+	return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Validate the file structure so that the accessors can read the mapping
+//! without any further bounds checks. The offsets and sizes in the file are
+//! untrusted and so are compared by subtraction rather than addition.
+
+void SnapshotReader::validate(uint64 fileSize) const
+{
+	const SnapshotHeader& header = *m_header;
+	bool                  valid = (memcmp(header.m_magic, SNAPSHOT_MAGIC, sizeof(header.m_magic)) == 0);
+
+	if (valid && (header.m_version != SNAPSHOT_VERSION))
+	{
+		const tstring message = Core::fmt(TXT("The snapshot '%s' is version %u, expected version %u"),
+											m_path.c_str(), header.m_version, SNAPSHOT_VERSION);
+		throw Exception(HRESULT_FROM_WIN32(ERROR_INVALID_DATA), message.c_str());
+	}
+
+	const uint64 rows = header.m_rowCount;
+	const uint64 stringTable = header.m_stringTableOffset;
+	const uint64 columnsSize = static_cast<uint64>(header.m_columnCount) * sizeof(SnapshotColumn);
+	const uint64 stringsSize = static_cast<uint64>(header.m_stringCount) * sizeof(SnapshotString);
+	const uint64 nullsSize = (rows / 8) + (((rows % 8) != 0) ? 1 : 0);
+
+	valid = valid && (header.m_headerSize >= sizeof(SnapshotHeader)) && ((header.m_headerSize % 8) == 0)
+				  && (header.m_fileSize == fileSize) && ((rows / 8) <= fileSize)
+				  && isWithin(header.m_headerSize, columnsSize, stringTable) && isWithin(stringTable, stringsSize, fileSize)
+				  && ((stringTable % 8) == 0) && (header.m_classNameIndex < header.m_stringCount);
+
+	// Both ends are known to be within the file now.
+	const uint64 columnsEnd = valid ? (header.m_headerSize + columnsSize) : 0;
+	const uint64 stringsEnd = valid ? (stringTable + stringsSize) : 0;
+
+	const SnapshotColumn* columns = reinterpret_cast<const SnapshotColumn*>(m_base + header.m_headerSize);
+
+	for (uint32 i = 0; valid && (i != header.m_columnCount); ++i)
+	{
+		const SnapshotColumn& column = columns[i];
+		const size_t          width = snapshotValueSize(column.m_storage);
+
+		valid = (width != 0) && (column.m_nameIndex < header.m_stringCount)
+			 && (column.m_nullsOffset >= columnsEnd) && isWithin(column.m_nullsOffset, nullsSize, column.m_valuesOffset)
+			 && ((column.m_valuesOffset % width) == 0) && isWithin(column.m_valuesOffset, rows * width, stringTable);
+	}
+
+	const SnapshotString* strings = reinterpret_cast<const SnapshotString*>(m_base + header.m_stringTableOffset);
+	const uint64          chars = valid ? ((fileSize - stringsEnd) / sizeof(uint16)) : 0;
+	const wchar_t*        text = reinterpret_cast<const wchar_t*>(m_base + stringsEnd);
+
+	for (uint32 i = 0; valid && (i != header.m_stringCount); ++i)
+	{
+		const SnapshotString& string = strings[i];
+
+		valid = ((static_cast<uint64>(string.m_offset) + string.m_length) < chars)
+			 && (text[string.m_offset + string.m_length] == L'\0');
+	}
+
+	if (!valid)
+	{
+		const tstring message = Core::fmt(TXT("The snapshot '%s' is corrupt or truncated"), m_path.c_str());
+		throw Exception(HRESULT_FROM_WIN32(ERROR_INVALID_DATA), message.c_str());
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get a string from the string table.
+
+const wchar_t* SnapshotReader::lookupString(uint32 index, size_t& length) const
+{
+	ASSERT(index < m_header->m_stringCount);
+
+	const SnapshotString& string = m_strings[index];
+
+	length = string.m_length;
+
+	return m_chars + string.m_offset;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the address of a value after checking its storage type.
+
+const byte* SnapshotReader::getValue(size_t row, size_t column, uint32 storage) const
+{
+	ASSERT(row < rowCount());
+	ASSERT(column < columnCount());
+
+	const SnapshotColumn& definition = m_columns[column];
+
+	if (definition.m_storage != storage)
+	{
+		size_t length = 0;
+
+		throw Core::BadLogicException(Core::fmt(TXT("The snapshot property '%s' is not of the requested type"),
+												lookupString(definition.m_nameIndex, length)));
+	}
+
+	return m_base + definition.m_valuesOffset + (row * snapshotValueSize(storage));
+}
+
+//namespace WMI
+}
@@ -0,0 +1,174 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   SnapshotReader.hpp
+//! \brief  The SnapshotReader class declaration.
+//! \author Chris Oldwood
+
+// Check for previous inclusion
+#ifndef WMI_SNAPSHOTREADER_HPP
+#define WMI_SNAPSHOTREADER_HPP
+
+#if _MSC_VER > 1000
+#pragma once
+#endif
+
+#include "Types.hpp"
+#include "SnapshotFormat.hpp"
+#include <Core/NotCopyable.hpp>
+
+namespace WMI
+{
+
+////////////////////////////////////////////////////////////////////////////////
+//! Provides read-only access to a binary snapshot written by the
+//! SnapshotWriter. The file is memory mapped and the values are read directly
+//! from the mapping, so strings are returned as pointers into the file rather
+//! than copies and no COM calls are made.
+//!
+//! A row can also be materialised as an in-memory IWbemClassObject so that it
+//! can be wrapped by the typed classes, e.g. Win32_Process.
+
+class SnapshotReader : private Core::NotCopyable
+{
+public:
+	//! Open and validate the snapshot file.
+	explicit SnapshotReader(const tstring& path); // throw(WMI::Exception)
+
+	//! Destructor.
+	~SnapshotReader();
+
+	//
+	// Properties.
+	//
+
+	//! Get the WMI class name.
+	const wchar_t* className() const;
+
+	//! Get the number of rows.
+	size_t rowCount() const;
+
+	//! Get the number of columns.
+	size_t columnCount() const;
+
+	//! Get the property name of a column.
+	const wchar_t* columnName(size_t column) const;
+
+	//! Get the CIM type of a column.
+	CIMTYPE columnType(size_t column) const;
+
+	//! Query if a column is a key property.
+	bool isKeyColumn(size_t column) const;
+
+	//
+	// Methods.
+	//
+
+	//! Try and find the column for a property.
+	bool tryFindColumn(const tstring& name, size_t& column) const;
+
+	//! Find the column for a property.
+	size_t findColumn(const tstring& name) const; // throw(Core::BadLogicException)
+
+	//! Query if a value is null.
+	bool isNull(size_t row, size_t column) const;
+
+	//! Get a signed integer value.
+	int64 getSigned(size_t row, size_t column) const; // throw(Core::BadLogicException)
+
+	//! Get an unsigned integer value.
+	uint64 getUnsigned(size_t row, size_t column) const; // throw(Core::BadLogicException)
+
+	//! Get a floating-point value.
+	double getReal(size_t row, size_t column) const; // throw(Core::BadLogicException)
+
+	//! Get a boolean value.
+	bool getBoolean(size_t row, size_t column) const; // throw(Core::BadLogicException)
+
+	//! Get a string value.
+	const wchar_t* getString(size_t row, size_t column) const; // throw(Core::BadLogicException, WMI::Exception)
+
+	//! Get a string value and its length.
+	const wchar_t* getString(size_t row, size_t column, size_t& length) const; // throw(Core::BadLogicException, WMI::Exception)
+
+	//! Create an in-memory object from a row.
+	IWbemClassObjectPtr getObject(size_t row) const;
+
+private:
+	//
+	// Members.
+	//
+	tstring					m_path;		//!< The path to the file.
+	HANDLE					m_file;		//!< The file handle.
+	HANDLE					m_mapping;	//!< The file mapping handle.
+	const byte*				m_base;		//!< The start of the mapped view.
+	const SnapshotHeader*	m_header;	//!< The file header.
+	const SnapshotColumn*	m_columns;	//!< The column definitions.
+	const SnapshotString*	m_strings;	//!< The string table entries.
+	const wchar_t*			m_chars;	//!< The string table characters.
+
+	//
+	// Internal methods.
+	//
+
+	//! Validate the file structure.
+	void validate(uint64 fileSize) const; // throw(WMI::Exception)
+
+	//! Get a string from the string table.
+	const wchar_t* lookupString(uint32 index, size_t& length) const;
+
+	//! Get the address of a value after checking its storage type.
+	const byte* getValue(size_t row, size_t column, uint32 storage) const; // throw(Core::BadLogicException)
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the number of rows.
+
+inline size_t SnapshotReader::rowCount() const
+{
+	return static_cast<size_t>(m_header->m_rowCount);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the number of columns.
+
+inline size_t SnapshotReader::columnCount() const
+{
+	return m_header->m_columnCount;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the CIM type of a column.
+
+inline CIMTYPE SnapshotReader::columnType(size_t column) const
+{
+	ASSERT(column < columnCount());
+
+	return static_cast<CIMTYPE>(m_columns[column].m_cimType);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Query if a column is a key property.
+
+inline bool SnapshotReader::isKeyColumn(size_t column) const
+{
+	ASSERT(column < columnCount());
+
+	return (m_columns[column].m_flags & SNAPSHOT_KEY_COLUMN) != 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Query if a value is null.
+
+inline bool SnapshotReader::isNull(size_t row, size_t column) const
+{
+	ASSERT(row < rowCount());
+	ASSERT(column < columnCount());
+
+	const byte* nulls = m_base + m_columns[column].m_nullsOffset;
+
+	return (nulls[row / 8] & (1 << (row % 8))) != 0;
+}
+
+//namespace WMI
+}
+
+#endif // WMI_SNAPSHOTREADER_HPP
@@ -0,0 +1,434 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   SnapshotWriter.cpp
+//! \brief  The SnapshotWriter class definition.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include "SnapshotWriter.hpp"
+#include "SnapshotFormat.hpp"
+#include "FileWriter.hpp"
+#include "Exception.hpp"
+#include <Core/StringUtils.hpp>
+#include <string.h>
+
+#ifndef _MSC_VER
+WCL_DECLARE_IFACETRAITS(IWbemClassObject, IID_IWbemClassObject);
+#endif
+
+namespace WMI
+{
+
+////////////////////////////////////////////////////////////////////////////////
+//! Map the CIM type of a property to the way its values are stored. Returns 0
+//! for the types that cannot be stored.
+
+static uint32 storageFromType(CIMTYPE type)
+{
+	if (type & CIM_FLAG_ARRAY)
+		return 0;
+
+	switch (type)
+	{
+		case CIM_SINT8:
+		case CIM_SINT16:
+		case CIM_SINT32:
+		case CIM_SINT64:
+			return SNAPSHOT_SIGNED;
+
+		case CIM_UINT8:
+		case CIM_UINT16:
+		case CIM_UINT32:
+		case CIM_UINT64:
+		case CIM_CHAR16:
+			return SNAPSHOT_UNSIGNED;
+
+		case CIM_REAL32:
+		case CIM_REAL64:
+			return SNAPSHOT_REAL;
+
+		case CIM_BOOLEAN:
+			return SNAPSHOT_BOOLEAN;
+
+		case CIM_STRING:
+		case CIM_DATETIME:
+		case CIM_REFERENCE:
+			return SNAPSHOT_STRING;
+
+		default:
+			break;
+	}
+
+	return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Write zeroes to pad the output from one offset to another.
+
+static void writePadding(BufferedWriter& writer, uint64 from, uint64 to)
+{
+	const char zeroes[8] = { 0 };
+
+	ASSERT((to >= from) && ((to - from) <= sizeof(zeroes)));
+
+	writer.write(zeroes, static_cast<size_t>(to - from));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Construction with the columns taken from the first object.
+
+SnapshotWriter::SnapshotWriter(const tstring& className)
+	: m_className(className)
+	, m_names()
+	, m_columns()
+	, m_rows(0)
+	, m_index()
+	, m_strings()
+{
+	addString(className.c_str(), className.length());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Construction with an explicit set of columns.
+
+SnapshotWriter::SnapshotWriter(const tstring& className, const Columns& columns)
+	: m_className(className)
+	, m_names(columns)
+	, m_columns()
+	, m_rows(0)
+	, m_index()
+	, m_strings()
+{
+	addString(className.c_str(), className.length());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Destructor.
+
+SnapshotWriter::~SnapshotWriter()
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Add a single object. Properties the object does not have are stored as
+//! null values.
+
+void SnapshotWriter::addRow(const Object& object)
+{
+	IWbemClassObjectPtr instance = object.get();
+
+	if (m_rows == 0)
+		createColumns(instance);
+
+	const size_t byte = m_rows / 8;
+	const uint8  bit = static_cast<uint8>(1 << (m_rows % 8));
+
+	for (ColumnList::iterator it = m_columns.begin(); it != m_columns.end(); ++it)
+	{
+		if (byte == it->m_nulls.size())
+			it->m_nulls.push_back(0);
+
+		WCL::Variant value;
+
+		HRESULT result = instance->Get(it->m_name.c_str(), 0, &value, nullptr, nullptr);
+
+		if ( (result != WBEM_E_NOT_FOUND) && FAILED(result) )
+		{
+			const tstring message = Core::fmt(TXT("Failed to retrieve the property '%s' for the snapshot"), it->m_name.c_str());
+			throw Exception(result, instance, message.c_str());
+		}
+
+		if ( (result == WBEM_E_NOT_FOUND) || (V_VT(&value) == VT_NULL) || (V_VT(&value) == VT_EMPTY) )
+		{
+			it->m_nulls[byte] |= bit;
+			it->m_values.push_back(0);
+		}
+		else
+		{
+			it->m_values.push_back(convertValue(*it, value));
+		}
+	}
+
+	++m_rows;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Write the snapshot to a file.
+
+void SnapshotWriter::save(const tstring& path) const
+{
+	const uint64 rows = m_rows;
+	const size_t nullsSize = static_cast<size_t>((rows + 7) / 8);
+
+	SnapshotHeader header;
+
+	memset(&header, 0, sizeof(header));
+	memcpy(header.m_magic, SNAPSHOT_MAGIC, sizeof(header.m_magic));
+	header.m_version        = SNAPSHOT_VERSION;
+	header.m_headerSize     = sizeof(SnapshotHeader);
+	header.m_classNameIndex = 0;
+	header.m_rowCount       = rows;
+	header.m_columnCount    = static_cast<uint32>(m_columns.size());
+	header.m_stringCount    = static_cast<uint32>(m_strings.size());
+
+	// Lay out the column blocks.
+	std::vector<SnapshotColumn> columns(m_columns.size());
+	uint64 offset = snapshotAlign(sizeof(SnapshotHeader) + (columns.size() * sizeof(SnapshotColumn)));
+
+	for (size_t i = 0; i != m_columns.size(); ++i)
+	{
+		const Column&   column = m_columns[i];
+		SnapshotColumn& layout = columns[i];
+
+		layout.m_nameIndex    = m_index.find(column.m_name)->second;
+		layout.m_cimType      = static_cast<uint32>(column.m_type);
+		layout.m_storage      = column.m_storage;
+		layout.m_flags        = column.m_isKey ? SNAPSHOT_KEY_COLUMN : 0;
+		layout.m_nullsOffset  = offset;
+		layout.m_valuesOffset = snapshotAlign(offset + nullsSize);
+
+		offset = snapshotAlign(layout.m_valuesOffset + (rows * snapshotValueSize(column.m_storage)));
+	}
+
+	// Lay out the string table.
+	std::vector<SnapshotString> strings(m_strings.size());
+	uint32 chars = 0;
+
+	for (size_t i = 0; i != m_strings.size(); ++i)
+	{
+		strings[i].m_offset = chars;
+		strings[i].m_length = static_cast<uint32>(m_strings[i]->length());
+
+		chars += strings[i].m_length + 1;
+	}
+
+	header.m_stringTableOffset = offset;
+	header.m_fileSize = offset + (strings.size() * sizeof(SnapshotString)) + (chars * sizeof(uint16));
+
+	// Write the file.
+	FileWriter file(path);
+
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+	if (!columns.empty())
+		file.write(reinterpret_cast<const char*>(&columns[0]), columns.size() * sizeof(SnapshotColumn));
+
+	uint64 written = sizeof(SnapshotHeader) + (columns.size() * sizeof(SnapshotColumn));
+
+	for (size_t i = 0; i != m_columns.size(); ++i)
+	{
+		const Column&         column = m_columns[i];
+		const SnapshotColumn& layout = columns[i];
+
+		writePadding(file, written, layout.m_nullsOffset);
+
+		if (!column.m_nulls.empty())
+			file.write(reinterpret_cast<const char*>(&column.m_nulls[0]), nullsSize);
+
+		writePadding(file, layout.m_nullsOffset + nullsSize, layout.m_valuesOffset);
+
+		const size_t width = snapshotValueSize(column.m_storage);
+
+		for (size_t row = 0; row != m_rows; ++row)
+		{
+			if (column.m_storage == SNAPSHOT_BOOLEAN)
+			{
+				file.write(static_cast<char>(column.m_values[row]));
+			}
+			else if (column.m_storage == SNAPSHOT_STRING)
+			{
+				const uint32 index = static_cast<uint32>(column.m_values[row]);
+
+				file.write(reinterpret_cast<const char*>(&index), sizeof(index));
+			}
+			else
+			{
+				file.write(reinterpret_cast<const char*>(&column.m_values[row]), sizeof(uint64));
+			}
+		}
+
+		written = layout.m_valuesOffset + (rows * width);
+	}
+
+	writePadding(file, written, header.m_stringTableOffset);
+
+	if (!strings.empty())
+		file.write(reinterpret_cast<const char*>(&strings[0]), strings.size() * sizeof(SnapshotString));
+
+	for (StringTable::const_iterator it = m_strings.begin(); it != m_strings.end(); ++it)
+		file.write(reinterpret_cast<const char*>((*it)->c_str()), ((*it)->length() + 1) * sizeof(wchar_t));
+
+	file.close();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Create the columns from the first object.
+
+void SnapshotWriter::createColumns(IWbemClassObjectPtr object)
+{
+	ASSERT(m_columns.empty());
+
+	Columns names = m_names;
+	bool    inferred = false;
+
+	if (names.empty())
+	{
+		Object::PropertyNames properties;
+
+		Object(object, Connection()).getPropertyNames(properties);
+
+		names.assign(properties.begin(), properties.end());
+		inferred = true;
+	}
+
+	WCL::Variant keys;
+
+	HRESULT result = object->GetNames(nullptr, WBEM_FLAG_KEYS_ONLY, nullptr, &V_ARRAY(&keys));
+
+	if (SUCCEEDED(result))
+		V_VT(&keys) = VT_ARRAY | VT_BSTR;
+
+	for (Columns::const_iterator it = names.begin(); it != names.end(); ++it)
+	{
+		CIMTYPE type = CIM_EMPTY;
+
+		result = object->Get(it->c_str(), 0, nullptr, &type, nullptr);
+
+		if (FAILED(result))
+		{
+			const tstring message = Core::fmt(TXT("Failed to retrieve the type of the property '%s' for the snapshot"), it->c_str());
+			throw Exception(result, object, message.c_str());
+		}
+
+		const uint32 storage = storageFromType(type);
+
+		if (storage == 0)
+		{
+			if (inferred)
+				continue;
+
+			const tstring message = Core::fmt(TXT("The type of the property '%s' cannot be stored in a snapshot"), it->c_str());
+			throw Exception(WBEM_E_TYPE_MISMATCH, message.c_str());
+		}
+
+		Column column;
+
+		column.m_name    = *it;
+		column.m_type    = type;
+		column.m_storage = storage;
+		column.m_isKey   = false;
+
+		if (V_VT(&keys) == (VT_ARRAY | VT_BSTR))
+		{
+			BSTR* keyNames = nullptr;
+			LONG  lower = 0, upper = -1;
+
+			::SafeArrayGetLBound(V_ARRAY(&keys), 1, &lower);
+			::SafeArrayGetUBound(V_ARRAY(&keys), 1, &upper);
+
+			if (SUCCEEDED(::SafeArrayAccessData(V_ARRAY(&keys), reinterpret_cast<void**>(&keyNames))))
+			{
+				for (LONG i = 0; (i <= (upper - lower)) && !column.m_isKey; ++i)
+					column.m_isKey = (_wcsicmp(keyNames[i], it->c_str()) == 0);
+
+				::SafeArrayUnaccessData(V_ARRAY(&keys));
+			}
+		}
+
+		addString(it->c_str(), it->length());
+
+		m_columns.push_back(column);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Add a string to the string table, if not already present, and return its
+//! index.
+
+uint32 SnapshotWriter::addString(const wchar_t* text, size_t length)
+{
+	const std::wstring value(text, length);
+
+	StringIndex::const_iterator it = m_index.find(value);
+
+	if (it != m_index.end())
+		return it->second;
+
+	const uint32 index = static_cast<uint32>(m_strings.size());
+
+	it = m_index.insert(std::make_pair(value, index)).first;
+	m_strings.push_back(&it->first);
+
+	return index;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Convert a property value to the column's storage format. The unsigned
+//! 16 and 32-bit values are passed by WMI in signed VARIANT types, and the
+//! 64-bit values as strings.
+
+uint64 SnapshotWriter::convertValue(const Column& column, const VARIANT& value)
+{
+	if (column.m_storage == SNAPSHOT_STRING)
+	{
+		if (V_VT(&value) == VT_BSTR)
+			return addString(V_BSTR(&value), ::SysStringLen(V_BSTR(&value)));
+
+		WCL::Variant string;
+
+		HRESULT result = ::VariantChangeType(&string, const_cast<VARIANT*>(&value), 0, VT_BSTR);
+
+		if (FAILED(result))
+		{
+			const tstring message = Core::fmt(TXT("Failed to convert the property '%s' for the snapshot"), column.m_name.c_str());
+			throw Exception(result, message.c_str());
+		}
+
+		return addString(V_BSTR(&string), ::SysStringLen(V_BSTR(&string)));
+	}
+
+	if (column.m_storage == SNAPSHOT_UNSIGNED)
+	{
+		if (V_VT(&value) == VT_I4)
+			return static_cast<uint32>(V_I4(&value));
+
+		if (V_VT(&value) == VT_I2)
+			return static_cast<uint16>(V_I2(&value));
+	}
+
+	VARTYPE type = VT_EMPTY;
+
+	switch (column.m_storage)
+	{
+		case SNAPSHOT_SIGNED:	type = VT_I8;	break;
+		case SNAPSHOT_UNSIGNED:	type = VT_UI8;	break;
+		case SNAPSHOT_REAL:		type = VT_R8;	break;
+		case SNAPSHOT_BOOLEAN:	type = VT_BOOL;	break;
+		default:				ASSERT_FALSE();	break;
+	}
+
+	WCL::Variant converted;
+
+	HRESULT result = ::VariantChangeType(&converted, const_cast<VARIANT*>(&value), 0, type);
+
+	if (FAILED(result))
+	{
+		const tstring message = Core::fmt(TXT("Failed to convert the property '%s' for the snapshot"), column.m_name.c_str());
+		throw Exception(result, message.c_str());
+	}
+
+	uint64 bits = 0;
+
+	switch (column.m_storage)
+	{
+		case SNAPSHOT_SIGNED:	bits = static_cast<uint64>(V_I8(&converted));					break;
+		case SNAPSHOT_UNSIGNED:	bits = V_UI8(&converted);										break;
+		case SNAPSHOT_REAL:		memcpy(&bits, &V_R8(&converted), sizeof(bits));					break;
+		case SNAPSHOT_BOOLEAN:	bits = (V_BOOL(&converted) != VARIANT_FALSE) ? 1 : 0;			break;
+		default:				ASSERT_FALSE();													break;
+	}
+
+	return bits;
+}
+
+//namespace WMI
+}
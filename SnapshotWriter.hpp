@@ -0,0 +1,148 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   SnapshotWriter.hpp
+//! \brief  The SnapshotWriter class declaration.
+//! \author Chris Oldwood
+
+// Check for previous inclusion
+#ifndef WMI_SNAPSHOTWRITER_HPP
+#define WMI_SNAPSHOTWRITER_HPP
+
+#if _MSC_VER > 1000
+#pragma once
+#endif
+
+#include "Object.hpp"
+#include <Core/NotCopyable.hpp>
+#include <vector>
+#include <map>
+
+namespace WMI
+{
+
+////////////////////////////////////////////////////////////////////////////////
+//! Builds a binary snapshot of a set of objects of the same WMI class that can
+//! later be loaded with the SnapshotReader. The values are accumulated in
+//! memory column by column and written to the file when saved.
+//!
+//! The columns are either supplied by the caller or taken from the non-system
+//! properties of the first object, in which case any array or embedded object
+//! properties are skipped as only scalar values are supported.
+
+class SnapshotWriter : private Core::NotCopyable
+{
+public:
+	//! The ordered collection of property names to capture.
+	typedef std::vector<tstring> Columns;
+
+public:
+	//! Construction with the columns taken from the first object.
+	explicit SnapshotWriter(const tstring& className);
+
+	//! Construction with an explicit set of columns.
+	SnapshotWriter(const tstring& className, const Columns& columns);
+
+	//! Destructor.
+	~SnapshotWriter();
+
+	//
+	// Properties.
+	//
+
+	//! Get the WMI class name.
+	const tstring& className() const;
+
+	//! Get the number of rows added so far.
+	size_t rowCount() const;
+
+	//
+	// Methods.
+	//
+
+	//! Add a single object.
+	void addRow(const Object& object); // throw(WMI::Exception)
+
+	//! Add all the objects in the range [first, last).
+	template<typename Iterator>
+	size_t addRows(Iterator first, Iterator last); // throw(WMI::Exception)
+
+	//! Write the snapshot to a file.
+	void save(const tstring& path) const; // throw(WMI::Exception)
+
+private:
+	//! The values for a single property.
+	struct Column
+	{
+		tstring				m_name;		//!< The property name.
+		CIMTYPE				m_type;		//!< The CIM type.
+		uint32				m_storage;	//!< How the values are stored.
+		bool				m_isKey;	//!< Is the property a key?
+		std::vector<uint64>	m_values;	//!< The values, as raw bits.
+		std::vector<uint8>	m_nulls;	//!< The null bitmap.
+	};
+
+	//! The column collection type.
+	typedef std::vector<Column> ColumnList;
+	//! The string to index map type.
+	typedef std::map<std::wstring, uint32> StringIndex;
+	//! The string table type.
+	typedef std::vector<const std::wstring*> StringTable;
+
+	//
+	// Members.
+	//
+	tstring		m_className;	//!< The WMI class name.
+	Columns		m_names;		//!< The requested column names.
+	ColumnList	m_columns;		//!< The column values.
+	size_t		m_rows;			//!< The number of rows added.
+	StringIndex	m_index;		//!< The string table lookup.
+	StringTable	m_strings;		//!< The string table in index order.
+
+	//
+	// Internal methods.
+	//
+
+	//! Create the columns from the first object.
+	void createColumns(IWbemClassObjectPtr object);
+
+	//! Add a string to the string table.
+	uint32 addString(const wchar_t* text, size_t length);
+
+	//! Convert a property value to the column's storage format.
+	uint64 convertValue(const Column& column, const VARIANT& value);
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the WMI class name.
+
+inline const tstring& SnapshotWriter::className() const
+{
+	return m_className;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the number of rows added so far.
+
+inline size_t SnapshotWriter::rowCount() const
+{
+	return m_rows;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Add all the objects in the range [first, last). The range can be a query's
+//! ObjectIterator or a materialised collection of objects.
+
+template<typename Iterator>
+inline size_t SnapshotWriter::addRows(Iterator first, Iterator last)
+{
+	size_t count = 0;
+
+	for (; first != last; ++first, ++count)
+		addRow(*first);
+
+	return count;
+}
+
+//namespace WMI
+}
+
+#endif // WMI_SNAPSHOTWRITER_HPP
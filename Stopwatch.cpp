@@ -0,0 +1,122 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   Stopwatch.cpp
+//! \brief  The Stopwatch class definition.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include "Stopwatch.hpp"
+
+namespace WMI
+{
+
+//! The period, in microseconds, below which a wait spins rather than sleeps.
+static const uint64 SPIN_THRESHOLD = 2000;
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the performance counter frequency, which is fixed at boot.
+
+static int64 frequency()
+{
+	static int64 s_frequency = 0;
+
+	if (s_frequency == 0)
+	{
+		LARGE_INTEGER value;
+
+		::QueryPerformanceFrequency(&value);
+
+		s_frequency = value.QuadPart;
+	}
+
+	return s_frequency;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Constructor. The stopwatch is started on construction.
+
+Stopwatch::Stopwatch()
+	: m_start()
+{
+	::QueryPerformanceCounter(&m_start);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the number of seconds elapsed since the stopwatch was started.
+
+double Stopwatch::elapsed() const
+{
+	return static_cast<double>(elapsedTicks()) / static_cast<double>(frequency());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the number of microseconds elapsed since the stopwatch was started.
+
+uint64 Stopwatch::elapsedMicroseconds() const
+{
+	return ticksToMicroseconds(elapsedTicks());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Block the calling thread for a period of time. The scheduler's granularity
+//! is too coarse for short periods so the final part of the wait spins.
+
+void Stopwatch::wait(uint64 microseconds)
+{
+	if (microseconds == 0)
+		return;
+
+	Stopwatch stopwatch;
+
+	if (microseconds > SPIN_THRESHOLD)
+		::Sleep(static_cast<DWORD>((microseconds - SPIN_THRESHOLD) / 1000));
+
+	while (stopwatch.elapsedMicroseconds() < microseconds)
+		::SwitchToThread();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the current performance counter value. This allows an interval to be
+//! timed without the cost of a Stopwatch when timing is optional.
+
+int64 Stopwatch::ticks()
+{
+	LARGE_INTEGER now;
+
+	::QueryPerformanceCounter(&now);
+
+	return now.QuadPart;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Convert a number of counter ticks to microseconds.
+
+uint64 Stopwatch::ticksToMicroseconds(int64 ticks)
+{
+	const int64 freq = frequency();
+
+	// Split the conversion to avoid overflowing on long intervals.
+	return static_cast<uint64>(((ticks / freq) * 1000000) + (((ticks % freq) * 1000000) / freq));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Convert a number of microseconds to counter ticks.
+
+int64 Stopwatch::microsecondsToTicks(uint64 microseconds)
+{
+	const int64 freq = frequency();
+	const int64 value = static_cast<int64>(microseconds);
+
+	// Split the conversion to avoid overflowing on long intervals.
+	return ((value / 1000000) * freq) + (((value % 1000000) * freq) / 1000000);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the number of counter ticks elapsed since the stopwatch was started.
+
+int64 Stopwatch::elapsedTicks() const
+{
+	return ticks() - m_start.QuadPart;
+}
+
+//namespace WMI
+}
@@ -0,0 +1,76 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   Stopwatch.hpp
+//! \brief  The Stopwatch class declaration.
+//! \author Chris Oldwood
+
+// Check for previous inclusion
+#ifndef WMI_STOPWATCH_HPP
+#define WMI_STOPWATCH_HPP
+
+#if _MSC_VER > 1000
+#pragma once
+#endif
+
+namespace WMI
+{
+
+////////////////////////////////////////////////////////////////////////////////
+//! A high resolution timer based on the performance counter.
+
+class Stopwatch
+{
+public:
+	//! Constructor. The stopwatch is started on construction.
+	Stopwatch();
+
+	//
+	// Properties.
+	//
+
+	//! Get the number of seconds elapsed since the stopwatch was started.
+	double elapsed() const;
+
+	//! Get the number of microseconds elapsed since the stopwatch was started.
+	uint64 elapsedMicroseconds() const;
+
+	//
+	// Methods.
+	//
+
+	//! Restart the stopwatch.
+	void restart();
+
+	//! Block the calling thread for a period of time.
+	static void wait(uint64 microseconds);
+
+	//! Get the current performance counter value.
+	static int64 ticks();
+
+	//! Convert a number of counter ticks to microseconds.
+	static uint64 ticksToMicroseconds(int64 ticks);
+
+	//! Convert a number of microseconds to counter ticks.
+	static int64 microsecondsToTicks(uint64 microseconds);
+
+private:
+	//
+	// Members.
+	//
+	LARGE_INTEGER	m_start;		//!< The counter value when started.
+
+	//! Get the number of counter ticks elapsed since the stopwatch was started.
+	int64 elapsedTicks() const;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//! Restart the stopwatch.
+
+inline void Stopwatch::restart()
+{
+	::QueryPerformanceCounter(&m_start);
+}
+
+//namespace WMI
+}
+
+#endif // WMI_STOPWATCH_HPP
@@ -0,0 +1,147 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   AssociationWalkerTests.cpp
+//! \brief  The unit tests for the AssociationWalker class.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include <Core/UnitTest.hpp>
+#include <WMI/AssociationWalker.hpp>
+#include <WMI/Connection.hpp>
+#include <WMI/Object.hpp>
+#include <WMI/MemoryObject.hpp>
+#include <WMI/ReplayServices.hpp>
+
+////////////////////////////////////////////////////////////////////////////////
+//! Create a service object with just its key.
+
+static WMI::IWbemClassObjectPtr createService(const tchar* name)
+{
+	WMI::MemoryObject*       object = new WMI::MemoryObject(TXT("Win32_Service"));
+	WMI::IWbemClassObjectPtr instance = object->getInterface();
+
+	object->setProperty(TXT("Name"), name, CIM_STRING, true);
+
+	return instance;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Record the services that depend on a service.
+
+static void addDependents(WMI::RecordingPtr recording, const tchar* name, const tchar* dependents)
+{
+	const tstring path = Core::fmt(TXT("Win32_Service.Name=\"%s\""), name);
+	const tstring text = WMI::Object::formatAssociatorsQuery(path, TXT("Win32_DependentService"), TXT(""), TXT("Antecedent"));
+	const size_t  query = recording->addCall(WMI::Recording::EXEC_QUERY, text, TXT(""), WBEM_S_NO_ERROR, 0);
+
+	for (const tchar* it = dependents; *it != TXT('\0'); ++it)
+	{
+		const tchar dependent[] = { *it, TXT('\0') };
+
+		recording->addObject(query, createService(dependent), 0);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Create a provider for the services A -> B, C; B -> C, D; C -> D, A; D.
+
+static WMI::IWbemServicesPtr createProvider()
+{
+	WMI::RecordingPtr recording(new WMI::Recording);
+
+	addDependents(recording, TXT("A"), TXT("BC"));
+	addDependents(recording, TXT("B"), TXT("CD"));
+	addDependents(recording, TXT("C"), TXT("DA"));
+	addDependents(recording, TXT("D"), TXT(""));
+
+	return (new WMI::ReplayServices(recording, false))->getInterface();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the names of the services.
+
+static tstring names(const WMI::AssociationWalker::Objects& services, const WMI::Connection& connection)
+{
+	tstring result;
+
+	for (WMI::AssociationWalker::Objects::const_iterator it = services.begin(); it != services.end(); ++it)
+		result += WMI::Object(*it, connection).getProperty<tstring>(TXT("Name"));
+
+	return result;
+}
+
+TEST_SET(AssociationWalker)
+{
+
+TEST_CASE("the targets shared by a set of sources are only returned once")
+{
+	WMI::Connection connection;
+
+	connection.open(createProvider());
+
+	WMI::AssociationWalker          walker(TXT("Win32_DependentService"), TXT(""), TXT("Antecedent"), 2);
+	WMI::AssociationWalker::Objects sources, targets;
+
+	sources.push_back(createService(TXT("A")));
+	sources.push_back(createService(TXT("B")));
+
+	TEST_TRUE(walker.associators(connection, sources, targets) == 3);
+	TEST_TRUE(names(targets, connection) == TXT("BCD"));
+	TEST_TRUE(walker.queries() == 2);
+	TEST_TRUE(walker.duplicates() == 1);
+}
+TEST_CASE_END
+
+TEST_CASE("a walk queries each object once, a level at a time, and ends on a cycle")
+{
+	WMI::Connection connection;
+
+	connection.open(createProvider());
+
+	WMI::AssociationWalker          walker(TXT("Win32_DependentService"), TXT(""), TXT("Antecedent"), 4);
+	WMI::AssociationWalker::Objects sources, reached;
+
+	sources.push_back(createService(TXT("A")));
+
+	TEST_TRUE(walker.walk(connection, sources, reached) == 3);
+	TEST_TRUE(names(reached, connection) == TXT("BCD"));
+	TEST_TRUE(walker.queries() == 4);
+	TEST_TRUE(walker.duplicates() == 3);
+
+	TEST_TRUE(walker.walk(connection, sources, reached, 1) == 2);
+	TEST_TRUE(names(reached, connection) == TXT("BC"));
+	TEST_TRUE(walker.queries() == 1);
+}
+TEST_CASE_END
+
+TEST_CASE("a source whose query fails is recorded and the walk carries on without it")
+{
+	WMI::RecordingPtr recording(new WMI::Recording);
+
+	addDependents(recording, TXT("A"), TXT("BC"));
+	addDependents(recording, TXT("C"), TXT("D"));
+	addDependents(recording, TXT("D"), TXT(""));
+
+	const tstring path = TXT("Win32_Service.Name=\"B\"");
+	const tstring text = WMI::Object::formatAssociatorsQuery(path, TXT("Win32_DependentService"), TXT(""), TXT("Antecedent"));
+
+	recording->addCall(WMI::Recording::EXEC_QUERY, text, TXT(""), WBEM_E_ACCESS_DENIED, 0);
+
+	WMI::Connection connection;
+
+	connection.open((new WMI::ReplayServices(recording, false))->getInterface());
+
+	WMI::AssociationWalker          walker(TXT("Win32_DependentService"), TXT(""), TXT("Antecedent"), 2);
+	WMI::AssociationWalker::Objects sources, reached;
+
+	sources.push_back(createService(TXT("A")));
+
+	TEST_TRUE(walker.walk(connection, sources, reached) == 3);
+	TEST_TRUE(names(reached, connection) == TXT("BCD"));
+	TEST_TRUE(walker.failures().size() == 1);
+	TEST_TRUE(walker.failures()[0].m_path == path);
+	TEST_TRUE(walker.failures()[0].m_result == WBEM_E_ACCESS_DENIED);
+}
+TEST_CASE_END
+
+}
+TEST_SET_END
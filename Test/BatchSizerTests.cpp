@@ -0,0 +1,101 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   BatchSizerTests.cpp
+//! \brief  The unit tests for the BatchSizer class.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include <Core/UnitTest.hpp>
+#include <WMI/BatchSizer.hpp>
+#include <math.h>
+
+////////////////////////////////////////////////////////////////////////////////
+//! Record calls to a host with a fixed round trip and cost per object.
+
+static void recordCalls(WMI::BatchSizer& sizer, size_t calls, uint64 roundTrip, uint64 objectCost)
+{
+	for (size_t i = 0; i != calls; ++i)
+		sizer.record(sizer.size(), roundTrip + (sizer.size() * objectCost));
+}
+
+TEST_SET(BatchSizer)
+{
+
+TEST_CASE("the first batch is the initial size limited by the maximum")
+{
+	WMI::BatchSizer sizer;
+	WMI::BatchSizer small(4);
+
+	TEST_TRUE(sizer.size() == WMI::BatchSizer::INITIAL_SIZE);
+	TEST_TRUE(small.size() == 4);
+}
+TEST_CASE_END
+
+TEST_CASE("the size doubles until the latency and cost can be estimated")
+{
+	WMI::BatchSizer sizer;
+
+	sizer.record(WMI::BatchSizer::INITIAL_SIZE, 1000);
+
+	TEST_TRUE(sizer.size() == WMI::BatchSizer::INITIAL_SIZE * 2);
+	TEST_TRUE(sizer.callLatency() == 0.0);
+}
+TEST_CASE_END
+
+TEST_CASE("the latency and cost are estimated from calls of different sizes")
+{
+	WMI::BatchSizer sizer;
+
+	sizer.record(8, 1000 + (8 * 100));
+	sizer.record(16, 1000 + (16 * 100));
+
+	TEST_TRUE(fabs(sizer.callLatency() - 1000.0) < 0.001);
+	TEST_TRUE(fabs(sizer.objectCost() - 100.0) < 0.001);
+}
+TEST_CASE_END
+
+TEST_CASE("a host where the round trip dominates converges on the maximum size")
+{
+	WMI::BatchSizer sizer(500);
+
+	recordCalls(sizer, 20, 50000, 100);
+
+	TEST_TRUE(sizer.size() == 500);
+}
+TEST_CASE_END
+
+TEST_CASE("a host where the object cost dominates converges on small batches")
+{
+	WMI::BatchSizer sizer;
+
+	recordCalls(sizer, 20, 200, 100);
+
+	TEST_TRUE(sizer.size() == 18);
+}
+TEST_CASE_END
+
+TEST_CASE("the size tracks a change in the round trip")
+{
+	WMI::BatchSizer sizer;
+
+	recordCalls(sizer, 20, 1000, 100);
+
+	TEST_TRUE(sizer.size() == 90);
+
+	recordCalls(sizer, 20, 200, 100);
+
+	TEST_TRUE(sizer.size() < 90);
+}
+TEST_CASE_END
+
+TEST_CASE("calls that return no objects are ignored")
+{
+	WMI::BatchSizer sizer;
+
+	sizer.record(0, 1000000);
+
+	TEST_TRUE(sizer.size() == WMI::BatchSizer::INITIAL_SIZE);
+}
+TEST_CASE_END
+
+}
+TEST_SET_END
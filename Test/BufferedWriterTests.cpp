@@ -0,0 +1,91 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   BufferedWriterTests.cpp
+//! \brief  The unit tests for the BufferedWriter class.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include <Core/UnitTest.hpp>
+#include "StringWriter.hpp"
+
+TEST_SET(BufferedWriter)
+{
+
+TEST_CASE("output is only handed on when the writer is flushed")
+{
+	StringWriter writer;
+
+	writer.write("abc");
+
+	TEST_TRUE(writer.output().empty());
+	TEST_TRUE(writer.bytesWritten() == 0);
+
+	writer.flush();
+
+	TEST_TRUE(writer.output() == "abc");
+	TEST_TRUE(writer.bytesWritten() == 3);
+}
+TEST_CASE_END
+
+TEST_CASE("output is handed on in whole blocks when the buffer fills")
+{
+	StringWriter writer(16);
+
+	for (size_t i = 0; i != 10; ++i)
+		writer.write("0123");
+
+	TEST_TRUE(writer.blocks() == 2);
+	TEST_TRUE(writer.output().length() == 32);
+
+	writer.flush();
+
+	TEST_TRUE(writer.output().length() == 40);
+}
+TEST_CASE_END
+
+TEST_CASE("a block larger than the buffer is written directly")
+{
+	StringWriter      writer(16);
+	const std::string block(100, 'x');
+
+	writer.write('a');
+	writer.write(block.data(), block.length());
+
+	TEST_TRUE(writer.output() == "a" + block);
+	TEST_TRUE(writer.blocks() == 2);
+}
+TEST_CASE_END
+
+TEST_CASE("the buffer size is never smaller than the minimum")
+{
+	StringWriter writer(1);
+
+	TEST_TRUE(writer.bufferSize() == WMI::BufferedWriter::MIN_BUFFER_SIZE);
+}
+TEST_CASE_END
+
+TEST_CASE("wide characters are encoded as UTF-8")
+{
+	StringWriter  writer;
+	const wchar_t text[] = { L'A', 0x00E9, 0x20AC, 0xD83D, 0xDE00 };
+
+	writer.write(text, ARRAY_SIZE(text));
+	writer.flush();
+
+	TEST_TRUE(writer.output() == "A\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80");
+}
+TEST_CASE_END
+
+TEST_CASE("an unpaired surrogate is encoded as the replacement character")
+{
+	StringWriter  writer;
+	const wchar_t text[] = { 0xD83D, L'A' };
+
+	writer.write(text, ARRAY_SIZE(text));
+	writer.flush();
+
+	TEST_TRUE(writer.output() == "\xEF\xBF\xBD" "A");
+}
+TEST_CASE_END
+
+}
+TEST_SET_END
@@ -0,0 +1,145 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   ConnectionStatsTests.cpp
+//! \brief  The unit tests for the ConnectionStats class.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include <Core/UnitTest.hpp>
+#include <WMI/ConnectionStats.hpp>
+#include <WMI/Connection.hpp>
+#include <WMI/ObjectIterator.hpp>
+#include <WMI/Recording.hpp>
+#include <WMI/ReplayServices.hpp>
+#include <WMI/MemoryObject.hpp>
+
+TEST_SET(ConnectionStats)
+{
+
+TEST_CASE("latencies map to log-linear buckets")
+{
+	TEST_TRUE(WMI::ConnectionStats::bucketIndex(0) == 0);
+	TEST_TRUE(WMI::ConnectionStats::bucketIndex(3) == 3);
+	TEST_TRUE(WMI::ConnectionStats::bucketIndex(4) == 4);
+	TEST_TRUE(WMI::ConnectionStats::bucketIndex(7) == 7);
+	TEST_TRUE(WMI::ConnectionStats::bucketIndex(8) == 8);
+	TEST_TRUE(WMI::ConnectionStats::bucketIndex(9) == 8);
+	TEST_TRUE(WMI::ConnectionStats::bucketIndex(10) == 9);
+	TEST_TRUE(WMI::ConnectionStats::bucketIndex(static_cast<uint64>(-1)) == WMI::ConnectionStats::BUCKET_COUNT-1);
+
+	for (size_t i = 0; i != WMI::ConnectionStats::BUCKET_COUNT; ++i)
+	{
+		TEST_TRUE(WMI::ConnectionStats::bucketIndex(WMI::ConnectionStats::bucketLowerBound(i)) == i);
+		TEST_TRUE(WMI::ConnectionStats::bucketIndex(WMI::ConnectionStats::bucketUpperBound(i)) == i);
+	}
+}
+TEST_CASE_END
+
+TEST_CASE("recorded calls are reflected in a snapshot")
+{
+	WMI::ConnectionStats           stats;
+	WMI::ConnectionStats::Snapshot snapshot;
+
+	stats.record(WMI::ConnectionStats::EXEC_QUERY, 100);
+	stats.record(WMI::ConnectionStats::EXEC_QUERY, 300, 64);
+	stats.snapshot(snapshot);
+
+	const WMI::ConnectionStats::OperationStats& query = snapshot.m_operations[WMI::ConnectionStats::EXEC_QUERY];
+
+	TEST_TRUE(query.m_count == 2);
+	TEST_TRUE(query.m_totalMicroseconds == 400);
+	TEST_TRUE(query.m_maxMicroseconds == 300);
+	TEST_TRUE(query.m_bytes == 64);
+	TEST_TRUE(WMI::ConnectionStats::mean(query) == 200.0);
+	TEST_TRUE(snapshot.m_operations[WMI::ConnectionStats::EXEC_METHOD].m_count == 0);
+}
+TEST_CASE_END
+
+TEST_CASE("the objects returned by calls give the mean batch size")
+{
+	WMI::ConnectionStats           stats;
+	WMI::ConnectionStats::Snapshot snapshot;
+
+	stats.record(WMI::ConnectionStats::ENUM_NEXT, 100, 0, 10);
+	stats.record(WMI::ConnectionStats::ENUM_NEXT, 100, 0, 30);
+	stats.snapshot(snapshot);
+
+	const WMI::ConnectionStats::OperationStats& next = snapshot.m_operations[WMI::ConnectionStats::ENUM_NEXT];
+
+	TEST_TRUE(next.m_objects == 40);
+	TEST_TRUE(WMI::ConnectionStats::meanObjects(next) == 20.0);
+}
+TEST_CASE_END
+
+TEST_CASE("a percentile is bounded by the bucket and the maximum latency")
+{
+	WMI::ConnectionStats           stats;
+	WMI::ConnectionStats::Snapshot snapshot;
+
+	for (uint64 i = 0; i != 99; ++i)
+		stats.record(WMI::ConnectionStats::ENUM_NEXT, 10);
+
+	stats.record(WMI::ConnectionStats::ENUM_NEXT, 1000);
+	stats.snapshot(snapshot);
+
+	const WMI::ConnectionStats::OperationStats& next = snapshot.m_operations[WMI::ConnectionStats::ENUM_NEXT];
+
+	TEST_TRUE(WMI::ConnectionStats::percentile(next, 50.0) == WMI::ConnectionStats::bucketUpperBound(WMI::ConnectionStats::bucketIndex(10)));
+	TEST_TRUE(WMI::ConnectionStats::percentile(next, 100.0) == 1000);
+}
+TEST_CASE_END
+
+TEST_CASE("a snapshot can reset the statistics")
+{
+	WMI::ConnectionStats           stats;
+	WMI::ConnectionStats::Snapshot snapshot;
+
+	stats.record(WMI::ConnectionStats::GET_OBJECT, 50);
+	stats.snapshotAndReset(snapshot);
+
+	TEST_TRUE(snapshot.m_operations[WMI::ConnectionStats::GET_OBJECT].m_count == 1);
+
+	stats.snapshot(snapshot);
+
+	TEST_TRUE(snapshot.m_operations[WMI::ConnectionStats::GET_OBJECT].m_count == 0);
+	TEST_TRUE(snapshot.m_operations[WMI::ConnectionStats::GET_OBJECT].m_maxMicroseconds == 0);
+}
+TEST_CASE_END
+
+TEST_CASE("a connection records its calls when statistics are enabled")
+{
+	WMI::MemoryObject*       object = new WMI::MemoryObject(TXT("Test_Class"));
+	WMI::IWbemClassObjectPtr instance = object->getInterface();
+
+	object->setProperty(TXT("Id"), 1, CIM_SINT32, true);
+	object->setProperty(TXT("Name"), TXT("one"));
+
+	WMI::RecordingPtr recording(new WMI::Recording);
+	const size_t      call = recording->addCall(WMI::Recording::EXEC_QUERY, TXT("SELECT * FROM Test_Class"), TXT(""), WBEM_S_NO_ERROR, 0);
+
+	recording->addObject(call, instance, 0);
+
+	WMI::ConnectionStatsPtr stats(new WMI::ConnectionStats);
+	WMI::Connection         connection;
+
+	connection.setStats(stats);
+	connection.open((new WMI::ReplayServices(recording, false))->getInterface());
+
+	WMI::ObjectIterator it = connection.execQuery(TXT("SELECT * FROM Test_Class"));
+	WMI::ObjectIterator end;
+
+	for (; it != end; ++it)
+		TEST_TRUE(it->getProperty<tstring>(TXT("Name")) == TXT("one"));
+
+	WMI::ConnectionStats::Snapshot snapshot;
+
+	stats->snapshot(snapshot);
+
+	TEST_TRUE(snapshot.m_operations[WMI::ConnectionStats::EXEC_QUERY].m_count == 1);
+	TEST_TRUE(snapshot.m_operations[WMI::ConnectionStats::ENUM_NEXT].m_count == 2);
+	TEST_TRUE(snapshot.m_operations[WMI::ConnectionStats::GET_PROPERTY].m_count == 1);
+	TEST_TRUE(snapshot.m_operations[WMI::ConnectionStats::GET_PROPERTY].m_bytes == 6);
+}
+TEST_CASE_END
+
+}
+TEST_SET_END
@@ -7,6 +7,8 @@
 #include <Core/UnitTest.hpp>
 #include <WMI/Connection.hpp>
 #include <WMI/ObjectIterator.hpp>
+#include <WMI/SharedLocator.hpp>
+#include <WMI/Object.hpp>
 
 TEST_SET(Connection)
 {
@@ -67,5 +69,94 @@ TEST_CASE("an object can be queried using it's path")
 }
 TEST_CASE_END
 
+TEST_CASE("trying to get an object that does not exist returns the error")
+{
+	WMI::Connection connection;
+	connection.open();
+
+	const WMI::Result<WMI::Object> object = connection.tryGetObject(TXT("Win32_Process.Handle=\"0xFFFFFFFF\""));
+
+	TEST_TRUE(object.failed());
+	TEST_TRUE(object.result() == WBEM_E_NOT_FOUND);
+}
+TEST_CASE_END
+
+TEST_CASE("trying to execute an invalid query returns the error")
+{
+	WMI::Connection connection;
+	connection.open();
+
+	const WMI::Result<WMI::ObjectIterator> it = connection.tryExecQuery(TXT("SELECT * FROM Win32_InvalidClassName"));
+
+	TEST_TRUE(it.failed());
+	TEST_TRUE(it.result() == WBEM_E_INVALID_CLASS);
+}
+TEST_CASE_END
+
+TEST_CASE("connections opened on the same thread share the locator")
+{
+	WMI::Connection connection;
+	connection.open();
+
+	TEST_TRUE(WMI::SharedLocator::isCreated());
+
+	const WMI::IWbemLocatorPtr first = WMI::SharedLocator::get();
+	const WMI::IWbemLocatorPtr second = WMI::SharedLocator::get();
+
+	TEST_TRUE(first.get() == second.get());
+}
+TEST_CASE_END
+
+TEST_CASE("the security blanket is applied to the connection and the query enumerators")
+{
+	const WMI::SecurityBlanket blanket(RPC_C_AUTHN_LEVEL_PKT_PRIVACY, RPC_C_IMP_LEVEL_IMPERSONATE);
+
+	WMI::Connection		connection;
+	WMI::ObjectIterator	end;
+
+	connection.setSecurityBlanket(blanket);
+	connection.open();
+
+	TEST_TRUE(connection.securityBlanket().authnLevel() == RPC_C_AUTHN_LEVEL_PKT_PRIVACY);
+
+	WMI::ObjectIterator it = connection.execQuery(TXT("SELECT * FROM Win32_OperatingSystem"));
+
+	TEST_TRUE(it != end);
+}
+TEST_CASE_END
+
+TEST_CASE("closing a connection does not close the objects created from it")
+{
+	WMI::Connection connection;
+	connection.open();
+
+	WMI::ObjectIterator it = connection.execQuery(TXT("SELECT * FROM Win32_OperatingSystem"));
+	const WMI::Object   object = *it;
+
+	connection.close();
+
+	TEST_FALSE(connection.isOpen());
+	TEST_TRUE(object.connection().isOpen());
+	TEST_TRUE(object.connection().get().get() != nullptr);
+}
+TEST_CASE_END
+
+TEST_CASE("changing a setting on a copy of a connection does not change the original")
+{
+	WMI::Connection connection;
+	connection.open();
+
+	WMI::Connection copy = connection;
+
+	TEST_TRUE(copy.get().get() == connection.get().get());
+
+	copy.setStats(WMI::ConnectionStatsPtr(new WMI::ConnectionStats));
+
+	TEST_TRUE(copy.stats().get() != nullptr);
+	TEST_TRUE(connection.stats().get() == nullptr);
+	TEST_TRUE(copy.isOpen());
+}
+TEST_CASE_END
+
 }
 TEST_SET_END
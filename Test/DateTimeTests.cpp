@@ -82,5 +82,19 @@ TEST_CASE("parseDateTime should throw when passed a malformed datetime")
 }
 TEST_CASE_END
 
+TEST_CASE("tryParseFileTime should keep the microseconds and fail when input invalid")
+{
+	uint64 earlier = 0, later = 0;
+
+	TEST_TRUE(WMI::tryParseFileTime(TXT("20010203040506.123456+060"), earlier));
+	TEST_TRUE(WMI::tryParseFileTime(TXT("20010203040506.123457+060"), later));
+	TEST_TRUE(later - earlier == 10);
+	TEST_TRUE(earlier % 10000000 == 1234560);
+
+	TEST_FALSE(WMI::tryParseFileTime(TXT("20010203040506#123456+060"), earlier));
+	TEST_FALSE(WMI::tryParseFileTime(TXT("2001020304"), earlier));
+}
+TEST_CASE_END
+
 }
 TEST_SET_END
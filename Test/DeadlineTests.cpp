@@ -0,0 +1,184 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   DeadlineTests.cpp
+//! \brief  The unit tests for the Deadline and CancellationToken classes.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include <Core/UnitTest.hpp>
+#include <WMI/Deadline.hpp>
+#include <WMI/CancellationToken.hpp>
+#include <WMI/Connection.hpp>
+#include <WMI/ObjectIterator.hpp>
+#include <WMI/MemoryObject.hpp>
+#include <WMI/ReplayServices.hpp>
+#include <WMI/Stopwatch.hpp>
+#include <WMI/Exception.hpp>
+#include <process.h>
+
+//! The query served by the stalled provider.
+static const tchar* QUERY = TXT("SELECT * FROM Test_Class");
+
+//! The time, in microseconds, the stalled provider takes to return the second object.
+static const uint32 STALL = 60 * 1000 * 1000;
+
+////////////////////////////////////////////////////////////////////////////////
+//! Create a provider that returns the first object of a query immediately and
+//! then stalls.
+
+static WMI::IWbemServicesPtr createStalledProvider()
+{
+	WMI::RecordingPtr recording(new WMI::Recording);
+
+	const size_t query = recording->addCall(WMI::Recording::EXEC_QUERY, QUERY, TXT(""), WBEM_S_NO_ERROR, 0);
+
+	for (int32 id = 1; id <= 2; ++id)
+	{
+		WMI::MemoryObject*       object = new WMI::MemoryObject(TXT("Test_Class"));
+		WMI::IWbemClassObjectPtr instance = object->getInterface();
+
+		object->setProperty(TXT("Id"), id, CIM_SINT32, true);
+
+		recording->addObject(query, instance, (id == 1) ? 0 : STALL);
+	}
+
+	WMI::ReplayServices* provider = new WMI::ReplayServices(recording, true);
+
+	return provider->getInterface();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! The thread function that cancels a token after a short delay.
+
+static unsigned __stdcall cancelAfterDelay(void* parameter)
+{
+	::Sleep(100);
+
+	static_cast<WMI::CancellationToken*>(parameter)->cancel();
+
+	return 0;
+}
+
+TEST_SET(Deadline)
+{
+
+TEST_CASE("a default deadline never expires")
+{
+	const WMI::Deadline deadline;
+
+	TEST_TRUE(deadline.isInfinite());
+	TEST_FALSE(deadline.hasExpired());
+	TEST_TRUE(deadline.remaining() == static_cast<long>(WBEM_INFINITE));
+}
+TEST_CASE_END
+
+TEST_CASE("a deadline expires after the timeout")
+{
+	const WMI::Deadline deadline = WMI::Deadline::after(50);
+
+	TEST_FALSE(deadline.isInfinite());
+	TEST_FALSE(deadline.hasExpired());
+	TEST_TRUE((deadline.remaining() > 0) && (deadline.remaining() <= 50));
+
+	::Sleep(100);
+
+	TEST_TRUE(deadline.hasExpired());
+	TEST_TRUE(deadline.remaining() == 0);
+}
+TEST_CASE_END
+
+TEST_CASE("a cancellation token is only cancelled on request")
+{
+	WMI::CancellationToken token;
+
+	TEST_FALSE(token.isCancelled());
+
+	token.cancel();
+
+	TEST_TRUE(token.isCancelled());
+}
+TEST_CASE_END
+
+TEST_CASE("enumerating a stalled query fails once the deadline has expired")
+{
+	WMI::Connection connection;
+	connection.open(createStalledProvider());
+
+	WMI::Stopwatch      stopwatch;
+	WMI::ObjectIterator it = connection.execQuery(QUERY, WMI::Deadline::after(200));
+
+	TEST_TRUE(it->getProperty<int32>(TXT("Id")) == 1);
+	TEST_THROWS(++it);
+	TEST_TRUE(stopwatch.elapsed() < 1.0);
+}
+TEST_CASE_END
+
+TEST_CASE("trying to enumerate a stalled query returns a timeout")
+{
+	WMI::Connection connection;
+	connection.open(createStalledProvider());
+
+	const WMI::Result<WMI::ObjectIterator> first = connection.tryExecQuery(QUERY, WMI::Deadline::after(200));
+
+	TEST_TRUE(first.succeeded());
+
+	WMI::ObjectIterator it = first.value();
+
+	HRESULT result = S_OK;
+
+	try
+	{
+		++it;
+	}
+	catch (const WMI::Exception& e)
+	{
+		result = e.m_result;
+	}
+
+	TEST_TRUE(result == WBEM_E_TIMED_OUT);
+}
+TEST_CASE_END
+
+TEST_CASE("enumerating a stalled query fails once cancelled from another thread")
+{
+	WMI::Connection connection;
+	connection.open(createStalledProvider());
+
+	WMI::CancellationTokenPtr token(new WMI::CancellationToken);
+	WMI::Stopwatch            stopwatch;
+	WMI::ObjectIterator       it = connection.execQuery(QUERY, WMI::Deadline(), token);
+
+	const uintptr_t thread = _beginthreadex(nullptr, 0, cancelAfterDelay, token.get(), 0, nullptr);
+
+	HRESULT result = S_OK;
+
+	try
+	{
+		++it;
+	}
+	catch (const WMI::Exception& e)
+	{
+		result = e.m_result;
+	}
+
+	TEST_TRUE(result == WBEM_E_CALL_CANCELLED);
+
+	::WaitForSingleObject(reinterpret_cast<HANDLE>(thread), INFINITE);
+	::CloseHandle(reinterpret_cast<HANDLE>(thread));
+
+	TEST_TRUE(stopwatch.elapsed() < 1.0);
+}
+TEST_CASE_END
+
+TEST_CASE("a query is not executed if the deadline has already expired")
+{
+	WMI::Connection connection;
+	connection.open(createStalledProvider());
+
+	const WMI::Deadline deadline = WMI::Deadline::after(0);
+
+	TEST_TRUE(connection.tryExecQuery(QUERY, deadline).result() == WBEM_E_TIMED_OUT);
+}
+TEST_CASE_END
+
+}
+TEST_SET_END
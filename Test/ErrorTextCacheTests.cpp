@@ -0,0 +1,62 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   ErrorTextCacheTests.cpp
+//! \brief  The unit tests for the ErrorTextCache class.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include <Core/UnitTest.hpp>
+#include <WMI/ErrorTextCache.hpp>
+#include <WMI/Exception.hpp>
+#include <wbemidl.h>
+#include <WCL/ComPtr.hpp>
+
+TEST_SET(ErrorTextCache)
+{
+
+TEST_CASE("the text for an error is only cached once")
+{
+	WMI::ErrorTextCache::clear();
+
+	const tstring first = WMI::ErrorTextCache::lookup(WBEM_E_NOT_FOUND);
+	const tstring second = WMI::ErrorTextCache::lookup(WBEM_E_NOT_FOUND);
+
+	TEST_TRUE(!first.empty());
+	TEST_TRUE(first == second);
+	TEST_TRUE(WMI::ErrorTextCache::size() == 1);
+
+	WMI::ErrorTextCache::lookup(WBEM_E_ACCESS_DENIED);
+
+	TEST_TRUE(WMI::ErrorTextCache::size() == 2);
+}
+TEST_CASE_END
+
+TEST_CASE("exceptions with the same error share the cached text")
+{
+	typedef WCL::ComPtr<IWbemLocator> IWbemLocatorPtr;
+
+	WMI::ErrorTextCache::clear();
+
+	IWbemLocatorPtr locator(CLSID_WbemAdministrativeLocator);
+
+	for (int i = 0; i != 10; ++i)
+	{
+		WMI::Exception e(WBEM_E_DATABASE_VER_MISMATCH, locator, TXT("Unit Test"));
+
+		TEST_TRUE(tstrstr(e.twhat(), TXT("version mismatch")) != nullptr);
+	}
+
+	TEST_TRUE(WMI::ErrorTextCache::size() == 1);
+}
+TEST_CASE_END
+
+TEST_CASE("clearing the cache discards all entries")
+{
+	WMI::ErrorTextCache::lookup(WBEM_E_FAILED);
+	WMI::ErrorTextCache::clear();
+
+	TEST_TRUE(WMI::ErrorTextCache::size() == 0);
+}
+TEST_CASE_END
+
+}
+TEST_SET_END
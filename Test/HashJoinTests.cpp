@@ -0,0 +1,176 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   HashJoinTests.cpp
+//! \brief  The unit tests for the HashJoin class.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include <Core/UnitTest.hpp>
+#include <WMI/HashJoin.hpp>
+#include <WMI/Win32_Process.hpp>
+#include <WMI/Win32_Service.hpp>
+#include <WMI/MemoryObject.hpp>
+
+namespace
+{
+
+////////////////////////////////////////////////////////////////////////////////
+//! A row with an integer key.
+
+class Row
+{
+public:
+	//! Construction with the key and a tag to identify the row.
+	Row(uint32 key, const tstring& tag)
+		: m_key(key)
+		, m_tag(tag)
+	{
+	}
+
+	//! Get the key.
+	uint32 key() const
+	{
+		return m_key;
+	}
+
+	//! Get the tag as a key.
+	tstring tag() const
+	{
+		return m_tag;
+	}
+
+private:
+	uint32	m_key;	//!< The key.
+	tstring	m_tag;	//!< The tag.
+};
+
+}
+
+//! The join of two collections of rows on the integer key.
+typedef WMI::HashJoin<Row, Row, uint32> RowJoin;
+
+////////////////////////////////////////////////////////////////////////////////
+//! Create a typed object of a WMI class with an integer property.
+
+template<typename T>
+static T createObject(const tchar* name, int32 value)
+{
+	WMI::MemoryObject*       object = new WMI::MemoryObject(T::WMI_CLASS_NAME);
+	WMI::IWbemClassObjectPtr instance = object->getInterface();
+
+	object->setProperty(name, value, CIM_UINT32);
+
+	return T(instance, WMI::Connection());
+}
+
+TEST_SET(HashJoin)
+{
+
+TEST_CASE("every pair of rows with equal keys is matched, ordered by the larger side")
+{
+	RowJoin::LeftRows  left;
+	RowJoin::RightRows right;
+	RowJoin::Matches   matches;
+
+	left.push_back(Row(1, TXT("a")));
+	left.push_back(Row(2, TXT("b")));
+	left.push_back(Row(2, TXT("c")));
+
+	right.push_back(Row(2, TXT("x")));
+	right.push_back(Row(3, TXT("y")));
+	right.push_back(Row(1, TXT("z")));
+	right.push_back(Row(2, TXT("w")));
+
+	RowJoin join(&Row::key, &Row::key);
+
+	TEST_TRUE(join.join(left, right, matches) == 5);
+	TEST_TRUE(join.buildRows() == 3);
+
+	TEST_TRUE( (matches[0].m_left == 1) && (matches[0].m_right == 0) );
+	TEST_TRUE( (matches[1].m_left == 2) && (matches[1].m_right == 0) );
+	TEST_TRUE( (matches[2].m_left == 0) && (matches[2].m_right == 2) );
+	TEST_TRUE( (matches[3].m_left == 1) && (matches[3].m_right == 3) );
+	TEST_TRUE( (matches[4].m_left == 2) && (matches[4].m_right == 3) );
+}
+TEST_CASE_END
+
+TEST_CASE("the hash table is built over the smaller side whichever side that is")
+{
+	RowJoin::LeftRows  left;
+	RowJoin::RightRows right;
+	RowJoin::Matches   matches;
+
+	for (uint32 key = 0; key != 100; ++key)
+		left.push_back(Row(key * 4, TXT("")));
+
+	right.push_back(Row(40, TXT("")));
+	right.push_back(Row(41, TXT("")));
+
+	RowJoin join(&Row::key, &Row::key);
+
+	TEST_TRUE(join.join(left, right, matches) == 1);
+	TEST_TRUE(join.buildRows() == 2);
+	TEST_TRUE( (matches[0].m_left == 10) && (matches[0].m_right == 0) );
+
+	right.clear();
+
+	TEST_TRUE(join.join(left, right, matches) == 0);
+	TEST_TRUE(join.buildRows() == 0);
+}
+TEST_CASE_END
+
+TEST_CASE("rows can be joined on a string key")
+{
+	typedef WMI::HashJoin<Row, Row, tstring> TagJoin;
+
+	TagJoin::LeftRows  left;
+	TagJoin::RightRows right;
+	TagJoin::Matches   matches;
+
+	left.push_back(Row(0, TXT("C:")));
+	left.push_back(Row(1, TXT("D:")));
+	right.push_back(Row(2, TXT("D:")));
+
+	TagJoin join(&Row::tag, &Row::tag);
+
+	TEST_TRUE(join.join(left, right, matches) == 1);
+	TEST_TRUE(matches[0].m_left == 1);
+}
+TEST_CASE_END
+
+TEST_CASE("the key types used by Windows, such as DWORD, can be hashed")
+{
+	const DWORD  dword = 1234;
+	const long   signedLong = -4;
+	const size_t size = 1234;
+
+	TEST_TRUE(WMI::hashJoinKey(dword) == WMI::hashJoinKey(static_cast<uint32>(1234)));
+	TEST_TRUE(WMI::hashJoinKey(signedLong) == WMI::hashJoinKey(static_cast<int32>(-4)));
+	TEST_TRUE(WMI::hashJoinKey(size) == WMI::hashJoinKey(static_cast<uint64>(1234)));
+}
+TEST_CASE_END
+
+TEST_CASE("services are joined to their hosting processes on the process ID")
+{
+	typedef WMI::HashJoin<WMI::Win32_Service, WMI::Win32_Process, uint32> ServiceJoin;
+
+	ServiceJoin::LeftRows  services;
+	ServiceJoin::RightRows processes;
+	ServiceJoin::Matches   matches;
+
+	services.push_back(createObject<WMI::Win32_Service>(TXT("ProcessId"), 1000));
+	services.push_back(createObject<WMI::Win32_Service>(TXT("ProcessId"), 0));
+	services.push_back(createObject<WMI::Win32_Service>(TXT("ProcessId"), 1000));
+
+	processes.push_back(createObject<WMI::Win32_Process>(TXT("ProcessId"), 4));
+	processes.push_back(createObject<WMI::Win32_Process>(TXT("ProcessId"), 1000));
+
+	ServiceJoin join(&WMI::Win32_Service::ProcessId, &WMI::Win32_Process::ProcessId);
+
+	TEST_TRUE(join.join(services, processes, matches) == 2);
+	TEST_TRUE( (matches[0].m_left == 0) && (matches[0].m_right == 1) );
+	TEST_TRUE( (matches[1].m_left == 2) && (matches[1].m_right == 1) );
+}
+TEST_CASE_END
+
+}
+TEST_SET_END
@@ -0,0 +1,204 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   HostLimiterTests.cpp
+//! \brief  The unit tests for the HostLimiter class.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include <Core/UnitTest.hpp>
+#include <WMI/HostLimiter.hpp>
+#include <WMI/Connection.hpp>
+#include <WMI/ObjectIterator.hpp>
+#include <WMI/MemoryObject.hpp>
+#include <WMI/ReplayServices.hpp>
+#include <WMI/Stopwatch.hpp>
+#include <process.h>
+
+//! The query served by the provider.
+static const tchar* QUERY = TXT("SELECT * FROM Test_Class");
+
+namespace
+{
+
+////////////////////////////////////////////////////////////////////////////////
+//! A caller waiting for a slot on another thread.
+
+struct Waiter
+{
+	WMI::HostLimiter*	m_limiter;	//!< The limiter to wait on.
+	volatile LONG*		m_sequence;	//!< The count of callers that acquired a slot.
+	LONG				m_order;	//!< The order this caller acquired its slot in.
+};
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! The thread function that acquires a slot, notes the order, and releases it.
+
+static unsigned __stdcall acquireInOrder(void* parameter)
+{
+	Waiter* waiter = static_cast<Waiter*>(parameter);
+	uint64  waited = 0;
+
+	if (waiter->m_limiter->acquire(WMI::HostLimiter::REQUEST, WMI::Deadline(), waited))
+	{
+		waiter->m_order = ::InterlockedIncrement(waiter->m_sequence);
+		waiter->m_limiter->release();
+	}
+
+	return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Start a waiter and wait until it has joined the queue.
+
+static HANDLE startWaiter(Waiter& waiter, size_t queueLength)
+{
+	const uintptr_t thread = _beginthreadex(nullptr, 0, acquireInOrder, &waiter, 0, nullptr);
+
+	while (waiter.m_limiter->queueLength() != queueLength)
+		::Sleep(1);
+
+	return reinterpret_cast<HANDLE>(thread);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Create a provider that serves two objects for the query.
+
+static WMI::IWbemServicesPtr createProvider()
+{
+	WMI::RecordingPtr recording(new WMI::Recording);
+
+	const size_t query = recording->addCall(WMI::Recording::EXEC_QUERY, QUERY, TXT(""), WBEM_S_NO_ERROR, 0);
+
+	for (int32 id = 1; id <= 2; ++id)
+	{
+		WMI::MemoryObject*       object = new WMI::MemoryObject(TXT("Test_Class"));
+		WMI::IWbemClassObjectPtr instance = object->getInterface();
+
+		object->setProperty(TXT("Id"), id, CIM_SINT32, true);
+
+		recording->addObject(query, instance, 0);
+	}
+
+	return (new WMI::ReplayServices(recording, false))->getInterface();
+}
+
+TEST_SET(HostLimiter)
+{
+
+TEST_CASE("calls over the concurrency limit wait and give up at their deadline")
+{
+	WMI::HostLimiter limiter(2);
+	uint64           waited = 0;
+
+	TEST_TRUE(limiter.acquire(WMI::HostLimiter::REQUEST, WMI::Deadline(), waited));
+	TEST_TRUE(limiter.acquire(WMI::HostLimiter::CONTINUATION, WMI::Deadline(), waited));
+	TEST_TRUE(waited == 0);
+	TEST_TRUE(limiter.inFlight() == 2);
+
+	TEST_FALSE(limiter.acquire(WMI::HostLimiter::REQUEST, WMI::Deadline::after(50), waited));
+	TEST_TRUE(waited >= 40000);
+	TEST_TRUE(limiter.timedOut() == 1);
+	TEST_TRUE(limiter.queueLength() == 0);
+
+	limiter.release();
+
+	TEST_TRUE(limiter.acquire(WMI::HostLimiter::REQUEST, WMI::Deadline::after(50), waited));
+
+	limiter.release();
+	limiter.release();
+
+	TEST_TRUE(limiter.inFlight() == 0);
+}
+TEST_CASE_END
+
+TEST_CASE("requests over the burst wait for the bucket to refill at the rate")
+{
+	WMI::HostLimiter limiter(10, 20, 2);
+	uint64           waited = 0;
+
+	for (size_t i = 0; i != 2; ++i)
+	{
+		TEST_TRUE(limiter.acquire(WMI::HostLimiter::REQUEST, WMI::Deadline(), waited));
+		TEST_TRUE(waited == 0);
+	}
+
+	TEST_TRUE(limiter.acquire(WMI::HostLimiter::CONTINUATION, WMI::Deadline(), waited));
+	TEST_TRUE(waited == 0);
+
+	TEST_TRUE(limiter.acquire(WMI::HostLimiter::REQUEST, WMI::Deadline(), waited));
+	TEST_TRUE(waited >= 25000);
+	TEST_TRUE(waited < 500000);
+	TEST_TRUE(limiter.queued() == 1);
+
+	for (size_t i = 0; i != 4; ++i)
+		limiter.release();
+}
+TEST_CASE_END
+
+TEST_CASE("waiting callers acquire a slot in the order they arrived")
+{
+	WMI::HostLimiter limiter(1);
+	volatile LONG    sequence = 0;
+	uint64           waited = 0;
+
+	TEST_TRUE(limiter.acquire(WMI::HostLimiter::REQUEST, WMI::Deadline(), waited));
+
+	Waiter first  = { &limiter, &sequence, 0 };
+	Waiter second = { &limiter, &sequence, 0 };
+
+	HANDLE threads[] = { startWaiter(first, 1), startWaiter(second, 2) };
+
+	TEST_TRUE(limiter.maxQueueLength() == 2);
+
+	limiter.release();
+
+	::WaitForMultipleObjects(ARRAY_SIZE(threads), threads, TRUE, INFINITE);
+	::CloseHandle(threads[0]);
+	::CloseHandle(threads[1]);
+
+	TEST_TRUE(first.m_order == 1);
+	TEST_TRUE(second.m_order == 2);
+	TEST_TRUE(limiter.inFlight() == 0);
+}
+TEST_CASE_END
+
+TEST_CASE("a query through a connection with a full limiter times out and the wait is reported")
+{
+	WMI::HostLimiterPtr     limiter(new WMI::HostLimiter(1));
+	WMI::ConnectionStatsPtr stats(new WMI::ConnectionStats);
+	WMI::Connection         connection;
+	uint64                  waited = 0;
+
+	connection.setStats(stats);
+	connection.setLimiter(limiter);
+	connection.open(createProvider());
+
+	TEST_TRUE(limiter->acquire(WMI::HostLimiter::REQUEST, WMI::Deadline(), waited));
+
+	const WMI::Result<WMI::ObjectIterator> blocked = connection.tryExecQuery(QUERY, WMI::Deadline::after(50));
+
+	TEST_TRUE(blocked.failed());
+	TEST_TRUE(blocked.result() == WBEM_E_TIMED_OUT);
+
+	limiter->release();
+
+	size_t count = 0;
+
+	for (WMI::ObjectIterator it = connection.execQuery(QUERY); it != WMI::ObjectIterator(); ++it)
+		++count;
+
+	WMI::ConnectionStats::Snapshot snapshot;
+	stats->snapshot(snapshot);
+
+	const WMI::ConnectionStats::OperationStats& wait = snapshot.m_operations[WMI::ConnectionStats::LIMITER_WAIT];
+
+	TEST_TRUE(count == 2);
+	TEST_TRUE(wait.m_count >= 3);
+	TEST_TRUE(wait.m_maxMicroseconds >= 40000);
+	TEST_TRUE(limiter->inFlight() == 0);
+}
+TEST_CASE_END
+
+}
+TEST_SET_END
@@ -0,0 +1,64 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   MarshalledConnectionTests.cpp
+//! \brief  The unit tests for the MarshalledConnection class.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include <Core/UnitTest.hpp>
+#include <WMI/MarshalledConnection.hpp>
+#include <WMI/ReplayServices.hpp>
+
+////////////////////////////////////////////////////////////////////////////////
+//! Create a provider that has no recorded calls.
+
+static WMI::IWbemServicesPtr createProvider()
+{
+	WMI::RecordingPtr recording(new WMI::Recording);
+
+	return (new WMI::ReplayServices(recording, false))->getInterface();
+}
+
+TEST_SET(MarshalledConnection)
+{
+
+TEST_CASE("an unmarshalled connection has the same settings as the original")
+{
+	const WMI::RetryPolicyPtr policy(new WMI::RetryPolicy(5, 10));
+
+	WMI::Connection connection;
+
+	connection.setBatchSize(25);
+	connection.setBatchBudget(100);
+	connection.setRetryPolicy(policy);
+	connection.open(createProvider());
+
+	const WMI::MarshalledConnection marshalled(connection);
+	const WMI::Connection           worker = marshalled.unmarshal();
+
+	TEST_TRUE(worker.isOpen());
+	TEST_TRUE(worker.batchSize() == connection.batchSize());
+	TEST_TRUE(worker.batchBudget() == connection.batchBudget());
+	TEST_TRUE(worker.retryPolicy().get() == connection.retryPolicy().get());
+	TEST_FALSE(worker.isReconnectable());
+}
+TEST_CASE_END
+
+TEST_CASE("an unmarshalled connection can re-open the original's namespace")
+{
+	const WMI::Connection::Target target(TXT("host"), TXT("root\\default"));
+
+	WMI::Connection connection;
+
+	connection.open(createProvider(), target);
+
+	const WMI::MarshalledConnection marshalled(connection);
+	const WMI::Connection           worker = marshalled.unmarshal();
+
+	TEST_TRUE(worker.isReconnectable());
+	TEST_TRUE(worker.target().m_host == target.m_host);
+	TEST_TRUE(worker.target().m_namespace == target.m_namespace);
+}
+TEST_CASE_END
+
+}
+TEST_SET_END
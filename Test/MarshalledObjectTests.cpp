@@ -0,0 +1,149 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   MarshalledObjectTests.cpp
+//! \brief  The unit tests for the thread affinity and marshalling classes.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include <Core/UnitTest.hpp>
+#include <WMI/MarshalledObject.hpp>
+#include <WMI/ThreadAffinity.hpp>
+#include <WMI/ObjectIterator.hpp>
+#include <WMI/Exception.hpp>
+#include <WCL/AutoCom.hpp>
+#include <process.h>
+
+namespace
+{
+
+//! The state shared with a worker thread.
+struct HandOff
+{
+	WMI::ThreadAffinity			m_affinity;		//!< The affinity captured on the test thread.
+	WMI::MarshalledObjectPtr	m_object;		//!< The object to hand off.
+	bool						m_accessible;	//!< Could the worker use the test thread's interfaces?
+	bool						m_inMta;		//!< Had the worker joined the MTA?
+	tstring						m_className;	//!< The object's class, read by the worker.
+	bool						m_threw;		//!< Did the worker throw?
+};
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! The worker thread function. This joins the MTA and reads the class name of
+//! the handed off object, if any.
+
+static unsigned __stdcall processOnWorker(void* parameter)
+{
+	HandOff* handOff = static_cast<HandOff*>(parameter);
+
+	try
+	{
+		WCL::AutoCom com(COINIT_MULTITHREADED);
+
+		handOff->m_accessible = handOff->m_affinity.isAccessible();
+		handOff->m_inMta = WMI::ThreadAffinity::inMultiThreadedApartment();
+
+		if (handOff->m_object.get() != nullptr)
+		{
+			const WMI::Object object = handOff->m_object->unmarshal();
+
+			handOff->m_className = object.getProperty<tstring>(TXT("__CLASS"));
+		}
+	}
+	catch (const WMI::Exception& /*e*/)
+	{
+		handOff->m_threw = true;
+	}
+
+	return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Run the worker thread function to completion.
+
+static void runWorker(HandOff& handOff)
+{
+	handOff.m_accessible = false;
+	handOff.m_inMta = false;
+	handOff.m_threw = false;
+
+	const uintptr_t thread = _beginthreadex(nullptr, 0, processOnWorker, &handOff, 0, nullptr);
+
+	ASSERT(thread != 0);
+
+	::WaitForSingleObject(reinterpret_cast<HANDLE>(thread), INFINITE);
+	::CloseHandle(reinterpret_cast<HANDLE>(thread));
+}
+
+TEST_SET(MarshalledObject)
+{
+
+TEST_CASE("the test thread is in a single-threaded apartment")
+{
+	const WMI::ThreadAffinity affinity;
+
+	TEST_TRUE(affinity.threadId() == ::GetCurrentThreadId());
+	TEST_FALSE(affinity.isMultiThreaded());
+	TEST_TRUE(affinity.isAccessible());
+	TEST_FALSE(WMI::ThreadAffinity::inMultiThreadedApartment());
+}
+TEST_CASE_END
+
+TEST_CASE("interfaces from a single-threaded apartment are not accessible from another thread")
+{
+	HandOff handOff;
+
+	runWorker(handOff);
+
+	TEST_TRUE(handOff.m_inMta);
+	TEST_FALSE(handOff.m_accessible);
+}
+TEST_CASE_END
+
+TEST_CASE("a connection is opened with the affinity of the calling thread")
+{
+	WMI::Connection connection;
+	connection.open();
+
+	TEST_TRUE(connection.affinity().threadId() == ::GetCurrentThreadId());
+	TEST_TRUE(connection.affinity().isAccessible());
+}
+TEST_CASE_END
+
+TEST_CASE("a marshalled object can be used on a thread in another apartment")
+{
+	WMI::Connection connection;
+	connection.open();
+
+	WMI::ObjectIterator it = connection.execQuery(TXT("SELECT * FROM Win32_OperatingSystem"));
+	WMI::ObjectIterator end;
+
+	TEST_TRUE(it != end);
+
+	HandOff handOff;
+
+	handOff.m_object = WMI::MarshalledObjectPtr(new WMI::MarshalledObject(*it));
+
+	runWorker(handOff);
+
+	TEST_FALSE(handOff.m_threw);
+	TEST_TRUE(handOff.m_className == TXT("Win32_OperatingSystem"));
+}
+TEST_CASE_END
+
+TEST_CASE("a marshalled object can be unmarshalled on the owning thread")
+{
+	WMI::Connection connection;
+	connection.open();
+
+	WMI::ObjectIterator it = connection.execQuery(TXT("SELECT * FROM Win32_OperatingSystem"));
+
+	const WMI::MarshalledObject marshalled(*it);
+	const WMI::Object           object = marshalled.unmarshal();
+
+	TEST_TRUE(object.getProperty<tstring>(TXT("__CLASS")) == TXT("Win32_OperatingSystem"));
+}
+TEST_CASE_END
+
+}
+TEST_SET_END
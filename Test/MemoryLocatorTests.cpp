@@ -0,0 +1,192 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   MemoryLocatorTests.cpp
+//! \brief  The unit tests for the MemoryLocator class and connection deadlines.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include <Core/UnitTest.hpp>
+#include <WMI/MemoryLocator.hpp>
+#include <WMI/Connection.hpp>
+#include <WMI/ObjectIterator.hpp>
+#include <WMI/MemoryObject.hpp>
+#include <WMI/ReplayServices.hpp>
+#include <WMI/Stopwatch.hpp>
+#include <WMI/Exception.hpp>
+
+//! The query served by the provider.
+static const tchar* QUERY = TXT("SELECT * FROM Test_Class");
+
+//! The time, in microseconds, a dead host takes to fail.
+static const uint64 DEAD_HOST_LATENCY = 60 * 1000 * 1000;
+
+//! The time, in microseconds, a live host takes to connect.
+static const uint64 LIVE_HOST_LATENCY = 10 * 1000;
+
+////////////////////////////////////////////////////////////////////////////////
+//! Create a provider that serves a single object for the query.
+
+static WMI::IWbemServicesPtr createProvider()
+{
+	WMI::RecordingPtr recording(new WMI::Recording);
+
+	const size_t query = recording->addCall(WMI::Recording::EXEC_QUERY, QUERY, TXT(""), WBEM_S_NO_ERROR, 0);
+
+	WMI::MemoryObject*       object = new WMI::MemoryObject(TXT("Test_Class"));
+	WMI::IWbemClassObjectPtr instance = object->getInterface();
+
+	object->setProperty(TXT("Id"), 1, CIM_SINT32, true);
+
+	recording->addObject(query, instance, 0);
+
+	WMI::ReplayServices* provider = new WMI::ReplayServices(recording, false);
+
+	return provider->getInterface();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Create a locator with a live host, LIVE, and a dead host, DEAD.
+
+static WMI::IWbemLocatorPtr createLocator(WMI::MemoryLocator*& locator)
+{
+	locator = new WMI::MemoryLocator;
+
+	WMI::IWbemLocatorPtr result = locator->getInterface();
+
+	locator->addNamespace(TXT("\\\\LIVE\\root\\cimv2"), createProvider(), LIVE_HOST_LATENCY);
+	locator->addFailure(TXT("\\\\DEAD\\root\\cimv2"), WBEM_E_TRANSPORT_FAILURE, DEAD_HOST_LATENCY);
+
+	return result;
+}
+
+TEST_SET(MemoryLocator)
+{
+
+TEST_CASE("opening a connection through the locator connects to the provider for the namespace")
+{
+	WMI::MemoryLocator*  locator = nullptr;
+	WMI::IWbemLocatorPtr keepAlive = createLocator(locator);
+	WMI::Connection      connection;
+
+	connection.setLocator(keepAlive);
+	connection.open(TXT("LIVE"), TXT(""), TXT(""), WMI::Connection::DEFAULT_NAMESPACE);
+
+	TEST_TRUE(connection.isOpen());
+	TEST_TRUE(locator->attempts() == 1);
+	TEST_TRUE(locator->lastFlags() == 0);
+
+	WMI::ObjectIterator it = connection.execQuery(QUERY);
+
+	TEST_TRUE(it->getProperty<int32>(TXT("Id")) == 1);
+}
+TEST_CASE_END
+
+TEST_CASE("opening a connection to an unknown namespace throws")
+{
+	WMI::MemoryLocator*  locator = nullptr;
+	WMI::IWbemLocatorPtr keepAlive = createLocator(locator);
+	WMI::Connection      connection;
+
+	connection.setLocator(keepAlive);
+
+	TEST_THROWS(connection.open(TXT("LIVE"), TXT(""), TXT(""), TXT("\\root\\unknown")));
+	TEST_FALSE(connection.isOpen());
+}
+TEST_CASE_END
+
+TEST_CASE("opening a connection with a deadline uses the maximum wait flag")
+{
+	WMI::MemoryLocator*  locator = nullptr;
+	WMI::IWbemLocatorPtr keepAlive = createLocator(locator);
+	WMI::Connection      connection;
+
+	connection.setLocator(keepAlive);
+	connection.open(TXT("LIVE"), TXT(""), TXT(""), WMI::Connection::DEFAULT_NAMESPACE, WMI::Deadline::after(5000));
+
+	TEST_TRUE(connection.isOpen());
+	TEST_TRUE((locator->lastFlags() & WBEM_FLAG_CONNECT_USE_MAX_WAIT) != 0);
+
+	WMI::ObjectIterator it = connection.execQuery(QUERY);
+
+	TEST_TRUE(it->getProperty<int32>(TXT("Id")) == 1);
+}
+TEST_CASE_END
+
+TEST_CASE("opening a connection to a dead host times out at the deadline")
+{
+	WMI::MemoryLocator*  locator = nullptr;
+	WMI::IWbemLocatorPtr keepAlive = createLocator(locator);
+	WMI::Connection      connection;
+	WMI::Stopwatch       stopwatch;
+	HRESULT              result = S_OK;
+
+	connection.setLocator(keepAlive);
+
+	try
+	{
+		connection.open(TXT("DEAD"), TXT(""), TXT(""), WMI::Connection::DEFAULT_NAMESPACE, WMI::Deadline::after(200));
+	}
+	catch (const WMI::Exception& e)
+	{
+		result = e.m_result;
+	}
+
+	TEST_TRUE(result == WBEM_E_TIMED_OUT);
+	TEST_FALSE(connection.isOpen());
+	TEST_TRUE(stopwatch.elapsed() < 1.0);
+}
+TEST_CASE_END
+
+TEST_CASE("racing connections returns the first to succeed")
+{
+	WMI::MemoryLocator*  locator = nullptr;
+	WMI::IWbemLocatorPtr keepAlive = createLocator(locator);
+	WMI::Connection      connection;
+	WMI::Stopwatch       stopwatch;
+
+	WMI::Connection::Targets targets;
+
+	targets.push_back(WMI::Connection::Target(TXT("DEAD")));
+	targets.push_back(WMI::Connection::Target(TXT("LIVE")));
+
+	connection.setLocator(keepAlive);
+
+	const size_t winner = connection.openFirst(targets, WMI::Deadline::after(5000));
+
+	TEST_TRUE(winner == 1);
+	TEST_TRUE(connection.isOpen());
+	TEST_TRUE(stopwatch.elapsed() < 1.0);
+}
+TEST_CASE_END
+
+TEST_CASE("racing connections that all fail returns the failure rather than waiting for the deadline")
+{
+	WMI::MemoryLocator*  locator = nullptr;
+	WMI::IWbemLocatorPtr keepAlive = createLocator(locator);
+	WMI::Connection      connection;
+	WMI::Stopwatch       stopwatch;
+	HRESULT              result = S_OK;
+
+	WMI::Connection::Targets targets;
+
+	targets.push_back(WMI::Connection::Target(TXT("LIVE"), TXT("\\root\\unknown")));
+	targets.push_back(WMI::Connection::Target(TXT("UNKNOWN")));
+
+	connection.setLocator(keepAlive);
+
+	try
+	{
+		connection.openFirst(targets, WMI::Deadline::after(5000));
+	}
+	catch (const WMI::Exception& e)
+	{
+		result = e.m_result;
+	}
+
+	TEST_TRUE(result == WBEM_E_INVALID_NAMESPACE);
+	TEST_TRUE(locator->attempts() == 2);
+	TEST_TRUE(stopwatch.elapsed() < 1.0);
+}
+TEST_CASE_END
+
+}
+TEST_SET_END
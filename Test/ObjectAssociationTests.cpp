@@ -0,0 +1,75 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   ObjectAssociationTests.cpp
+//! \brief  The unit tests for the associations aspect of the Object class.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include <Core/UnitTest.hpp>
+#include <WMI/Object.hpp>
+#include <WMI/Connection.hpp>
+#include <WMI/ObjectIterator.hpp>
+#include <WMI/Win32_Service.hpp>
+#include <WMI/MemoryObject.hpp>
+#include <WMI/ReplayServices.hpp>
+
+////////////////////////////////////////////////////////////////////////////////
+//! Create a service object with just its key.
+
+static WMI::IWbemClassObjectPtr createService(const tchar* name)
+{
+	WMI::MemoryObject*       object = new WMI::MemoryObject(TXT("Win32_Service"));
+	WMI::IWbemClassObjectPtr instance = object->getInterface();
+
+	object->setProperty(TXT("Name"), name, CIM_STRING, true);
+
+	return instance;
+}
+
+TEST_SET(ObjectAssociation)
+{
+
+TEST_CASE("an association query only has the clauses that are specified")
+{
+	const tstring path = TXT("Win32_Service.Name=\"A\"");
+
+	TEST_TRUE(WMI::Object::formatAssociatorsQuery(path, TXT(""), TXT(""), TXT(""))
+				== TXT("ASSOCIATORS OF {Win32_Service.Name=\"A\"}"));
+	TEST_TRUE(WMI::Object::formatAssociatorsQuery(path, TXT("Win32_DependentService"), TXT(""), TXT("Antecedent"))
+				== TXT("ASSOCIATORS OF {Win32_Service.Name=\"A\"} WHERE AssocClass = Win32_DependentService Role = Antecedent"));
+	TEST_TRUE(WMI::Object::formatReferencesQuery(path, TXT(""), TXT(""))
+				== TXT("REFERENCES OF {Win32_Service.Name=\"A\"}"));
+	TEST_TRUE(WMI::Object::formatReferencesQuery(path, TXT("Win32_DependentService"), TXT("Dependent"))
+				== TXT("REFERENCES OF {Win32_Service.Name=\"A\"} WHERE ResultClass = Win32_DependentService Role = Dependent"));
+}
+TEST_CASE_END
+
+TEST_CASE("the objects of a type associated with a typed object can be queried")
+{
+	WMI::RecordingPtr recording(new WMI::Recording);
+
+	const size_t query = recording->addCall(WMI::Recording::EXEC_QUERY,
+		TXT("ASSOCIATORS OF {Win32_Service.Name=\"A\"} WHERE AssocClass = Win32_DependentService ResultClass = Win32_Service Role = Antecedent"),
+		TXT(""), WBEM_S_NO_ERROR, 0);
+
+	recording->addObject(query, createService(TXT("B")), 0);
+	recording->addObject(query, createService(TXT("C")), 0);
+
+	WMI::Connection connection;
+
+	connection.open((new WMI::ReplayServices(recording, false))->getInterface());
+
+	const WMI::Win32_Service service(createService(TXT("A")), connection);
+	const WMI::Win32_Service::Iterator end;
+
+	std::vector<tstring> names;
+
+	for (WMI::Win32_Service::Iterator it = service.associators<WMI::Win32_Service>(TXT("Win32_DependentService"), TXT("Antecedent")); it != end; ++it)
+		names.push_back(it->Name());
+
+	TEST_TRUE(names.size() == 2);
+	TEST_TRUE( (names[0] == TXT("B")) && (names[1] == TXT("C")) );
+}
+TEST_CASE_END
+
+}
+TEST_SET_END
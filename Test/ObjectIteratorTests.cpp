@@ -7,9 +7,25 @@
 #include <Core/UnitTest.hpp>
 #include <WMI/ObjectIterator.hpp>
 #include <WMI/Connection.hpp>
+#include <WMI/MemoryObject.hpp>
+#include <WMI/MemoryEnumerator.hpp>
+#include <algorithm>
 
 static WMI::Connection s_connection;
 
+////////////////////////////////////////////////////////////////////////////////
+//! Create an enumerator that serves a sequence of in-memory objects.
+
+static WMI::MemoryEnumerator* createEnumerator(size_t count)
+{
+	WMI::MemoryObject* object = new WMI::MemoryObject(TXT("Test_Class"));
+	WMI::MemoryEnumerator::Objects objects;
+
+	objects.push_back(object->getInterface());
+
+	return new WMI::MemoryEnumerator(objects, count);
+}
+
 TEST_SET(ObjectIterator)
 {
 
@@ -96,5 +112,96 @@ TEST_CASE("an iterator not at the end can be invoked via the ptr-to-member opera
 }
 TEST_CASE_END
 
+TEST_CASE("a fixed batch size requests that many objects per call")
+{
+	WMI::Connection connection;
+
+	connection.setBatchSize(4);
+
+	WMI::MemoryEnumerator*       enumerator = createEnumerator(10);
+	WMI::IEnumWbemClassObjectPtr sequence = enumerator->getInterface();
+	WMI::ObjectIterator          end;
+	size_t                       count = 0;
+
+	for (WMI::ObjectIterator it(sequence, connection); it != end; ++it)
+		++count;
+
+	TEST_TRUE(count == 10);
+	TEST_TRUE(enumerator->calls() == 3);
+}
+TEST_CASE_END
+
+TEST_CASE("a fixed batch size is limited by the budget")
+{
+	WMI::Connection connection;
+
+	connection.setBatchSize(100);
+	connection.setBatchBudget(5);
+
+	WMI::MemoryEnumerator*       enumerator = createEnumerator(10);
+	WMI::IEnumWbemClassObjectPtr sequence = enumerator->getInterface();
+	WMI::ObjectIterator          it(sequence, connection);
+
+	TEST_TRUE(it.batchSize() == 5);
+}
+TEST_CASE_END
+
+TEST_CASE("an adaptive batch size grows to amortise a long round trip")
+{
+	WMI::Connection connection;
+
+	connection.setBatchSize(WMI::Connection::ADAPTIVE_BATCH_SIZE);
+	connection.setStats(WMI::ConnectionStatsPtr(new WMI::ConnectionStats));
+
+	WMI::MemoryEnumerator*       enumerator = createEnumerator(2000);
+	WMI::IEnumWbemClassObjectPtr sequence = enumerator->getInterface();
+	WMI::ObjectIterator          end;
+	size_t                       count = 0;
+	size_t                       largest = 0;
+
+	enumerator->setRoundTrip(2000);
+
+	for (WMI::ObjectIterator it(sequence, connection); it != end; ++it)
+	{
+		largest = std::max(largest, it.batchSize());
+		++count;
+	}
+
+	WMI::ConnectionStats::Snapshot snapshot;
+
+	connection.stats()->snapshot(snapshot);
+
+	const WMI::ConnectionStats::OperationStats& next = snapshot.m_operations[WMI::ConnectionStats::ENUM_NEXT];
+
+	TEST_TRUE(count == 2000);
+	TEST_TRUE(largest > WMI::BatchSizer::INITIAL_SIZE);
+	TEST_TRUE(largest <= connection.batchBudget());
+	TEST_TRUE(enumerator->calls() < 20);
+	TEST_TRUE(next.m_objects == 2000);
+	TEST_TRUE(WMI::ConnectionStats::meanObjects(next) > 100.0);
+}
+TEST_CASE_END
+
+TEST_CASE("an adaptive batch size stays within the budget")
+{
+	WMI::Connection connection;
+
+	connection.setBatchSize(WMI::Connection::ADAPTIVE_BATCH_SIZE);
+	connection.setBatchBudget(50);
+
+	WMI::MemoryEnumerator*       enumerator = createEnumerator(1000);
+	WMI::IEnumWbemClassObjectPtr sequence = enumerator->getInterface();
+	WMI::ObjectIterator          end;
+	size_t                       largest = 0;
+
+	enumerator->setRoundTrip(1000);
+
+	for (WMI::ObjectIterator it(sequence, connection); it != end; ++it)
+		largest = std::max(largest, it.batchSize());
+
+	TEST_TRUE(largest == 50);
+}
+TEST_CASE_END
+
 }
 TEST_SET_END
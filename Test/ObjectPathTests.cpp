@@ -0,0 +1,128 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   ObjectPathTests.cpp
+//! \brief  The unit tests for the ObjectPath class.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include <Core/UnitTest.hpp>
+#include <WMI/ObjectPath.hpp>
+#include <WMI/Object.hpp>
+#include <WMI/MemoryObject.hpp>
+#include <WMI/Exception.hpp>
+
+TEST_SET(ObjectPath)
+{
+
+TEST_CASE("an absolute path is split into the server, namespace, class and keys")
+{
+	const WMI::ObjectPath path(TXT("\\\\HOST.domain.com\\root\\cimv2:Win32_Service.Name=\"Alerter\""));
+
+	TEST_FALSE(path.isRelative());
+	TEST_TRUE(path.server() == TXT("HOST.domain.com"));
+	TEST_TRUE(path.nmspace() == TXT("root\\cimv2"));
+	TEST_TRUE(path.className() == TXT("Win32_Service"));
+	TEST_TRUE(path.relativePath() == TXT("Win32_Service.Name=\"Alerter\""));
+	TEST_TRUE(path.keyCount() == 1);
+	TEST_TRUE(path.keyName(0) == TXT("Name"));
+	TEST_TRUE(path.keyValue(0) == TXT("Alerter"));
+}
+TEST_CASE_END
+
+TEST_CASE("a relative path has no server or namespace")
+{
+	const WMI::ObjectPath path(TXT("Win32_Process.Handle=\"4\""));
+
+	TEST_TRUE(path.isRelative());
+	TEST_TRUE(path.server().empty());
+	TEST_TRUE(path.nmspace().empty());
+	TEST_TRUE(path.className() == TXT("Win32_Process"));
+	TEST_TRUE(path.relativePath() == path.toString());
+}
+TEST_CASE_END
+
+TEST_CASE("quoted key values are unescaped and other values are returned as is")
+{
+	const WMI::ObjectPath path(TXT("Test_Class.Name=\"a\\\"b\\\\c\",Id=42"));
+
+	TEST_TRUE(path.keyCount() == 2);
+	TEST_TRUE(path.keyValue(0) == TXT("a\"b\\c"));
+	TEST_TRUE(path.keyName(1) == TXT("Id"));
+	TEST_TRUE(path.keyValue(1) == TXT("42"));
+}
+TEST_CASE_END
+
+TEST_CASE("a key can be found by name ignoring case")
+{
+	const WMI::ObjectPath path(TXT("Test_Class.Name=\"a,b\",Id=42"));
+	tstring               value;
+
+	TEST_TRUE(path.findKey(TXT("id"), value));
+	TEST_TRUE(value == TXT("42"));
+	TEST_TRUE(path.findKey(TXT("NAME"), value));
+	TEST_TRUE(value == TXT("a,b"));
+	TEST_FALSE(path.findKey(TXT("Unknown"), value));
+}
+TEST_CASE_END
+
+TEST_CASE("a singleton has no keys and a single key name can be implied")
+{
+	const WMI::ObjectPath singleton(TXT("Win32_WMISetting=@"));
+
+	TEST_TRUE(singleton.isSingleton());
+	TEST_TRUE(singleton.keyCount() == 0);
+
+	const WMI::ObjectPath implied(TXT("Win32_Directory=\"C:\\\\\""));
+
+	TEST_FALSE(implied.isSingleton());
+	TEST_TRUE(implied.keyCount() == 1);
+	TEST_TRUE(implied.keyName(0).empty());
+	TEST_TRUE(implied.keyValue(0) == TXT("C:\\"));
+}
+TEST_CASE_END
+
+TEST_CASE("parsing an invalid path throws")
+{
+	TEST_THROWS(WMI::ObjectPath(TXT("")));
+	TEST_THROWS(WMI::ObjectPath(TXT("\\\\HOST")));
+	TEST_THROWS(WMI::ObjectPath(TXT("Test_Class.Name=\"unterminated")));
+	TEST_THROWS(WMI::ObjectPath(TXT("Test_Class.=1")));
+	TEST_THROWS(WMI::ObjectPath(TXT("Test_Class.Id=1,")));
+}
+TEST_CASE_END
+
+TEST_CASE("an object's paths come from its parsed full path")
+{
+	WMI::MemoryObject*       memory = new WMI::MemoryObject(TXT("Test_Class"));
+	WMI::IWbemClassObjectPtr instance = memory->getInterface();
+	WMI::Connection          connection;
+
+	memory->setProperty(TXT("Id"), 1, CIM_SINT32, true);
+
+	const WMI::Object object(instance, connection);
+
+	TEST_TRUE(object.path().className() == TXT("Test_Class"));
+	TEST_TRUE(object.path().keyValue(0) == TXT("1"));
+	TEST_TRUE(object.relativePath() == TXT("Test_Class.Id=1"));
+	TEST_TRUE(object.absolutePath() == TXT("\\\\.\\root\\cimv2:Test_Class.Id=1"));
+}
+TEST_CASE_END
+
+TEST_CASE("an object's path is parsed once and a copy parses its own")
+{
+	WMI::MemoryObject*       memory = new WMI::MemoryObject(TXT("Test_Class"));
+	WMI::IWbemClassObjectPtr instance = memory->getInterface();
+	WMI::Connection          connection;
+
+	memory->setProperty(TXT("Id"), 1, CIM_SINT32, true);
+
+	const WMI::Object object(instance, connection);
+	const WMI::Object copy(object);
+
+	TEST_TRUE(&object.path() == &object.path());
+	TEST_TRUE(&copy.path() != &object.path());
+	TEST_TRUE(copy.relativePath() == object.relativePath());
+}
+TEST_CASE_END
+
+}
+TEST_SET_END
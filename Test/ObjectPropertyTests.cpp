@@ -72,6 +72,29 @@ TEST_CASE("fetching the value for an unknown property throws an exception")
 }
 TEST_CASE_END
 
+TEST_CASE("trying to fetch the value for an unknown property returns the error")
+{
+	WCL::Variant value;
+
+	TEST_TRUE(object.tryGetProperty(TXT("__INVALID_PROPERTY_NAME__"), value) == WBEM_E_NOT_FOUND);
+
+	const WMI::Result<tstring> missing = object.tryGetProperty<tstring>(TXT("__INVALID_PROPERTY_NAME__"));
+
+	TEST_TRUE(missing.failed());
+	TEST_TRUE(missing.result() == WBEM_E_NOT_FOUND);
+	TEST_TRUE(missing.valueOr(TXT("default")) == TXT("default"));
+}
+TEST_CASE_END
+
+TEST_CASE("trying to fetch the value for a known property returns the value")
+{
+	const WMI::Result<tstring> name = object.tryGetProperty<tstring>(TXT("__CLASS"));
+
+	TEST_TRUE(name.succeeded());
+	TEST_TRUE(name.value() == TXT("Win32_OperatingSystem"));
+}
+TEST_CASE_END
+
 TEST_CASE("property values can be coerced to a specific type")
 {
 	TEST_TRUE(object.getProperty<tstring>(TXT("__CLASS")) == TXT("Win32_OperatingSystem"));
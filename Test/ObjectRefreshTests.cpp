@@ -0,0 +1,136 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   ObjectRefreshTests.cpp
+//! \brief  The unit tests for the refresh aspect of the Object class.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include <Core/UnitTest.hpp>
+#include <WMI/Object.hpp>
+#include <WMI/Connection.hpp>
+#include <WMI/MemoryObject.hpp>
+#include <WMI/ReplayServices.hpp>
+
+//! The query that refreshes the objects in a single batch.
+static const tchar* BATCH_QUERY = TXT("SELECT * FROM Test_Class WHERE (Id = 1) OR (Id = 2) OR (Id = 3)");
+
+////////////////////////////////////////////////////////////////////////////////
+//! Create an instance of the test class.
+
+static WMI::IWbemClassObjectPtr createInstance(int32 id, const tstring& state)
+{
+	WMI::MemoryObject*       object = new WMI::MemoryObject(TXT("Test_Class"));
+	WMI::IWbemClassObjectPtr instance = object->getInterface();
+
+	object->setProperty(TXT("Id"), id, CIM_SINT32, true);
+	object->setProperty(TXT("State"), state);
+
+	return instance;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Create a provider that answers the batch query with only the first and last
+//! objects, in their new state.
+
+static WMI::IWbemServicesPtr createProvider()
+{
+	WMI::RecordingPtr recording(new WMI::Recording);
+
+	const size_t query = recording->addCall(WMI::Recording::EXEC_QUERY, BATCH_QUERY, TXT(""), WBEM_S_NO_ERROR, 0);
+
+	recording->addObject(query, createInstance(3, TXT("Stopped")), 0);
+	recording->addObject(query, createInstance(1, TXT("Stopped")), 0);
+
+	WMI::ReplayServices* provider = new WMI::ReplayServices(recording, false);
+
+	return provider->getInterface();
+}
+
+TEST_SET(ObjectRefresh)
+{
+
+TEST_CASE("the key predicate selects the instance by all its keys")
+{
+	WMI::MemoryObject*       memory = new WMI::MemoryObject(TXT("Test_Class"));
+	WMI::IWbemClassObjectPtr instance = memory->getInterface();
+	WMI::Connection          connection;
+
+	memory->setProperty(TXT("Name"), TXT("O'Brien\\"), CIM_STRING, true);
+	memory->setProperty(TXT("Id"), 42, CIM_SINT32, true);
+	memory->setProperty(TXT("State"), TXT("Running"));
+
+	const WMI::Object object(instance, connection);
+
+	TEST_TRUE(object.keyPredicate() == TXT("Id = 42 AND Name = 'O\\'Brien\\\\'"));
+}
+TEST_CASE_END
+
+TEST_CASE("a real key value is formatted independently of the user's locale")
+{
+	WMI::MemoryObject*       memory = new WMI::MemoryObject(TXT("Test_Class"));
+	WMI::IWbemClassObjectPtr instance = memory->getInterface();
+	WMI::Connection          connection;
+	WCL::Variant             value;
+
+	V_VT(&value) = VT_R8;
+	V_R8(&value) = 1.5;
+
+	memory->setProperty(TXT("Value"), value, CIM_REAL64, true);
+
+	const WMI::Object object(instance, connection);
+
+	TEST_TRUE(object.keyPredicate() == TXT("Value = 1.5"));
+}
+TEST_CASE_END
+
+TEST_CASE("an object without keys has an empty key predicate")
+{
+	WMI::MemoryObject*       memory = new WMI::MemoryObject(TXT("Test_Singleton"));
+	WMI::IWbemClassObjectPtr instance = memory->getInterface();
+	WMI::Connection          connection;
+
+	memory->setProperty(TXT("State"), TXT("Running"));
+
+	const WMI::Object object(instance, connection);
+
+	TEST_TRUE(object.keyPredicate().empty());
+}
+TEST_CASE_END
+
+TEST_CASE("refreshing a set of objects uses a single query and reports those that vanished")
+{
+	WMI::Connection connection;
+
+	connection.setStats(WMI::ConnectionStatsPtr(new WMI::ConnectionStats));
+	connection.open(createProvider());
+
+	WMI::Object first(createInstance(1, TXT("Running")), connection);
+	WMI::Object second(createInstance(2, TXT("Running")), connection);
+	WMI::Object third(createInstance(3, TXT("Running")), connection);
+
+	WMI::Object::Objects objects;
+
+	objects.push_back(&first);
+	objects.push_back(&second);
+	objects.push_back(&third);
+
+	WMI::Object::Indices vanished(1, 99);
+
+	WMI::Object::refreshAll(objects, vanished);
+
+	TEST_TRUE(vanished.size() == 1);
+	TEST_TRUE(vanished[0] == 1);
+	TEST_TRUE(first.getProperty<tstring>(TXT("State")) == TXT("Stopped"));
+	TEST_TRUE(second.getProperty<tstring>(TXT("State")) == TXT("Running"));
+	TEST_TRUE(third.getProperty<tstring>(TXT("State")) == TXT("Stopped"));
+
+	WMI::ConnectionStats::Snapshot snapshot;
+
+	connection.stats()->snapshot(snapshot);
+
+	TEST_TRUE(snapshot.m_operations[WMI::ConnectionStats::EXEC_QUERY].m_count == 1);
+	TEST_TRUE(snapshot.m_operations[WMI::ConnectionStats::GET_OBJECT].m_count == 0);
+}
+TEST_CASE_END
+
+}
+TEST_SET_END
@@ -0,0 +1,228 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   ParallelForEachTests.cpp
+//! \brief  The unit tests for the ParallelForEach and WorkStealingPool classes.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include <Core/UnitTest.hpp>
+#include <WMI/ParallelForEach.hpp>
+#include <WMI/MemoryObject.hpp>
+#include <WMI/ObjectIterator.hpp>
+#include <WMI/ThreadAffinity.hpp>
+#include <WMI/Exception.hpp>
+#include <Core/InvalidArgException.hpp>
+#include <algorithm>
+
+namespace
+{
+
+////////////////////////////////////////////////////////////////////////////////
+//! A reducer that counts and sums the Id property of the rows.
+
+class SumReducer
+{
+public:
+	//! Default constructor.
+	SumReducer()
+		: m_rows(0)
+		, m_sum(0)
+		, m_inMta(true)
+	{
+	}
+
+	//! Process a row.
+	void operator()(const WMI::Object& row)
+	{
+		m_sum += row.getProperty<int32>(TXT("Id"));
+		m_inMta = m_inMta && WMI::ThreadAffinity::inMultiThreadedApartment();
+		++m_rows;
+	}
+
+	//
+	// Members.
+	//
+	size_t	m_rows;		//!< The number of rows processed.
+	int64	m_sum;		//!< The sum of the Id values.
+	bool	m_inMta;	//!< Were all rows processed in the MTA?
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//! A reducer that counts the rows with a name.
+
+class NameReducer
+{
+public:
+	//! Default constructor.
+	NameReducer()
+		: m_rows(0)
+	{
+	}
+
+	//! Process a row.
+	void operator()(const WMI::Object& row)
+	{
+		if (!row.getProperty<tstring>(TXT("Name")).empty())
+			++m_rows;
+	}
+
+	//
+	// Members.
+	//
+	size_t	m_rows;		//!< The number of rows with a name.
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//! A reducer that fails on a specific row.
+
+class FailingReducer
+{
+public:
+	//! Process a row.
+	void operator()(const WMI::Object& row)
+	{
+		if (row.getProperty<int32>(TXT("Id")) == 500)
+			throw Core::InvalidArgException(TXT("Unit Test"));
+	}
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//! A task that counts the number of times each item is processed.
+
+class CountingTask : public WMI::WorkStealingPool::Task
+{
+public:
+	//! Constructor.
+	CountingTask(std::vector<LONG>& counts)
+		: m_counts(counts)
+	{
+	}
+
+	//! Count each item in the range.
+	virtual void process(size_t /*worker*/, size_t begin, size_t end)
+	{
+		for (size_t i = begin; i != end; ++i)
+			::InterlockedIncrement(&m_counts[i]);
+	}
+
+private:
+	std::vector<LONG>&	m_counts;	//!< The counts, by item.
+};
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Create a set of in-memory rows with the Id values [1, count].
+
+static WMI::ParallelForEach::Rows createRows(size_t count)
+{
+	WMI::ParallelForEach::Rows rows;
+
+	for (size_t i = 1; i <= count; ++i)
+	{
+		WMI::MemoryObject*       object = new WMI::MemoryObject(TXT("Test_Class"));
+		WMI::IWbemClassObjectPtr row = object->getInterface();
+
+		object->setProperty(TXT("Id"), static_cast<int32>(i), CIM_SINT32, true);
+		rows.push_back(row);
+	}
+
+	return rows;
+}
+
+TEST_SET(ParallelForEach)
+{
+	WMI::Connection connection;
+	connection.open();
+
+TEST_CASE("the pool processes every item exactly once")
+{
+	const size_t      count = 10007;
+	std::vector<LONG> counts(count, 0);
+	CountingTask      task(counts);
+
+	WMI::WorkStealingPool pool(4);
+
+	pool.run(task, count, 16);
+
+	TEST_TRUE(std::count(counts.begin(), counts.end(), 1) == static_cast<ptrdiff_t>(count));
+}
+TEST_CASE_END
+
+TEST_CASE("the pool can run an empty range")
+{
+	std::vector<LONG> counts;
+	CountingTask      task(counts);
+
+	WMI::WorkStealingPool pool(4);
+
+	pool.run(task, 0);
+
+	TEST_TRUE(pool.workers() == 4);
+}
+TEST_CASE_END
+
+TEST_CASE("each row is reduced once by one of the workers in the MTA")
+{
+	const size_t                     count = 1000;
+	const WMI::ParallelForEach::Rows rows = createRows(count);
+
+	WMI::ParallelForEach    forEach(4);
+	std::vector<SumReducer> reducers;
+
+	forEach.run(connection, rows, SumReducer(), reducers, 8);
+
+	TEST_TRUE(reducers.size() == forEach.workers());
+
+	size_t rowCount = 0;
+	int64  sum = 0;
+	bool   inMta = true;
+
+	for (size_t i = 0; i != reducers.size(); ++i)
+	{
+		rowCount += reducers[i].m_rows;
+		sum += reducers[i].m_sum;
+		inMta = inMta && reducers[i].m_inMta;
+	}
+
+	TEST_TRUE(rowCount == count);
+	TEST_TRUE(sum == static_cast<int64>(count * (count + 1) / 2));
+	TEST_TRUE(inMta);
+}
+TEST_CASE_END
+
+TEST_CASE("a failure on a worker is rethrown on the calling thread")
+{
+	const WMI::ParallelForEach::Rows rows = createRows(1000);
+
+	WMI::ParallelForEach        forEach(4);
+	std::vector<FailingReducer> reducers;
+
+	TEST_THROWS(forEach.run(connection, rows, FailingReducer(), reducers));
+}
+TEST_CASE_END
+
+TEST_CASE("a query result can be materialised and processed in parallel")
+{
+	WMI::ParallelForEach::Rows rows;
+
+	const size_t count = WMI::ParallelForEach::materialise(connection.execQuery(TXT("SELECT * FROM Win32_Process")), rows);
+
+	TEST_TRUE(count != 0);
+	TEST_TRUE(rows.size() == count);
+
+	WMI::ParallelForEach     forEach;
+	std::vector<NameReducer> reducers;
+
+	forEach.run(connection, rows, NameReducer(), reducers);
+
+	size_t rowCount = 0;
+
+	for (size_t i = 0; i != reducers.size(); ++i)
+		rowCount += reducers[i].m_rows;
+
+	TEST_TRUE(rowCount == count);
+}
+TEST_CASE_END
+
+}
+TEST_SET_END
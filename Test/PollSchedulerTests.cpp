@@ -0,0 +1,221 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   PollSchedulerTests.cpp
+//! \brief  The unit tests for the PollScheduler class.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include <Core/UnitTest.hpp>
+#include <WMI/PollScheduler.hpp>
+#include <WMI/MemoryObject.hpp>
+#include <WMI/ReplayServices.hpp>
+
+//! The name of the polled host.
+static const tstring HOST = TXT("HOST");
+//! The class polled.
+static const tstring CLASS_NAME = TXT("Test_Class");
+
+////////////////////////////////////////////////////////////////////////////////
+//! Counts the results and failures passed to it.
+
+class CountingSink : public WMI::PollScheduler::Sink
+{
+public:
+	//! Default constructor.
+	CountingSink()
+		: m_results(0)
+		, m_objects(0)
+		, m_failures(0)
+	{
+	}
+
+	//! Count the results of a poll.
+	virtual void onResults(size_t /*poll*/, const tstring& /*host*/, const WMI::PollScheduler::Objects& objects)
+	{
+		::InterlockedIncrement(&m_results);
+		::InterlockedExchangeAdd(&m_objects, static_cast<LONG>(objects.size()));
+	}
+
+	//! Count a failed poll.
+	virtual void onFailure(size_t /*poll*/, const tstring& /*host*/, const WMI::Exception& /*error*/)
+	{
+		::InterlockedIncrement(&m_failures);
+	}
+
+	volatile LONG	m_results;		//!< The number of polls that succeeded.
+	volatile LONG	m_objects;		//!< The number of objects returned.
+	volatile LONG	m_failures;		//!< The number of polls that failed.
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//! Create a provider that serves two objects for the queries.
+
+static WMI::IWbemServicesPtr createProvider()
+{
+	const tchar* queries[] = { TXT("SELECT * FROM Test_Class"), TXT("SELECT Id, Name FROM Test_Class"), TXT("SELECT Name FROM Test_Class") };
+
+	WMI::RecordingPtr recording(new WMI::Recording);
+
+	for (size_t i = 0; i != ARRAY_SIZE(queries); ++i)
+	{
+		const size_t call = recording->addCall(WMI::Recording::EXEC_QUERY, queries[i], TXT(""), WBEM_S_NO_ERROR, 0);
+
+		for (int32 id = 1; id <= 2; ++id)
+		{
+			WMI::MemoryObject*       object = new WMI::MemoryObject(CLASS_NAME);
+			WMI::IWbemClassObjectPtr instance = object->getInterface();
+
+			object->setProperty(TXT("Id"), id, CIM_SINT32, true);
+			object->setProperty(TXT("Name"), TXT("name"));
+
+			recording->addObject(call, instance, 0);
+		}
+	}
+
+	return (new WMI::ReplayServices(recording, false))->getInterface();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Create a property list with a single property.
+
+static WMI::PollScheduler::Properties properties(const tchar* property)
+{
+	return WMI::PollScheduler::Properties(1, property);
+}
+
+TEST_SET(PollScheduler)
+{
+
+TEST_CASE("polls for the same class on a host that fall due together are coalesced")
+{
+	CountingSink               sink;
+	WMI::PollScheduler         scheduler(1, 100);
+	WMI::PollScheduler::Cycles cycles;
+
+	scheduler.setJitter(0);
+	scheduler.addHost(HOST, createProvider());
+	scheduler.addPoll(HOST, CLASS_NAME, properties(TXT("Name")), 500, sink);
+	scheduler.addPoll(HOST, CLASS_NAME, properties(TXT("Id")), 1000, sink);
+	scheduler.collect(5, cycles);
+
+	TEST_TRUE(cycles.size() == 1);
+	TEST_TRUE(cycles[0].m_queries.size() == 1);
+	TEST_TRUE(cycles[0].m_queries[0].m_text == TXT("SELECT Name FROM Test_Class"));
+
+	scheduler.execute(cycles[0]);
+	cycles.clear();
+	scheduler.collect(10, cycles);
+
+	TEST_TRUE(cycles.size() == 1);
+	TEST_TRUE(cycles[0].m_queries.size() == 1);
+	TEST_TRUE(cycles[0].m_queries[0].m_text == TXT("SELECT Id, Name FROM Test_Class"));
+	TEST_TRUE(cycles[0].m_queries[0].m_targets.size() == 2);
+	TEST_TRUE(scheduler.coalescedPolls() == 1);
+}
+TEST_CASE_END
+
+TEST_CASE("executing a cycle passes the results to the sink of each poll")
+{
+	CountingSink               sink;
+	WMI::PollScheduler         scheduler(1, 100);
+	WMI::PollScheduler::Cycles cycles;
+
+	scheduler.setJitter(0);
+	scheduler.addHost(HOST, createProvider());
+	scheduler.addPoll(HOST, CLASS_NAME, WMI::PollScheduler::Properties(), 500, sink);
+	scheduler.addPoll(HOST, CLASS_NAME, properties(TXT("Name")), 500, sink);
+	scheduler.collect(5, cycles);
+
+	TEST_TRUE(cycles.size() == 1);
+	TEST_TRUE(cycles[0].m_queries[0].m_text == TXT("SELECT * FROM Test_Class"));
+
+	scheduler.execute(cycles[0]);
+
+	TEST_TRUE(sink.m_results == 2);
+	TEST_TRUE(sink.m_objects == 4);
+	TEST_TRUE(sink.m_failures == 0);
+}
+TEST_CASE_END
+
+TEST_CASE("a failed query is passed to the sink")
+{
+	CountingSink               sink;
+	WMI::PollScheduler         scheduler(1, 100);
+	WMI::PollScheduler::Cycles cycles;
+
+	scheduler.setJitter(0);
+	scheduler.addHost(HOST, createProvider());
+	scheduler.addPoll(HOST, TXT("Unknown_Class"), WMI::PollScheduler::Properties(), 500, sink);
+	scheduler.collect(5, cycles);
+	scheduler.execute(cycles[0]);
+
+	TEST_TRUE(sink.m_results == 0);
+	TEST_TRUE(sink.m_failures == 1);
+}
+TEST_CASE_END
+
+TEST_CASE("a host is skipped while its previous cycle is running")
+{
+	CountingSink               sink;
+	WMI::PollScheduler         scheduler(1, 100);
+	WMI::PollScheduler::Cycles cycles;
+
+	scheduler.setJitter(0);
+	scheduler.addHost(HOST, createProvider());
+	scheduler.addPoll(HOST, CLASS_NAME, WMI::PollScheduler::Properties(), 500, sink);
+	scheduler.collect(5, cycles);
+
+	const WMI::PollScheduler::Cycle running = cycles[0];
+
+	cycles.clear();
+	scheduler.collect(10, cycles);
+
+	TEST_TRUE(cycles.empty());
+	TEST_TRUE(scheduler.skippedCycles() == 1);
+
+	scheduler.execute(running);
+	scheduler.collect(15, cycles);
+
+	TEST_TRUE(cycles.size() == 1);
+}
+TEST_CASE_END
+
+TEST_CASE("a removed poll is no longer collected")
+{
+	CountingSink               sink;
+	WMI::PollScheduler         scheduler(1, 100);
+	WMI::PollScheduler::Cycles cycles;
+
+	scheduler.setJitter(0);
+
+	const size_t poll = scheduler.addPoll(HOST, CLASS_NAME, WMI::PollScheduler::Properties(), 500, sink);
+
+	scheduler.removePoll(poll);
+	scheduler.collect(5, cycles);
+
+	TEST_TRUE(cycles.empty());
+}
+TEST_CASE_END
+
+TEST_CASE("a started scheduler polls the hosts on its worker threads")
+{
+	CountingSink       sink;
+	WMI::PollScheduler scheduler(2, 10);
+
+	scheduler.setJitter(0);
+	scheduler.addHost(HOST, createProvider());
+	scheduler.addPoll(HOST, CLASS_NAME, WMI::PollScheduler::Properties(), 20, sink);
+	scheduler.start();
+
+	TEST_TRUE(scheduler.isRunning());
+
+	::Sleep(200);
+	scheduler.stop();
+
+	TEST_FALSE(scheduler.isRunning());
+	TEST_TRUE(sink.m_results != 0);
+	TEST_TRUE(sink.m_failures == 0);
+}
+TEST_CASE_END
+
+}
+TEST_SET_END
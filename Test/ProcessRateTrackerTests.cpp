@@ -0,0 +1,194 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   ProcessRateTrackerTests.cpp
+//! \brief  The unit tests for the ProcessRateTracker class.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include <Core/UnitTest.hpp>
+#include <WMI/ProcessRateTracker.hpp>
+#include <WMI/Object.hpp>
+#include <WMI/MemoryObject.hpp>
+#include <WMI/Connection.hpp>
+
+//! The number of 100ns units per second.
+static const uint64 ONE_SECOND = 10000000;
+
+////////////////////////////////////////////////////////////////////////////////
+//! Create the counters for a process.
+
+static WMI::ProcessRateTracker::Counters counters(uint32 processId, uint64 created, uint64 cpuTime, uint64 ioBytes)
+{
+	WMI::ProcessRateTracker::Counters result;
+
+	result.m_processId    = processId;
+	result.m_created      = created;
+	result.m_cpuTime      = cpuTime;
+	result.m_ioBytes      = ioBytes;
+	result.m_ioOperations = ioBytes / 4096;
+	result.m_pageFaults   = cpuTime / 1000;
+	result.m_timestamp    = 0;
+	result.m_frequency    = 0;
+
+	return result;
+}
+
+TEST_SET(ProcessRateTracker)
+{
+
+TEST_CASE("the rates are computed from the change in the counters over the interval")
+{
+	WMI::ProcessRateTracker                  tracker;
+	WMI::ProcessRateTracker::Snapshot        snapshot;
+	WMI::ProcessRateTracker::RatesCollection rates;
+
+	snapshot.push_back(counters(4, 1, 0, 0));
+	tracker.update(ONE_SECOND, snapshot, rates);
+
+	TEST_TRUE(rates.size() == 1);
+	TEST_FALSE(rates[0].m_valid);
+
+	snapshot[0] = counters(4, 1, ONE_SECOND, 8 * 4096);
+	tracker.update(3 * ONE_SECOND, snapshot, rates);
+
+	TEST_TRUE(rates[0].m_valid);
+	TEST_TRUE(rates[0].m_processId == 4);
+	TEST_TRUE(rates[0].m_cpuPercent == 50.0);
+	TEST_TRUE(rates[0].m_ioBytesPerSec == 4 * 4096);
+	TEST_TRUE(rates[0].m_ioOperationsPerSec == 4.0);
+	TEST_TRUE(rates[0].m_pageFaultsPerSec == 5000.0);
+}
+TEST_CASE_END
+
+TEST_CASE("the interval is taken from the counters' own sample times when they have them")
+{
+	WMI::ProcessRateTracker                  tracker;
+	WMI::ProcessRateTracker::Snapshot        snapshot;
+	WMI::ProcessRateTracker::RatesCollection rates;
+
+	snapshot.push_back(counters(4, 1, 0, 0));
+	snapshot[0].m_timestamp = 10 * ONE_SECOND;
+	snapshot[0].m_frequency = ONE_SECOND;
+	tracker.update(ONE_SECOND, snapshot, rates);
+
+	snapshot[0] = counters(4, 1, ONE_SECOND, 0);
+	snapshot[0].m_timestamp = 14 * ONE_SECOND;
+	snapshot[0].m_frequency = ONE_SECOND;
+	tracker.update(2 * ONE_SECOND, snapshot, rates);
+
+	TEST_TRUE(rates[0].m_valid);
+	TEST_TRUE(rates[0].m_cpuPercent == 25.0);
+
+	snapshot[0] = counters(4, 1, 2 * ONE_SECOND, 0);
+	snapshot[0].m_timestamp = 14 * ONE_SECOND;
+	snapshot[0].m_frequency = ONE_SECOND;
+	tracker.update(3 * ONE_SECOND, snapshot, rates);
+
+	TEST_FALSE(rates[0].m_valid);
+}
+TEST_CASE_END
+
+TEST_CASE("a reused process ID starts afresh instead of inheriting the old counters")
+{
+	WMI::ProcessRateTracker                  tracker;
+	WMI::ProcessRateTracker::Snapshot        snapshot;
+	WMI::ProcessRateTracker::RatesCollection rates;
+
+	snapshot.push_back(counters(8, 1, ONE_SECOND, 0));
+	tracker.update(ONE_SECOND, snapshot, rates);
+
+	snapshot[0] = counters(8, 2, 0, 0);
+	tracker.update(2 * ONE_SECOND, snapshot, rates);
+
+	TEST_FALSE(rates[0].m_valid);
+	TEST_TRUE(tracker.reusedIds() == 1);
+
+	snapshot[0] = counters(8, 2, ONE_SECOND / 10, 0);
+	tracker.update(3 * ONE_SECOND, snapshot, rates);
+
+	TEST_TRUE(rates[0].m_valid);
+	TEST_TRUE(rates[0].m_cpuPercent == 10.0);
+}
+TEST_CASE_END
+
+TEST_CASE("processes missing from a snapshot are forgotten")
+{
+	WMI::ProcessRateTracker                  tracker;
+	WMI::ProcessRateTracker::Snapshot        snapshot;
+	WMI::ProcessRateTracker::RatesCollection rates;
+
+	for (uint32 id = 4; id <= 4000; id += 4)
+		snapshot.push_back(counters(id, id, 0, 0));
+
+	tracker.update(ONE_SECOND, snapshot, rates);
+
+	TEST_TRUE(tracker.size() == 1000);
+
+	snapshot.resize(10);
+	tracker.update(2 * ONE_SECOND, snapshot, rates);
+
+	TEST_TRUE(tracker.size() == 10);
+	TEST_TRUE(rates.size() == 10);
+	TEST_TRUE(rates[9].m_valid);
+
+	snapshot.resize(1000, counters(4000, 4000, 0, 0));
+	tracker.update(3 * ONE_SECOND, snapshot, rates);
+
+	TEST_FALSE(rates[999].m_valid);
+	TEST_TRUE(tracker.reusedIds() == 0);
+}
+TEST_CASE_END
+
+TEST_CASE("the counters are read from a Win32_Process object")
+{
+	WMI::MemoryObject*       object = new WMI::MemoryObject(TXT("Win32_Process"));
+	WMI::IWbemClassObjectPtr instance = object->getInterface();
+
+	object->setProperty(TXT("ProcessId"), 1234, CIM_UINT32, true);
+	object->setProperty(TXT("CreationDate"), TXT("20010203040506.123456+060"), CIM_DATETIME);
+	object->setProperty(TXT("KernelModeTime"), TXT("100"), CIM_UINT64);
+	object->setProperty(TXT("UserModeTime"), TXT("200"), CIM_UINT64);
+	object->setProperty(TXT("ReadTransferCount"), TXT("4096"), CIM_UINT64);
+	object->setProperty(TXT("WriteTransferCount"), TXT("8192"), CIM_UINT64);
+	object->setProperty(TXT("ReadOperationCount"), TXT("1"), CIM_UINT64);
+	object->setProperty(TXT("WriteOperationCount"), TXT("2"), CIM_UINT64);
+	object->setProperty(TXT("PageFaults"), 42, CIM_UINT32);
+
+	const WMI::ProcessRateTracker::Counters process = WMI::ProcessRateTracker::fromProcess(WMI::Object(instance, WMI::Connection()));
+
+	TEST_TRUE(process.m_processId == 1234);
+	TEST_TRUE(process.m_created != 0);
+	TEST_TRUE(process.m_created % 10000000 == 1234560);
+	TEST_TRUE(process.m_cpuTime == 300);
+	TEST_TRUE(process.m_ioBytes == 12288);
+	TEST_TRUE(process.m_ioOperations == 3);
+	TEST_TRUE(process.m_pageFaults == 42);
+}
+TEST_CASE_END
+
+TEST_CASE("the counters and their sample time are read from a Win32_PerfRawData_PerfProc_Process object")
+{
+	WMI::MemoryObject*       object = new WMI::MemoryObject(TXT("Win32_PerfRawData_PerfProc_Process"));
+	WMI::IWbemClassObjectPtr instance = object->getInterface();
+
+	object->setProperty(TXT("IDProcess"), 1234, CIM_UINT32, true);
+	object->setProperty(TXT("ElapsedTime"), TXT("5"), CIM_UINT64);
+	object->setProperty(TXT("PercentProcessorTime"), TXT("300"), CIM_UINT64);
+	object->setProperty(TXT("IODataBytesPersec"), TXT("12288"), CIM_UINT64);
+	object->setProperty(TXT("IODataOperationsPersec"), TXT("3"), CIM_UINT64);
+	object->setProperty(TXT("PageFaultsPersec"), 42, CIM_UINT32);
+	object->setProperty(TXT("Timestamp_Sys100NS"), TXT("130000000000"), CIM_UINT64);
+	object->setProperty(TXT("Frequency_Sys100NS"), TXT("10000000"), CIM_UINT64);
+
+	const WMI::ProcessRateTracker::Counters process = WMI::ProcessRateTracker::fromPerfRawData(WMI::Object(instance, WMI::Connection()));
+
+	TEST_TRUE(process.m_processId == 1234);
+	TEST_TRUE(process.m_created == 5);
+	TEST_TRUE(process.m_cpuTime == 300);
+	TEST_TRUE(process.m_pageFaults == 42);
+	TEST_TRUE(process.m_timestamp == 130000000000ULL);
+	TEST_TRUE(process.m_frequency == 10000000);
+}
+TEST_CASE_END
+
+}
+TEST_SET_END
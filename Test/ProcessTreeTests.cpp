@@ -0,0 +1,238 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   ProcessTreeTests.cpp
+//! \brief  The unit tests for the ProcessTree class.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include <Core/UnitTest.hpp>
+#include <WMI/ProcessTree.hpp>
+#include <WMI/Connection.hpp>
+#include <WMI/Object.hpp>
+#include <WMI/MemoryObject.hpp>
+#include <WMI/ReplayServices.hpp>
+
+////////////////////////////////////////////////////////////////////////////////
+//! Create the identity of a process.
+
+static WMI::ProcessTree::Process process(uint32 processId, uint32 parentId, uint64 created)
+{
+	WMI::ProcessTree::Process result = { processId, parentId, created };
+
+	return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Create a Win32_Process object with just the properties the tree queries.
+
+static WMI::IWbemClassObjectPtr createProcess(int32 processId, int32 parentId, const tchar* created)
+{
+	WMI::MemoryObject*       object = new WMI::MemoryObject(TXT("Win32_Process"));
+	WMI::IWbemClassObjectPtr instance = object->getInterface();
+
+	object->setProperty(TXT("ProcessId"), processId, CIM_UINT32, true);
+	object->setProperty(TXT("ParentProcessId"), parentId, CIM_UINT32);
+	object->setProperty(TXT("CreationDate"), created, CIM_DATETIME);
+
+	return instance;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Record fetching a process by path and, if it is still the same process,
+//! terminating it successfully via the path the fetched object reports.
+
+static void addTermination(WMI::RecordingPtr recording, int32 processId, const tchar* created)
+{
+	const tstring path = Core::fmt(TXT("Win32_Process.Handle=\"%d\""), processId);
+	const size_t  get = recording->addCall(WMI::Recording::GET_OBJECT, path, TXT(""), WBEM_S_NO_ERROR, 0);
+
+	recording->addObject(get, createProcess(processId, 0, created), 0);
+
+	WMI::MemoryObject*       output = new WMI::MemoryObject(TXT("__PARAMETERS"));
+	WMI::IWbemClassObjectPtr outParams = output->getInterface();
+
+	output->setProperty(TXT("ReturnValue"), 0, CIM_UINT32);
+
+	const tstring relativePath = Core::fmt(TXT("Win32_Process.ProcessId=%d"), processId);
+	const size_t  method = recording->addCall(WMI::Recording::EXEC_METHOD, relativePath, TXT("Terminate"), WBEM_S_NO_ERROR, 0);
+
+	recording->addObject(method, outParams, 0);
+}
+
+TEST_SET(ProcessTree)
+{
+
+TEST_CASE("a process's subtree lists every descendant with each parent ahead of its children")
+{
+	WMI::ProcessTree             tree;
+	WMI::ProcessTree::Processes  processes;
+	WMI::ProcessTree::ProcessIds ids;
+
+	processes.push_back(process(40, 8, 4));
+	processes.push_back(process(8, 4, 2));
+	processes.push_back(process(4, 0, 1));
+	processes.push_back(process(12, 4, 3));
+	processes.push_back(process(16, 8, 5));
+	processes.push_back(process(20, 16, 6));
+	processes.push_back(process(0, 0, 0));
+
+	tree.build(processes);
+
+	TEST_TRUE(tree.size() == 7);
+	TEST_TRUE(tree.contains(20));
+	TEST_FALSE(tree.contains(24));
+
+	tree.children(8, ids);
+
+	TEST_TRUE(ids.size() == 2);
+	TEST_TRUE( (ids[0] == 16) && (ids[1] == 40) );
+
+	tree.subtree(8, ids);
+
+	TEST_TRUE(ids.size() == 4);
+	TEST_TRUE( (ids[0] == 8) && (ids[1] == 16) && (ids[2] == 20) && (ids[3] == 40) );
+
+	tree.subtree(0, ids);
+
+	TEST_TRUE(ids.size() == 7);
+	TEST_TRUE(ids[0] == 0);
+
+	tree.subtree(24, ids);
+
+	TEST_TRUE(ids.empty());
+}
+TEST_CASE_END
+
+TEST_CASE("a process whose parent ID now belongs to a newer process is not adopted by it")
+{
+	WMI::ProcessTree             tree;
+	WMI::ProcessTree::Processes  processes;
+	WMI::ProcessTree::ProcessIds ids;
+
+	processes.push_back(process(100, 4, 10));
+	processes.push_back(process(200, 100, 20));
+	processes.push_back(process(300, 400, 30));
+	processes.push_back(process(400, 4, 40));
+	processes.push_back(process(400, 4, 40));
+
+	tree.build(processes);
+
+	TEST_TRUE(tree.size() == 4);
+	TEST_TRUE(tree.reusedIds() == 1);
+
+	tree.subtree(400, ids);
+
+	TEST_TRUE(ids.size() == 1);
+
+	tree.subtree(100, ids);
+
+	TEST_TRUE(ids.size() == 2);
+}
+TEST_CASE_END
+
+TEST_CASE("the tree is built from a single query of the processes")
+{
+	WMI::RecordingPtr recording(new WMI::Recording);
+
+	const size_t query = recording->addCall(WMI::Recording::EXEC_QUERY, WMI::ProcessTree::QUERY, TXT(""), WBEM_S_NO_ERROR, 0);
+
+	recording->addObject(query, createProcess(4, 0, TXT("20010203040506.000001+060")), 0);
+	recording->addObject(query, createProcess(8, 4, TXT("20010203040506.000002+060")), 0);
+	recording->addObject(query, createProcess(12, 8, TXT("20010203040506.000003+060")), 0);
+	recording->addObject(query, createProcess(16, 12, TXT("20010203040506.000001+060")), 0);
+
+	WMI::Connection connection;
+
+	connection.open((new WMI::ReplayServices(recording, false))->getInterface());
+
+	WMI::ProcessTree             tree;
+	WMI::ProcessTree::ProcessIds ids;
+
+	tree.build(connection);
+
+	TEST_TRUE(tree.size() == 4);
+	TEST_TRUE(tree.reusedIds() == 1);
+
+	tree.subtree(4, ids);
+
+	TEST_TRUE(ids.size() == 3);
+	TEST_TRUE(ids[2] == 12);
+}
+TEST_CASE_END
+
+TEST_CASE("a cycle of processes with the same creation time lists each process once")
+{
+	WMI::ProcessTree             tree;
+	WMI::ProcessTree::Processes  processes;
+	WMI::ProcessTree::ProcessIds ids;
+
+	processes.push_back(process(0, 0, 0));
+	processes.push_back(process(4, 0, 1));
+	processes.push_back(process(10, 20, 5));
+	processes.push_back(process(20, 10, 5));
+
+	tree.build(processes);
+	tree.subtree(10, ids);
+
+	TEST_TRUE(ids.size() == 2);
+	TEST_TRUE( (ids[0] == 10) && (ids[1] == 20) );
+}
+TEST_CASE_END
+
+TEST_CASE("a process whose ID has been reused since the tree was built is not terminated")
+{
+	const tchar* PARENT_CREATED = TXT("20010203040506.000001+060");
+	const tchar* CHILD_CREATED = TXT("20010203040506.000002+060");
+	const tchar* REUSED_CREATED = TXT("20010203040506.000003+060");
+
+	WMI::MemoryObject*       arguments = new WMI::MemoryObject(TXT("__PARAMETERS"));
+	WMI::IWbemClassObjectPtr inParams = arguments->getInterface();
+	WMI::MemoryObject*       definition = new WMI::MemoryObject(TXT("Win32_Process"));
+	WMI::IWbemClassObjectPtr processClass = definition->getInterface();
+	WMI::RecordingPtr        recording(new WMI::Recording);
+
+	arguments->setProperty(TXT("Reason"), 0, CIM_UINT32);
+	definition->setMethod(TXT("Terminate"), inParams);
+
+	const size_t get = recording->addCall(WMI::Recording::GET_OBJECT, TXT("Win32_Process"), TXT(""), WBEM_S_NO_ERROR, 0);
+
+	recording->addObject(get, processClass, 0);
+
+	addTermination(recording, 4, PARENT_CREATED);
+	addTermination(recording, 8, REUSED_CREATED);
+
+	WMI::Connection connection;
+
+	connection.open((new WMI::ReplayServices(recording, false))->getInterface());
+
+	WMI::ProcessTree               tree;
+	WMI::ProcessTree::Processes    processes;
+	WMI::ProcessTree::Terminations terminations;
+
+	processes.push_back(WMI::ProcessTree::fromProcess(WMI::Object(createProcess(4, 0, PARENT_CREATED), connection)));
+	processes.push_back(WMI::ProcessTree::fromProcess(WMI::Object(createProcess(8, 4, CHILD_CREATED), connection)));
+
+	tree.build(processes);
+
+	TEST_TRUE(tree.terminate(connection, 4, 1, terminations) == 1);
+	TEST_TRUE(terminations.size() == 2);
+	TEST_TRUE( (terminations[0].m_processId == 4) && (terminations[0].m_result == S_OK) );
+	TEST_TRUE( (terminations[1].m_processId == 8) && (terminations[1].m_result == WBEM_E_NOT_FOUND) );
+}
+TEST_CASE_END
+
+TEST_CASE("terminating a process that is not in the tree makes no calls")
+{
+	WMI::Connection connection;
+
+	connection.open((new WMI::ReplayServices(WMI::RecordingPtr(new WMI::Recording), false))->getInterface());
+
+	WMI::ProcessTree               tree;
+	WMI::ProcessTree::Terminations terminations;
+
+	TEST_TRUE(tree.terminate(connection, 4, 1, terminations) == 0);
+	TEST_TRUE(terminations.empty());
+}
+TEST_CASE_END
+
+}
+TEST_SET_END
@@ -0,0 +1,191 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   RecordReplayTests.cpp
+//! \brief  The unit tests for the RecordingServices and ReplayServices classes.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include <Core/UnitTest.hpp>
+#include <WMI/Recording.hpp>
+#include <WMI/RecordingServices.hpp>
+#include <WMI/ReplayServices.hpp>
+#include <WMI/MemoryObject.hpp>
+#include <WMI/Connection.hpp>
+#include <WMI/Object.hpp>
+#include <WMI/ObjectIterator.hpp>
+
+//! The file used for the recordings.
+static const tchar* RECORDING_FILE = TXT("RecordReplayTests.wmir");
+
+//! The query used for the recorded calls.
+static const tchar* QUERY = TXT("SELECT * FROM Test_Class");
+
+////////////////////////////////////////////////////////////////////////////////
+//! Create an in-memory object with a key and a value property.
+
+static WMI::IWbemClassObjectPtr createObject(int32 id, const tstring& name)
+{
+	WMI::MemoryObject* object = new WMI::MemoryObject(TXT("Test_Class"));
+	WMI::IWbemClassObjectPtr result = object->getInterface();
+
+	object->setProperty(TXT("Id"), id, CIM_SINT32, true);
+	object->setProperty(TXT("Name"), name);
+
+	return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Create a recording of a query, an object fetch and a method call.
+
+static WMI::RecordingPtr createRecording()
+{
+	WMI::RecordingPtr recording(new WMI::Recording);
+
+	const size_t query = recording->addCall(WMI::Recording::EXEC_QUERY, QUERY, TXT(""), WBEM_S_NO_ERROR, 100);
+
+	recording->addObject(query, createObject(1, TXT("one")), 10);
+	recording->addObject(query, createObject(2, TXT("two")), 10);
+
+	const size_t get = recording->addCall(WMI::Recording::GET_OBJECT, TXT("Test_Class.Id=1"), TXT(""), WBEM_S_NO_ERROR, 100);
+
+	recording->addObject(get, createObject(1, TXT("one")), 0);
+
+	WMI::MemoryObject*       output = new WMI::MemoryObject(TXT("__PARAMETERS"));
+	WMI::IWbemClassObjectPtr outParams = output->getInterface();
+
+	output->setProperty(TXT("ReturnValue"), 42, CIM_UINT32);
+
+	const size_t method = recording->addCall(WMI::Recording::EXEC_METHOD, TXT("Test_Class.Id=1"), TXT("Reset"), WBEM_S_NO_ERROR, 100);
+
+	recording->addObject(method, outParams, 0);
+
+	return recording;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Read the Name property of each object returned by the recorded query.
+
+static tstring queryNames(WMI::Connection& connection)
+{
+	tstring             names;
+	WMI::ObjectIterator it = connection.execQuery(QUERY);
+	WMI::ObjectIterator end;
+
+	for (; it != end; ++it)
+		names += it->getProperty<tstring>(TXT("Name")) + TXT(";");
+
+	return names;
+}
+
+TEST_SET(RecordReplay)
+{
+
+TEST_CASE_TEARDOWN()
+{
+	::DeleteFile(RECORDING_FILE);
+}
+TEST_CASE_TEARDOWN_END
+
+TEST_CASE("a replay serves the recorded query, object and method results")
+{
+	WMI::Connection connection;
+
+	connection.open((new WMI::ReplayServices(createRecording(), false))->getInterface());
+
+	TEST_TRUE(queryNames(connection) == TXT("one;two;"));
+
+	WMI::Object object = connection.getObject(TXT("Test_Class.Id=1"));
+
+	TEST_TRUE(object.getProperty<tstring>(TXT("Name")) == TXT("one"));
+
+	WCL::Variant returnValue;
+
+	WMI::Connection::execMethod(connection.get(), object.get(), TXT("Test_Class.Id=1"), TXT("Reset"), returnValue);
+
+	TEST_TRUE(V_VT(&returnValue) == VT_I4);
+	TEST_TRUE(V_I4(&returnValue) == 42);
+}
+TEST_CASE_END
+
+TEST_CASE("a call that was not recorded fails")
+{
+	WMI::Connection connection;
+
+	connection.open((new WMI::ReplayServices(createRecording(), false))->getInterface());
+
+	TEST_THROWS(connection.execQuery(TXT("SELECT * FROM Other_Class")));
+	TEST_THROWS(connection.getObject(TXT("Test_Class.Id=2")));
+}
+TEST_CASE_END
+
+TEST_CASE("repeated calls are served in the order recorded and then repeat")
+{
+	WMI::RecordingPtr recording(new WMI::Recording);
+
+	const size_t first = recording->addCall(WMI::Recording::GET_OBJECT, TXT("Test_Class.Id=1"), TXT(""), WBEM_S_NO_ERROR, 0);
+	recording->addObject(first, createObject(1, TXT("before")), 0);
+
+	const size_t second = recording->addCall(WMI::Recording::GET_OBJECT, TXT("Test_Class.Id=1"), TXT(""), WBEM_S_NO_ERROR, 0);
+	recording->addObject(second, createObject(1, TXT("after")), 0);
+
+	WMI::Connection connection;
+
+	connection.open((new WMI::ReplayServices(recording, false))->getInterface());
+
+	TEST_TRUE(connection.getObject(TXT("Test_Class.Id=1")).getProperty<tstring>(TXT("Name")) == TXT("before"));
+	TEST_TRUE(connection.getObject(TXT("Test_Class.Id=1")).getProperty<tstring>(TXT("Name")) == TXT("after"));
+	TEST_TRUE(connection.getObject(TXT("Test_Class.Id=1")).getProperty<tstring>(TXT("Name")) == TXT("before"));
+}
+TEST_CASE_END
+
+TEST_CASE("a recorded session can be saved, loaded and replayed")
+{
+	WMI::RecordingPtr recording(new WMI::Recording);
+
+	{
+		WMI::IWbemServicesPtr provider = (new WMI::ReplayServices(createRecording(), false))->getInterface();
+		WMI::Connection       connection;
+
+		connection.open((new WMI::RecordingServices(provider, recording))->getInterface());
+
+		TEST_TRUE(queryNames(connection) == TXT("one;two;"));
+		TEST_TRUE(connection.getObject(TXT("Test_Class.Id=1")).getProperty<tstring>(TXT("Name")) == TXT("one"));
+	}
+
+	TEST_TRUE(recording->calls().size() == 2);
+	TEST_TRUE(recording->calls()[0].m_objects.size() == 2);
+
+	recording->save(RECORDING_FILE);
+
+	WMI::RecordingPtr loaded(new WMI::Recording);
+
+	loaded->load(RECORDING_FILE);
+
+	TEST_TRUE(loaded->calls().size() == 2);
+	TEST_TRUE(loaded->calls()[0].m_operation == WMI::Recording::EXEC_QUERY);
+	TEST_TRUE(loaded->calls()[0].m_target == QUERY);
+	TEST_TRUE(loaded->calls()[0].m_latencies.size() == 2);
+
+	WMI::Connection connection;
+
+	connection.open((new WMI::ReplayServices(loaded, true))->getInterface());
+
+	TEST_TRUE(queryNames(connection) == TXT("one;two;"));
+
+	WMI::Object object = connection.getObject(TXT("Test_Class.Id=1"));
+
+	TEST_TRUE(object.getProperty<tstring>(TXT("Name")) == TXT("one"));
+	TEST_TRUE(object.getProperty<int32>(TXT("Id")) == 1);
+	TEST_TRUE(object.relativePath() == TXT("Test_Class.Id=1"));
+}
+TEST_CASE_END
+
+TEST_CASE("loading a file that is not a recording fails")
+{
+	WMI::Recording recording;
+
+	TEST_THROWS(recording.load(TXT("RecordReplayTests.missing")));
+}
+TEST_CASE_END
+
+}
+TEST_SET_END
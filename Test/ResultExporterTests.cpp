@@ -0,0 +1,244 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   ResultExporterTests.cpp
+//! \brief  The unit tests for the ResultExporter class.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include <Core/UnitTest.hpp>
+#include <WMI/ResultExporter.hpp>
+#include <WMI/MemoryObject.hpp>
+#include <WMI/MemoryEnumerator.hpp>
+#include <WMI/Connection.hpp>
+#include "StringWriter.hpp"
+#include <locale.h>
+
+static WMI::Connection s_connection;
+
+////////////////////////////////////////////////////////////////////////////////
+//! Create an in-memory object with a key and a value property.
+
+static WMI::IWbemClassObjectPtr createObject(int32 id, const tstring& name)
+{
+	WMI::MemoryObject* object = new WMI::MemoryObject(TXT("Test_Class"));
+	WMI::IWbemClassObjectPtr result = object->getInterface();
+
+	object->setProperty(TXT("Id"), id, CIM_SINT32, true);
+	object->setProperty(TXT("Name"), name);
+
+	return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Create an iterator over a sequence of in-memory objects.
+
+static WMI::ObjectIterator createIterator(const WMI::MemoryEnumerator::Objects& objects)
+{
+	WMI::MemoryEnumerator* enumerator = new WMI::MemoryEnumerator(objects);
+
+	return WMI::ObjectIterator(enumerator->getInterface(), s_connection);
+}
+
+TEST_SET(ResultExporter)
+{
+
+TEST_CASE("CSV output has a header row followed by one row per object")
+{
+	WMI::MemoryEnumerator::Objects objects;
+
+	objects.push_back(createObject(1, TXT("one")));
+	objects.push_back(createObject(2, TXT("two")));
+
+	StringWriter         writer;
+	WMI::ResultExporter  exporter(writer, WMI::ResultExporter::CSV);
+
+	const size_t rows = exporter.writeAll(createIterator(objects));
+
+	TEST_TRUE(rows == 2);
+	TEST_TRUE(exporter.rowCount() == 2);
+	TEST_TRUE(writer.output() == "Id,Name\r\n1,one\r\n2,two\r\n");
+}
+TEST_CASE_END
+
+TEST_CASE("NDJSON output has one object per line")
+{
+	WMI::MemoryEnumerator::Objects objects;
+
+	objects.push_back(createObject(1, TXT("one")));
+	objects.push_back(createObject(2, TXT("two")));
+
+	StringWriter         writer;
+	WMI::ResultExporter  exporter(writer, WMI::ResultExporter::NDJSON);
+
+	exporter.writeAll(createIterator(objects));
+
+	TEST_TRUE(writer.output() == "{\"Id\":1,\"Name\":\"one\"}\n{\"Id\":2,\"Name\":\"two\"}\n");
+}
+TEST_CASE_END
+
+TEST_CASE("only the requested columns are exported and missing properties are written as null")
+{
+	WMI::MemoryEnumerator::Objects objects;
+
+	objects.push_back(createObject(1, TXT("one")));
+
+	WMI::ResultExporter::Columns columns;
+
+	columns.push_back(TXT("Name"));
+	columns.push_back(TXT("Missing"));
+
+	StringWriter         csv;
+	WMI::ResultExporter  csvExporter(csv, WMI::ResultExporter::CSV, columns);
+
+	csvExporter.writeAll(createIterator(objects));
+
+	TEST_TRUE(csv.output() == "Name,Missing\r\none,\r\n");
+
+	StringWriter         json;
+	WMI::ResultExporter  jsonExporter(json, WMI::ResultExporter::NDJSON, columns);
+
+	jsonExporter.writeAll(createIterator(objects));
+
+	TEST_TRUE(json.output() == "{\"Name\":\"one\",\"Missing\":null}\n");
+}
+TEST_CASE_END
+
+TEST_CASE("a CSV header is written for an empty result when the columns are known")
+{
+	WMI::MemoryEnumerator::Objects objects;
+	WMI::ResultExporter::Columns   columns;
+
+	columns.push_back(TXT("Name"));
+
+	StringWriter         writer;
+	WMI::ResultExporter  exporter(writer, WMI::ResultExporter::CSV, columns);
+
+	TEST_TRUE(exporter.writeAll(createIterator(objects)) == 0);
+	TEST_TRUE(writer.output() == "Name\r\n");
+}
+TEST_CASE_END
+
+TEST_CASE("strings are quoted and escaped as required by the format")
+{
+	WMI::MemoryEnumerator::Objects objects;
+
+	objects.push_back(createObject(1, TXT("a,\"b\"\nc\\")));
+
+	StringWriter         csv;
+	WMI::ResultExporter  csvExporter(csv, WMI::ResultExporter::CSV);
+
+	csvExporter.writeAll(createIterator(objects));
+
+	TEST_TRUE(csv.output() == "Id,Name\r\n1,\"a,\"\"b\"\"\nc\\\"\r\n");
+
+	StringWriter         json;
+	WMI::ResultExporter  jsonExporter(json, WMI::ResultExporter::NDJSON);
+
+	jsonExporter.writeAll(createIterator(objects));
+
+	TEST_TRUE(json.output() == "{\"Id\":1,\"Name\":\"a,\\\"b\\\"\\nc\\\\\"}\n");
+}
+TEST_CASE_END
+
+TEST_CASE("64-bit integers are written as numbers and datetimes in ISO 8601 format")
+{
+	WMI::MemoryObject* object = new WMI::MemoryObject(TXT("Test_Class"));
+	WMI::MemoryEnumerator::Objects objects;
+
+	objects.push_back(object->getInterface());
+
+	object->setProperty(TXT("Size"), TXT("18446744073709551615"), CIM_UINT64);
+	object->setProperty(TXT("Started"), TXT("20010203040506.123456-090"), CIM_DATETIME);
+
+	StringWriter         writer;
+	WMI::ResultExporter  exporter(writer, WMI::ResultExporter::NDJSON);
+
+	exporter.writeAll(createIterator(objects));
+
+	TEST_TRUE(writer.output() == "{\"Size\":18446744073709551615,\"Started\":\"2001-02-03T04:05:06.123456-01:30\"}\n");
+}
+TEST_CASE_END
+
+TEST_CASE("reals are written with a '.' decimal point whatever the host's locale")
+{
+	WMI::MemoryObject* object = new WMI::MemoryObject(TXT("Test_Class"));
+	WMI::MemoryEnumerator::Objects objects;
+	WCL::Variant value;
+
+	objects.push_back(object->getInterface());
+
+	V_VT(&value) = VT_R8;
+	V_R8(&value) = 1.5;
+
+	object->setProperty(TXT("Ratio"), value, CIM_REAL64);
+
+	StringWriter         writer;
+	WMI::ResultExporter  exporter(writer, WMI::ResultExporter::NDJSON);
+
+	const bool localised = (setlocale(LC_ALL, "de-DE") != nullptr);
+
+	exporter.writeAll(createIterator(objects));
+
+	if (localised)
+		setlocale(LC_ALL, "C");
+
+	TEST_TRUE(writer.output() == "{\"Ratio\":1.5}\n");
+}
+TEST_CASE_END
+
+TEST_CASE("arrays are written as a JSON array or a single CSV field")
+{
+	WMI::MemoryObject* object = new WMI::MemoryObject(TXT("Test_Class"));
+	WMI::MemoryEnumerator::Objects objects;
+
+	objects.push_back(object->getInterface());
+
+	WCL::Variant values;
+
+	V_VT(&values) = VT_ARRAY | VT_I4;
+	V_ARRAY(&values) = ::SafeArrayCreateVector(VT_I4, 0, 3);
+
+	for (LONG i = 0; i != 3; ++i)
+	{
+		LONG value = i + 1;
+
+		::SafeArrayPutElement(V_ARRAY(&values), &i, &value);
+	}
+
+	object->setProperty(TXT("Values"), values, CIM_SINT32 | CIM_FLAG_ARRAY);
+
+	StringWriter         csv;
+	WMI::ResultExporter  csvExporter(csv, WMI::ResultExporter::CSV);
+
+	csvExporter.writeAll(createIterator(objects));
+
+	TEST_TRUE(csv.output() == "Values\r\n\"1;2;3\"\r\n");
+
+	StringWriter         json;
+	WMI::ResultExporter  jsonExporter(json, WMI::ResultExporter::NDJSON);
+
+	jsonExporter.writeAll(createIterator(objects));
+
+	TEST_TRUE(json.output() == "{\"Values\":[1,2,3]}\n");
+}
+TEST_CASE_END
+
+TEST_CASE("the output is streamed through the writer's buffer")
+{
+	WMI::MemoryEnumerator::Objects objects;
+
+	objects.push_back(createObject(1, TXT("one")));
+
+	WMI::MemoryEnumerator* enumerator = new WMI::MemoryEnumerator(objects, 10000);
+	WMI::ObjectIterator    it(enumerator->getInterface(), s_connection);
+
+	StringWriter         writer(1024);
+	WMI::ResultExporter  exporter(writer, WMI::ResultExporter::NDJSON);
+
+	TEST_TRUE(exporter.writeAll(it) == 10000);
+	TEST_TRUE(writer.blocks() > 1);
+	TEST_TRUE(writer.bytesWritten() == writer.output().length());
+}
+TEST_CASE_END
+
+}
+TEST_SET_END
@@ -0,0 +1,46 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   ResultTests.cpp
+//! \brief  The unit tests for the Result class.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include <Core/UnitTest.hpp>
+#include <WMI/Result.hpp>
+
+TEST_SET(Result)
+{
+
+TEST_CASE("a successful result holds the value")
+{
+	const WMI::Result<int> result = WMI::Result<int>::success(42);
+
+	TEST_TRUE(result.succeeded());
+	TEST_FALSE(result.failed());
+	TEST_TRUE(result.result() == S_OK);
+	TEST_TRUE(result.value() == 42);
+	TEST_TRUE(result.valueOr(0) == 42);
+}
+TEST_CASE_END
+
+TEST_CASE("a failed result holds the error")
+{
+	const WMI::Result<int> result = WMI::Result<int>::failure(E_FAIL);
+
+	TEST_FALSE(result.succeeded());
+	TEST_TRUE(result.failed());
+	TEST_TRUE(result.result() == E_FAIL);
+	TEST_TRUE(result.valueOr(-1) == -1);
+}
+TEST_CASE_END
+
+TEST_CASE("a success code other than S_OK is a successful result")
+{
+	const WMI::Result<int> result(S_FALSE, 42);
+
+	TEST_TRUE(result.succeeded());
+	TEST_TRUE(result.value() == 42);
+}
+TEST_CASE_END
+
+}
+TEST_SET_END
@@ -0,0 +1,244 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   RetryPolicyTests.cpp
+//! \brief  The unit tests for the RetryPolicy class and connection retries.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include <Core/UnitTest.hpp>
+#include <WMI/RetryPolicy.hpp>
+#include <WMI/Connection.hpp>
+#include <WMI/Object.hpp>
+#include <WMI/MemoryLocator.hpp>
+#include <WMI/MemoryObject.hpp>
+#include <WMI/ReplayServices.hpp>
+#include <WMI/Exception.hpp>
+
+//! The path of the object served by the provider.
+static const tchar* PATH = TXT("Test_Class.Id=1");
+
+////////////////////////////////////////////////////////////////////////////////
+//! Add the object to a recorded call.
+
+static void addObject(WMI::RecordingPtr recording, size_t call)
+{
+	WMI::MemoryObject*       object = new WMI::MemoryObject(TXT("Test_Class"));
+	WMI::IWbemClassObjectPtr instance = object->getInterface();
+
+	object->setProperty(TXT("Id"), 1, CIM_SINT32, true);
+
+	recording->addObject(call, instance, 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Create a provider that returns each of the results in turn when getting the
+//! object and then succeeds.
+
+static WMI::IWbemServicesPtr createProvider(const HRESULT* results, size_t count)
+{
+	WMI::RecordingPtr recording(new WMI::Recording);
+
+	for (size_t i = 0; i != count; ++i)
+	{
+		const size_t call = recording->addCall(WMI::Recording::GET_OBJECT, PATH, TXT(""), results[i], 0);
+
+		if (SUCCEEDED(results[i]))
+			addObject(recording, call);
+	}
+
+	addObject(recording, recording->addCall(WMI::Recording::GET_OBJECT, PATH, TXT(""), WBEM_S_NO_ERROR, 0));
+
+	WMI::ReplayServices* provider = new WMI::ReplayServices(recording, false);
+
+	return provider->getInterface();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Open a connection to the provider through a fake locator, so that it can be
+//! re-opened, with a fast retry policy and statistics.
+
+static void openConnection(WMI::Connection& connection, WMI::MemoryLocator*& locator, const HRESULT* results, size_t count, size_t maxRetries)
+{
+	locator = new WMI::MemoryLocator;
+
+	WMI::IWbemLocatorPtr keepAlive = locator->getInterface();
+
+	locator->addNamespace(TXT("\\\\HOST\\root\\cimv2"), createProvider(results, count), 0);
+
+	connection.setLocator(keepAlive);
+	connection.setStats(WMI::ConnectionStatsPtr(new WMI::ConnectionStats));
+	connection.setRetryPolicy(WMI::RetryPolicyPtr(new WMI::RetryPolicy(maxRetries, 1, 10, 5000)));
+	connection.open(TXT("HOST"));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the number of times an event has been recorded for a connection.
+
+static uint64 eventCount(const WMI::Connection& connection, WMI::ConnectionStats::Event event)
+{
+	WMI::ConnectionStats::Snapshot snapshot;
+
+	connection.stats()->snapshot(snapshot);
+
+	return snapshot.m_events[event];
+}
+
+TEST_SET(RetryPolicy)
+{
+
+TEST_CASE("a lost connection is distinguished from a busy host and from other failures")
+{
+	TEST_TRUE(WMI::RetryPolicy::classify(HRESULT_FROM_WIN32(RPC_S_SERVER_UNAVAILABLE)) == WMI::RetryPolicy::DISCONNECTED);
+	TEST_TRUE(WMI::RetryPolicy::classify(WBEM_E_TRANSPORT_FAILURE) == WMI::RetryPolicy::DISCONNECTED);
+	TEST_TRUE(WMI::RetryPolicy::classify(RPC_E_DISCONNECTED) == WMI::RetryPolicy::DISCONNECTED);
+	TEST_TRUE(WMI::RetryPolicy::classify(WBEM_E_SERVER_TOO_BUSY) == WMI::RetryPolicy::TRANSIENT);
+	TEST_TRUE(WMI::RetryPolicy::classify(RPC_E_CALL_REJECTED) == WMI::RetryPolicy::TRANSIENT);
+	TEST_TRUE(WMI::RetryPolicy::classify(WBEM_E_NOT_FOUND) == WMI::RetryPolicy::PERMANENT);
+	TEST_TRUE(WMI::RetryPolicy::classify(WBEM_E_ACCESS_DENIED) == WMI::RetryPolicy::PERMANENT);
+	TEST_TRUE(WMI::RetryPolicy::classify(E_FAIL) == WMI::RetryPolicy::PERMANENT);
+}
+TEST_CASE_END
+
+TEST_CASE("the delay doubles with each retry and is jittered between half and all of it")
+{
+	const WMI::RetryPolicy policy(10, 100, 1000, 30000);
+
+	TEST_TRUE(policy.delay(0, 0.0) == 50);
+	TEST_TRUE(policy.delay(0, 0.999) == 100);
+	TEST_TRUE(policy.delay(1, 0.0) == 100);
+	TEST_TRUE(policy.delay(1, 0.999) == 200);
+	TEST_TRUE(policy.delay(2, 0.0) == 200);
+
+	for (size_t retry = 0; retry != 10; ++retry)
+	{
+		const uint delay = policy.delay(retry);
+
+		TEST_TRUE((delay >= 50) && (delay <= 1000));
+	}
+}
+TEST_CASE_END
+
+TEST_CASE("the delay is capped at the maximum")
+{
+	const WMI::RetryPolicy policy(10, 100, 1000, 30000);
+
+	TEST_TRUE(policy.delay(9, 0.0) == 500);
+	TEST_TRUE(policy.delay(9, 0.999) == 1000);
+}
+TEST_CASE_END
+
+TEST_CASE("the jitter varies between retries and stays between half and all of the delay")
+{
+	const WMI::RetryPolicy policy(10, 1000, 1000, 30000);
+
+	const uint first = policy.delay(0);
+	bool varied = false;
+
+	for (size_t i = 0; i != 100; ++i)
+	{
+		const uint delay = policy.delay(0);
+
+		TEST_TRUE( (delay >= 500) && (delay <= 1000) );
+
+		if (delay != first)
+			varied = true;
+	}
+
+	TEST_TRUE(varied);
+}
+TEST_CASE_END
+
+TEST_CASE("a call is retried after reconnecting when the connection has been lost")
+{
+	const HRESULT results[] = { WBEM_E_TRANSPORT_FAILURE };
+
+	WMI::MemoryLocator* locator = nullptr;
+	WMI::Connection     connection;
+
+	openConnection(connection, locator, results, ARRAY_SIZE(results), 3);
+
+	const WMI::Object object = connection.getObject(PATH);
+
+	TEST_TRUE(object.getProperty<int32>(TXT("Id")) == 1);
+	TEST_TRUE(locator->attempts() == 2);
+	TEST_TRUE(eventCount(connection, WMI::ConnectionStats::RETRY) == 1);
+	TEST_TRUE(eventCount(connection, WMI::ConnectionStats::RECONNECT) == 1);
+}
+TEST_CASE_END
+
+TEST_CASE("a call is retried without reconnecting when the host is busy")
+{
+	const HRESULT results[] = { WBEM_E_SERVER_TOO_BUSY, WBEM_E_SERVER_TOO_BUSY };
+
+	WMI::MemoryLocator* locator = nullptr;
+	WMI::Connection     connection;
+
+	openConnection(connection, locator, results, ARRAY_SIZE(results), 3);
+
+	TEST_TRUE(connection.tryGetObject(PATH).succeeded());
+	TEST_TRUE(locator->attempts() == 1);
+	TEST_TRUE(eventCount(connection, WMI::ConnectionStats::RETRY) == 2);
+	TEST_TRUE(eventCount(connection, WMI::ConnectionStats::RECONNECT) == 0);
+}
+TEST_CASE_END
+
+TEST_CASE("a permanent failure is not retried")
+{
+	const HRESULT results[] = { WBEM_E_INVALID_CLASS };
+
+	WMI::MemoryLocator* locator = nullptr;
+	WMI::Connection     connection;
+
+	openConnection(connection, locator, results, ARRAY_SIZE(results), 3);
+
+	TEST_TRUE(connection.tryGetObject(PATH).result() == WBEM_E_INVALID_CLASS);
+	TEST_TRUE(eventCount(connection, WMI::ConnectionStats::RETRY) == 0);
+}
+TEST_CASE_END
+
+TEST_CASE("the retries for a call are limited by the policy")
+{
+	const HRESULT results[] = { WBEM_E_SERVER_TOO_BUSY, WBEM_E_SERVER_TOO_BUSY, WBEM_E_SERVER_TOO_BUSY };
+
+	WMI::MemoryLocator* locator = nullptr;
+	WMI::Connection     connection;
+
+	openConnection(connection, locator, results, ARRAY_SIZE(results), 2);
+
+	TEST_THROWS(connection.getObject(PATH));
+	TEST_TRUE(eventCount(connection, WMI::ConnectionStats::RETRY) == 2);
+}
+TEST_CASE_END
+
+TEST_CASE("refreshing an object retries after reconnecting when the connection has been lost")
+{
+	const HRESULT results[] = { WBEM_S_NO_ERROR, WBEM_E_TRANSPORT_FAILURE };
+
+	WMI::MemoryLocator* locator = nullptr;
+	WMI::Connection     connection;
+
+	openConnection(connection, locator, results, ARRAY_SIZE(results), 3);
+
+	WMI::Object object = connection.getObject(PATH);
+
+	object.refresh();
+
+	TEST_TRUE(object.getProperty<int32>(TXT("Id")) == 1);
+	TEST_TRUE(eventCount(connection, WMI::ConnectionStats::RECONNECT) == 1);
+}
+TEST_CASE_END
+
+TEST_CASE("a connection attached to an existing COM connection is not re-opened")
+{
+	const HRESULT results[] = { WBEM_E_TRANSPORT_FAILURE };
+
+	WMI::Connection connection;
+
+	connection.setRetryPolicy(WMI::RetryPolicyPtr(new WMI::RetryPolicy(3, 1, 10, 5000)));
+	connection.open(createProvider(results, ARRAY_SIZE(results)));
+
+	TEST_TRUE(connection.tryGetObject(PATH).result() == WBEM_E_TRANSPORT_FAILURE);
+}
+TEST_CASE_END
+
+}
+TEST_SET_END
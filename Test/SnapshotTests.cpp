@@ -0,0 +1,199 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   SnapshotTests.cpp
+//! \brief  The unit tests for the SnapshotWriter and SnapshotReader classes.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include <Core/UnitTest.hpp>
+#include <WMI/SnapshotWriter.hpp>
+#include <WMI/SnapshotReader.hpp>
+#include <WMI/MemoryObject.hpp>
+#include <WMI/MemoryEnumerator.hpp>
+#include <WMI/Win32_Process.hpp>
+#include <WMI/FileWriter.hpp>
+
+static WMI::Connection s_connection;
+
+//! The file used for the snapshots.
+static const tchar* SNAPSHOT_FILE = TXT("SnapshotTests.wmis");
+
+////////////////////////////////////////////////////////////////////////////////
+//! Create an in-memory process object.
+
+static WMI::IWbemClassObjectPtr createProcess(int32 id, const tstring& name, const tstring& workingSet)
+{
+	WMI::MemoryObject* object = new WMI::MemoryObject(TXT("Win32_Process"));
+	WMI::IWbemClassObjectPtr result = object->getInterface();
+
+	object->setProperty(TXT("Handle"), Core::fmt(TXT("%d"), id), CIM_STRING, true);
+	object->setProperty(TXT("ProcessId"), id, CIM_UINT32);
+	object->setProperty(TXT("Name"), name);
+	object->setProperty(TXT("WorkingSetSize"), workingSet, CIM_UINT64);
+
+	return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Write a snapshot of the objects to the test file.
+
+static void writeSnapshot(const WMI::MemoryEnumerator::Objects& objects)
+{
+	WMI::MemoryEnumerator* enumerator = new WMI::MemoryEnumerator(objects);
+	WMI::ObjectIterator    it(enumerator->getInterface(), s_connection);
+	WMI::ObjectIterator    end;
+
+	WMI::SnapshotWriter writer(TXT("Win32_Process"));
+
+	writer.addRows(it, end);
+	writer.save(SNAPSHOT_FILE);
+}
+
+TEST_SET(Snapshot)
+{
+
+TEST_CASE_TEARDOWN()
+{
+	::DeleteFile(SNAPSHOT_FILE);
+}
+TEST_CASE_TEARDOWN_END
+
+TEST_CASE("a snapshot can be read back with the same schema and values")
+{
+	WMI::MemoryEnumerator::Objects objects;
+
+	objects.push_back(createProcess(4, TXT("System"), TXT("65536")));
+	objects.push_back(createProcess(1234, TXT("explorer.exe"), TXT("18446744073709551615")));
+
+	writeSnapshot(objects);
+
+	WMI::SnapshotReader reader(SNAPSHOT_FILE);
+
+	TEST_TRUE(wcscmp(reader.className(), L"Win32_Process") == 0);
+	TEST_TRUE(reader.rowCount() == 2);
+	TEST_TRUE(reader.columnCount() == 4);
+
+	const size_t id = reader.findColumn(TXT("ProcessId"));
+	const size_t name = reader.findColumn(TXT("Name"));
+	const size_t workingSet = reader.findColumn(TXT("WorkingSetSize"));
+
+	TEST_TRUE(reader.columnType(id) == CIM_UINT32);
+	TEST_TRUE(reader.isKeyColumn(reader.findColumn(TXT("Handle"))));
+	TEST_FALSE(reader.isKeyColumn(id));
+
+	TEST_TRUE(reader.getUnsigned(0, id) == 4);
+	TEST_TRUE(reader.getUnsigned(1, id) == 1234);
+	TEST_TRUE(wcscmp(reader.getString(1, name), L"explorer.exe") == 0);
+	TEST_TRUE(reader.getUnsigned(1, workingSet) == 18446744073709551615ULL);
+}
+TEST_CASE_END
+
+TEST_CASE("missing and null properties are read back as nulls")
+{
+	WMI::MemoryEnumerator::Objects objects;
+
+	objects.push_back(createProcess(4, TXT("System"), TXT("65536")));
+
+	WMI::MemoryObject* object = new WMI::MemoryObject(TXT("Win32_Process"));
+
+	objects.push_back(object->getInterface());
+	object->setProperty(TXT("Handle"), TXT("8"), CIM_STRING, true);
+
+	writeSnapshot(objects);
+
+	WMI::SnapshotReader reader(SNAPSHOT_FILE);
+
+	const size_t name = reader.findColumn(TXT("Name"));
+
+	TEST_FALSE(reader.isNull(0, name));
+	TEST_TRUE(reader.isNull(1, name));
+	TEST_TRUE(wcscmp(reader.getString(1, name), L"") == 0);
+}
+TEST_CASE_END
+
+TEST_CASE("duplicate strings are stored once and returned without copying")
+{
+	WMI::MemoryEnumerator::Objects objects;
+
+	objects.push_back(createProcess(1, TXT("svchost.exe"), TXT("0")));
+	objects.push_back(createProcess(2, TXT("svchost.exe"), TXT("0")));
+
+	writeSnapshot(objects);
+
+	WMI::SnapshotReader reader(SNAPSHOT_FILE);
+
+	const size_t name = reader.findColumn(TXT("Name"));
+
+	TEST_TRUE(reader.getString(0, name) == reader.getString(1, name));
+}
+TEST_CASE_END
+
+TEST_CASE("requesting a value as the wrong type throws")
+{
+	WMI::MemoryEnumerator::Objects objects;
+
+	objects.push_back(createProcess(4, TXT("System"), TXT("65536")));
+
+	writeSnapshot(objects);
+
+	WMI::SnapshotReader reader(SNAPSHOT_FILE);
+
+	TEST_THROWS(reader.getSigned(0, reader.findColumn(TXT("Name"))));
+	TEST_THROWS(reader.findColumn(TXT("Missing")));
+}
+TEST_CASE_END
+
+TEST_CASE("a row can be materialised and used with the typed class")
+{
+	WMI::MemoryEnumerator::Objects objects;
+
+	objects.push_back(createProcess(1234, TXT("explorer.exe"), TXT("18446744073709551615")));
+
+	writeSnapshot(objects);
+
+	WMI::SnapshotReader reader(SNAPSHOT_FILE);
+	WMI::Win32_Process  process(reader.getObject(0), s_connection);
+
+	TEST_TRUE(process.ProcessId() == 1234);
+	TEST_TRUE(process.Name() == TXT("explorer.exe"));
+	TEST_TRUE(process.WorkingSetSize() == 18446744073709551615ULL);
+}
+TEST_CASE_END
+
+TEST_CASE("opening a file that is not a valid snapshot throws")
+{
+	{
+		WMI::FileWriter file(SNAPSHOT_FILE);
+
+		for (size_t i = 0; i != 16; ++i)
+			file.write("not a snapshot");
+	}
+
+	TEST_THROWS(WMI::SnapshotReader(SNAPSHOT_FILE).rowCount());
+}
+TEST_CASE_END
+
+TEST_CASE("a snapshot whose offsets wrap around when added to a size throws")
+{
+	WMI::SnapshotHeader header;
+
+	memset(&header, 0, sizeof(header));
+	memcpy(header.m_magic, WMI::SNAPSHOT_MAGIC, sizeof(header.m_magic));
+
+	header.m_version           = WMI::SNAPSHOT_VERSION;
+	header.m_headerSize        = sizeof(header);
+	header.m_stringCount       = 1;
+	header.m_stringTableOffset = 0xFFFFFFFFFFFFFFF8ULL;
+	header.m_fileSize          = sizeof(header);
+
+	{
+		WMI::FileWriter file(SNAPSHOT_FILE);
+
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	}
+
+	TEST_THROWS(WMI::SnapshotReader(SNAPSHOT_FILE).rowCount());
+}
+TEST_CASE_END
+
+}
+TEST_SET_END
@@ -0,0 +1,59 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   StringWriter.hpp
+//! \brief  The StringWriter class declaration.
+//! \author Chris Oldwood
+
+// Check for previous inclusion
+#ifndef APP_STRINGWRITER_HPP
+#define APP_STRINGWRITER_HPP
+
+#if _MSC_VER > 1000
+#pragma once
+#endif
+
+#include <WMI/BufferedWriter.hpp>
+#include <string>
+
+////////////////////////////////////////////////////////////////////////////////
+//! A BufferedWriter that collects its output in a string so that it can be
+//! inspected by the tests.
+
+class StringWriter : public WMI::BufferedWriter
+{
+public:
+	//! Constructor.
+	explicit StringWriter(size_t bufferSize = DEFAULT_BUFFER_SIZE)
+		: WMI::BufferedWriter(bufferSize)
+		, m_output()
+		, m_blocks(0)
+	{
+	}
+
+	//! Get the output flushed so far.
+	const std::string& output() const
+	{
+		return m_output;
+	}
+
+	//! Get the number of blocks flushed so far.
+	size_t blocks() const
+	{
+		return m_blocks;
+	}
+
+private:
+	//
+	// Members.
+	//
+	std::string	m_output;	//!< The output flushed so far.
+	size_t		m_blocks;	//!< The number of blocks flushed so far.
+
+	//! Write a block of output to the underlying destination.
+	virtual void writeBlock(const char* data, size_t length)
+	{
+		m_output.append(data, length);
+		++m_blocks;
+	}
+};
+
+#endif // APP_STRINGWRITER_HPP
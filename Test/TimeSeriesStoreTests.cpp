@@ -0,0 +1,141 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   TimeSeriesStoreTests.cpp
+//! \brief  The unit tests for the TimeSeriesStore class.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include <Core/UnitTest.hpp>
+#include <WMI/TimeSeriesStore.hpp>
+#include <WMI/Win32_LogicalDisk.hpp>
+#include <WMI/MemoryObject.hpp>
+
+//! The largest gauge value.
+static const uint64 LARGEST = ~static_cast<uint64>(0);
+//! A gauge value too large for 32 bits, i.e. 5GB.
+static const uint64 FIVE_GB = static_cast<uint64>(5) * 1024 * 1024 * 1024;
+
+TEST_SET(TimeSeriesStore)
+{
+
+TEST_CASE("samples are returned unchanged once their block has been compressed")
+{
+	WMI::TimeSeriesStore store(8);
+
+	const size_t        series = store.addSeries(TXT("FreeSpace"), 100);
+	std::vector<uint64> values;
+
+	for (int64 i = 0; i != 20; ++i)
+	{
+		const uint64 value = ((i % 3) == 0) ? (LARGEST - i) : (FIVE_GB + (i * 4096));
+
+		values.push_back(value);
+		store.append(series, (i * 1000) + (i % 2), value);
+	}
+
+	WMI::TimeSeriesStore::Samples samples;
+	store.range(series, 0, 100000, samples);
+
+	TEST_TRUE(store.size(series) == 20);
+	TEST_TRUE(samples.m_times.size() == 20);
+
+	bool matches = true;
+
+	for (size_t i = 0; i != samples.m_times.size(); ++i)
+	{
+		const int64 time = (static_cast<int64>(i) * 1000) + (i % 2);
+
+		matches = matches && (samples.m_times[i] == time) && (samples.m_values[i] == values[i]);
+	}
+
+	TEST_TRUE(matches);
+}
+TEST_CASE_END
+
+TEST_CASE("a full series drops its oldest block")
+{
+	WMI::TimeSeriesStore store(8);
+
+	const size_t series = store.addSeries(TXT("WorkingSetSize"), 20);
+
+	TEST_TRUE(store.capacity(series) == 24);
+
+	for (int64 i = 0; i != 50; ++i)
+		store.append(series, i, static_cast<uint64>(i));
+
+	WMI::TimeSeriesStore::Samples samples;
+	store.range(series, 0, 100, samples);
+
+	TEST_TRUE(store.size(series) == 26);
+	TEST_TRUE(samples.m_times.front() == 24);
+	TEST_TRUE(samples.m_times.back() == 49);
+}
+TEST_CASE_END
+
+TEST_CASE("a range query only returns the samples within the range")
+{
+	WMI::TimeSeriesStore store(8);
+
+	const size_t series = store.addSeries(TXT("FreeVirtualMemory"), 100);
+
+	for (int64 i = 0; i != 30; ++i)
+		store.append(series, i * 10, static_cast<uint64>(i));
+
+	WMI::TimeSeriesStore::Samples samples;
+	store.range(series, 95, 250, samples);
+
+	TEST_TRUE(samples.m_times.size() == 16);
+	TEST_TRUE(samples.m_times.front() == 100);
+	TEST_TRUE(samples.m_values.back() == 25);
+}
+TEST_CASE_END
+
+TEST_CASE("downsampling summarises the samples in each interval")
+{
+	WMI::TimeSeriesStore store(8);
+
+	const size_t series = store.addSeries(TXT("FreeSpace"), 100);
+
+	for (int64 i = 0; i != 20; ++i)
+		store.append(series, i, static_cast<uint64>(i));
+
+	WMI::TimeSeriesStore::Aggregates aggregates;
+	store.downsample(series, 0, 19, 10, aggregates);
+
+	TEST_TRUE(aggregates.size() == 2);
+	TEST_TRUE(aggregates[1].m_start == 10);
+	TEST_TRUE(aggregates[1].m_count == 10);
+	TEST_TRUE(aggregates[1].m_min == 10);
+	TEST_TRUE(aggregates[1].m_max == 19);
+	TEST_TRUE(aggregates[1].m_mean == 14.5);
+	TEST_TRUE(aggregates[1].m_last == 19);
+}
+TEST_CASE_END
+
+TEST_CASE("a sample can be read from a typed object's property")
+{
+	WMI::MemoryObject*       object = new WMI::MemoryObject(TXT("Win32_LogicalDisk"));
+	WMI::IWbemClassObjectPtr instance = object->getInterface();
+
+	object->setProperty(TXT("DeviceID"), TXT("C:"), CIM_STRING, true);
+	object->setProperty(TXT("FreeSpace"), TXT("5368709120"), CIM_UINT64);
+
+	WMI::Win32_LogicalDisk disk(instance, WMI::Connection());
+	WMI::TimeSeriesStore   store;
+
+	const size_t series = store.addSeries(disk.DeviceID(), 10);
+
+	store.append(series, 1, disk, &WMI::Win32_LogicalDisk::FreeSpace);
+
+	WMI::TimeSeriesStore::Samples samples;
+	store.range(series, 0, 1, samples);
+
+	size_t found = 0;
+
+	TEST_TRUE(store.findSeries(TXT("C:"), found) && (found == series));
+	TEST_TRUE(samples.m_values.size() == 1);
+	TEST_TRUE(samples.m_values[0] == FIVE_GB);
+}
+TEST_CASE_END
+
+}
+TEST_SET_END
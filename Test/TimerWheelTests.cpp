@@ -0,0 +1,78 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   TimerWheelTests.cpp
+//! \brief  The unit tests for the TimerWheel class.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include <Core/UnitTest.hpp>
+#include <WMI/TimerWheel.hpp>
+
+TEST_SET(TimerWheel)
+{
+
+TEST_CASE("a timer is not due until the wheel reaches its tick")
+{
+	WMI::TimerWheel         wheel;
+	WMI::TimerWheel::Timers expired;
+
+	wheel.schedule(1, 5);
+	wheel.advance(4, expired);
+
+	TEST_TRUE(expired.empty());
+
+	wheel.advance(5, expired);
+
+	TEST_TRUE(expired.size() == 1);
+	TEST_TRUE(expired[0] == 1);
+	TEST_TRUE(wheel.size() == 0);
+}
+TEST_CASE_END
+
+TEST_CASE("a timer more than a revolution ahead is not expired early")
+{
+	WMI::TimerWheel         wheel(8);
+	WMI::TimerWheel::Timers expired;
+
+	wheel.schedule(1, 12);
+	wheel.advance(4, expired);
+	wheel.advance(11, expired);
+
+	TEST_TRUE(expired.empty());
+
+	wheel.advance(12, expired);
+
+	TEST_TRUE(expired.size() == 1);
+}
+TEST_CASE_END
+
+TEST_CASE("advancing by more than a revolution expires all the timers due")
+{
+	WMI::TimerWheel         wheel(8);
+	WMI::TimerWheel::Timers expired;
+
+	wheel.schedule(1, 3);
+	wheel.schedule(2, 20);
+	wheel.schedule(3, 100);
+	wheel.advance(50, expired);
+
+	TEST_TRUE(expired.size() == 2);
+	TEST_TRUE(wheel.size() == 1);
+	TEST_TRUE(wheel.now() == 50);
+}
+TEST_CASE_END
+
+TEST_CASE("a timer scheduled in the past is due on the next advance")
+{
+	WMI::TimerWheel         wheel;
+	WMI::TimerWheel::Timers expired;
+
+	wheel.advance(10, expired);
+	wheel.schedule(1, 5);
+	wheel.advance(11, expired);
+
+	TEST_TRUE(expired.size() == 1);
+}
+TEST_CASE_END
+
+}
+TEST_SET_END
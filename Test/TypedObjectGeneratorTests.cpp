@@ -0,0 +1,160 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   TypedObjectGeneratorTests.cpp
+//! \brief  The unit tests for the TypedObjectGenerator class.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include <Core/UnitTest.hpp>
+#include <WMI/TypedObjectGenerator.hpp>
+#include <WMI/ArgumentTemplates.hpp>
+#include <WMI/MemoryObject.hpp>
+
+//! Query if the generated source contains the text.
+static bool contains(const tstring& source, const tchar* text)
+{
+	return (source.find(text) != tstring::npos);
+}
+
+TEST_SET(TypedObjectGenerator)
+{
+	WMI::MemoryObject*       memory = new WMI::MemoryObject(TXT("Test_Class"));
+	WMI::IWbemClassObjectPtr definition = memory->getInterface();
+	WMI::MemoryObject*       arguments = new WMI::MemoryObject(TXT("__PARAMETERS"));
+	WMI::IWbemClassObjectPtr signature = arguments->getInterface();
+	WMI::MemoryObject*       stopResults = new WMI::MemoryObject(TXT("__PARAMETERS"));
+	WMI::IWbemClassObjectPtr stopSignature = stopResults->getInterface();
+	WMI::MemoryObject*       queryResults = new WMI::MemoryObject(TXT("__PARAMETERS"));
+	WMI::IWbemClassObjectPtr querySignature = queryResults->getInterface();
+
+	memory->setProperty(TXT("Name"), TXT("name"), CIM_STRING, true);
+	memory->setProperty(TXT("Count"), 1, CIM_UINT32);
+	memory->setProperty(TXT("Size"), TXT("1"), CIM_UINT64);
+	memory->setProperty(TXT("Enabled"), WCL::Variant(true), CIM_BOOLEAN);
+
+	arguments->setProperty(TXT("Reason"), 0, CIM_UINT32);
+
+	stopResults->setProperty(TXT("ReturnValue"), 0, CIM_UINT32);
+	stopResults->setProperty(TXT("Reason"), 0, CIM_UINT32);
+
+	queryResults->setProperty(TXT("ReturnValue"), 0, CIM_UINT32);
+	queryResults->setProperty(TXT("Owner"), TXT(""), CIM_STRING);
+	queryResults->setProperty(TXT("Size"), TXT("0"), CIM_UINT64);
+
+	memory->setMethod(TXT("Stop"), signature, stopSignature);
+	memory->setMethod(TXT("Pause"), WMI::IWbemClassObjectPtr());
+	memory->setMethod(TXT("Query"), WMI::IWbemClassObjectPtr(), querySignature);
+
+	const WMI::TypedObjectGenerator generator(definition);
+
+TEST_CASE("the class name is read from the definition")
+{
+	TEST_TRUE(generator.className() == TXT("Test_Class"));
+}
+TEST_CASE_END
+
+TEST_CASE("each property getter uses the cheapest decoding for its CIM type")
+{
+	const tstring header = generator.generateHeader();
+
+	TEST_TRUE(contains(header, TXT("#ifndef WMI_TEST_CLASS_HPP")));
+	TEST_TRUE(contains(header, TXT("class Test_Class : public TypedObject<Test_Class>")));
+	TEST_TRUE(contains(header, TXT("\treturn getProperty<tstring>(TXT(\"Name\"));")));
+	TEST_TRUE(contains(header, TXT("\treturn static_cast<uint32>(getProperty<int32>(TXT(\"Count\")));")));
+	TEST_TRUE(contains(header, TXT("\treturn Core::parse<uint64>(value);")));
+	TEST_TRUE(contains(header, TXT("\treturn getProperty<bool>(TXT(\"Enabled\"));")));
+}
+TEST_CASE_END
+
+TEST_CASE("a method wrapper is generated for each method, in name order")
+{
+	const tstring header = generator.generateHeader();
+	const tstring source = generator.generateSource();
+
+	TEST_TRUE(contains(header, TXT("\tuint32 Pause();")));
+	TEST_TRUE(contains(header, TXT("\tuint32 Stop(uint32 reason);")));
+	TEST_TRUE(header.find(TXT("Pause()")) < header.find(TXT("Stop(")));
+
+	TEST_TRUE(contains(source, TXT("execMethod(TXT(\"Pause\"), returnValue);")));
+	TEST_TRUE(contains(source, TXT("createArgumentsObject(WMI_CLASS_NAME, METHOD);")));
+	TEST_TRUE(contains(source, TXT("setArgument(arguments, TXT(\"Reason\"), WCL::Variant(static_cast<int32>(reason)));")));
+}
+TEST_CASE_END
+
+TEST_CASE("the output parameters of a method are returned by reference")
+{
+	const tstring header = generator.generateHeader();
+	const tstring source = generator.generateSource();
+
+	TEST_TRUE(contains(header, TXT("\tuint32 Query(tstring& owner, uint64& size);")));
+	TEST_TRUE(contains(source, TXT("execMethod(METHOD, IWbemClassObjectPtr(), returnValue, results);")));
+	TEST_TRUE(contains(source, TXT("\t\tif (getArgument(results, TXT(\"Owner\"), value))\n\t\t\towner = WCL::getValue<tstring>(value);")));
+	TEST_TRUE(contains(source, TXT("\t\t\tsize = Core::parse<uint64>(WCL::getValue<tstring>(value));")));
+	TEST_FALSE(contains(source, TXT("TXT(\"ReturnValue\")")));
+}
+TEST_CASE_END
+
+TEST_CASE("a parameter that would be a keyword or hide a generated name keeps its case")
+{
+	WMI::MemoryObject*       names = new WMI::MemoryObject(TXT("Test_Names"));
+	WMI::IWbemClassObjectPtr namesDefinition = names->getInterface();
+	WMI::MemoryObject*       inputs = new WMI::MemoryObject(TXT("__PARAMETERS"));
+	WMI::IWbemClassObjectPtr inSignature = inputs->getInterface();
+	WMI::MemoryObject*       outputs = new WMI::MemoryObject(TXT("__PARAMETERS"));
+	WMI::IWbemClassObjectPtr outSignature = outputs->getInterface();
+
+	inputs->setProperty(TXT("Int"), 0, CIM_UINT32);
+	outputs->setProperty(TXT("ReturnValue"), 0, CIM_UINT32);
+	outputs->setProperty(TXT("Value"), TXT(""), CIM_STRING);
+	outputs->setProperty(TXT("results"), TXT(""), CIM_STRING);
+
+	names->setMethod(TXT("Read"), inSignature, outSignature);
+
+	const WMI::TypedObjectGenerator namesGenerator(namesDefinition);
+	const tstring                   header = namesGenerator.generateHeader();
+	const tstring                   source = namesGenerator.generateSource();
+
+	TEST_TRUE(contains(header, TXT("\tuint32 Read(uint32 Int, tstring& Value, tstring& results_);")));
+	TEST_TRUE(contains(source, TXT("\t\t\tValue = WCL::getValue<tstring>(value);")));
+	TEST_TRUE(contains(source, TXT("\t\t\tresults_ = WCL::getValue<tstring>(value);")));
+}
+TEST_CASE_END
+
+TEST_CASE("the default of a trailing input is only included in the declaration")
+{
+	WMI::TypedObjectGenerator defaults(definition);
+
+	TEST_TRUE(defaults.setDefaultArgument(TXT("Stop"), TXT("Reason"), TXT("0")));
+	TEST_FALSE(defaults.setDefaultArgument(TXT("Stop"), TXT("Missing"), TXT("0")));
+	TEST_FALSE(defaults.setDefaultArgument(TXT("Query"), TXT("Owner"), TXT("")));
+
+	TEST_TRUE(contains(defaults.generateHeader(), TXT("\tuint32 Stop(uint32 reason = 0);")));
+	TEST_TRUE(contains(defaults.generateSource(), TXT("uint32 Test_Class::Stop(uint32 reason)\n")));
+}
+TEST_CASE_END
+
+TEST_CASE("an in/out parameter is only passed in")
+{
+	const tstring header = generator.generateHeader();
+
+	TEST_TRUE(contains(header, TXT("\tuint32 Stop(uint32 reason);")));
+}
+TEST_CASE_END
+
+TEST_CASE("method argument definitions are cached by class and method name")
+{
+	WMI::ArgumentTemplates   templates;
+	WMI::IWbemClassObjectPtr found;
+
+	TEST_FALSE(templates.find(TXT("Test_Class"), TXT("Stop"), found));
+
+	templates.add(TXT("Test_Class"), TXT("Stop"), signature);
+
+	TEST_TRUE(templates.size() == 1);
+	TEST_TRUE(templates.find(TXT("Test_Class"), TXT("Stop"), found));
+	TEST_TRUE(found.get() == signature.get());
+	TEST_FALSE(templates.find(TXT("Test_Class"), TXT("Pause"), found));
+}
+TEST_CASE_END
+
+}
+TEST_SET_END
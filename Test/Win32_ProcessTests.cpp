@@ -0,0 +1,113 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   Win32_ProcessTests.cpp
+//! \brief  The unit tests for the Win32_Process class.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include <Core/UnitTest.hpp>
+#include <WMI/Connection.hpp>
+#include <WMI/Win32_Process.hpp>
+#include <WMI/MemoryObject.hpp>
+#include <WMI/ReplayServices.hpp>
+
+//! The path of the process the methods are executed on.
+static const tchar* PROCESS_PATH = TXT("Win32_Process.Handle=\"1234\"");
+
+////////////////////////////////////////////////////////////////////////////////
+//! Create a process object with just its key and ID.
+
+static WMI::IWbemClassObjectPtr createProcess()
+{
+	WMI::MemoryObject*       object = new WMI::MemoryObject(TXT("Win32_Process"));
+	WMI::IWbemClassObjectPtr instance = object->getInterface();
+
+	object->setProperty(TXT("Handle"), TXT("1234"), CIM_STRING, true);
+	object->setProperty(TXT("ProcessId"), 1234, CIM_UINT32);
+
+	return instance;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Create a provider that serves a call to GetOwner() with the result and, if
+//! it succeeded, the owner.
+
+static WMI::IWbemServicesPtr createProvider(uint32 returnValue)
+{
+	WMI::RecordingPtr        recording(new WMI::Recording);
+	WMI::MemoryObject*       output = new WMI::MemoryObject(TXT("__PARAMETERS"));
+	WMI::IWbemClassObjectPtr results = output->getInterface();
+
+	output->setProperty(TXT("ReturnValue"), static_cast<int32>(returnValue), CIM_UINT32);
+
+	if (returnValue == 0)
+	{
+		output->setProperty(TXT("User"), TXT("chris"), CIM_STRING);
+		output->setProperty(TXT("Domain"), TXT("HOME"), CIM_STRING);
+	}
+	else
+	{
+		WCL::Variant null;
+
+		V_VT(&null) = VT_NULL;
+
+		output->setProperty(TXT("User"), null, CIM_STRING);
+		output->setProperty(TXT("Domain"), null, CIM_STRING);
+	}
+
+	const size_t call = recording->addCall(WMI::Recording::EXEC_METHOD, PROCESS_PATH, TXT("GetOwner"), WBEM_S_NO_ERROR, 0);
+
+	recording->addObject(call, results, 0);
+
+	return (new WMI::ReplayServices(recording, false))->getInterface();
+}
+
+TEST_SET(Win32_Process)
+{
+
+TEST_CASE("the properties are decoded from the untyped WMI object")
+{
+	WMI::Connection connection;
+
+	connection.open(createProvider(0));
+
+	const WMI::Win32_Process process(createProcess(), connection);
+
+	TEST_TRUE(process.Handle() == TXT("1234"));
+	TEST_TRUE(process.ProcessId() == 1234);
+}
+TEST_CASE_END
+
+TEST_CASE("a method returns its output parameters by reference")
+{
+	WMI::Connection connection;
+
+	connection.open(createProvider(0));
+
+	WMI::Win32_Process process(createProcess(), connection);
+	tstring            user;
+	tstring            domain;
+
+	TEST_TRUE(process.GetOwner(user, domain) == 0);
+	TEST_TRUE(user == TXT("chris"));
+	TEST_TRUE(domain == TXT("HOME"));
+}
+TEST_CASE_END
+
+TEST_CASE("the output parameters that a failed method did not set are left unchanged")
+{
+	WMI::Connection connection;
+
+	connection.open(createProvider(2));
+
+	WMI::Win32_Process process(createProcess(), connection);
+	tstring            user = TXT("unchanged");
+	tstring            domain = TXT("unchanged");
+
+	TEST_TRUE(process.GetOwner(user, domain) == 2);
+	TEST_TRUE(user == TXT("unchanged"));
+	TEST_TRUE(domain == TXT("unchanged"));
+}
+TEST_CASE_END
+
+}
+TEST_SET_END
@@ -0,0 +1,52 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   ThreadAffinity.cpp
+//! \brief  The ThreadAffinity class definition.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include "ThreadAffinity.hpp"
+
+namespace WMI
+{
+
+////////////////////////////////////////////////////////////////////////////////
+//! Default constructor. Captures the calling thread's apartment.
+
+ThreadAffinity::ThreadAffinity()
+	: m_threadId(::GetCurrentThreadId())
+	, m_multiThreaded(inMultiThreadedApartment())
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Query if the calling thread can use interfaces with this affinity. That is
+//! either the capturing thread or, for the MTA, any other thread in the MTA.
+
+bool ThreadAffinity::isAccessible() const
+{
+	if (::GetCurrentThreadId() == m_threadId)
+		return true;
+
+	return m_multiThreaded && inMultiThreadedApartment();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Query if the calling thread has joined the multi-threaded apartment. This
+//! attempts to join the MTA, which fails if the thread is in an STA and is a
+//! no-op if it has already joined, and so works on all versions of Windows.
+
+bool ThreadAffinity::inMultiThreadedApartment()
+{
+	const HRESULT result = ::CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+
+	if (FAILED(result))
+		return false;
+
+	// Balance the call, which also undoes it if COM was uninitialised.
+	::CoUninitialize();
+
+	return (result == S_FALSE);
+}
+
+//namespace WMI
+}
@@ -0,0 +1,77 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   ThreadAffinity.hpp
+//! \brief  The ThreadAffinity class declaration.
+//! \author Chris Oldwood
+
+// Check for previous inclusion
+#ifndef WMI_THREADAFFINITY_HPP
+#define WMI_THREADAFFINITY_HPP
+
+#if _MSC_VER > 1000
+#pragma once
+#endif
+
+namespace WMI
+{
+
+////////////////////////////////////////////////////////////////////////////////
+//! The thread, and COM apartment, that a COM interface was acquired on. An
+//! interface acquired in a single-threaded apartment can only be used on the
+//! thread that created it, whereas one acquired in the multi-threaded apartment
+//! can be used by any thread that has also joined the MTA. Interfaces that need
+//! to cross apartments must be marshalled, such as with the MarshalledObject.
+
+class ThreadAffinity
+{
+public:
+	//! Default constructor. Captures the calling thread's apartment.
+	ThreadAffinity();
+
+	//
+	// Properties.
+	//
+
+	//! Get the ID of the thread the affinity was captured on.
+	DWORD threadId() const;
+
+	//! Query if the affinity was captured in the multi-threaded apartment.
+	bool isMultiThreaded() const;
+
+	//! Query if the calling thread can use interfaces with this affinity.
+	bool isAccessible() const;
+
+	//
+	// Class methods.
+	//
+
+	//! Query if the calling thread has joined the multi-threaded apartment.
+	static bool inMultiThreadedApartment();
+
+private:
+	//
+	// Members.
+	//
+	DWORD	m_threadId;			//!< The thread the affinity was captured on.
+	bool	m_multiThreaded;	//!< Captured in the multi-threaded apartment?
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the ID of the thread the affinity was captured on.
+
+inline DWORD ThreadAffinity::threadId() const
+{
+	return m_threadId;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Query if the affinity was captured in the multi-threaded apartment.
+
+inline bool ThreadAffinity::isMultiThreaded() const
+{
+	return m_multiThreaded;
+}
+
+//namespace WMI
+}
+
+#endif // WMI_THREADAFFINITY_HPP
@@ -0,0 +1,371 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   TimeSeriesStore.cpp
+//! \brief  The TimeSeriesStore class definition.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include "TimeSeriesStore.hpp"
+#include <algorithm>
+
+namespace WMI
+{
+
+////////////////////////////////////////////////////////////////////////////////
+//! Append an unsigned value as a variable length integer, 7 bits per byte with
+//! the top bit set on all but the last byte.
+
+static void writeVarint(std::vector<uint8>& data, uint64 value)
+{
+	while (value >= 0x80)
+	{
+		data.push_back(static_cast<uint8>(value | 0x80));
+		value >>= 7;
+	}
+
+	data.push_back(static_cast<uint8>(value));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Read a variable length integer, advancing the position.
+
+static uint64 readVarint(const uint8*& data)
+{
+	uint64 value = 0;
+	uint   shift = 0;
+
+	for (;;)
+	{
+		const uint8 next = *data++;
+
+		value |= static_cast<uint64>(next & 0x7F) << shift;
+
+		if ((next & 0x80) == 0)
+			break;
+
+		shift += 7;
+	}
+
+	return value;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Map a signed value to an unsigned one so that small magnitudes of either
+//! sign encode as small values.
+
+static uint64 zigzag(int64 value)
+{
+	return (static_cast<uint64>(value) << 1) ^ static_cast<uint64>(value >> 63);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Reverse the zigzag mapping.
+
+static int64 unzigzag(uint64 value)
+{
+	return static_cast<int64>(value >> 1) ^ -static_cast<int64>(value & 1);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Construction with the number of samples per block. Larger blocks compress
+//! better but are dropped from a full series in larger steps.
+
+TimeSeriesStore::TimeSeriesStore(size_t blockSize)
+	: m_blockSize(blockSize)
+	, m_series()
+	, m_index()
+{
+	ASSERT(blockSize > 1);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Destructor.
+
+TimeSeriesStore::~TimeSeriesStore()
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the name of a series.
+
+const tstring& TimeSeriesStore::name(size_t series) const
+{
+	ASSERT(series < m_series.size());
+
+	return m_series[series].m_name;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the fewest samples a full series holds.
+
+size_t TimeSeriesStore::capacity(size_t series) const
+{
+	ASSERT(series < m_series.size());
+
+	return m_series[series].m_capacity;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the number of samples a series holds.
+
+size_t TimeSeriesStore::size(size_t series) const
+{
+	ASSERT(series < m_series.size());
+
+	const Series& entry = m_series[series];
+	size_t        count = entry.m_times.size();
+
+	for (size_t i = 0; i != entry.m_sealed; ++i)
+		count += entry.m_blocks[(entry.m_oldest + i) % entry.m_blocks.size()].m_count;
+
+	return count;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the number of bytes used to hold the samples of all series, which is
+//! the size of the compressed blocks plus the samples in the open blocks.
+
+size_t TimeSeriesStore::bytesUsed() const
+{
+	size_t bytes = 0;
+
+	for (std::vector<Series>::const_iterator it = m_series.begin(); it != m_series.end(); ++it)
+	{
+		bytes += it->m_times.size() * (sizeof(int64) + sizeof(uint64));
+
+		for (size_t i = 0; i != it->m_sealed; ++i)
+			bytes += it->m_blocks[(it->m_oldest + i) % it->m_blocks.size()].m_data.size();
+	}
+
+	return bytes;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Add a series that holds at least a number of samples, returning its index.
+//! The capacity is rounded up to a whole number of blocks.
+
+size_t TimeSeriesStore::addSeries(const tstring& name, size_t capacity)
+{
+	ASSERT(m_index.find(name) == m_index.end());
+	ASSERT(capacity != 0);
+
+	const size_t index = m_series.size();
+	const size_t blocks = (capacity + m_blockSize - 1) / m_blockSize;
+
+	m_series.push_back(Series());
+
+	Series& series = m_series.back();
+
+	series.m_name = name;
+	series.m_capacity = blocks * m_blockSize;
+	series.m_blocks.resize(blocks);
+	series.m_oldest = 0;
+	series.m_sealed = 0;
+	series.m_times.reserve(m_blockSize);
+	series.m_values.reserve(m_blockSize);
+
+	m_index[name] = index;
+
+	return index;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Find a series by name.
+
+bool TimeSeriesStore::findSeries(const tstring& name, size_t& series) const
+{
+	const SeriesIndex::const_iterator it = m_index.find(name);
+
+	if (it == m_index.end())
+		return false;
+
+	series = it->second;
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Append a sample to a series. The time must not be before the last sample.
+
+void TimeSeriesStore::append(size_t series, int64 time, uint64 value)
+{
+	ASSERT(series < m_series.size());
+
+	Series& entry = m_series[series];
+
+	ASSERT(entry.m_times.empty() || (time >= entry.m_times.back()));
+
+	entry.m_times.push_back(time);
+	entry.m_values.push_back(value);
+
+	if (entry.m_times.size() == m_blockSize)
+		seal(entry);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the samples of a series within a time range, inclusive. The samples are
+//! appended to the collection. The compressed blocks that lie wholly outside
+//! the range are skipped without being decoded.
+
+void TimeSeriesStore::range(size_t series, int64 from, int64 to, Samples& samples) const
+{
+	ASSERT(series < m_series.size());
+
+	const Series& entry = m_series[series];
+
+	for (size_t i = 0; i != entry.m_sealed; ++i)
+	{
+		const Block& block = entry.m_blocks[(entry.m_oldest + i) % entry.m_blocks.size()];
+
+		if ( (block.m_last >= from) && (block.m_first <= to) )
+			decode(block, from, to, samples);
+	}
+
+	for (size_t i = 0; i != entry.m_times.size(); ++i)
+	{
+		const int64 time = entry.m_times[i];
+
+		if ( (time >= from) && (time <= to) )
+		{
+			samples.m_times.push_back(time);
+			samples.m_values.push_back(entry.m_values[i]);
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Summarise the samples of a series within a time range, inclusive, by
+//! interval. The intervals start at the beginning of the range and only those
+//! with at least one sample are appended to the collection.
+
+void TimeSeriesStore::downsample(size_t series, int64 from, int64 to, int64 interval, Aggregates& aggregates) const
+{
+	ASSERT(interval > 0);
+
+	Samples samples;
+
+	range(series, from, to, samples);
+
+	const size_t first = aggregates.size();
+	double       total = 0.0;
+
+	for (size_t i = 0; i != samples.m_times.size(); ++i)
+	{
+		const int64  start = from + ((samples.m_times[i] - from) / interval) * interval;
+		const uint64 value = samples.m_values[i];
+
+		if ( (aggregates.size() == first) || (aggregates.back().m_start != start) )
+		{
+			if (aggregates.size() != first)
+				aggregates.back().m_mean = total / aggregates.back().m_count;
+
+			const Aggregate aggregate = { start, 0, value, value, 0.0, value };
+
+			aggregates.push_back(aggregate);
+			total = 0.0;
+		}
+
+		Aggregate& current = aggregates.back();
+
+		++current.m_count;
+		current.m_min = std::min(current.m_min, value);
+		current.m_max = std::max(current.m_max, value);
+		current.m_last = value;
+		total += static_cast<double>(value);
+	}
+
+	if (aggregates.size() != first)
+		aggregates.back().m_mean = total / aggregates.back().m_count;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Compress the open block into the ring, reusing the oldest block's buffer
+//! once the ring is full.
+
+void TimeSeriesStore::seal(Series& series)
+{
+	const size_t blocks = series.m_blocks.size();
+	size_t       index;
+
+	if (series.m_sealed != blocks)
+	{
+		index = (series.m_oldest + series.m_sealed) % blocks;
+		++series.m_sealed;
+	}
+	else
+	{
+		index = series.m_oldest;
+		series.m_oldest = (series.m_oldest + 1) % blocks;
+	}
+
+	encode(series, series.m_blocks[index]);
+
+	series.m_times.clear();
+	series.m_values.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Encode the samples of the open block. The first time and value are written
+//! in full, then each time as the change in the delta and each value as the
+//! difference from the previous one, which wraps so that any change is exact.
+
+void TimeSeriesStore::encode(const Series& series, Block& block)
+{
+	const std::vector<int64>&  times = series.m_times;
+	const std::vector<uint64>& values = series.m_values;
+
+	ASSERT(!times.empty());
+
+	block.m_data.clear();
+	block.m_first = times.front();
+	block.m_last = times.back();
+	block.m_count = times.size();
+
+	writeVarint(block.m_data, zigzag(times[0]));
+	writeVarint(block.m_data, values[0]);
+
+	int64 delta = 0;
+
+	for (size_t i = 1; i != times.size(); ++i)
+	{
+		const int64 next = times[i] - times[i-1];
+
+		writeVarint(block.m_data, zigzag(next - delta));
+		writeVarint(block.m_data, zigzag(static_cast<int64>(values[i] - values[i-1])));
+
+		delta = next;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Decode the samples of a block within a time range, inclusive, appending
+//! them to the collection.
+
+void TimeSeriesStore::decode(const Block& block, int64 from, int64 to, Samples& samples)
+{
+	const uint8* data = &block.m_data[0];
+
+	int64  time = unzigzag(readVarint(data));
+	uint64 value = readVarint(data);
+	int64  delta = 0;
+
+	for (size_t i = 0; i != block.m_count; ++i)
+	{
+		if (i != 0)
+		{
+			delta += unzigzag(readVarint(data));
+			time += delta;
+			value += static_cast<uint64>(unzigzag(readVarint(data)));
+		}
+
+		if (time > to)
+			break;
+
+		if (time >= from)
+		{
+			samples.m_times.push_back(time);
+			samples.m_values.push_back(value);
+		}
+	}
+}
+
+//namespace WMI
+}
@@ -0,0 +1,194 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   TimeSeriesStore.hpp
+//! \brief  The TimeSeriesStore class declaration.
+//! \author Chris Oldwood
+
+// Check for previous inclusion
+#ifndef WMI_TIMESERIESSTORE_HPP
+#define WMI_TIMESERIESSTORE_HPP
+
+#if _MSC_VER > 1000
+#pragma once
+#endif
+
+#include <Core/NotCopyable.hpp>
+#include <vector>
+#include <map>
+
+namespace WMI
+{
+
+////////////////////////////////////////////////////////////////////////////////
+//! A fixed-capacity store for series of sampled gauges, such as the free space
+//! on a disk or the working set of a process. Each series is a ring of blocks
+//! and, once full, the oldest block is dropped to make room for the newest.
+//!
+//! The samples are appended to an open block, which holds the times and values
+//! in separate arrays. When the open block is full it is compressed into the
+//! ring, with the times stored as the delta of their deltas, which is zero for
+//! a fixed cadence, and the values as the delta from the previous value. Both
+//! are written as variable length integers, and so a slowly changing gauge
+//! sampled at a fixed cadence costs a few bytes per sample.
+//!
+//! The times are in whatever units the caller chooses and must not go
+//! backwards within a series.
+
+class TimeSeriesStore : private Core::NotCopyable
+{
+public:
+	//! The samples returned by a query, in time order.
+	struct Samples
+	{
+		std::vector<int64>	m_times;	//!< The sample times.
+		std::vector<uint64>	m_values;	//!< The sample values.
+	};
+
+	//! The summary of the samples in an interval.
+	struct Aggregate
+	{
+		int64	m_start;	//!< The start of the interval.
+		size_t	m_count;	//!< The number of samples.
+		uint64	m_min;		//!< The smallest value.
+		uint64	m_max;		//!< The largest value.
+		double	m_mean;		//!< The mean value.
+		uint64	m_last;		//!< The last value.
+	};
+
+	//! A collection of interval summaries.
+	typedef std::vector<Aggregate> Aggregates;
+
+public:
+	//! Construction with the number of samples per block.
+	explicit TimeSeriesStore(size_t blockSize = DEFAULT_BLOCK_SIZE);
+
+	//! Destructor.
+	~TimeSeriesStore();
+
+	//
+	// Properties.
+	//
+
+	//! Get the number of samples per block.
+	size_t blockSize() const;
+
+	//! Get the number of series.
+	size_t seriesCount() const;
+
+	//! Get the name of a series.
+	const tstring& name(size_t series) const;
+
+	//! Get the fewest samples a full series holds.
+	size_t capacity(size_t series) const;
+
+	//! Get the number of samples a series holds.
+	size_t size(size_t series) const;
+
+	//! Get the number of bytes used to hold the samples of all series.
+	size_t bytesUsed() const;
+
+	//
+	// Methods.
+	//
+
+	//! Add a series that holds at least a number of samples.
+	size_t addSeries(const tstring& name, size_t capacity);
+
+	//! Find a series by name.
+	bool findSeries(const tstring& name, size_t& series) const;
+
+	//! Append a sample to a series.
+	void append(size_t series, int64 time, uint64 value);
+
+	//! Append a sample read from a typed object's property to a series.
+	template <typename T>
+	void append(size_t series, int64 time, const T& object, uint64 (T::*getter)() const); // throw(WMI::Exception)
+
+	//! Get the samples of a series within a time range.
+	void range(size_t series, int64 from, int64 to, Samples& samples) const;
+
+	//! Summarise the samples of a series within a time range by interval.
+	void downsample(size_t series, int64 from, int64 to, int64 interval, Aggregates& aggregates) const;
+
+	//
+	// Constants.
+	//
+
+	//! The default number of samples per block.
+	static const size_t DEFAULT_BLOCK_SIZE = 128;
+
+private:
+	//! A compressed block of samples.
+	struct Block
+	{
+		std::vector<uint8>	m_data;		//!< The encoded samples.
+		int64				m_first;	//!< The time of the first sample.
+		int64				m_last;		//!< The time of the last sample.
+		size_t				m_count;	//!< The number of samples.
+	};
+
+	//! A series of samples.
+	struct Series
+	{
+		tstring				m_name;		//!< The series name.
+		size_t				m_capacity;	//!< The fewest samples held when full.
+		std::vector<int64>	m_times;	//!< The times in the open block.
+		std::vector<uint64>	m_values;	//!< The values in the open block.
+		std::vector<Block>	m_blocks;	//!< The ring of compressed blocks.
+		size_t				m_oldest;	//!< The index of the oldest compressed block.
+		size_t				m_sealed;	//!< The number of compressed blocks in use.
+	};
+
+	//! The map of series name to index.
+	typedef std::map<tstring, size_t> SeriesIndex;
+
+	//
+	// Members.
+	//
+	size_t				m_blockSize;	//!< The number of samples per block.
+	std::vector<Series>	m_series;		//!< The series.
+	SeriesIndex			m_index;		//!< The series, by name.
+
+	//
+	// Internal methods.
+	//
+
+	//! Compress the open block into the ring, dropping the oldest if full.
+	void seal(Series& series);
+
+	//! Encode the samples of the open block.
+	static void encode(const Series& series, Block& block);
+
+	//! Decode the samples of a block within a time range.
+	static void decode(const Block& block, int64 from, int64 to, Samples& samples);
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the number of samples per block.
+
+inline size_t TimeSeriesStore::blockSize() const
+{
+	return m_blockSize;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the number of series.
+
+inline size_t TimeSeriesStore::seriesCount() const
+{
+	return m_series.size();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Append a sample read from a typed object's property to a series, e.g.
+//! store.append(series, now, disk, &Win32_LogicalDisk::FreeSpace).
+
+template <typename T>
+inline void TimeSeriesStore::append(size_t series, int64 time, const T& object, uint64 (T::*getter)() const)
+{
+	append(series, time, (object.*getter)());
+}
+
+//namespace WMI
+}
+
+#endif // WMI_TIMESERIESSTORE_HPP
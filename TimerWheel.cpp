@@ -0,0 +1,85 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   TimerWheel.cpp
+//! \brief  The TimerWheel class definition.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include "TimerWheel.hpp"
+#include <algorithm>
+
+namespace WMI
+{
+
+////////////////////////////////////////////////////////////////////////////////
+//! Construction with the number of slots.
+
+TimerWheel::TimerWheel(size_t slots)
+	: m_slots(slots)
+	, m_now(0)
+	, m_size(0)
+{
+	ASSERT(slots != 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Destructor.
+
+TimerWheel::~TimerWheel()
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Schedule a timer for a tick. A timer for the current tick, or one already
+//! passed, is due when the wheel is next advanced.
+
+void TimerWheel::schedule(size_t timer, uint64 tick)
+{
+	if (tick <= m_now)
+		tick = m_now + 1;
+
+	const Entry entry = { timer, tick };
+
+	m_slots[static_cast<size_t>(tick % m_slots.size())].push_back(entry);
+	++m_size;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Advance the wheel to a tick, appending the timers that are due to the
+//! collection. Each slot is visited at most once, so jumping ahead by more
+//! than a revolution costs no more than a single revolution. The timers are
+//! appended in the order they were due, except for those due on the same tick
+//! or when jumping more than a revolution.
+
+void TimerWheel::advance(uint64 tick, Timers& expired)
+{
+	if (tick <= m_now)
+		return;
+
+	const uint64 steps = std::min<uint64>(tick - m_now, m_slots.size());
+
+	for (uint64 step = 1; step <= steps; ++step)
+	{
+		Slot& slot = m_slots[static_cast<size_t>((m_now + step) % m_slots.size())];
+
+		for (size_t i = 0; i != slot.size(); )
+		{
+			if (slot[i].m_tick <= tick)
+			{
+				expired.push_back(slot[i].m_timer);
+
+				slot[i] = slot.back();
+				slot.pop_back();
+				--m_size;
+			}
+			else
+			{
+				++i;
+			}
+		}
+	}
+
+	m_now = tick;
+}
+
+//namespace WMI
+}
@@ -0,0 +1,110 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   TimerWheel.hpp
+//! \brief  The TimerWheel class declaration.
+//! \author Chris Oldwood
+
+// Check for previous inclusion
+#ifndef WMI_TIMERWHEEL_HPP
+#define WMI_TIMERWHEEL_HPP
+
+#if _MSC_VER > 1000
+#pragma once
+#endif
+
+#include <Core/NotCopyable.hpp>
+#include <vector>
+
+namespace WMI
+{
+
+////////////////////////////////////////////////////////////////////////////////
+//! A hashed timing wheel that holds a large number of timers, which are
+//! identified by the caller's index. Time is measured in ticks and a timer is
+//! held in the slot for its due tick modulo the number of slots. Scheduling a
+//! timer is O(1) and advancing the wheel by one tick only visits the timers in
+//! a single slot, rather than the whole set as a sorted queue would.
+//!
+//! A timer due more than one revolution ahead shares its slot with nearer ones
+//! and is skipped until the wheel reaches its tick.
+
+class TimerWheel : private Core::NotCopyable
+{
+public:
+	//! The collection of timers returned when the wheel is advanced.
+	typedef std::vector<size_t> Timers;
+
+public:
+	//! Construction with the number of slots.
+	explicit TimerWheel(size_t slots = DEFAULT_SLOTS);
+
+	//! Destructor.
+	~TimerWheel();
+
+	//
+	// Properties.
+	//
+
+	//! Get the current tick.
+	uint64 now() const;
+
+	//! Get the number of timers scheduled.
+	size_t size() const;
+
+	//
+	// Methods.
+	//
+
+	//! Schedule a timer for a tick.
+	void schedule(size_t timer, uint64 tick);
+
+	//! Advance the wheel to a tick, appending the timers that are due.
+	void advance(uint64 tick, Timers& expired);
+
+	//
+	// Constants.
+	//
+
+	//! The default number of slots.
+	static const size_t DEFAULT_SLOTS = 512;
+
+private:
+	//! A scheduled timer.
+	struct Entry
+	{
+		size_t	m_timer;	//!< The caller's index.
+		uint64	m_tick;		//!< The tick it is due.
+	};
+
+	//! The timers held by a slot.
+	typedef std::vector<Entry> Slot;
+	//! The collection of slots.
+	typedef std::vector<Slot> Slots;
+
+	//
+	// Members.
+	//
+	Slots	m_slots;	//!< The timers, by slot.
+	uint64	m_now;		//!< The current tick.
+	size_t	m_size;		//!< The number of timers scheduled.
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the current tick.
+
+inline uint64 TimerWheel::now() const
+{
+	return m_now;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the number of timers scheduled.
+
+inline size_t TimerWheel::size() const
+{
+	return m_size;
+}
+
+//namespace WMI
+}
+
+#endif // WMI_TIMERWHEEL_HPP
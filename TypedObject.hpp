@@ -18,6 +18,7 @@
 #include "Connection.hpp"
 #include <WCL/VariantVector.hpp>
 #include <algorithm>
+#include <vector>
 #include <Core/Functor.hpp>
 
 namespace WMI
@@ -52,8 +53,22 @@ public:
 	//! Select those objects of the derived type matching the predicate.
 	static Iterator selectWhere(Connection& connection, const tstring& predicate);
 
+	//! Read the remaining objects of a query into memory.
+	static size_t materialise(Iterator it, std::vector<T>& objects); // throw(WMI::Exception)
+
 	//! Refresh the state of the object.
 	void refresh();
+
+	//! Query the objects of another type associated with this one.
+	template <typename R>
+	TypedObjectIterator<R> associators(const tstring& assocClass = TXT(""), const tstring& role = TXT("")) const; // throw(WMI::Exception)
+
+	//! Query the association objects of a type that refer to this one.
+	template <typename A>
+	TypedObjectIterator<A> references(const tstring& role = TXT("")) const; // throw(WMI::Exception)
+
+	//! Refresh the state of a set of objects, returning those that no longer exist.
+	static void refreshAll(std::vector<T>& objects, Object::Indices& vanished); // throw(WMI::Exception)
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -118,6 +133,23 @@ inline typename TypedObject<T>::Iterator TypedObject<T>::selectWhere(Connection&
 	return connection.execQuery(query.c_str());
 }
 
+////////////////////////////////////////////////////////////////////////////////
+//! Read the remaining objects of a query into memory, e.g. to join them with
+//! the results of another query. The objects are appended to the collection
+//! and the number read is returned.
+
+template <typename T>
+inline size_t TypedObject<T>::materialise(Iterator it, std::vector<T>& objects)
+{
+	const Iterator end;
+	size_t         count = 0;
+
+	for (; it != end; ++it, ++count)
+		objects.push_back(*it);
+
+	return count;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 //! Refresh the state of the object.
 
@@ -127,6 +159,50 @@ inline void TypedObject<T>::refresh()
 	Object::refresh();
 }
 
+////////////////////////////////////////////////////////////////////////////////
+//! Query the objects of another type associated with this one, e.g. the
+//! services that depend on a service are
+//! service.associators<Win32_Service>(TXT("Win32_DependentService"), TXT("Antecedent")).
+
+template <typename T>
+template <typename R>
+inline TypedObjectIterator<R> TypedObject<T>::associators(const tstring& assocClass, const tstring& role) const
+{
+	return Object::associators(assocClass, R::WMI_CLASS_NAME, role);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Query the association objects of a type that refer to this one.
+
+template <typename T>
+template <typename A>
+inline TypedObjectIterator<A> TypedObject<T>::references(const tstring& role) const
+{
+	return Object::references(A::WMI_CLASS_NAME, role);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Refresh the state of a set of objects with a query per batch, rather than a
+//! call per object. The positions of the objects that no longer exist are
+//! returned and those objects are left unchanged.
+
+template <typename T>
+inline void TypedObject<T>::refreshAll(std::vector<T>& objects, Object::Indices& vanished)
+{
+	Object::Objects pointers;
+
+	pointers.reserve(objects.size());
+
+	for (typename std::vector<T>::iterator it = objects.begin(); it != objects.end(); ++it)
+	{
+		TypedObject<T>* typed = &*it;
+
+		pointers.push_back(typed);
+	}
+
+	Object::refreshAll(pointers, vanished);
+}
+
 //namespace WMI
 }
 
@@ -0,0 +1,794 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   TypedObjectGenerator.cpp
+//! \brief  The TypedObjectGenerator class definition.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include "TypedObjectGenerator.hpp"
+#include "Exception.hpp"
+#include <WCL/VariantVector.hpp>
+#include <WCL/ComStr.hpp>
+#include <Core/StringUtils.hpp>
+#include <algorithm>
+#include <tchar.h>
+
+#ifndef _MSC_VER
+WCL_DECLARE_IFACETRAITS(IWbemClassObject, IID_IWbemClassObject);
+WCL_DECLARE_IFACETRAITS(IWbemQualifierSet, IID_IWbemQualifierSet);
+#endif
+
+namespace WMI
+{
+
+//! The separator line that precedes each definition.
+static const tchar* SEPARATOR = TXT("////////////////////////////////////////////////////////////////////////////////\n");
+
+//! The C++ keywords that a parameter name could collide with.
+static const tchar* KEYWORDS[] =
+{
+	TXT("and"), TXT("and_eq"), TXT("asm"), TXT("auto"), TXT("bitand"), TXT("bitor"),
+	TXT("bool"), TXT("break"), TXT("case"), TXT("catch"), TXT("char"), TXT("class"),
+	TXT("compl"), TXT("const"), TXT("const_cast"), TXT("continue"), TXT("default"), TXT("delete"),
+	TXT("do"), TXT("double"), TXT("dynamic_cast"), TXT("else"), TXT("enum"), TXT("explicit"),
+	TXT("export"), TXT("extern"), TXT("false"), TXT("float"), TXT("for"), TXT("friend"),
+	TXT("goto"), TXT("if"), TXT("inline"), TXT("int"), TXT("long"), TXT("mutable"),
+	TXT("namespace"), TXT("new"), TXT("not"), TXT("not_eq"), TXT("nullptr"), TXT("operator"),
+	TXT("or"), TXT("or_eq"), TXT("private"), TXT("protected"), TXT("public"), TXT("register"),
+	TXT("reinterpret_cast"), TXT("return"), TXT("short"), TXT("signed"), TXT("sizeof"), TXT("static"),
+	TXT("static_cast"), TXT("struct"), TXT("switch"), TXT("template"), TXT("this"), TXT("throw"),
+	TXT("true"), TXT("try"), TXT("typedef"), TXT("typeid"), TXT("typename"), TXT("union"),
+	TXT("unsigned"), TXT("using"), TXT("virtual"), TXT("void"), TXT("volatile"), TXT("wchar_t"),
+	TXT("while"), TXT("xor"), TXT("xor_eq")
+};
+
+//! The names used by the generated method wrappers, which a parameter must not
+//! hide, i.e. their locals and the Object members they call.
+static const tchar* RESERVED_NAMES[] =
+{
+	TXT("arguments"), TXT("createArgumentsObject"), TXT("execMethod"), TXT("getArgument"),
+	TXT("results"), TXT("returnValue"), TXT("setArgument"), TXT("value")
+};
+
+//! The ways in which a value is decoded.
+enum Decoding
+{
+	AS_STRING,		//!< Read as a string.
+	AS_BOOLEAN,		//!< Read as a bool.
+	AS_INT32,		//!< Read directly as a 32-bit integer.
+	AS_SMALL_INT,	//!< Coerced to a 32-bit integer.
+	AS_INT64,		//!< Parsed from a string.
+	AS_REAL,		//!< Coerced to a double.
+	AS_DATETIME,	//!< Parsed from a DMTF date/time string.
+	AS_VARIANT		//!< Returned as is.
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//! Choose the cheapest decoding for a CIM type. WMI passes all 32-bit integers,
+//! and unsigned 16-bit ones, as VT_I4 but 64-bit integers as strings.
+
+static Decoding chooseDecoding(CIMTYPE type, bool interval)
+{
+	if ((type & CIM_FLAG_ARRAY) != 0)
+		return AS_VARIANT;
+
+	switch (type)
+	{
+		case CIM_STRING:
+		case CIM_REFERENCE:		return AS_STRING;
+		case CIM_DATETIME:		return (interval) ? AS_STRING : AS_DATETIME;
+		case CIM_BOOLEAN:		return AS_BOOLEAN;
+		case CIM_SINT32:
+		case CIM_UINT32:
+		case CIM_UINT16:		return AS_INT32;
+		case CIM_SINT8:
+		case CIM_UINT8:
+		case CIM_SINT16:
+		case CIM_CHAR16:		return AS_SMALL_INT;
+		case CIM_SINT64:
+		case CIM_UINT64:		return AS_INT64;
+		case CIM_REAL32:
+		case CIM_REAL64:		return AS_REAL;
+		default:				break;
+	}
+
+	return AS_VARIANT;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the C++ type used for a CIM type.
+
+static const tchar* formatTypeName(CIMTYPE type, Decoding decoding)
+{
+	switch (decoding)
+	{
+		case AS_STRING:		return TXT("tstring");
+		case AS_BOOLEAN:	return TXT("bool");
+		case AS_REAL:		return TXT("double");
+		case AS_DATETIME:	return TXT("CDateTime");
+		case AS_VARIANT:	return TXT("WCL::Variant");
+		default:			break;
+	}
+
+	switch (type)
+	{
+		case CIM_SINT8:		return TXT("int8");
+		case CIM_UINT8:		return TXT("uint8");
+		case CIM_SINT16:	return TXT("int16");
+		case CIM_UINT16:
+		case CIM_CHAR16:	return TXT("uint16");
+		case CIM_SINT32:	return TXT("int32");
+		case CIM_UINT32:	return TXT("uint32");
+		case CIM_SINT64:	return TXT("int64");
+		case CIM_UINT64:	return TXT("uint64");
+		default:			break;
+	}
+
+	ASSERT_FALSE();
+	return TXT("WCL::Variant");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Query if a name is one of a set.
+
+static bool isOneOf(const tstring& name, const tchar* const* names, size_t count)
+{
+	for (size_t i = 0; i != count; ++i)
+	{
+		if (name == names[i])
+			return true;
+	}
+
+	return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Format the name of a parameter, which starts in lower case unless that
+//! would make it a keyword or hide a name used by the generated code. A name
+//! that would still clash, as it was already in lower case, gets a trailing
+//! underscore.
+
+static tstring formatParameterName(const tstring& name)
+{
+	tstring parameter = name;
+
+	parameter[0] = static_cast<tchar>(_totlower(parameter[0]));
+
+	if (!isOneOf(parameter, KEYWORDS, ARRAY_SIZE(KEYWORDS))
+	 && !isOneOf(parameter, RESERVED_NAMES, ARRAY_SIZE(RESERVED_NAMES)))
+		return parameter;
+
+	if (parameter != name)
+		return name;
+
+	return parameter + TXT("_");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Construction from the class definition. The definition is read up front so
+//! the generator can outlive it.
+
+TypedObjectGenerator::TypedObjectGenerator(IWbemClassObjectPtr definition)
+	: m_className()
+	, m_properties()
+	, m_methods()
+{
+	ASSERT(definition.get() != nullptr);
+
+	WCL::Variant className;
+
+	HRESULT result = definition->Get(L"__CLASS", 0, &className, nullptr, nullptr);
+
+	if (FAILED(result))
+		throw Exception(result, definition, TXT("Failed to retrieve the name of the class to generate"));
+
+	m_className = WCL::getValue<tstring>(className);
+
+	readProperties(definition, m_properties);
+	readMethods(definition);
+
+	// Order the members for stable output and the parameters by position.
+	std::stable_sort(m_properties.begin(), m_properties.end(), compareNames<Property>);
+	std::stable_sort(m_methods.begin(), m_methods.end(), compareNames<Method>);
+
+	for (Methods::iterator it = m_methods.begin(); it != m_methods.end(); ++it)
+	{
+		std::stable_sort(it->m_parameters.begin(), it->m_parameters.end(), compareIds);
+		std::stable_sort(it->m_results.begin(), it->m_results.end(), compareIds);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Destructor.
+
+TypedObjectGenerator::~TypedObjectGenerator()
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Set the default value of a method's input parameter, e.g. "0", which is
+//! written as is into the declaration of the wrapper. Only the trailing inputs
+//! of a method without output parameters can have defaults, so a default that
+//! would be followed by a parameter without one is not written. Returns false
+//! if the method has no such input parameter.
+
+bool TypedObjectGenerator::setDefaultArgument(const tstring& method, const tstring& parameter, const tstring& value)
+{
+	for (Methods::iterator it = m_methods.begin(); it != m_methods.end(); ++it)
+	{
+		if (it->m_name != method)
+			continue;
+
+		for (Properties::iterator param = it->m_parameters.begin(); param != it->m_parameters.end(); ++param)
+		{
+			if (param->m_name == parameter)
+			{
+				param->m_default = value;
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Generate the header file, containing the class declaration and the inline
+//! property getters.
+
+tstring TypedObjectGenerator::generateHeader() const
+{
+	tstring guard = TXT("WMI_") + m_className + TXT("_HPP");
+
+	for (tstring::iterator it = guard.begin(); it != guard.end(); ++it)
+		*it = static_cast<tchar>(_totupper(*it));
+
+	bool dateTimes = false;
+	bool integers = false;
+
+	for (Properties::const_iterator it = m_properties.begin(); it != m_properties.end(); ++it)
+	{
+		const Decoding decoding = chooseDecoding(it->m_type, it->m_interval);
+
+		dateTimes |= (decoding == AS_DATETIME);
+		integers  |= (decoding == AS_INT64);
+	}
+
+	tstring output;
+
+	output += SEPARATOR;
+	output += Core::fmt(TXT("//! \\file   %s.hpp\n"), m_className.c_str());
+	output += Core::fmt(TXT("//! \\brief  The %s class declaration.\n"), m_className.c_str());
+	output += TXT("//! \\note   Generated from the WMI class definition by the Gen tool.\n");
+	output += TXT("\n");
+	output += TXT("// Check for previous inclusion\n");
+	output += Core::fmt(TXT("#ifndef %s\n"), guard.c_str());
+	output += Core::fmt(TXT("#define %s\n"), guard.c_str());
+	output += TXT("\n");
+	output += TXT("#if _MSC_VER > 1000\n");
+	output += TXT("#pragma once\n");
+	output += TXT("#endif\n");
+	output += TXT("\n");
+	output += TXT("#include \"TypedObject.hpp\"\n");
+
+	if (dateTimes)
+		output += TXT("#include \"DateTime.hpp\"\n");
+
+	if (integers)
+		output += TXT("#include <Core/StringUtils.hpp>\n");
+
+	output += TXT("\n");
+	output += TXT("namespace WMI\n");
+	output += TXT("{\n");
+	output += TXT("\n");
+	output += SEPARATOR;
+	output += Core::fmt(TXT("//! The C++ facade for the %s WMI class.\n"), m_className.c_str());
+	output += TXT("\n");
+	output += Core::fmt(TXT("class %s : public TypedObject<%s>\n"), m_className.c_str(), m_className.c_str());
+	output += TXT("{\n");
+	output += TXT("public:\n");
+	output += TXT("\t//! Construction from the underlying COM object and connection.\n");
+	output += Core::fmt(TXT("\t%s(IWbemClassObjectPtr object, const Connection& connection);\n"), m_className.c_str());
+	output += TXT("\n");
+	output += TXT("\t//! Destructor.\n");
+	output += Core::fmt(TXT("\tvirtual ~%s();\n"), m_className.c_str());
+
+	if (!m_properties.empty())
+	{
+		output += TXT("\n");
+		output += TXT("\t//\n");
+		output += TXT("\t// WMI typed properties.\n");
+		output += TXT("\t//\n");
+
+		for (Properties::const_iterator it = m_properties.begin(); it != m_properties.end(); ++it)
+		{
+			output += TXT("\n");
+			output += Core::fmt(TXT("\t//! The %s property.\n"), it->m_name.c_str());
+			output += TXT("\t") + formatGetterDeclaration(*it) + TXT(";\n");
+		}
+	}
+
+	if (!m_methods.empty())
+	{
+		output += TXT("\n");
+		output += TXT("\t//\n");
+		output += TXT("\t// WMI methods.\n");
+		output += TXT("\t//\n");
+
+		for (Methods::const_iterator it = m_methods.begin(); it != m_methods.end(); ++it)
+		{
+			output += TXT("\n");
+			output += Core::fmt(TXT("\t//! Execute the %s method.\n"), it->m_name.c_str());
+			output += TXT("\tuint32 ") + formatMethodSignature(*it, true) + TXT(";\n");
+		}
+	}
+
+	output += TXT("\n");
+	output += TXT("\t//\n");
+	output += TXT("\t// Constants.\n");
+	output += TXT("\t//\n");
+	output += TXT("\n");
+	output += TXT("\t//! The WMI class name this type mirrors.\n");
+	output += TXT("\tstatic const tchar* WMI_CLASS_NAME;\n");
+	output += TXT("};\n");
+
+	for (Properties::const_iterator it = m_properties.begin(); it != m_properties.end(); ++it)
+		output += TXT("\n") + formatGetterDefinition(*it);
+
+	output += TXT("\n");
+	output += TXT("//namespace WMI\n");
+	output += TXT("}\n");
+	output += TXT("\n");
+	output += Core::fmt(TXT("#endif // %s\n"), guard.c_str());
+
+	return output;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Generate the source file, containing the class name, construction and the
+//! method wrappers.
+
+tstring TypedObjectGenerator::generateSource() const
+{
+	const tchar* name = m_className.c_str();
+
+	tstring output;
+
+	output += SEPARATOR;
+	output += Core::fmt(TXT("//! \\file   %s.cpp\n"), name);
+	output += Core::fmt(TXT("//! \\brief  The %s class definition.\n"), name);
+	output += TXT("//! \\note   Generated from the WMI class definition by the Gen tool.\n");
+	output += TXT("\n");
+	output += TXT("#include \"Common.hpp\"\n");
+	output += Core::fmt(TXT("#include \"%s.hpp\"\n"), name);
+	output += TXT("\n");
+	output += TXT("namespace WMI\n");
+	output += TXT("{\n");
+	output += TXT("\n");
+	output += TXT("//! The WMI class name this type mirrors.\n");
+	output += Core::fmt(TXT("const tchar* %s::WMI_CLASS_NAME = TXT(\"%s\");\n"), name, name);
+	output += TXT("\n");
+	output += SEPARATOR;
+	output += TXT("//! Construction from the underlying COM object and connection.\n");
+	output += TXT("\n");
+	output += Core::fmt(TXT("%s::%s(IWbemClassObjectPtr object, const Connection& connection)\n"), name, name);
+	output += Core::fmt(TXT("\t: TypedObject<%s>(object, connection)\n"), name);
+	output += TXT("{\n");
+	output += TXT("}\n");
+	output += TXT("\n");
+	output += SEPARATOR;
+	output += TXT("//! Destructor.\n");
+	output += TXT("\n");
+	output += Core::fmt(TXT("%s::~%s()\n"), name, name);
+	output += TXT("{\n");
+	output += TXT("}\n");
+
+	for (Methods::const_iterator it = m_methods.begin(); it != m_methods.end(); ++it)
+		output += TXT("\n") + formatMethodDefinition(*it);
+
+	output += TXT("\n");
+	output += TXT("//namespace WMI\n");
+	output += TXT("}\n");
+
+	return output;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Read the non-system properties of a class or method signature. A date/time
+//! is an interval if it has the SubType qualifier set to "interval" and the ID
+//! qualifier gives the position of a method parameter.
+
+void TypedObjectGenerator::readProperties(IWbemClassObjectPtr definition, Properties& properties)
+{
+	SAFEARRAY* array = nullptr;
+
+	HRESULT result = definition->GetNames(nullptr, WBEM_FLAG_NONSYSTEM_ONLY, nullptr, &array);
+
+	if (FAILED(result))
+		throw Exception(result, definition, TXT("Failed to retrieve the property names of the class to generate"));
+
+	WCL::VariantVector<BSTR> names(array, VT_BSTR, true);
+
+	for (size_t i = 0; i != names.size(); ++i)
+	{
+		Property property;
+
+		property.m_name = names[i];
+		property.m_type = CIM_EMPTY;
+		property.m_interval = false;
+		property.m_id = static_cast<int32>(i);
+
+		result = definition->Get(names[i], 0, nullptr, &property.m_type, nullptr);
+
+		if (FAILED(result))
+			throw Exception(result, definition, TXT("Failed to retrieve the type of a property of the class to generate"));
+
+		IWbemQualifierSetPtr qualifiers;
+
+		if (SUCCEEDED(definition->GetPropertyQualifierSet(names[i], AttachTo(qualifiers))))
+		{
+			WCL::Variant subType;
+			WCL::Variant id;
+
+			if (SUCCEEDED(qualifiers->Get(L"SubType", 0, &subType, nullptr)) && (V_VT(&subType) == VT_BSTR))
+				property.m_interval = (_wcsicmp(V_BSTR(&subType), L"interval") == 0);
+
+			if (SUCCEEDED(qualifiers->Get(L"ID", 0, &id, nullptr)) && (V_VT(&id) == VT_I4))
+				property.m_id = V_I4(&id);
+		}
+
+		properties.push_back(property);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Read the non-static methods of the class and their input and output
+//! parameters. Static methods are invoked on the class rather than an instance
+//! and so are not wrapped.
+
+void TypedObjectGenerator::readMethods(IWbemClassObjectPtr definition)
+{
+	HRESULT result = definition->BeginMethodEnumeration(0);
+
+	if (FAILED(result))
+		throw Exception(result, definition, TXT("Failed to enumerate the methods of the class to generate"));
+
+	for (;;)
+	{
+		BSTR                name = nullptr;
+		IWbemClassObjectPtr signature;
+		IWbemClassObjectPtr results;
+
+		if (definition->NextMethod(0, &name, AttachTo(signature), AttachTo(results)) != WBEM_S_NO_ERROR)
+			break;
+
+		Method method;
+
+		method.m_name = name;
+
+		::SysFreeString(name);
+
+		IWbemQualifierSetPtr qualifiers;
+		WCL::Variant         isStatic;
+
+		if (SUCCEEDED(definition->GetMethodQualifierSet(WCL::ComStr(method.m_name).Get(), AttachTo(qualifiers)))
+		 && SUCCEEDED(qualifiers->Get(L"Static", 0, &isStatic, nullptr))
+		 && (V_VT(&isStatic) == VT_BOOL) && (V_BOOL(&isStatic) != VARIANT_FALSE))
+		{
+			continue;
+		}
+
+		if (signature.get() != nullptr)
+			readProperties(signature, method.m_parameters);
+
+		if (results.get() != nullptr)
+			readResults(results, method);
+
+		m_methods.push_back(method);
+	}
+
+	definition->EndMethodEnumeration();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Read the output parameters of a method. The return value is returned by the
+//! wrapper itself and an in/out parameter is only passed in.
+
+void TypedObjectGenerator::readResults(IWbemClassObjectPtr signature, Method& method)
+{
+	Properties results;
+
+	readProperties(signature, results);
+
+	for (Properties::const_iterator it = results.begin(); it != results.end(); ++it)
+	{
+		bool isInput = (_wcsicmp(it->m_name.c_str(), L"ReturnValue") == 0);
+
+		for (Properties::const_iterator input = method.m_parameters.begin(); !isInput && (input != method.m_parameters.end()); ++input)
+			isInput = (_wcsicmp(it->m_name.c_str(), input->m_name.c_str()) == 0);
+
+		if (!isInput)
+			method.m_results.push_back(*it);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Order properties and methods by name, ignoring case.
+
+template<typename T>
+bool TypedObjectGenerator::compareNames(const T& lhs, const T& rhs)
+{
+	return (_wcsicmp(lhs.m_name.c_str(), rhs.m_name.c_str()) < 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Order method parameters by position.
+
+bool TypedObjectGenerator::compareIds(const Property& lhs, const Property& rhs)
+{
+	return (lhs.m_id < rhs.m_id);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Format the declaration of a property getter.
+
+tstring TypedObjectGenerator::formatGetterDeclaration(const Property& property)
+{
+	const Decoding decoding = chooseDecoding(property.m_type, property.m_interval);
+
+	return Core::fmt(TXT("%s %s() const"), formatTypeName(property.m_type, decoding), property.m_name.c_str());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Format the definition of a property getter.
+
+tstring TypedObjectGenerator::formatGetterDefinition(const Property& property) const
+{
+	const Decoding decoding = chooseDecoding(property.m_type, property.m_interval);
+	const tchar*   type = formatTypeName(property.m_type, decoding);
+	const tchar*   name = property.m_name.c_str();
+
+	tstring output;
+
+	output += SEPARATOR;
+	output += Core::fmt(TXT("//! The %s property.\n"), name);
+	output += TXT("\n");
+	output += Core::fmt(TXT("inline %s %s::%s() const\n"), type, m_className.c_str(), name);
+	output += TXT("{\n");
+
+	switch (decoding)
+	{
+		case AS_STRING:
+		case AS_BOOLEAN:
+		{
+			output += Core::fmt(TXT("\treturn getProperty<%s>(TXT(\"%s\"));\n"), type, name);
+		}
+		break;
+
+		case AS_INT32:
+		{
+			if (property.m_type == CIM_SINT32)
+				output += Core::fmt(TXT("\treturn getProperty<int32>(TXT(\"%s\"));\n"), name);
+			else
+				output += Core::fmt(TXT("\treturn static_cast<%s>(getProperty<int32>(TXT(\"%s\")));\n"), type, name);
+		}
+		break;
+
+		case AS_INT64:
+		{
+			output += TXT("\t// 64-bit values are passed as BSTR values.\n");
+			output += Core::fmt(TXT("\tconst tstring value = getProperty<tstring>(TXT(\"%s\"));\n"), name);
+			output += Core::fmt(TXT("\treturn Core::parse<%s>(value);\n"), type);
+		}
+		break;
+
+		case AS_DATETIME:
+		{
+			output += Core::fmt(TXT("\treturn parseDateTime(getProperty<tstring>(TXT(\"%s\")));\n"), name);
+		}
+		break;
+
+		case AS_SMALL_INT:
+		case AS_REAL:
+		case AS_VARIANT:
+		{
+			output += TXT("\tWCL::Variant value;\n");
+			output += TXT("\n");
+			output += Core::fmt(TXT("\tgetProperty(TXT(\"%s\"), value);\n"), name);
+			output += TXT("\n");
+
+			if (decoding == AS_SMALL_INT)
+				output += Core::fmt(TXT("\treturn static_cast<%s>(WCL::getValue<int32>(WCL::Variant(value, VT_I4)));\n"), type);
+			else if (decoding == AS_REAL)
+				output += TXT("\treturn WCL::getValue<double>(WCL::Variant(value, VT_R8));\n");
+			else
+				output += TXT("\treturn value;\n");
+		}
+		break;
+	}
+
+	output += TXT("}\n");
+
+	return output;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Format the signature of a method wrapper. Date/time arguments are passed in
+//! their DMTF string form. The output parameters follow the inputs and are
+//! passed by reference. The defaults of the trailing inputs are only included
+//! in the declaration.
+
+tstring TypedObjectGenerator::formatMethodSignature(const Method& method, bool withDefaults)
+{
+	size_t firstDefault = method.m_parameters.size();
+
+	if (withDefaults && method.m_results.empty())
+	{
+		while ( (firstDefault != 0) && !method.m_parameters[firstDefault-1].m_default.empty() )
+			--firstDefault;
+	}
+
+	tstring signature = method.m_name + TXT("(");
+
+	for (Properties::const_iterator it = method.m_parameters.begin(); it != method.m_parameters.end(); ++it)
+	{
+		const Decoding decoding = chooseDecoding(it->m_type, true);
+		const tchar*   type = formatTypeName(it->m_type, decoding);
+
+		if (it != method.m_parameters.begin())
+			signature += TXT(", ");
+
+		if ( (decoding == AS_STRING) || (decoding == AS_VARIANT) )
+			signature += Core::fmt(TXT("const %s& "), type);
+		else
+			signature += Core::fmt(TXT("%s "), type);
+
+		signature += formatParameterName(it->m_name);
+
+		if (static_cast<size_t>(it - method.m_parameters.begin()) >= firstDefault)
+			signature += TXT(" = ") + it->m_default;
+	}
+
+	for (Properties::const_iterator it = method.m_results.begin(); it != method.m_results.end(); ++it)
+	{
+		const Decoding decoding = chooseDecoding(it->m_type, true);
+		const tchar*   type = formatTypeName(it->m_type, decoding);
+
+		if (!method.m_parameters.empty() || (it != method.m_results.begin()))
+			signature += TXT(", ");
+
+		signature += Core::fmt(TXT("%s& "), type);
+		signature += formatParameterName(it->m_name);
+	}
+
+	return signature + TXT(")");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Format the definition of a method wrapper. The arguments object is spawned
+//! from the definition cached by the connection. An output parameter is only
+//! assigned if the method set it.
+
+tstring TypedObjectGenerator::formatMethodDefinition(const Method& method) const
+{
+	const bool hasArguments = !method.m_parameters.empty();
+	const bool hasResults = !method.m_results.empty();
+
+	tstring output;
+
+	output += SEPARATOR;
+	output += Core::fmt(TXT("//! Execute the %s method.\n"), method.m_name.c_str());
+	output += TXT("\n");
+	output += Core::fmt(TXT("uint32 %s::%s\n"), m_className.c_str(), formatMethodSignature(method, false).c_str());
+	output += TXT("{\n");
+
+	if (!hasArguments && !hasResults)
+	{
+		output += TXT("\tWCL::Variant returnValue;\n");
+		output += TXT("\n");
+		output += Core::fmt(TXT("\texecMethod(TXT(\"%s\"), returnValue);\n"), method.m_name.c_str());
+	}
+	else
+	{
+		output += Core::fmt(TXT("\tconst tchar* METHOD = TXT(\"%s\");\n"), method.m_name.c_str());
+		output += TXT("\n");
+
+		if (hasArguments)
+		{
+			output += TXT("\tIWbemClassObjectPtr arguments = createArgumentsObject(WMI_CLASS_NAME, METHOD);\n");
+			output += TXT("\n");
+		}
+
+		for (Properties::const_iterator it = method.m_parameters.begin(); it != method.m_parameters.end(); ++it)
+		{
+			const Decoding decoding = chooseDecoding(it->m_type, true);
+			const tstring  name = formatParameterName(it->m_name);
+
+			tstring value;
+
+			switch (decoding)
+			{
+				case AS_INT32:
+				case AS_SMALL_INT:	value = Core::fmt(TXT("WCL::Variant(static_cast<int32>(%s))"), name.c_str());	break;
+				case AS_INT64:		value = Core::fmt(TXT("WCL::Variant(Core::format(%s))"), name.c_str());			break;
+				case AS_VARIANT:	value = name;																		break;
+				default:			value = Core::fmt(TXT("WCL::Variant(%s)"), name.c_str());						break;
+			}
+
+			output += Core::fmt(TXT("\tsetArgument(arguments, TXT(\"%s\"), %s);\n"), it->m_name.c_str(), value.c_str());
+		}
+
+		if (hasArguments)
+			output += TXT("\n");
+
+		if (!hasResults)
+		{
+			output += TXT("\tWCL::Variant returnValue;\n");
+			output += TXT("\n");
+			output += TXT("\texecMethod(METHOD, arguments, returnValue);\n");
+		}
+		else
+		{
+			output += TXT("\tWCL::Variant        returnValue;\n");
+			output += TXT("\tIWbemClassObjectPtr results;\n");
+			output += TXT("\n");
+
+			if (hasArguments)
+				output += TXT("\texecMethod(METHOD, arguments, returnValue, results);\n");
+			else
+				output += TXT("\texecMethod(METHOD, IWbemClassObjectPtr(), returnValue, results);\n");
+
+			for (Properties::const_iterator it = method.m_results.begin(); it != method.m_results.end(); ++it)
+				output += TXT("\n") + formatResultAssignment(*it);
+		}
+	}
+
+	output += TXT("\n");
+	output += TXT("\treturn WCL::getValue<uint32>(WCL::Variant(returnValue, VT_UI4));\n");
+	output += TXT("}\n");
+
+	return output;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Format the assignment of an output parameter, which is decoded in the same
+//! way as a property.
+
+tstring TypedObjectGenerator::formatResultAssignment(const Property& result)
+{
+	const Decoding decoding = chooseDecoding(result.m_type, true);
+	const tchar*   type = formatTypeName(result.m_type, decoding);
+	const tstring  name = formatParameterName(result.m_name);
+
+	tstring value;
+
+	switch (decoding)
+	{
+		case AS_STRING:		value = TXT("WCL::getValue<tstring>(value)");											break;
+		case AS_BOOLEAN:	value = TXT("WCL::getValue<bool>(value)");												break;
+		case AS_INT64:		value = Core::fmt(TXT("Core::parse<%s>(WCL::getValue<tstring>(value))"), type);		break;
+		case AS_REAL:		value = TXT("WCL::getValue<double>(WCL::Variant(value, VT_R8))");						break;
+		case AS_VARIANT:	value = TXT("value");																	break;
+		default:
+		{
+			if (result.m_type == CIM_SINT32)
+				value = TXT("WCL::getValue<int32>(WCL::Variant(value, VT_I4))");
+			else
+				value = Core::fmt(TXT("static_cast<%s>(WCL::getValue<int32>(WCL::Variant(value, VT_I4)))"), type);
+		}
+		break;
+	}
+
+	tstring output;
+
+	output += TXT("\t{\n");
+	output += TXT("\t\tWCL::Variant value;\n");
+	output += TXT("\n");
+	output += Core::fmt(TXT("\t\tif (getArgument(results, TXT(\"%s\"), value))\n"), result.m_name.c_str());
+	output += Core::fmt(TXT("\t\t\t%s = %s;\n"), name.c_str(), value.c_str());
+	output += TXT("\t}\n");
+
+	return output;
+}
+
+//namespace WMI
+}
@@ -0,0 +1,139 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   TypedObjectGenerator.hpp
+//! \brief  The TypedObjectGenerator class declaration.
+//! \author Chris Oldwood
+
+// Check for previous inclusion
+#ifndef WMI_TYPEDOBJECTGENERATOR_HPP
+#define WMI_TYPEDOBJECTGENERATOR_HPP
+
+#if _MSC_VER > 1000
+#pragma once
+#endif
+
+#include "Types.hpp"
+#include <vector>
+
+namespace WMI
+{
+
+////////////////////////////////////////////////////////////////////////////////
+//! Generates the source for a TypedObject derived facade from a WMI class
+//! definition, either fetched from a namespace or captured in a MemoryObject.
+//! Each property getter uses the cheapest decoding for its CIM type, e.g.
+//! 32-bit integers are read directly whereas 64-bit ones are parsed from their
+//! string form. A wrapper is generated for each non-static method, which
+//! creates its arguments from the connection's cached definition and returns
+//! any output parameters through reference arguments. As WMI does not describe
+//! default values, those for the trailing inputs of a method can be supplied
+//! so that a regenerated wrapper keeps its existing signature.
+
+class TypedObjectGenerator
+{
+public:
+	//! Construction from the class definition.
+	explicit TypedObjectGenerator(IWbemClassObjectPtr definition); // throw(WMI::Exception)
+
+	//! Destructor.
+	~TypedObjectGenerator();
+
+	//
+	// Properties.
+	//
+
+	//! Get the WMI class name.
+	const tstring& className() const;
+
+	//
+	// Methods.
+	//
+
+	//! Set the default value of a method's input parameter.
+	bool setDefaultArgument(const tstring& method, const tstring& parameter, const tstring& value);
+
+	//! Generate the header file, containing the class and property getters.
+	tstring generateHeader() const;
+
+	//! Generate the source file, containing the method wrappers.
+	tstring generateSource() const;
+
+private:
+	//! A property or method parameter.
+	struct Property
+	{
+		tstring	m_name;		//!< The name.
+		CIMTYPE	m_type;		//!< The CIM type.
+		bool	m_interval;	//!< Whether a date/time is an interval.
+		int32	m_id;		//!< The position of a method parameter.
+		tstring	m_default;	//!< The default value of an input parameter, or empty if none.
+	};
+
+	//! A collection of properties.
+	typedef std::vector<Property> Properties;
+
+	//! A method.
+	struct Method
+	{
+		tstring		m_name;			//!< The name.
+		Properties	m_parameters;	//!< The input parameters, in order.
+		Properties	m_results;		//!< The output parameters, in order, except the return value.
+	};
+
+	//! A collection of methods.
+	typedef std::vector<Method> Methods;
+
+	//
+	// Members.
+	//
+	tstring		m_className;	//!< The WMI class name.
+	Properties	m_properties;	//!< The properties, by name.
+	Methods		m_methods;		//!< The non-static methods, by name.
+
+	//
+	// Internal methods.
+	//
+
+	//! Read the non-system properties of a class or method signature.
+	static void readProperties(IWbemClassObjectPtr definition, Properties& properties); // throw(WMI::Exception)
+
+	//! Read the non-static methods of the class.
+	void readMethods(IWbemClassObjectPtr definition); // throw(WMI::Exception)
+
+	//! Order properties and methods by name, ignoring case.
+	template<typename T>
+	static bool compareNames(const T& lhs, const T& rhs);
+
+	//! Order method parameters by position.
+	static bool compareIds(const Property& lhs, const Property& rhs);
+
+	//! Read the output parameters of a method that are not also inputs.
+	static void readResults(IWbemClassObjectPtr signature, Method& method); // throw(WMI::Exception)
+
+	//! Format the declaration of a property getter.
+	static tstring formatGetterDeclaration(const Property& property);
+
+	//! Format the definition of a property getter.
+	tstring formatGetterDefinition(const Property& property) const;
+
+	//! Format the signature of a method wrapper.
+	static tstring formatMethodSignature(const Method& method, bool withDefaults);
+
+	//! Format the definition of a method wrapper.
+	tstring formatMethodDefinition(const Method& method) const;
+
+	//! Format the assignment of an output parameter.
+	static tstring formatResultAssignment(const Property& result);
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the WMI class name.
+
+inline const tstring& TypedObjectGenerator::className() const
+{
+	return m_className;
+}
+
+//namespace WMI
+}
+
+#endif // WMI_TYPEDOBJECTGENERATOR_HPP
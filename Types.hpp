@@ -28,6 +28,8 @@ typedef WCL::ComPtr<IWbemServices> IWbemServicesPtr;
 typedef WCL::ComPtr<IEnumWbemClassObject> IEnumWbemClassObjectPtr;
 //! The WMI object type.
 typedef WCL::ComPtr<IWbemClassObject> IWbemClassObjectPtr;
+//! The WMI qualifier set type.
+typedef WCL::ComPtr<IWbemQualifierSet> IWbemQualifierSetPtr;
 
 //namespace WMI
 }
@@ -1,11 +1,10 @@
 ////////////////////////////////////////////////////////////////////////////////
 //! \file   Win32_Process.cpp
 //! \brief  The Win32_Process class definition.
-//! \author Chris Oldwood
+//! \note   Generated from the WMI class definition by the Gen tool.
 
 #include "Common.hpp"
 #include "Win32_Process.hpp"
-#include "Exception.hpp"
 
 namespace WMI
 {
@@ -29,19 +28,122 @@ Win32_Process::~Win32_Process()
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-//! Terminate the process.
+//! Execute the AttachDebugger method.
+
+uint32 Win32_Process::AttachDebugger()
+{
+	WCL::Variant returnValue;
+
+	execMethod(TXT("AttachDebugger"), returnValue);
+
+	return WCL::getValue<uint32>(WCL::Variant(returnValue, VT_UI4));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Execute the GetAvailableVirtualSize method.
+
+uint32 Win32_Process::GetAvailableVirtualSize(uint64& availableVirtualSize)
+{
+	const tchar* METHOD = TXT("GetAvailableVirtualSize");
+
+	WCL::Variant        returnValue;
+	IWbemClassObjectPtr results;
+
+	execMethod(METHOD, IWbemClassObjectPtr(), returnValue, results);
+
+	{
+		WCL::Variant value;
+
+		if (getArgument(results, TXT("AvailableVirtualSize"), value))
+			availableVirtualSize = Core::parse<uint64>(WCL::getValue<tstring>(value));
+	}
+
+	return WCL::getValue<uint32>(WCL::Variant(returnValue, VT_UI4));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Execute the GetOwner method.
+
+uint32 Win32_Process::GetOwner(tstring& user, tstring& domain)
+{
+	const tchar* METHOD = TXT("GetOwner");
+
+	WCL::Variant        returnValue;
+	IWbemClassObjectPtr results;
+
+	execMethod(METHOD, IWbemClassObjectPtr(), returnValue, results);
+
+	{
+		WCL::Variant value;
+
+		if (getArgument(results, TXT("User"), value))
+			user = WCL::getValue<tstring>(value);
+	}
+
+	{
+		WCL::Variant value;
+
+		if (getArgument(results, TXT("Domain"), value))
+			domain = WCL::getValue<tstring>(value);
+	}
+
+	return WCL::getValue<uint32>(WCL::Variant(returnValue, VT_UI4));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Execute the GetOwnerSid method.
+
+uint32 Win32_Process::GetOwnerSid(tstring& sid)
+{
+	const tchar* METHOD = TXT("GetOwnerSid");
+
+	WCL::Variant        returnValue;
+	IWbemClassObjectPtr results;
+
+	execMethod(METHOD, IWbemClassObjectPtr(), returnValue, results);
+
+	{
+		WCL::Variant value;
+
+		if (getArgument(results, TXT("Sid"), value))
+			sid = WCL::getValue<tstring>(value);
+	}
+
+	return WCL::getValue<uint32>(WCL::Variant(returnValue, VT_UI4));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Execute the SetPriority method.
+
+uint32 Win32_Process::SetPriority(int32 priority)
+{
+	const tchar* METHOD = TXT("SetPriority");
+
+	IWbemClassObjectPtr arguments = createArgumentsObject(WMI_CLASS_NAME, METHOD);
+
+	setArgument(arguments, TXT("Priority"), WCL::Variant(static_cast<int32>(priority)));
+
+	WCL::Variant returnValue;
+
+	execMethod(METHOD, arguments, returnValue);
+
+	return WCL::getValue<uint32>(WCL::Variant(returnValue, VT_UI4));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Execute the Terminate method.
 
 uint32 Win32_Process::Terminate(uint32 reason)
 {
-	const tchar* TERMINATE = TXT("Terminate");
+	const tchar* METHOD = TXT("Terminate");
 
-	IWbemClassObjectPtr arguments = createArgumentsObject(WMI_CLASS_NAME, TERMINATE);
+	IWbemClassObjectPtr arguments = createArgumentsObject(WMI_CLASS_NAME, METHOD);
 
-	setArgument(arguments, TXT("Reason"), WCL::Variant((int32)reason));
+	setArgument(arguments, TXT("Reason"), WCL::Variant(static_cast<int32>(reason)));
 
 	WCL::Variant returnValue;
 
-	execMethod(TERMINATE, arguments, returnValue);
+	execMethod(METHOD, arguments, returnValue);
 
 	return WCL::getValue<uint32>(WCL::Variant(returnValue, VT_UI4));
 }
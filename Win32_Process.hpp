@@ -1,7 +1,7 @@
 ////////////////////////////////////////////////////////////////////////////////
 //! \file   Win32_Process.hpp
 //! \brief  The Win32_Process class declaration.
-//! \author Chris Oldwood
+//! \note   Generated from the WMI class definition by the Gen tool.
 
 // Check for previous inclusion
 #ifndef WMI_WIN32_PROCESS_HPP
@@ -34,35 +34,161 @@ public:
 	// WMI typed properties.
 	//
 
-	//! The command line.
+	//! The Caption property.
+	tstring Caption() const;
+
+	//! The CommandLine property.
 	tstring CommandLine() const;
 
-	//! The number of handles it has open.
+	//! The CreationClassName property.
+	tstring CreationClassName() const;
+
+	//! The CreationDate property.
+	CDateTime CreationDate() const;
+
+	//! The CSCreationClassName property.
+	tstring CSCreationClassName() const;
+
+	//! The CSName property.
+	tstring CSName() const;
+
+	//! The Description property.
+	tstring Description() const;
+
+	//! The ExecutablePath property.
+	tstring ExecutablePath() const;
+
+	//! The ExecutionState property.
+	uint16 ExecutionState() const;
+
+	//! The Handle property.
+	tstring Handle() const;
+
+	//! The HandleCount property.
 	uint32 HandleCount() const;
 
-	//! The name of the process.
+	//! The InstallDate property.
+	CDateTime InstallDate() const;
+
+	//! The KernelModeTime property.
+	uint64 KernelModeTime() const;
+
+	//! The MaximumWorkingSetSize property.
+	uint32 MaximumWorkingSetSize() const;
+
+	//! The MinimumWorkingSetSize property.
+	uint32 MinimumWorkingSetSize() const;
+
+	//! The Name property.
 	tstring Name() const;
 
-	//! The number of privately allocated pages.
+	//! The OSCreationClassName property.
+	tstring OSCreationClassName() const;
+
+	//! The OSName property.
+	tstring OSName() const;
+
+	//! The OtherOperationCount property.
+	uint64 OtherOperationCount() const;
+
+	//! The OtherTransferCount property.
+	uint64 OtherTransferCount() const;
+
+	//! The PageFaults property.
+	uint32 PageFaults() const;
+
+	//! The PageFileUsage property.
+	uint32 PageFileUsage() const;
+
+	//! The ParentProcessId property.
+	uint32 ParentProcessId() const;
+
+	//! The PeakPageFileUsage property.
+	uint32 PeakPageFileUsage() const;
+
+	//! The PeakVirtualSize property.
+	uint64 PeakVirtualSize() const;
+
+	//! The PeakWorkingSetSize property.
+	uint32 PeakWorkingSetSize() const;
+
+	//! The Priority property.
+	uint32 Priority() const;
+
+	//! The PrivatePageCount property.
 	uint64 PrivatePageCount() const;
 
-	//! The unique ID of the process.
+	//! The ProcessId property.
 	uint32 ProcessId() const;
 
-	//! The number of threads it has running.
+	//! The QuotaNonPagedPoolUsage property.
+	uint32 QuotaNonPagedPoolUsage() const;
+
+	//! The QuotaPagedPoolUsage property.
+	uint32 QuotaPagedPoolUsage() const;
+
+	//! The QuotaPeakNonPagedPoolUsage property.
+	uint32 QuotaPeakNonPagedPoolUsage() const;
+
+	//! The QuotaPeakPagedPoolUsage property.
+	uint32 QuotaPeakPagedPoolUsage() const;
+
+	//! The ReadOperationCount property.
+	uint64 ReadOperationCount() const;
+
+	//! The ReadTransferCount property.
+	uint64 ReadTransferCount() const;
+
+	//! The SessionId property.
+	uint32 SessionId() const;
+
+	//! The Status property.
+	tstring Status() const;
+
+	//! The TerminationDate property.
+	CDateTime TerminationDate() const;
+
+	//! The ThreadCount property.
 	uint32 ThreadCount() const;
 
-	//! The amount of virtual address space used, in bytes.
+	//! The UserModeTime property.
+	uint64 UserModeTime() const;
+
+	//! The VirtualSize property.
 	uint64 VirtualSize() const;
 
-	//! The size of its working set, in bytes.
+	//! The WindowsVersion property.
+	tstring WindowsVersion() const;
+
+	//! The WorkingSetSize property.
 	uint64 WorkingSetSize() const;
 
+	//! The WriteOperationCount property.
+	uint64 WriteOperationCount() const;
+
+	//! The WriteTransferCount property.
+	uint64 WriteTransferCount() const;
+
 	//
 	// WMI methods.
 	//
 
-	//! Terminate the process.
+	//! Execute the AttachDebugger method.
+	uint32 AttachDebugger();
+
+	//! Execute the GetAvailableVirtualSize method.
+	uint32 GetAvailableVirtualSize(uint64& availableVirtualSize);
+
+	//! Execute the GetOwner method.
+	uint32 GetOwner(tstring& user, tstring& domain);
+
+	//! Execute the GetOwnerSid method.
+	uint32 GetOwnerSid(tstring& sid);
+
+	//! Execute the SetPriority method.
+	uint32 SetPriority(int32 priority);
+
+	//! Execute the Terminate method.
 	uint32 Terminate(uint32 reason = 0);
 
 	//
@@ -74,7 +200,15 @@ public:
 };
 
 ////////////////////////////////////////////////////////////////////////////////
-//! The command line.
+//! The Caption property.
+
+inline tstring Win32_Process::Caption() const
+{
+	return getProperty<tstring>(TXT("Caption"));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! The CommandLine property.
 
 inline tstring Win32_Process::CommandLine() const
 {
@@ -82,15 +216,113 @@ inline tstring Win32_Process::CommandLine() const
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-//! The number of handles it has open.
+//! The CreationClassName property.
+
+inline tstring Win32_Process::CreationClassName() const
+{
+	return getProperty<tstring>(TXT("CreationClassName"));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! The CreationDate property.
+
+inline CDateTime Win32_Process::CreationDate() const
+{
+	return parseDateTime(getProperty<tstring>(TXT("CreationDate")));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! The CSCreationClassName property.
+
+inline tstring Win32_Process::CSCreationClassName() const
+{
+	return getProperty<tstring>(TXT("CSCreationClassName"));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! The CSName property.
+
+inline tstring Win32_Process::CSName() const
+{
+	return getProperty<tstring>(TXT("CSName"));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! The Description property.
+
+inline tstring Win32_Process::Description() const
+{
+	return getProperty<tstring>(TXT("Description"));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! The ExecutablePath property.
+
+inline tstring Win32_Process::ExecutablePath() const
+{
+	return getProperty<tstring>(TXT("ExecutablePath"));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! The ExecutionState property.
+
+inline uint16 Win32_Process::ExecutionState() const
+{
+	return static_cast<uint16>(getProperty<int32>(TXT("ExecutionState")));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! The Handle property.
+
+inline tstring Win32_Process::Handle() const
+{
+	return getProperty<tstring>(TXT("Handle"));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! The HandleCount property.
 
 inline uint32 Win32_Process::HandleCount() const
 {
-	return getProperty<int32>(TXT("HandleCount"));
+	return static_cast<uint32>(getProperty<int32>(TXT("HandleCount")));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-//! The name of the process.
+//! The InstallDate property.
+
+inline CDateTime Win32_Process::InstallDate() const
+{
+	return parseDateTime(getProperty<tstring>(TXT("InstallDate")));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! The KernelModeTime property.
+
+inline uint64 Win32_Process::KernelModeTime() const
+{
+	// 64-bit values are passed as BSTR values.
+	const tstring value = getProperty<tstring>(TXT("KernelModeTime"));
+	return Core::parse<uint64>(value);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! The MaximumWorkingSetSize property.
+
+inline uint32 Win32_Process::MaximumWorkingSetSize() const
+{
+	return static_cast<uint32>(getProperty<int32>(TXT("MaximumWorkingSetSize")));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! The MinimumWorkingSetSize property.
+
+inline uint32 Win32_Process::MinimumWorkingSetSize() const
+{
+	return static_cast<uint32>(getProperty<int32>(TXT("MinimumWorkingSetSize")));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! The Name property.
 
 inline tstring Win32_Process::Name() const
 {
@@ -98,7 +330,101 @@ inline tstring Win32_Process::Name() const
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-//! The number of privately allocated pages.
+//! The OSCreationClassName property.
+
+inline tstring Win32_Process::OSCreationClassName() const
+{
+	return getProperty<tstring>(TXT("OSCreationClassName"));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! The OSName property.
+
+inline tstring Win32_Process::OSName() const
+{
+	return getProperty<tstring>(TXT("OSName"));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! The OtherOperationCount property.
+
+inline uint64 Win32_Process::OtherOperationCount() const
+{
+	// 64-bit values are passed as BSTR values.
+	const tstring value = getProperty<tstring>(TXT("OtherOperationCount"));
+	return Core::parse<uint64>(value);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! The OtherTransferCount property.
+
+inline uint64 Win32_Process::OtherTransferCount() const
+{
+	// 64-bit values are passed as BSTR values.
+	const tstring value = getProperty<tstring>(TXT("OtherTransferCount"));
+	return Core::parse<uint64>(value);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! The PageFaults property.
+
+inline uint32 Win32_Process::PageFaults() const
+{
+	return static_cast<uint32>(getProperty<int32>(TXT("PageFaults")));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! The PageFileUsage property.
+
+inline uint32 Win32_Process::PageFileUsage() const
+{
+	return static_cast<uint32>(getProperty<int32>(TXT("PageFileUsage")));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! The ParentProcessId property.
+
+inline uint32 Win32_Process::ParentProcessId() const
+{
+	return static_cast<uint32>(getProperty<int32>(TXT("ParentProcessId")));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! The PeakPageFileUsage property.
+
+inline uint32 Win32_Process::PeakPageFileUsage() const
+{
+	return static_cast<uint32>(getProperty<int32>(TXT("PeakPageFileUsage")));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! The PeakVirtualSize property.
+
+inline uint64 Win32_Process::PeakVirtualSize() const
+{
+	// 64-bit values are passed as BSTR values.
+	const tstring value = getProperty<tstring>(TXT("PeakVirtualSize"));
+	return Core::parse<uint64>(value);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! The PeakWorkingSetSize property.
+
+inline uint32 Win32_Process::PeakWorkingSetSize() const
+{
+	return static_cast<uint32>(getProperty<int32>(TXT("PeakWorkingSetSize")));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! The Priority property.
+
+inline uint32 Win32_Process::Priority() const
+{
+	return static_cast<uint32>(getProperty<int32>(TXT("Priority")));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! The PrivatePageCount property.
 
 inline uint64 Win32_Process::PrivatePageCount() const
 {
@@ -108,23 +434,109 @@ inline uint64 Win32_Process::PrivatePageCount() const
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-//! The unique ID of the process.
+//! The ProcessId property.
 
 inline uint32 Win32_Process::ProcessId() const
 {
-	return getProperty<int32>(TXT("ProcessId"));
+	return static_cast<uint32>(getProperty<int32>(TXT("ProcessId")));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! The QuotaNonPagedPoolUsage property.
+
+inline uint32 Win32_Process::QuotaNonPagedPoolUsage() const
+{
+	return static_cast<uint32>(getProperty<int32>(TXT("QuotaNonPagedPoolUsage")));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! The QuotaPagedPoolUsage property.
+
+inline uint32 Win32_Process::QuotaPagedPoolUsage() const
+{
+	return static_cast<uint32>(getProperty<int32>(TXT("QuotaPagedPoolUsage")));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! The QuotaPeakNonPagedPoolUsage property.
+
+inline uint32 Win32_Process::QuotaPeakNonPagedPoolUsage() const
+{
+	return static_cast<uint32>(getProperty<int32>(TXT("QuotaPeakNonPagedPoolUsage")));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! The QuotaPeakPagedPoolUsage property.
+
+inline uint32 Win32_Process::QuotaPeakPagedPoolUsage() const
+{
+	return static_cast<uint32>(getProperty<int32>(TXT("QuotaPeakPagedPoolUsage")));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! The ReadOperationCount property.
+
+inline uint64 Win32_Process::ReadOperationCount() const
+{
+	// 64-bit values are passed as BSTR values.
+	const tstring value = getProperty<tstring>(TXT("ReadOperationCount"));
+	return Core::parse<uint64>(value);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-//! The number of threads it has running.
+//! The ReadTransferCount property.
+
+inline uint64 Win32_Process::ReadTransferCount() const
+{
+	// 64-bit values are passed as BSTR values.
+	const tstring value = getProperty<tstring>(TXT("ReadTransferCount"));
+	return Core::parse<uint64>(value);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! The SessionId property.
+
+inline uint32 Win32_Process::SessionId() const
+{
+	return static_cast<uint32>(getProperty<int32>(TXT("SessionId")));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! The Status property.
+
+inline tstring Win32_Process::Status() const
+{
+	return getProperty<tstring>(TXT("Status"));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! The TerminationDate property.
+
+inline CDateTime Win32_Process::TerminationDate() const
+{
+	return parseDateTime(getProperty<tstring>(TXT("TerminationDate")));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! The ThreadCount property.
 
 inline uint32 Win32_Process::ThreadCount() const
 {
-	return getProperty<int32>(TXT("ThreadCount"));
+	return static_cast<uint32>(getProperty<int32>(TXT("ThreadCount")));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-//! The amount of virtual address space used, in bytes.
+//! The UserModeTime property.
+
+inline uint64 Win32_Process::UserModeTime() const
+{
+	// 64-bit values are passed as BSTR values.
+	const tstring value = getProperty<tstring>(TXT("UserModeTime"));
+	return Core::parse<uint64>(value);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! The VirtualSize property.
 
 inline uint64 Win32_Process::VirtualSize() const
 {
@@ -134,7 +546,15 @@ inline uint64 Win32_Process::VirtualSize() const
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-//! The size of its working set in bytes.
+//! The WindowsVersion property.
+
+inline tstring Win32_Process::WindowsVersion() const
+{
+	return getProperty<tstring>(TXT("WindowsVersion"));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! The WorkingSetSize property.
 
 inline uint64 Win32_Process::WorkingSetSize() const
 {
@@ -143,6 +563,26 @@ inline uint64 Win32_Process::WorkingSetSize() const
 	return Core::parse<uint64>(value);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+//! The WriteOperationCount property.
+
+inline uint64 Win32_Process::WriteOperationCount() const
+{
+	// 64-bit values are passed as BSTR values.
+	const tstring value = getProperty<tstring>(TXT("WriteOperationCount"));
+	return Core::parse<uint64>(value);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! The WriteTransferCount property.
+
+inline uint64 Win32_Process::WriteTransferCount() const
+{
+	// 64-bit values are passed as BSTR values.
+	const tstring value = getProperty<tstring>(TXT("WriteTransferCount"));
+	return Core::parse<uint64>(value);
+}
+
 //namespace WMI
 }
 
@@ -41,6 +41,9 @@ public:
 	//! The unique name of the service.
 	tstring Name() const;
 
+	//! The ID of the process hosting the service, or 0 if it is stopped.
+	uint32 ProcessId() const;
+
 	//! The type of the service.
 	tstring ServiceType() const;
 
@@ -111,6 +114,14 @@ inline tstring Win32_Service::Name() const
 	return getProperty<tstring>(TXT("Name"));
 }
 
+////////////////////////////////////////////////////////////////////////////////
+//! The ID of the process hosting the service, or 0 if it is stopped.
+
+inline uint32 Win32_Service::ProcessId() const
+{
+	return getProperty<int32>(TXT("ProcessId"));
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 //! The type of the service.
 
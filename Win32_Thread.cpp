@@ -0,0 +1,31 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   Win32_Thread.cpp
+//! \brief  The Win32_Thread class definition.
+//! \note   Generated from the WMI class definition by the Gen tool.
+
+#include "Common.hpp"
+#include "Win32_Thread.hpp"
+
+namespace WMI
+{
+
+//! The WMI class name this type mirrors.
+const tchar* Win32_Thread::WMI_CLASS_NAME = TXT("Win32_Thread");
+
+////////////////////////////////////////////////////////////////////////////////
+//! Construction from the underlying COM object and connection.
+
+Win32_Thread::Win32_Thread(IWbemClassObjectPtr object, const Connection& connection)
+	: TypedObject<Win32_Thread>(object, connection)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Destructor.
+
+Win32_Thread::~Win32_Thread()
+{
+}
+
+//namespace WMI
+}
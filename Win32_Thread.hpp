@@ -0,0 +1,296 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   Win32_Thread.hpp
+//! \brief  The Win32_Thread class declaration.
+//! \note   Generated from the WMI class definition by the Gen tool.
+
+// Check for previous inclusion
+#ifndef WMI_WIN32_THREAD_HPP
+#define WMI_WIN32_THREAD_HPP
+
+#if _MSC_VER > 1000
+#pragma once
+#endif
+
+#include "TypedObject.hpp"
+#include "DateTime.hpp"
+#include <Core/StringUtils.hpp>
+
+namespace WMI
+{
+
+////////////////////////////////////////////////////////////////////////////////
+//! The C++ facade for the Win32_Thread WMI class.
+
+class Win32_Thread : public TypedObject<Win32_Thread>
+{
+public:
+	//! Construction from the underlying COM object and connection.
+	Win32_Thread(IWbemClassObjectPtr object, const Connection& connection);
+
+	//! Destructor.
+	virtual ~Win32_Thread();
+
+	//
+	// WMI typed properties.
+	//
+
+	//! The Caption property.
+	tstring Caption() const;
+
+	//! The CreationClassName property.
+	tstring CreationClassName() const;
+
+	//! The CSCreationClassName property.
+	tstring CSCreationClassName() const;
+
+	//! The CSName property.
+	tstring CSName() const;
+
+	//! The Description property.
+	tstring Description() const;
+
+	//! The ElapsedTime property.
+	uint64 ElapsedTime() const;
+
+	//! The ExecutionState property.
+	uint16 ExecutionState() const;
+
+	//! The Handle property.
+	tstring Handle() const;
+
+	//! The InstallDate property.
+	CDateTime InstallDate() const;
+
+	//! The KernelModeTime property.
+	uint64 KernelModeTime() const;
+
+	//! The Name property.
+	tstring Name() const;
+
+	//! The OSCreationClassName property.
+	tstring OSCreationClassName() const;
+
+	//! The OSName property.
+	tstring OSName() const;
+
+	//! The Priority property.
+	uint32 Priority() const;
+
+	//! The PriorityBase property.
+	uint32 PriorityBase() const;
+
+	//! The ProcessCreationClassName property.
+	tstring ProcessCreationClassName() const;
+
+	//! The ProcessHandle property.
+	tstring ProcessHandle() const;
+
+	//! The StartAddress property.
+	uint32 StartAddress() const;
+
+	//! The Status property.
+	tstring Status() const;
+
+	//! The ThreadState property.
+	uint32 ThreadState() const;
+
+	//! The ThreadWaitReason property.
+	uint32 ThreadWaitReason() const;
+
+	//! The UserModeTime property.
+	uint64 UserModeTime() const;
+
+	//
+	// Constants.
+	//
+
+	//! The WMI class name this type mirrors.
+	static const tchar* WMI_CLASS_NAME;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//! The Caption property.
+
+inline tstring Win32_Thread::Caption() const
+{
+	return getProperty<tstring>(TXT("Caption"));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! The CreationClassName property.
+
+inline tstring Win32_Thread::CreationClassName() const
+{
+	return getProperty<tstring>(TXT("CreationClassName"));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! The CSCreationClassName property.
+
+inline tstring Win32_Thread::CSCreationClassName() const
+{
+	return getProperty<tstring>(TXT("CSCreationClassName"));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! The CSName property.
+
+inline tstring Win32_Thread::CSName() const
+{
+	return getProperty<tstring>(TXT("CSName"));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! The Description property.
+
+inline tstring Win32_Thread::Description() const
+{
+	return getProperty<tstring>(TXT("Description"));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! The ElapsedTime property.
+
+inline uint64 Win32_Thread::ElapsedTime() const
+{
+	// 64-bit values are passed as BSTR values.
+	const tstring value = getProperty<tstring>(TXT("ElapsedTime"));
+	return Core::parse<uint64>(value);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! The ExecutionState property.
+
+inline uint16 Win32_Thread::ExecutionState() const
+{
+	return static_cast<uint16>(getProperty<int32>(TXT("ExecutionState")));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! The Handle property.
+
+inline tstring Win32_Thread::Handle() const
+{
+	return getProperty<tstring>(TXT("Handle"));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! The InstallDate property.
+
+inline CDateTime Win32_Thread::InstallDate() const
+{
+	return parseDateTime(getProperty<tstring>(TXT("InstallDate")));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! The KernelModeTime property.
+
+inline uint64 Win32_Thread::KernelModeTime() const
+{
+	// 64-bit values are passed as BSTR values.
+	const tstring value = getProperty<tstring>(TXT("KernelModeTime"));
+	return Core::parse<uint64>(value);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! The Name property.
+
+inline tstring Win32_Thread::Name() const
+{
+	return getProperty<tstring>(TXT("Name"));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! The OSCreationClassName property.
+
+inline tstring Win32_Thread::OSCreationClassName() const
+{
+	return getProperty<tstring>(TXT("OSCreationClassName"));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! The OSName property.
+
+inline tstring Win32_Thread::OSName() const
+{
+	return getProperty<tstring>(TXT("OSName"));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! The Priority property.
+
+inline uint32 Win32_Thread::Priority() const
+{
+	return static_cast<uint32>(getProperty<int32>(TXT("Priority")));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! The PriorityBase property.
+
+inline uint32 Win32_Thread::PriorityBase() const
+{
+	return static_cast<uint32>(getProperty<int32>(TXT("PriorityBase")));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! The ProcessCreationClassName property.
+
+inline tstring Win32_Thread::ProcessCreationClassName() const
+{
+	return getProperty<tstring>(TXT("ProcessCreationClassName"));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! The ProcessHandle property.
+
+inline tstring Win32_Thread::ProcessHandle() const
+{
+	return getProperty<tstring>(TXT("ProcessHandle"));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! The StartAddress property.
+
+inline uint32 Win32_Thread::StartAddress() const
+{
+	return static_cast<uint32>(getProperty<int32>(TXT("StartAddress")));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! The Status property.
+
+inline tstring Win32_Thread::Status() const
+{
+	return getProperty<tstring>(TXT("Status"));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! The ThreadState property.
+
+inline uint32 Win32_Thread::ThreadState() const
+{
+	return static_cast<uint32>(getProperty<int32>(TXT("ThreadState")));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! The ThreadWaitReason property.
+
+inline uint32 Win32_Thread::ThreadWaitReason() const
+{
+	return static_cast<uint32>(getProperty<int32>(TXT("ThreadWaitReason")));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! The UserModeTime property.
+
+inline uint64 Win32_Thread::UserModeTime() const
+{
+	// 64-bit values are passed as BSTR values.
+	const tstring value = getProperty<tstring>(TXT("UserModeTime"));
+	return Core::parse<uint64>(value);
+}
+
+//namespace WMI
+}
+
+#endif // WMI_WIN32_THREAD_HPP
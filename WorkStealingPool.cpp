@@ -0,0 +1,299 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   WorkStealingPool.cpp
+//! \brief  The WorkStealingPool class definition.
+//! \author Chris Oldwood
+
+#include "Common.hpp"
+#include "WorkStealingPool.hpp"
+#include "Exception.hpp"
+#include <WCL/AutoCom.hpp>
+#include <Core/AnsiWide.hpp>
+#include <process.h>
+#include <algorithm>
+
+namespace WMI
+{
+
+////////////////////////////////////////////////////////////////////////////////
+//! Called on each worker thread before it processes any items.
+
+void WorkStealingPool::Task::startWorker(size_t /*worker*/)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Called on each worker thread after it has processed its last item.
+
+void WorkStealingPool::Task::stopWorker(size_t /*worker*/)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Destructor.
+
+WorkStealingPool::Task::~Task()
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Construction with the number of workers, or one per processor if 0.
+
+WorkStealingPool::WorkStealingPool(size_t workers)
+	: m_workers(workers)
+	, m_shares()
+	, m_chunkSize(DEFAULT_CHUNK_SIZE)
+	, m_failed(0)
+	, m_failureLock()
+	, m_result(S_OK)
+	, m_failure()
+{
+	if (m_workers == 0)
+	{
+		SYSTEM_INFO info;
+
+		::GetSystemInfo(&info);
+
+		m_workers = info.dwNumberOfProcessors;
+	}
+
+	if (m_workers > MAX_WORKERS)
+		m_workers = MAX_WORKERS;
+	else if (m_workers == 0)
+		m_workers = 1;
+
+	for (size_t i = 0; i != m_workers; ++i)
+		m_shares.push_back(SharePtr(new Share));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Destructor.
+
+WorkStealingPool::~WorkStealingPool()
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Process the items [0, count) in chunks, returning when all are done. The
+//! first failure stops the remaining work and is rethrown on the caller's
+//! thread. The caller's thread continues to pump messages whilst it waits so
+//! that workers can call back into a single-threaded apartment.
+
+void WorkStealingPool::run(Task& task, size_t count, size_t chunkSize)
+{
+	ASSERT(chunkSize != 0);
+
+	// Split the work evenly.
+	const size_t share = count / m_workers;
+	const size_t extra = count % m_workers;
+	size_t       begin = 0;
+
+	for (size_t i = 0; i != m_workers; ++i)
+	{
+		const size_t end = begin + share + ((i < extra) ? 1 : 0);
+
+		m_shares[i]->m_begin = begin;
+		m_shares[i]->m_end = end;
+
+		begin = end;
+	}
+
+	m_chunkSize = chunkSize;
+	m_failed = 0;
+	m_result = S_OK;
+	m_failure.clear();
+
+	// Start the workers.
+	std::vector<Worker> workers(m_workers);
+	std::vector<HANDLE> threads;
+
+	for (size_t i = 0; i != m_workers; ++i)
+	{
+		workers[i].m_pool = this;
+		workers[i].m_task = &task;
+		workers[i].m_index = i;
+
+		const uintptr_t thread = _beginthreadex(nullptr, 0, workerThread, &workers[i], 0, nullptr);
+
+		if (thread == 0)
+		{
+			fail(E_OUTOFMEMORY, TXT("Failed to start a worker thread"));
+			break;
+		}
+
+		threads.push_back(reinterpret_cast<HANDLE>(thread));
+	}
+
+	// Wait for them to finish.
+	while (!threads.empty())
+	{
+		DWORD index = 0;
+
+		HRESULT result = ::CoWaitForMultipleHandles(0, INFINITE, static_cast<ULONG>(threads.size()), &threads.front(), &index);
+
+		if (FAILED(result))
+		{
+			::WaitForMultipleObjects(static_cast<DWORD>(threads.size()), &threads.front(), TRUE, INFINITE);
+			index = 0;
+		}
+
+		::CloseHandle(threads[index]);
+		threads.erase(threads.begin() + index);
+	}
+
+	if (m_failed != 0)
+		throw Exception(m_result, m_failure.c_str());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Take the next chunk of work for a worker, stealing some if it has none.
+
+bool WorkStealingPool::takeChunk(size_t worker, size_t& begin, size_t& end)
+{
+	Share& share = *m_shares[worker];
+
+	do
+	{
+		if (m_failed != 0)
+			return false;
+
+		CriticalSection::Lock lock(share.m_lock);
+
+		if (share.m_begin != share.m_end)
+		{
+			begin = share.m_begin;
+			end = std::min(share.m_begin + m_chunkSize, share.m_end);
+
+			share.m_begin = end;
+
+			return true;
+		}
+	}
+	while (steal(worker));
+
+	return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Move the back half of the largest remaining share to a worker. Only one
+//! lock is held at a time and so the largest share is a hint.
+
+bool WorkStealingPool::steal(size_t worker)
+{
+	size_t victim = worker;
+	size_t largest = 0;
+
+	for (size_t i = 0; i != m_workers; ++i)
+	{
+		Share&                share = *m_shares[i];
+		CriticalSection::Lock lock(share.m_lock);
+
+		const size_t remaining = share.m_end - share.m_begin;
+
+		if (remaining > largest)
+		{
+			victim = i;
+			largest = remaining;
+		}
+	}
+
+	if ( (largest == 0) || (victim == worker) )
+		return false;
+
+	size_t begin = 0;
+	size_t end = 0;
+
+	{
+		Share&                share = *m_shares[victim];
+		CriticalSection::Lock lock(share.m_lock);
+
+		const size_t remaining = share.m_end - share.m_begin;
+
+		if (remaining == 0)
+			return true;
+
+		// A share of no more than one chunk is taken whole, as splitting it
+		// would only create chunks smaller than the configured size.
+		const size_t stolen = (remaining <= m_chunkSize) ? remaining : (remaining / 2);
+
+		begin = share.m_end - stolen;
+		end = share.m_end;
+
+		share.m_end = begin;
+	}
+
+	Share&                share = *m_shares[worker];
+	CriticalSection::Lock lock(share.m_lock);
+
+	share.m_begin = begin;
+	share.m_end = end;
+
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Run a worker until there is no work left.
+
+void WorkStealingPool::runWorker(Task& task, size_t worker)
+{
+	try
+	{
+		WCL::AutoCom com(COINIT_MULTITHREADED);
+
+		task.startWorker(worker);
+
+		size_t begin = 0;
+		size_t end = 0;
+
+		while (takeChunk(worker, begin, end))
+			task.process(worker, begin, end);
+
+		task.stopWorker(worker);
+	}
+	catch (const WCL::ComException& e)
+	{
+		fail(e.m_result, e.twhat());
+	}
+	catch (const Core::Exception& e)
+	{
+		fail(E_FAIL, e.twhat());
+	}
+	catch (const std::exception& e)
+	{
+		fail(E_FAIL, A2T(e.what()));
+	}
+	catch (...)
+	{
+		fail(E_FAIL, TXT("Unexpected exception in a worker thread"));
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Record the first failure and stop the workers.
+
+void WorkStealingPool::fail(HRESULT result, const tchar* message)
+{
+	CriticalSection::Lock lock(m_failureLock);
+
+	if (m_failed == 0)
+	{
+		m_result = result;
+		m_failure = message;
+
+		::InterlockedExchange(&m_failed, 1);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! The worker thread function.
+
+unsigned __stdcall WorkStealingPool::workerThread(void* parameter)
+{
+	Worker* worker = static_cast<Worker*>(parameter);
+
+	worker->m_pool->runWorker(*worker->m_task, worker->m_index);
+
+	return 0;
+}
+
+//namespace WMI
+}
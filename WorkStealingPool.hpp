@@ -0,0 +1,145 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file   WorkStealingPool.hpp
+//! \brief  The WorkStealingPool class declaration.
+//! \author Chris Oldwood
+
+// Check for previous inclusion
+#ifndef WMI_WORKSTEALINGPOOL_HPP
+#define WMI_WORKSTEALINGPOOL_HPP
+
+#if _MSC_VER > 1000
+#pragma once
+#endif
+
+#include "CriticalSection.hpp"
+#include <Core/SharedPtr.hpp>
+#include <vector>
+
+namespace WMI
+{
+
+////////////////////////////////////////////////////////////////////////////////
+//! A set of worker threads that process a range of items in parallel. The
+//! range is split evenly between the workers up front and each worker takes
+//! chunks from the front of its own share. A worker that runs out steals the
+//! back half of the largest remaining share, so that uneven per-item costs do
+//! not leave workers idle.
+//!
+//! Each worker joins the multi-threaded apartment for the duration of the run.
+
+class WorkStealingPool : private Core::NotCopyable
+{
+public:
+	//! The work done by the workers.
+	class Task
+	{
+	public:
+		//! Called on each worker thread before it processes any items.
+		virtual void startWorker(size_t worker);
+
+		//! Process the items in the range [begin, end).
+		virtual void process(size_t worker, size_t begin, size_t end) = 0;
+
+		//! Called on each worker thread after it has processed its last item.
+		virtual void stopWorker(size_t worker);
+
+	protected:
+		//! Destructor.
+		virtual ~Task();
+	};
+
+public:
+	//! Construction with the number of workers, or one per processor if 0.
+	explicit WorkStealingPool(size_t workers = 0);
+
+	//! Destructor.
+	~WorkStealingPool();
+
+	//
+	// Properties.
+	//
+
+	//! Get the number of workers.
+	size_t workers() const;
+
+	//
+	// Methods.
+	//
+
+	//! Process the items [0, count) in chunks, returning when all are done.
+	void run(Task& task, size_t count, size_t chunkSize = DEFAULT_CHUNK_SIZE); // throw(WMI::Exception)
+
+	//
+	// Constants.
+	//
+
+	//! The default number of items taken by a worker at a time.
+	static const size_t DEFAULT_CHUNK_SIZE = 64;
+	//! The maximum number of workers.
+	static const size_t MAX_WORKERS = 64;
+
+private:
+	//! The share of the range yet to be processed by a worker.
+	struct Share
+	{
+		CriticalSection	m_lock;		//!< The lock guarding the range.
+		size_t			m_begin;	//!< The first unprocessed item.
+		size_t			m_end;		//!< One past the last unprocessed item.
+	};
+
+	//! The per-worker state passed to the thread function.
+	struct Worker
+	{
+		WorkStealingPool*	m_pool;		//!< The pool.
+		Task*				m_task;		//!< The task being run.
+		size_t				m_index;	//!< The worker number.
+	};
+
+	//! The share smart-pointer type.
+	typedef Core::SharedPtr<Share> SharePtr;
+	//! The collection of shares.
+	typedef std::vector<SharePtr> Shares;
+
+	//
+	// Members.
+	//
+	size_t			m_workers;		//!< The number of workers.
+	Shares			m_shares;		//!< The work remaining, by worker.
+	size_t			m_chunkSize;	//!< The number of items taken at a time.
+	volatile LONG	m_failed;		//!< Set when a worker fails.
+	CriticalSection	m_failureLock;	//!< The lock guarding the failure.
+	HRESULT			m_result;		//!< The error from the first failure.
+	tstring			m_failure;		//!< The message from the first failure.
+
+	//
+	// Internal methods.
+	//
+
+	//! Take the next chunk of work for a worker.
+	bool takeChunk(size_t worker, size_t& begin, size_t& end);
+
+	//! Move half of another worker's remaining share to a worker.
+	bool steal(size_t worker);
+
+	//! Run a worker until there is no work left.
+	void runWorker(Task& task, size_t worker);
+
+	//! Record the first failure and stop the workers.
+	void fail(HRESULT result, const tchar* message);
+
+	//! The worker thread function.
+	static unsigned __stdcall workerThread(void* parameter);
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//! Get the number of workers.
+
+inline size_t WorkStealingPool::workers() const
+{
+	return m_workers;
+}
+
+//namespace WMI
+}
+
+#endif // WMI_WORKSTEALINGPOOL_HPP